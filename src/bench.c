@@ -0,0 +1,667 @@
+/**
+ * @file bench.c
+ * @brief MotiveSyz benchmark harness
+ *
+ * Measures JSON parse and serialize throughput over a corpus, allocator
+ * operation cost on one and several threads, and object lookup latency by
+ * key count. The corpus is generated in memory (documents shaped like
+ * twitter.json, canada.json and citm_catalog.json, plus synthetic deep,
+ * wide and number-heavy ones); JSON files named on the command line are
+ * added to it.
+ *
+ * Every result is printed as one JSON object per line:
+ *
+ *   {"bench":"parse","case":"twitter","engine":"structural","bytes":...,
+ *    "samples":31,"median_ns":...,"p99_ns":...,"mb_per_s":...,
+ *    "allocs_per_doc":...}
+ *
+ * median_ns and p99_ns are per operation (one document, one allocator
+ * call pair or one lookup); mb_per_s is derived from the median, and
+ * allocs_per_doc counts allocations plus reallocations.
+ *
+ * Usage: motivesyz_bench [-n samples] [-t threads] [file.json ...]
+ */
+
+#define _POSIX_C_SOURCE 200809L  /* clock_gettime(), sysconf() */
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "motivesyz/motivesyz.h"
+
+/* Configuration constants */
+#define BENCH_DEFAULT_SAMPLES 31
+#define BENCH_MIN_SAMPLE_NS 2000000.0     /* Each sample repeats its operation for at least 2 ms */
+#define BENCH_ALLOC_OPS 100000            /* Allocate/free pairs per allocator sample */
+#define BENCH_ALLOC_LIVE 256              /* Blocks held live at once in the batch pattern */
+#define BENCH_LOOKUPS 4096                /* Lookups per lookup sample */
+#define BENCH_MAX_CASES 64
+
+/**
+ * @brief Growing text buffer the corpus generators write into
+ */
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} bench_text_t;
+
+/**
+ * @brief One corpus document
+ */
+typedef struct {
+    const char* name;
+    char* text;
+    size_t length;
+} bench_case_t;
+
+/**
+ * @brief Timed operation; returns 0 on success
+ */
+typedef int (*bench_fn_t)(void* arg);
+
+/* Shared state for the multi-threaded allocator run */
+typedef struct {
+    int thread_local_cache;
+    size_t ops;
+    pthread_barrier_t* start;
+    double elapsed_ns;
+} bench_thread_arg_t;
+
+/* Forward declarations */
+static double bench_now_ns(void);
+static int bench_compare_double(const void* a, const void* b);
+static int bench_measure(bench_fn_t fn, void* arg, size_t samples, double* median_ns, double* p99_ns);
+static void bench_append(bench_text_t* text, const char* format, ...);
+static uint32_t bench_random(uint32_t* state);
+static void bench_gen_twitter(bench_text_t* text);
+static void bench_gen_canada(bench_text_t* text);
+static void bench_gen_citm(bench_text_t* text);
+static void bench_gen_deep(bench_text_t* text);
+static void bench_gen_wide(bench_text_t* text);
+static void bench_gen_numbers(bench_text_t* text);
+static int bench_load_file(const char* path, bench_case_t* out);
+static void bench_json(bench_case_t* bench_case, size_t samples);
+static void bench_allocators(size_t samples, size_t threads);
+static void bench_lookup(size_t samples);
+
+/* Parse / serialize operations */
+typedef struct {
+    const bench_case_t* bench_case;
+    ms_json_options_t options;
+    ms_json_value_t* tree;
+} bench_json_arg_t;
+
+static int bench_parse_once(void* arg) {
+    bench_json_arg_t* job = arg;
+    ms_json_value_t* value = NULL;
+    if (ms_json_parse(job->bench_case->text, &job->options, &value) != MS_JSON_SUCCESS) {
+        return 1;
+    }
+    ms_json_destroy(value, NULL);
+    return 0;
+}
+
+static int bench_serialize_once(void* arg) {
+    bench_json_arg_t* job = arg;
+    char* text = NULL;
+    if (ms_json_serialize(job->tree, NULL, &text) != MS_JSON_SUCCESS) {
+        return 1;
+    }
+    ms_allocator_deallocate(ms_allocator_default(), text);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    size_t samples = BENCH_DEFAULT_SAMPLES;
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t threads = online > 1 ? (size_t)online : 2;
+
+    bench_case_t cases[BENCH_MAX_CASES];
+    size_t case_count = 0;
+
+    static void (*const generators[])(bench_text_t*) = {
+        bench_gen_twitter, bench_gen_canada, bench_gen_citm, bench_gen_deep, bench_gen_wide, bench_gen_numbers
+    };
+    static const char* const generator_names[] = { "twitter", "canada", "citm_catalog", "deep", "wide", "numbers" };
+
+    for (size_t i = 0; i < sizeof(generators) / sizeof(generators[0]); i++) {
+        bench_text_t text = {0};
+        generators[i](&text);
+        cases[case_count++] = (bench_case_t){ generator_names[i], text.data, text.length };
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            samples = (size_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            threads = (size_t)strtoul(argv[++i], NULL, 10);
+        } else if (case_count < BENCH_MAX_CASES && bench_load_file(argv[i], &cases[case_count])) {
+            case_count++;
+        } else {
+            fprintf(stderr, "motivesyz_bench: cannot read %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (samples == 0) {
+        samples = 1;
+    }
+    if (threads == 0) {
+        threads = 1;
+    }
+
+    for (size_t i = 0; i < case_count; i++) {
+        bench_json(&cases[i], samples);
+        free(cases[i].text);
+    }
+    bench_allocators(samples, threads);
+    bench_lookup(samples);
+    return 0;
+}
+
+/**
+ * @brief Parse and serialize throughput of one document
+ */
+static void bench_json(bench_case_t* bench_case, size_t samples) {
+    static const ms_json_engine_t engines[] = { MS_JSON_ENGINE_RECURSIVE, MS_JSON_ENGINE_STRUCTURAL };
+    static const char* const engine_names[] = { "recursive", "structural" };
+
+    for (size_t e = 0; e < 2; e++) {
+        bench_json_arg_t job = { bench_case, {0}, NULL };
+        job.options.engine = engines[e];
+
+        /* Allocations of one parse, counted on a private allocator */
+        ms_allocator_t* counting = ms_allocator_create();
+        ms_json_options_t counted = job.options;
+        counted.allocator = counting;
+        ms_json_value_t* tree = NULL;
+        if (!counting || ms_json_parse(bench_case->text, &counted, &tree) != MS_JSON_SUCCESS) {
+            fprintf(stderr, "motivesyz_bench: %s does not parse\n", bench_case->name);
+            ms_allocator_destroy(counting);
+            return;
+        }
+        ms_memory_stats_t stats = {0};
+        ms_allocator_get_stats(counting, &stats);
+        ms_json_destroy(tree, NULL);
+        ms_allocator_destroy(counting);
+
+        double median = 0.0;
+        double p99 = 0.0;
+        if (bench_measure(bench_parse_once, &job, samples, &median, &p99) == 0) {
+            printf("{\"bench\":\"parse\",\"case\":\"%s\",\"engine\":\"%s\",\"bytes\":%zu,\"samples\":%zu,"
+                   "\"median_ns\":%.0f,\"p99_ns\":%.0f,\"mb_per_s\":%.1f,\"allocs_per_doc\":%zu}\n",
+                   bench_case->name, engine_names[e], bench_case->length, samples, median, p99,
+                   (double)bench_case->length * 1e3 / median, stats.allocation_total + stats.reallocation_count);
+        }
+    }
+
+    bench_json_arg_t job = { bench_case, {0}, NULL };
+    if (ms_json_parse(bench_case->text, NULL, &job.tree) != MS_JSON_SUCCESS) {
+        return;
+    }
+
+    size_t output_length = 0;
+    ms_json_serialized_size(job.tree, &output_length);
+
+    /* Allocations and reallocations of one serialization */
+    ms_allocator_t* counting = ms_allocator_create();
+    size_t allocations = 0;
+    char* counted_text = NULL;
+    if (counting && ms_json_serialize(job.tree, counting, &counted_text) == MS_JSON_SUCCESS) {
+        ms_memory_stats_t stats = {0};
+        ms_allocator_get_stats(counting, &stats);
+        allocations = stats.allocation_total + stats.reallocation_count;
+        ms_allocator_deallocate(counting, counted_text);
+    }
+    ms_allocator_destroy(counting);
+
+    double median = 0.0;
+    double p99 = 0.0;
+    if (bench_measure(bench_serialize_once, &job, samples, &median, &p99) == 0) {
+        printf("{\"bench\":\"serialize\",\"case\":\"%s\",\"bytes\":%zu,\"samples\":%zu,"
+               "\"median_ns\":%.0f,\"p99_ns\":%.0f,\"mb_per_s\":%.1f,\"allocs_per_doc\":%zu}\n",
+               bench_case->name, output_length, samples, median, p99, (double)output_length * 1e3 / median,
+               allocations);
+    }
+    ms_json_destroy(job.tree, NULL);
+}
+
+/* Allocator operations */
+typedef struct {
+    ms_allocator_t* allocator;
+    int batch;  /* Hold BENCH_ALLOC_LIVE blocks of mixed sizes before freeing them */
+} bench_alloc_arg_t;
+
+static int bench_alloc_run(ms_allocator_t* allocator, int batch, size_t ops) {
+    void* live[BENCH_ALLOC_LIVE];
+    if (!batch) {
+        for (size_t i = 0; i < ops; i++) {
+            void* block = NULL;
+            if (ms_allocator_allocate(allocator, 48, &block) != MS_MEMORY_SUCCESS) {
+                return 1;
+            }
+            ms_allocator_deallocate(allocator, block);
+        }
+        return 0;
+    }
+
+    for (size_t done = 0; done < ops; done += BENCH_ALLOC_LIVE) {
+        for (size_t i = 0; i < BENCH_ALLOC_LIVE; i++) {
+            if (ms_allocator_allocate(allocator, 16 + (i * 40) % 240, &live[i]) != MS_MEMORY_SUCCESS) {
+                return 1;
+            }
+        }
+        if (ms_allocator_is_arena(allocator)) {
+            ms_allocator_reset(allocator);
+            continue;
+        }
+        for (size_t i = BENCH_ALLOC_LIVE; i-- > 0;) {
+            ms_allocator_deallocate(allocator, live[i]);
+        }
+    }
+    return 0;
+}
+
+static int bench_alloc_once(void* arg) {
+    bench_alloc_arg_t* job = arg;
+    return bench_alloc_run(job->allocator, job->batch, BENCH_ALLOC_OPS);
+}
+
+static void* bench_alloc_thread(void* arg) {
+    bench_thread_arg_t* job = arg;
+    pthread_barrier_wait(job->start);
+    ms_allocator_t* allocator = job->thread_local_cache ? ms_allocator_thread_local() : ms_allocator_default();
+    double start = bench_now_ns();
+    bench_alloc_run(allocator, 1, job->ops);
+    job->elapsed_ns = bench_now_ns() - start;
+    return NULL;
+}
+
+/**
+ * @brief Allocate/deallocate cost per allocator kind, then scaling across threads
+ */
+static void bench_allocators(size_t samples, size_t threads) {
+    ms_allocator_t* pool = ms_allocator_create_pool();
+    ms_allocator_t* arena = ms_allocator_create_arena(0);
+    struct {
+        const char* name;
+        ms_allocator_t* allocator;
+    } kinds[] = { { "default", ms_allocator_default() }, { "pool", pool }, { "arena", arena } };
+
+    for (size_t k = 0; k < sizeof(kinds) / sizeof(kinds[0]); k++) {
+        for (int batch = 0; batch < 2; batch++) {
+            if (!kinds[k].allocator || (!batch && ms_allocator_is_arena(kinds[k].allocator))) {
+                continue;
+            }
+            bench_alloc_arg_t job = { kinds[k].allocator, batch };
+            double median = 0.0;
+            double p99 = 0.0;
+            if (bench_measure(bench_alloc_once, &job, samples, &median, &p99) == 0) {
+                printf("{\"bench\":\"allocator\",\"case\":\"%s\",\"pattern\":\"%s\",\"threads\":1,"
+                       "\"samples\":%zu,\"median_ns\":%.2f,\"p99_ns\":%.2f,\"ops_per_s\":%.0f}\n",
+                       kinds[k].name, batch ? "batch" : "pair", samples, median / BENCH_ALLOC_OPS,
+                       p99 / BENCH_ALLOC_OPS, BENCH_ALLOC_OPS * 1e9 / median);
+            }
+        }
+    }
+    ms_allocator_destroy(pool);
+    ms_allocator_destroy(arena);
+
+    /* Every thread runs the batch pattern at once; throughput is total ops over the slowest thread */
+    pthread_t* handles = malloc(threads * sizeof(*handles));
+    bench_thread_arg_t* args = malloc(threads * sizeof(*args));
+    double* totals = malloc(samples * sizeof(*totals));
+    if (!handles || !args || !totals) {
+        free(handles);
+        free(args);
+        free(totals);
+        return;
+    }
+
+    for (int cache = 0; cache < 2; cache++) {
+        size_t completed = 0;
+        for (size_t s = 0; s < samples; s++) {
+            pthread_barrier_t start;
+            pthread_barrier_init(&start, NULL, (unsigned)threads);
+            size_t started = 0;
+            for (; started < threads; started++) {
+                args[started] = (bench_thread_arg_t){ cache, BENCH_ALLOC_OPS, &start, 0.0 };
+                if (pthread_create(&handles[started], NULL, bench_alloc_thread, &args[started]) != 0) {
+                    break;
+                }
+            }
+            if (started < threads) {
+                /* The barrier can never fill; give up on this run */
+                fprintf(stderr, "motivesyz_bench: cannot start %zu threads\n", threads);
+                exit(1);
+            }
+
+            double slowest = 0.0;
+            for (size_t t = 0; t < threads; t++) {
+                pthread_join(handles[t], NULL);
+                if (args[t].elapsed_ns > slowest) {
+                    slowest = args[t].elapsed_ns;
+                }
+            }
+            pthread_barrier_destroy(&start);
+            totals[completed++] = slowest / BENCH_ALLOC_OPS;
+        }
+
+        qsort(totals, completed, sizeof(*totals), bench_compare_double);
+        double median = totals[completed / 2];
+        double p99 = totals[(completed * 99) / 100 < completed ? (completed * 99) / 100 : completed - 1];
+        printf("{\"bench\":\"allocator\",\"case\":\"%s\",\"pattern\":\"batch\",\"threads\":%zu,"
+               "\"samples\":%zu,\"median_ns\":%.2f,\"p99_ns\":%.2f,\"ops_per_s\":%.0f}\n",
+               cache ? "thread_local" : "default", threads, completed, median, p99, threads * 1e9 / median);
+    }
+
+    free(handles);
+    free(args);
+    free(totals);
+}
+
+/* Object lookup */
+typedef struct {
+    ms_json_value_t* object;
+    char (*keys)[32];
+    size_t key_count;
+    uint32_t seed;
+} bench_lookup_arg_t;
+
+static int bench_lookup_once(void* arg) {
+    bench_lookup_arg_t* job = arg;
+    for (size_t i = 0; i < BENCH_LOOKUPS; i++) {
+        ms_json_value_t* value = NULL;
+        const char* key = job->keys[bench_random(&job->seed) % job->key_count];
+        if (ms_json_get_object_value(job->object, key, &value) != MS_JSON_SUCCESS) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Latency of ms_json_get_object_value() on a hit, by object size
+ */
+static void bench_lookup(size_t samples) {
+    static const size_t key_counts[] = { 1, 4, 7, 8, 16, 64, 256, 1024, 16384, 262144 };
+
+    for (size_t k = 0; k < sizeof(key_counts) / sizeof(key_counts[0]); k++) {
+        bench_lookup_arg_t job = { ms_json_create_object(NULL), NULL, key_counts[k], 12345u };
+        job.keys = malloc(job.key_count * sizeof(*job.keys));
+        if (!job.object || !job.keys) {
+            ms_json_destroy(job.object, NULL);
+            free(job.keys);
+            return;
+        }
+        for (size_t i = 0; i < job.key_count; i++) {
+            snprintf(job.keys[i], sizeof(job.keys[i]), "field_%zu", i);
+            ms_json_object_set(job.object, job.keys[i], ms_json_create_integer(NULL, (int64_t)i));
+        }
+
+        double median = 0.0;
+        double p99 = 0.0;
+        if (bench_measure(bench_lookup_once, &job, samples, &median, &p99) == 0) {
+            printf("{\"bench\":\"lookup\",\"keys\":%zu,\"samples\":%zu,\"median_ns\":%.2f,\"p99_ns\":%.2f}\n",
+                   job.key_count, samples, median / BENCH_LOOKUPS, p99 / BENCH_LOOKUPS);
+        }
+        ms_json_destroy(job.object, NULL);
+        free(job.keys);
+    }
+}
+
+/**
+ * @brief Time fn over samples runs; each sample repeats fn enough times to
+ *        last BENCH_MIN_SAMPLE_NS and reports the mean time of one call
+ *
+ * @return 0 on success, 1 if fn failed
+ */
+static int bench_measure(bench_fn_t fn, void* arg, size_t samples, double* median_ns, double* p99_ns) {
+    /* Warm up and calibrate the repeat count */
+    double start = bench_now_ns();
+    if (fn(arg) != 0) {
+        return 1;
+    }
+    double single = bench_now_ns() - start;
+    size_t repeats = single >= BENCH_MIN_SAMPLE_NS ? 1 : (size_t)(BENCH_MIN_SAMPLE_NS / (single > 1.0 ? single : 1.0)) + 1;
+
+    double* times = malloc(samples * sizeof(*times));
+    if (!times) {
+        return 1;
+    }
+
+    for (size_t s = 0; s < samples; s++) {
+        start = bench_now_ns();
+        for (size_t r = 0; r < repeats; r++) {
+            if (fn(arg) != 0) {
+                free(times);
+                return 1;
+            }
+        }
+        times[s] = (bench_now_ns() - start) / (double)repeats;
+    }
+
+    qsort(times, samples, sizeof(*times), bench_compare_double);
+    *median_ns = times[samples / 2];
+    size_t p99_index = (samples * 99) / 100;
+    *p99_ns = times[p99_index < samples ? p99_index : samples - 1];
+    free(times);
+    return 0;
+}
+
+static double bench_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1e9 + (double)now.tv_nsec;
+}
+
+static int bench_compare_double(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void bench_append(bench_text_t* text, const char* format, ...) {
+    for (;;) {
+        size_t room = text->capacity - text->length;
+        va_list args;
+        va_start(args, format);
+        int written = text->data ? vsnprintf(text->data + text->length, room, format, args) : -1;
+        va_end(args);
+
+        if (written >= 0 && (size_t)written < room) {
+            text->length += (size_t)written;
+            return;
+        }
+
+        size_t capacity = text->capacity ? text->capacity * 2 : 1 << 20;
+        char* data = realloc(text->data, capacity);
+        if (!data) {
+            fprintf(stderr, "motivesyz_bench: out of memory\n");
+            exit(1);
+        }
+        text->data = data;
+        text->capacity = capacity;
+    }
+}
+
+/* xorshift32, so every run generates the same corpus */
+static uint32_t bench_random(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+/**
+ * @brief Social media statuses: nested objects, long strings with escapes
+ */
+static void bench_gen_twitter(bench_text_t* text) {
+    uint32_t seed = 1;
+    bench_append(text, "{\"statuses\":[");
+    for (int i = 0; i < 1500; i++) {
+        uint32_t user = bench_random(&seed);
+        bench_append(text,
+                     "%s{\"created_at\":\"Sun Aug 31 00:29:%02d +0000 2014\",\"id\":%d50532770%04d,"
+                     "\"id_str\":\"%d50532770%04d\",\"text\":\"@aym0566x \\n\\u540d\\u524d:\\u524d\\u7530"
+                     "\\u3042\\u3086\\u307f status %d, see https:\\/\\/t.co\\/%08x\",\"truncated\":false,"
+                     "\"entities\":{\"hashtags\":[{\"text\":\"tag%u\",\"indices\":[%d,%d]}],\"urls\":[],"
+                     "\"user_mentions\":[{\"screen_name\":\"aym0566x\",\"id\":%u,\"indices\":[0,9]}]},"
+                     "\"user\":{\"id\":%u,\"name\":\"user %u\",\"screen_name\":\"sn_%u\",\"location\":\"\","
+                     "\"description\":\"\\u3080\\u3055\\u3057 profile text for user %u\",\"followers_count\":%u,"
+                     "\"friends_count\":%u,\"verified\":false,\"profile_image_url\":\"http:\\/\\/pbs.twimg.com"
+                     "\\/profile_images\\/%u\\/image.jpeg\"},\"geo\":null,\"coordinates\":null,"
+                     "\"retweet_count\":%u,\"favorite_count\":%u,\"favorited\":false,\"retweeted\":false,"
+                     "\"lang\":\"ja\"}",
+                     i ? "," : "", i % 60, 5 + i % 4, i, 5 + i % 4, i, i, bench_random(&seed), user % 1000,
+                     i % 100, i % 100 + 8, user, user, user, user, user, user % 100000, user % 2000, user,
+                     bench_random(&seed) % 1000, bench_random(&seed) % 1000);
+    }
+    bench_append(text, "],\"search_metadata\":{\"completed_in\":0.087,\"max_id\":505874924095815700,"
+                       "\"query\":\"%%E4%%B8%%80\",\"count\":1500,\"since_id\":0}}");
+}
+
+/**
+ * @brief Polygon coordinates: arrays of long doubles
+ */
+static void bench_gen_canada(bench_text_t* text) {
+    uint32_t seed = 2;
+    bench_append(text, "{\"type\":\"FeatureCollection\",\"features\":[");
+    for (int feature = 0; feature < 40; feature++) {
+        bench_append(text, "%s{\"type\":\"Feature\",\"properties\":{\"name\":\"Canada\"},"
+                           "\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[[", feature ? "," : "");
+        for (int point = 0; point < 1500; point++) {
+            double x = -141.0 + (bench_random(&seed) % 8000000) / 100000.0 + 1e-12 * point;
+            double y = 41.0 + (bench_random(&seed) % 4200000) / 100000.0 + 3e-13 * point;
+            bench_append(text, "%s[%.15f,%.14f]", point ? "," : "", x, y);
+        }
+        bench_append(text, "]]}}");
+    }
+    bench_append(text, "]}");
+}
+
+/**
+ * @brief Event catalogue: wide objects keyed by IDs, integer arrays, nulls
+ */
+static void bench_gen_citm(bench_text_t* text) {
+    uint32_t seed = 3;
+    bench_append(text, "{\"areaNames\":{\"205705993\":\"Arri\\u00e8re-sc\\u00e8ne central\",\"205705994\":"
+                       "\"1er balcon central\"},\"events\":{");
+    for (int i = 0; i < 2000; i++) {
+        unsigned id = 138586341u + (unsigned)i * 4u;
+        bench_append(text, "%s\"%u\":{\"description\":null,\"id\":%u,\"logo\":%s,\"name\":\"Event %d\","
+                           "\"subTopicIds\":[337184269,337184283],\"subjectCode\":null,\"subtitle\":null,"
+                           "\"topicIds\":[324846099,107888604]}",
+                     i ? "," : "", id, id, i % 3 ? "null" : "\"/images/UE0AAAAACEKo6QAAAAZDSVRN\"", i);
+    }
+    bench_append(text, "},\"performances\":[");
+    for (int i = 0; i < 2000; i++) {
+        bench_append(text, "%s{\"eventId\":%u,\"id\":%u,\"logo\":null,\"name\":null,\"prices\":[",
+                     i ? "," : "", 138586341u + (unsigned)i * 4u, 339887544u + (unsigned)i);
+        for (int p = 0; p < 4; p++) {
+            bench_append(text, "%s{\"amount\":%u,\"audienceSubCategoryId\":337100890,\"seatCategoryId\":%u}",
+                         p ? "," : "", 10000 + bench_random(&seed) % 90000, 338937295u + (unsigned)p);
+        }
+        bench_append(text, "],\"seatCategories\":[{\"areas\":[{\"areaId\":205705999,\"blockIds\":[]}],"
+                           "\"seatCategoryId\":338937295}],\"seatMapImage\":null,\"start\":%llu,"
+                           "\"venueCode\":\"PLEYEL_PLEYEL\"}", 1372701600000ULL + (unsigned long long)i * 86400000ULL);
+    }
+    bench_append(text, "]}");
+}
+
+/**
+ * @brief Many chains of alternately nested arrays and objects
+ */
+static void bench_gen_deep(bench_text_t* text) {
+    bench_append(text, "[");
+    for (int chain = 0; chain < 400; chain++) {
+        bench_append(text, chain ? "," : "");
+        for (int level = 0; level < 120; level++) {
+            bench_append(text, level % 2 ? "{\"k\":" : "[");
+        }
+        bench_append(text, "%d", chain);
+        for (int level = 119; level >= 0; level--) {
+            bench_append(text, level % 2 ? "}" : "]");
+        }
+    }
+    bench_append(text, "]");
+}
+
+/**
+ * @brief One object with very many keys
+ */
+static void bench_gen_wide(bench_text_t* text) {
+    bench_append(text, "{");
+    for (int i = 0; i < 60000; i++) {
+        bench_append(text, "%s\"property_%d\":{\"v\":%d,\"s\":\"x\"}", i ? "," : "", i, i);
+    }
+    bench_append(text, "}");
+}
+
+/**
+ * @brief Flat array of integers, decimals and exponents
+ */
+static void bench_gen_numbers(bench_text_t* text) {
+    uint32_t seed = 4;
+    bench_append(text, "[");
+    for (int i = 0; i < 150000; i++) {
+        uint32_t r = bench_random(&seed);
+        const char* separator = i ? "," : "";
+        switch (i % 4) {
+            case 0: bench_append(text, "%s%u", separator, r); break;
+            case 1: bench_append(text, "%s-%u", separator, r % 1000); break;
+            case 2: bench_append(text, "%s%.17g", separator, r / 4294967296.0); break;
+            default: bench_append(text, "%s%ue-%u", separator, r % 100000, r % 300); break;
+        }
+    }
+    bench_append(text, "]");
+}
+
+/**
+ * @brief Add a JSON file to the corpus
+ *
+ * @return 1 on success, 0 if it cannot be read
+ */
+static int bench_load_file(const char* path, bench_case_t* out) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return 0;
+    }
+
+    bench_text_t text = {0};
+    char chunk[65536];
+    size_t read = 0;
+    while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        if (text.length + read + 1 > text.capacity) {
+            size_t capacity = text.capacity ? text.capacity : 1 << 20;
+            while (capacity < text.length + read + 1) {
+                capacity *= 2;
+            }
+            char* data = realloc(text.data, capacity);
+            if (!data) {
+                fclose(file);
+                free(text.data);
+                return 0;
+            }
+            text.data = data;
+            text.capacity = capacity;
+        }
+        memcpy(text.data + text.length, chunk, read);
+        text.length += read;
+    }
+    fclose(file);
+    if (!text.data) {
+        return 0;
+    }
+    text.data[text.length] = '\0';
+
+    const char* name = strrchr(path, '/');
+    *out = (bench_case_t){ name ? name + 1 : path, text.data, text.length };
+    return 1;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file ms_instrument.c
+ * @brief Per-thread phase counters and the trace hook
+ *
+ * Counters live in thread-local storage, so recording a span takes two
+ * clock reads and a few plain additions, with no shared cache lines.
+ */
+
+#define _POSIX_C_SOURCE 200809L  /* clock_gettime() */
+
+#include "ms_instrument.h"
+#include "ms_platform.h"
+#include <string.h>
+#include <time.h>
+
+/**
+ * @defgroup instrument_state Instrumentation State
+ * @{
+ */
+
+static MS_THREAD_LOCAL ms_instrument_counters_t thread_counters; /**< Calling thread's totals */
+static MS_THREAD_LOCAL int thread_in_hook = 0;     /**< Hook is running on this thread */
+static ms_instrument_hook_t trace_hook = NULL;     /**< Installed hook, NULL for none */
+static void* trace_hook_ctx = NULL;                /**< Context passed to the hook */
+static unsigned int trace_hook_phases = 0;         /**< MS_INSTRUMENT_MASK() bits that call it */
+
+/** @} */
+
+/* Forward declarations */
+static uint64_t ms_instrument_now(void);
+
+int ms_instrument_enabled(void) {
+#ifdef MS_INSTRUMENT
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+void ms_instrument_get(ms_instrument_counters_t* counters) {
+    if (counters) {
+        *counters = thread_counters;
+    }
+}
+
+void ms_instrument_reset(void) {
+    memset(&thread_counters, 0, sizeof(thread_counters));
+}
+
+void ms_instrument_set_hook(ms_instrument_hook_t hook, void* user_ctx, unsigned int phases) {
+    MS_ATOMIC_STORE(&trace_hook_ctx, user_ctx);
+    MS_ATOMIC_STORE(&trace_hook_phases, phases);
+    MS_ATOMIC_STORE_RELEASE(&trace_hook, hook);
+}
+
+const char* ms_instrument_phase_name(ms_instrument_phase_t phase) {
+    static const char* const names[MS_INSTRUMENT_PHASE_COUNT] = {
+        "parse", "tokenize", "string", "number", "growth", "allocator", "serialize"
+    };
+    return (unsigned int)phase < MS_INSTRUMENT_PHASE_COUNT ? names[phase] : "unknown";
+}
+
+ms_instrument_span_t ms_instrument_begin(size_t offset) {
+    ms_instrument_span_t span = { ms_instrument_now(), offset };
+    return span;
+}
+
+void ms_instrument_end(const ms_instrument_span_t* span, ms_instrument_phase_t phase, size_t offset) {
+    uint64_t elapsed = ms_instrument_now() - span->start;
+    size_t bytes = offset - span->offset;
+
+    ms_instrument_phase_stats_t* stats = &thread_counters.phases[phase];
+    stats->calls++;
+    stats->nanoseconds += elapsed;
+    stats->bytes += bytes;
+
+    ms_instrument_hook_t hook = MS_ATOMIC_LOAD_ACQUIRE(&trace_hook);
+    if (hook && !thread_in_hook && (MS_ATOMIC_LOAD(&trace_hook_phases) & MS_INSTRUMENT_MASK(phase))) {
+        thread_in_hook = 1;
+        hook(phase, elapsed, bytes, MS_ATOMIC_LOAD(&trace_hook_ctx));
+        thread_in_hook = 0;
+    }
+}
+
+/* Monotonic clock in nanoseconds */
+static uint64_t ms_instrument_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
@@ -0,0 +1,127 @@
+/**
+ * @file ms_instrument.h
+ * @brief Optional per-phase counters, timers and trace hook
+ *
+ * Built only when MS_INSTRUMENT is defined (make INSTRUMENT=1). Without it
+ * the recording points compile to nothing, the functions below stay
+ * available and report zeros, and the hook is never called.
+ */
+
+#ifndef MS_INSTRUMENT_H
+#define MS_INSTRUMENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Instrumented phases
+ *
+ * Phases nest: string decoding includes the allocations it makes, and a
+ * parse includes every other phase it runs, so times add up per phase, not
+ * across phases.
+ */
+typedef enum {
+    MS_INSTRUMENT_PARSE = 0,   /**< One document parse; bytes of input */
+    MS_INSTRUMENT_TOKENIZE,    /**< Whitespace and comment skipping, structural indexing; bytes skipped or indexed */
+    MS_INSTRUMENT_STRING,      /**< String and key scanning and unescaping; bytes of input */
+    MS_INSTRUMENT_NUMBER,      /**< Number conversion; bytes of input */
+    MS_INSTRUMENT_GROWTH,      /**< Array and object capacity changes; bytes of the new storage */
+    MS_INSTRUMENT_ALLOCATOR,   /**< Allocate, reallocate and deallocate calls; bytes requested */
+    MS_INSTRUMENT_SERIALIZE,   /**< One serialization; bytes of output, 0 for sinks */
+    MS_INSTRUMENT_PHASE_COUNT
+} ms_instrument_phase_t;
+
+/** Bit of a phase in the mask of ms_instrument_set_hook() */
+#define MS_INSTRUMENT_MASK(phase) (1u << (phase))
+
+/**
+ * @brief Totals of one phase
+ */
+typedef struct {
+    uint64_t calls;        /**< Spans recorded */
+    uint64_t nanoseconds;  /**< Monotonic time spent inside them */
+    uint64_t bytes;        /**< Sum of the bytes each span reports */
+} ms_instrument_phase_stats_t;
+
+/**
+ * @brief Totals of every phase for one thread
+ */
+typedef struct {
+    ms_instrument_phase_stats_t phases[MS_INSTRUMENT_PHASE_COUNT];
+} ms_instrument_counters_t;
+
+/**
+ * @brief Called at the end of each span of a selected phase
+ *
+ * Runs on the thread that did the work, inside the library call. Spans the
+ * hook itself causes, such as its own allocations, are counted but do not
+ * call it again.
+ */
+typedef void (*ms_instrument_hook_t)(ms_instrument_phase_t phase, uint64_t nanoseconds, size_t bytes,
+                                     void* user_ctx);
+
+/**
+ * @brief Whether the library was built with MS_INSTRUMENT
+ */
+int ms_instrument_enabled(void);
+
+/**
+ * @brief Copy the calling thread's counters
+ *
+ * Counters accumulate per thread, so resetting before a call and reading
+ * after it attributes exactly that call. Work done on other threads, such
+ * as parallel serializer workers, lands in those threads' counters.
+ */
+void ms_instrument_get(ms_instrument_counters_t* counters);
+
+/**
+ * @brief Zero the calling thread's counters
+ */
+void ms_instrument_reset(void);
+
+/**
+ * @brief Install the trace hook, or remove it with NULL
+ *
+ * @param hook Callback, NULL to remove
+ * @param user_ctx Passed to every hook call
+ * @param phases MS_INSTRUMENT_MASK() bits of the phases that call it
+ *
+ * @note Set it before other threads start working; hook, context and mask
+ *       are not updated as one unit
+ */
+void ms_instrument_set_hook(ms_instrument_hook_t hook, void* user_ctx, unsigned int phases);
+
+/**
+ * @brief Short lowercase phase name such as "parse", for metric labels
+ */
+const char* ms_instrument_phase_name(ms_instrument_phase_t phase);
+
+/**
+ * @defgroup instrument_recording Recording Points
+ * @brief Used inside the library around instrumented code
+ *
+ * A span starts at an input offset and ends at another; the difference is
+ * the byte count reported. Spans that are not about input pass 0 and the
+ * byte count at the end.
+ * @{
+ */
+
+typedef struct {
+    uint64_t start;   /**< Monotonic start time in nanoseconds */
+    size_t offset;    /**< Offset at the start */
+} ms_instrument_span_t;
+
+ms_instrument_span_t ms_instrument_begin(size_t offset);
+void ms_instrument_end(const ms_instrument_span_t* span, ms_instrument_phase_t phase, size_t offset);
+
+#ifdef MS_INSTRUMENT
+#define MS_INSTRUMENT_BEGIN(span, offset) ms_instrument_span_t span = ms_instrument_begin(offset)
+#define MS_INSTRUMENT_END(span, phase, offset) ms_instrument_end(&(span), (phase), (offset))
+#else
+#define MS_INSTRUMENT_BEGIN(span, offset) ((void)0)
+#define MS_INSTRUMENT_END(span, phase, offset) ((void)0)
+#endif
+
+/** @} */
+
+#endif /* MS_INSTRUMENT_H */
@@ -13,6 +13,15 @@
 #include "ms_json_types.h"
 #include "ms_json_api.h"
 #include "ms_json_builder.h"
+#include "ms_json_keys.h"
 #include "ms_json_parser.h"
+#include "ms_json_sax.h"
+#include "ms_json_ndjson.h"
+#include "ms_json_tape.h"
+#include "ms_json_path.h"
+#include "ms_json_serializer.h"
+#include "ms_json_msgpack.h"
+#include "ms_json_fragment.h"
+#include "ms_json_bind.h"
 
 #endif /* MS_JSON_H */
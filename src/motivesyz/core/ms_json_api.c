@@ -5,43 +5,21 @@
 
 #include "ms_json_api.h"
 #include "ms_json_parser.h"
+#include "ms_json_structural.h"
 #include "ms_json_builder.h"
+#include "ms_json_keys.h"
 #include "ms_json_internal.h"
+#include "ms_instrument.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <math.h>
-
-/* Configuration */
-#define JSON_MAX_DEPTH_DEFAULT 256
-#define MAX_FILE_SIZE (10 * 1024 * 1024) /* 10MB max file size */
-#define SERIALIZE_BUFFER_INITIAL_SIZE 1024
-#define SERIALIZE_MAX_DOUBLE_LENGTH 64
-
-/* Serialization context */
-typedef struct {
-    ms_allocator_t* allocator;
-    char* buffer;
-    size_t position;
-    size_t capacity;
-    int needs_comma;
-} ms_json_serialize_context_t;
 
 /* Forward declarations for internal functions */
+static void ms_json_init_context(ms_json_parse_context_t* ctx, const char* input, size_t length,
+                                 const ms_json_options_t* options);
 static ms_json_result_t ms_json_validate_no_trailing_content(ms_json_parse_context_t* ctx, ms_json_value_t** result);
-static char* ms_json_read_entire_file(FILE* file);
 static int ms_json_validate_access(const ms_json_value_t* value, const void* result, ms_json_type_t expected_type);
-
-/* Serialization functions */
-static ms_json_result_t ms_json_serialize_value(const ms_json_value_t* value, ms_json_serialize_context_t* ctx);
-static ms_json_result_t ms_json_serialize_null(ms_json_serialize_context_t* ctx);
-static ms_json_result_t ms_json_serialize_bool(int value, ms_json_serialize_context_t* ctx);
-static ms_json_result_t ms_json_serialize_number(double value, ms_json_serialize_context_t* ctx);
-static ms_json_result_t ms_json_serialize_string(const char* value, ms_json_serialize_context_t* ctx);
-static ms_json_result_t ms_json_serialize_array(const ms_json_value_t* value, ms_json_serialize_context_t* ctx);
-static ms_json_result_t ms_json_serialize_object(const ms_json_value_t* value, ms_json_serialize_context_t* ctx);
-static ms_json_result_t ms_json_serialize_ensure_capacity(ms_json_serialize_context_t* ctx, size_t needed);
-static ms_json_result_t ms_json_serialize_append(ms_json_serialize_context_t* ctx, const char* data, size_t length);
+static ms_json_result_t ms_json_parse_document_tree(ms_json_parse_context_t* ctx, ms_json_value_t** result);
 
 /* Main parsing function */
 ms_json_result_t ms_json_parse(const char* input, const ms_json_options_t* options,
@@ -50,427 +28,193 @@ ms_json_result_t ms_json_parse(const char* input, const ms_json_options_t* optio
         return MS_JSON_ERROR_INVALID_ARGUMENT;
     }
 
-    ms_json_parse_context_t ctx = {
-        .input = input,
-        .position = 0,
-        .length = strlen(input),
-        .options = options ? *options : (ms_json_options_t){0},
-        .allocator = NULL,
-        .depth = 0
-    };
-
-    /* Set default options if not provided */
-    if (!options) {
-        ctx.options.max_depth = JSON_MAX_DEPTH_DEFAULT;
-        ctx.options.allow_comments = 0;
-        ctx.options.allocator = NULL;
-    }
-
-    ctx.allocator = ctx.options.allocator ? ctx.options.allocator : ms_allocator_default();
-
-    if (!ms_json_skip_whitespace_and_comments(&ctx)) {
-        return MS_JSON_ERROR_SYNTAX;
-    }
-
-    ms_json_result_t parse_result = ms_json_parse_value(&ctx, result);
-
-    if (parse_result == MS_JSON_SUCCESS) {
-        parse_result = ms_json_validate_no_trailing_content(&ctx, result);
-    }
-
-    return parse_result;
+    return ms_json_parse_buffer(input, strlen(input), options, result);
 }
 
-static ms_json_result_t ms_json_validate_no_trailing_content(ms_json_parse_context_t* ctx, ms_json_value_t** result) {
-    if (!ctx || !result) {
+ms_json_result_t ms_json_parse_buffer(const char* input, size_t length, const ms_json_options_t* options,
+                                      ms_json_value_t** result) {
+    if ((!input && length > 0) || !result) {
         return MS_JSON_ERROR_INVALID_ARGUMENT;
     }
 
-    ms_json_skip_whitespace_and_comments(ctx);
-
-    if (ctx->position < ctx->length) {
-        if (*result) {
-            ms_json_destroy(*result, ctx->allocator);
-            *result = NULL;
-        }
-        return MS_JSON_ERROR_SYNTAX;
-    }
-
-    return MS_JSON_SUCCESS;
+    ms_json_parse_context_t ctx;
+    ms_json_init_context(&ctx, input, length, options);
+    return ms_json_parse_document(&ctx, result);
 }
 
-/* File I/O operations */
-ms_json_result_t ms_json_parse_file(const char* filename, const ms_json_options_t* options,
-                                   ms_json_value_t** result) {
-    if (!filename || !result) {
-        return MS_JSON_ERROR_INVALID_ARGUMENT;
-    }
-
-    FILE* file = fopen(filename, "rb");
-    if (!file) {
-        return MS_JSON_ERROR_INVALID_ARGUMENT;
-    }
-
-    char* file_content = ms_json_read_entire_file(file);
-    fclose(file);
-
-    if (!file_content) {
-        return MS_JSON_ERROR_MEMORY;
-    }
-
-    ms_json_result_t parse_result = ms_json_parse(file_content, options, result);
-    free(file_content);
+ms_json_result_t ms_json_parse_n(const char* input, size_t length, const ms_json_options_t* options,
+                                 ms_json_value_t** result) {
+    return ms_json_parse_buffer(input, length, options, result);
+}
 
+ms_json_result_t ms_json_parse_document(ms_json_parse_context_t* ctx, ms_json_value_t** result) {
+    MS_INSTRUMENT_BEGIN(span, 0);
+    ms_json_result_t parse_result = ms_json_parse_document_tree(ctx, result);
+    MS_INSTRUMENT_END(span, MS_INSTRUMENT_PARSE, ctx->length);
     return parse_result;
 }
 
-static char* ms_json_read_entire_file(FILE* file) {
-    if (!file) {
-        return NULL;
-    }
-
-    if (fseek(file, 0, SEEK_END) != 0) {
-        return NULL;
-    }
-
-    long file_size = ftell(file);
-    if (file_size < 0 || file_size > MAX_FILE_SIZE) {
-        return NULL;
+/* Pick the engine for a whole document and run it */
+static ms_json_result_t ms_json_parse_document_tree(ms_json_parse_context_t* ctx, ms_json_value_t** result) {
+    /* The structural index has no notion of comments */
+    if (ctx->options.lazy && !ctx->options.allow_comments && ctx->length <= MS_JSON_STRUCTURAL_MAX_INPUT) {
+        return ms_json_lazy_parse(ctx, result);
     }
 
-    if (fseek(file, 0, SEEK_SET) != 0) {
-        return NULL;
+    /* Every object of the tree holds its own reference to the key table */
+    int owns_keys = ctx->keys == NULL;
+    ms_json_result_t parse_result = MS_JSON_SUCCESS;
+    if (owns_keys) {
+        parse_result = ms_json_key_table_acquire(&ctx->options, ctx->allocator, &ctx->keys);
+        if (parse_result != MS_JSON_SUCCESS) {
+            return parse_result;
+        }
     }
 
-    char* content = malloc(file_size + 1);
-    if (!content) {
-        return NULL;
+    if (ctx->options.engine == MS_JSON_ENGINE_STRUCTURAL && !ctx->options.allow_comments &&
+        ctx->length <= MS_JSON_STRUCTURAL_MAX_INPUT) {
+        parse_result = ms_json_structural_parse(ctx, result);
+    } else if (!ms_json_skip_whitespace_and_comments(ctx)) {
+        parse_result = MS_JSON_ERROR_SYNTAX;
+    } else {
+        parse_result = ms_json_parse_value(ctx, result);
+        if (parse_result == MS_JSON_SUCCESS) {
+            parse_result = ms_json_validate_no_trailing_content(ctx, result);
+        }
     }
 
-    size_t bytes_read = fread(content, 1, file_size, file);
-    if (bytes_read != (size_t)file_size) {
-        free(content);
-        return NULL;
+    if (owns_keys) {
+        ms_json_key_table_release(ctx->keys);
+        ctx->keys = NULL;
     }
-
-    content[file_size] = '\0';
-    return content;
+    return parse_result;
 }
 
-ms_json_result_t ms_json_serialize_file(const ms_json_value_t* value, const char* filename) {
-    if (!value || !filename) {
+ms_json_result_t ms_json_parse_sax(const char* input, size_t length, const ms_json_options_t* options,
+                                   const ms_json_sax_handler_t* handler, void* user_ctx) {
+    if (!input && length > 0) {
         return MS_JSON_ERROR_INVALID_ARGUMENT;
     }
 
-    char* json_string = NULL;
-    ms_json_result_t result = ms_json_serialize(value, NULL, &json_string);
+    static const ms_json_sax_handler_t validate_only = {0};
+    ms_json_parse_context_t ctx;
+    ms_json_init_context(&ctx, input, length, options);
 
-    if (result != MS_JSON_SUCCESS) {
-        return result;
+    ms_json_result_t parse_result = ms_json_sax_parse_value(&ctx, handler ? handler : &validate_only, user_ctx);
+    if (parse_result != MS_JSON_SUCCESS) {
+        return parse_result;
     }
 
-    FILE* file = fopen(filename, "w");
-    if (!file) {
-        free(json_string);
-        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    if (!ms_json_skip_whitespace_and_comments(&ctx) || ctx.position < ctx.length) {
+        return MS_JSON_ERROR_SYNTAX;
     }
 
-    size_t len = strlen(json_string);
-    size_t written = fwrite(json_string, 1, len, file);
-    fclose(file);
-
-    free(json_string);
-
-    return (written == len) ? MS_JSON_SUCCESS : MS_JSON_ERROR_INVALID_ARGUMENT;
+    return MS_JSON_SUCCESS;
 }
 
-/* Real serialization implementation */
-ms_json_result_t ms_json_serialize(const ms_json_value_t* value, ms_allocator_t* allocator,
-                                  char** result) {
-    if (!value || !result) {
-        return MS_JSON_ERROR_INVALID_ARGUMENT;
-    }
+static void ms_json_init_context(ms_json_parse_context_t* ctx, const char* input, size_t length,
+                                 const ms_json_options_t* options) {
+    ctx->input = input;
+    ctx->position = 0;
+    ctx->length = length;
+    ctx->depth = 0;
+    ctx->keys = NULL;
+    ctx->scratch = NULL;
 
-    if (!allocator) {
-        allocator = ms_allocator_default();
-    }
-
-    ms_json_serialize_context_t ctx = {
-        .allocator = allocator,
-        .buffer = NULL,
-        .position = 0,
-        .capacity = 0,
-        .needs_comma = 0
-    };
-
-    /* Allocate initial buffer */
-    if (ms_allocator_allocate(allocator, SERIALIZE_BUFFER_INITIAL_SIZE, (void**)&ctx.buffer) != MS_MEMORY_SUCCESS) {
-        return MS_JSON_ERROR_MEMORY;
-    }
-    ctx.capacity = SERIALIZE_BUFFER_INITIAL_SIZE;
-
-    ms_json_result_t serialize_result = ms_json_serialize_value(value, &ctx);
-
-    if (serialize_result == MS_JSON_SUCCESS) {
-        /* Ensure null termination */
-        if (ctx.position >= ctx.capacity) {
-            if (ms_json_serialize_ensure_capacity(&ctx, 1) != MS_JSON_SUCCESS) {
-                ms_allocator_deallocate(allocator, ctx.buffer);
-                return MS_JSON_ERROR_MEMORY;
-            }
-        }
-        ctx.buffer[ctx.position] = '\0';
-        *result = ctx.buffer;
+    /* Set default options if not provided */
+    if (options) {
+        ctx->options = *options;
     } else {
-        if (ctx.buffer) {
-            ms_allocator_deallocate(allocator, ctx.buffer);
-        }
+        ctx->options = (ms_json_options_t){0};
+        ctx->options.max_depth = MS_JSON_MAX_DEPTH_DEFAULT;
     }
 
-    return serialize_result;
+    ctx->allocator = ctx->options.allocator ? ctx->options.allocator : ms_allocator_default();
 }
 
-static ms_json_result_t ms_json_serialize_value(const ms_json_value_t* value, ms_json_serialize_context_t* ctx) {
-    switch (ms_json_value_get_type(value)) {
-        case MS_JSON_NULL:
-            return ms_json_serialize_null(ctx);
-        case MS_JSON_BOOL:
-            return ms_json_serialize_bool(ms_json_value_get_bool(value), ctx);
-        case MS_JSON_NUMBER:
-            return ms_json_serialize_number(ms_json_value_get_number(value), ctx);
-        case MS_JSON_STRING:
-            return ms_json_serialize_string(ms_json_value_get_string(value), ctx);
-        case MS_JSON_ARRAY:
-            return ms_json_serialize_array(value, ctx);
-        case MS_JSON_OBJECT:
-            return ms_json_serialize_object(value, ctx);
-        default:
-            return MS_JSON_ERROR_INVALID_ARGUMENT;
-    }
-}
-
-static ms_json_result_t ms_json_serialize_null(ms_json_serialize_context_t* ctx) {
-    return ms_json_serialize_append(ctx, "null", 4);
-}
-
-static ms_json_result_t ms_json_serialize_bool(int value, ms_json_serialize_context_t* ctx) {
-    if (value) {
-        return ms_json_serialize_append(ctx, "true", 4);
-    } else {
-        return ms_json_serialize_append(ctx, "false", 5);
-    }
-}
-
-static ms_json_result_t ms_json_serialize_number(double value, ms_json_serialize_context_t* ctx) {
-    char number_buffer[SERIALIZE_MAX_DOUBLE_LENGTH];
-
-    /* Handle special cases */
-    if (isnan(value)) {
-        return ms_json_serialize_append(ctx, "null", 4);
-    }
-
-    if (isinf(value)) {
-        if (value > 0) {
-            return ms_json_serialize_append(ctx, "1e999", 5);
-        } else {
-            return ms_json_serialize_append(ctx, "-1e999", 6);
-        }
-    }
-
-    /* Use snprintf for proper formatting */
-    int length = snprintf(number_buffer, sizeof(number_buffer), "%.15g", value);
-
-    if (length < 0 || length >= (int)sizeof(number_buffer)) {
+static ms_json_result_t ms_json_validate_no_trailing_content(ms_json_parse_context_t* ctx, ms_json_value_t** result) {
+    if (!ctx || !result) {
         return MS_JSON_ERROR_INVALID_ARGUMENT;
     }
 
-    return ms_json_serialize_append(ctx, number_buffer, (size_t)length);
-}
-
-static ms_json_result_t ms_json_serialize_string(const char* value, ms_json_serialize_context_t* ctx) {
-    if (!value) {
-        return ms_json_serialize_append(ctx, "\"\"", 2);
-    }
-
-    /* Start with quote */
-    ms_json_result_t result = ms_json_serialize_append(ctx, "\"", 1);
-    if (result != MS_JSON_SUCCESS) {
-        return result;
-    }
-
-    /* Escape and append string content */
-    const char* p = value;
-    while (*p) {
-        char escape_buffer[8];
-        const char* to_append = NULL;
-        size_t append_length = 1;
-
-        switch (*p) {
-            case '"':  to_append = "\\\""; append_length = 2; break;
-            case '\\': to_append = "\\\\"; append_length = 2; break;
-            case '\b': to_append = "\\b"; append_length = 2; break;
-            case '\f': to_append = "\\f"; append_length = 2; break;
-            case '\n': to_append = "\\n"; append_length = 2; break;
-            case '\r': to_append = "\\r"; append_length = 2; break;
-            case '\t': to_append = "\\t"; append_length = 2; break;
-            default:
-                if ((unsigned char)*p < 0x20) {
-                    /* Control character - escape as Unicode */
-                    snprintf(escape_buffer, sizeof(escape_buffer), "\\u%04x", (unsigned char)*p);
-                    to_append = escape_buffer;
-                    append_length = 6;
-                } else {
-                    to_append = p;
-                    append_length = 1;
-                }
-                break;
-        }
+    ms_json_skip_whitespace_and_comments(ctx);
 
-        result = ms_json_serialize_append(ctx, to_append, append_length);
-        if (result != MS_JSON_SUCCESS) {
-            return result;
+    if (ctx->position < ctx->length) {
+        if (*result) {
+            ms_json_destroy(*result, ctx->allocator);
+            *result = NULL;
         }
-
-        p++;
+        return MS_JSON_ERROR_SYNTAX;
     }
 
-    /* Closing quote */
-    return ms_json_serialize_append(ctx, "\"", 1);
+    return MS_JSON_SUCCESS;
 }
 
-static ms_json_result_t ms_json_serialize_array(const ms_json_value_t* value, ms_json_serialize_context_t* ctx) {
-    ms_json_result_t result = ms_json_serialize_append(ctx, "[", 1);
-    if (result != MS_JSON_SUCCESS) {
-        return result;
-    }
-
-    int saved_needs_comma = ctx->needs_comma;
-    ctx->needs_comma = 0;
-
-    const ms_json_array_t* array = ms_json_value_get_array_const(value);
-    for (size_t i = 0; i < array->count; i++) {
-        if (ctx->needs_comma) {
-            result = ms_json_serialize_append(ctx, ",", 1);
-            if (result != MS_JSON_SUCCESS) {
-                return result;
-            }
-        }
-
-        result = ms_json_serialize_value(array->items[i], ctx);
-        if (result != MS_JSON_SUCCESS) {
-            return result;
-        }
-
-        ctx->needs_comma = 1;
-    }
-
-    ctx->needs_comma = saved_needs_comma;
-    return ms_json_serialize_append(ctx, "]", 1);
+/* Value type accessors */
+ms_json_type_t ms_json_get_type(const ms_json_value_t* value) {
+    return value ? ms_json_value_get_type(value) : MS_JSON_NULL;
 }
 
-static ms_json_result_t ms_json_serialize_object(const ms_json_value_t* value, ms_json_serialize_context_t* ctx) {
-    ms_json_result_t result = ms_json_serialize_append(ctx, "{", 1);
-    if (result != MS_JSON_SUCCESS) {
-        return result;
+ms_json_result_t ms_json_get_bool(const ms_json_value_t* value, int* result) {
+    if (!ms_json_validate_access(value, result, MS_JSON_BOOL)) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
     }
 
-    int saved_needs_comma = ctx->needs_comma;
-    ctx->needs_comma = 0;
-
-    const ms_json_object_t* object = ms_json_value_get_object_const(value);
-    for (size_t i = 0; i < object->count; i++) {
-        if (ctx->needs_comma) {
-            result = ms_json_serialize_append(ctx, ",", 1);
-            if (result != MS_JSON_SUCCESS) {
-                return result;
-            }
-        }
-
-        /* Serialize key */
-        result = ms_json_serialize_string(object->entries[i].key, ctx);
-        if (result != MS_JSON_SUCCESS) {
-            return result;
-        }
-
-        /* Colon separator */
-        result = ms_json_serialize_append(ctx, ":", 1);
-        if (result != MS_JSON_SUCCESS) {
-            return result;
-        }
-
-        /* Serialize value */
-        result = ms_json_serialize_value(object->entries[i].value, ctx);
-        if (result != MS_JSON_SUCCESS) {
-            return result;
-        }
+    *result = ms_json_value_get_bool(value);
+    return MS_JSON_SUCCESS;
+}
 
-        ctx->needs_comma = 1;
+ms_json_result_t ms_json_get_number(const ms_json_value_t* value, double* result) {
+    if (!ms_json_validate_access(value, result, MS_JSON_NUMBER)) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
     }
 
-    ctx->needs_comma = saved_needs_comma;
-    return ms_json_serialize_append(ctx, "}", 1);
+    *result = ms_json_value_get_number(value);
+    return MS_JSON_SUCCESS;
 }
 
-static ms_json_result_t ms_json_serialize_ensure_capacity(ms_json_serialize_context_t* ctx, size_t needed) {
-    if (ctx->position + needed <= ctx->capacity) {
-        return MS_JSON_SUCCESS;
-    }
-
-    size_t new_capacity = ctx->capacity * 2;
-    if (new_capacity < ctx->position + needed) {
-        new_capacity = ctx->position + needed;
+ms_json_result_t ms_json_get_int64(const ms_json_value_t* value, int64_t* result) {
+    if (!ms_json_validate_access(value, result, MS_JSON_NUMBER)) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
     }
 
-    char* new_buffer = NULL;
-    if (ms_allocator_reallocate(ctx->allocator, ctx->buffer, new_capacity, (void**)&new_buffer) != MS_MEMORY_SUCCESS) {
-        return MS_JSON_ERROR_MEMORY;
+    if (value->flags & MS_JSON_FLAG_INTEGER) {
+        *result = value->data.integer;
+        return MS_JSON_SUCCESS;
     }
 
-    ctx->buffer = new_buffer;
-    ctx->capacity = new_capacity;
-    return MS_JSON_SUCCESS;
-}
-
-static ms_json_result_t ms_json_serialize_append(ms_json_serialize_context_t* ctx, const char* data, size_t length) {
-    ms_json_result_t result = ms_json_serialize_ensure_capacity(ctx, length);
-    if (result != MS_JSON_SUCCESS) {
-        return result;
+    /* Doubles qualify only when integral and inside [-2^63, 2^63) */
+    double number = value->data.number;
+    if (!(number >= -9223372036854775808.0 && number < 9223372036854775808.0) ||
+        (double)(int64_t)number != number) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
     }
 
-    memcpy(ctx->buffer + ctx->position, data, length);
-    ctx->position += length;
+    *result = (int64_t)number;
     return MS_JSON_SUCCESS;
 }
 
-/* Value type accessors */
-ms_json_type_t ms_json_get_type(const ms_json_value_t* value) {
-    return value ? ms_json_value_get_type(value) : MS_JSON_NULL;
-}
-
-ms_json_result_t ms_json_get_bool(const ms_json_value_t* value, int* result) {
-    if (!ms_json_validate_access(value, result, MS_JSON_BOOL)) {
+ms_json_result_t ms_json_get_string(const ms_json_value_t* value, const char** result) {
+    if (!ms_json_validate_access(value, result, MS_JSON_STRING)) {
         return MS_JSON_ERROR_INVALID_ARGUMENT;
     }
 
-    *result = ms_json_value_get_bool(value);
-    return MS_JSON_SUCCESS;
-}
-
-ms_json_result_t ms_json_get_number(const ms_json_value_t* value, double* result) {
-    if (!ms_json_validate_access(value, result, MS_JSON_NUMBER)) {
+    /* Borrowed strings are not NUL-terminated */
+    if (value->flags & MS_JSON_FLAG_BORROWED) {
         return MS_JSON_ERROR_INVALID_ARGUMENT;
     }
 
-    *result = ms_json_value_get_number(value);
+    *result = ms_json_value_get_string(value);
     return MS_JSON_SUCCESS;
 }
 
-ms_json_result_t ms_json_get_string(const ms_json_value_t* value, const char** result) {
-    if (!ms_json_validate_access(value, result, MS_JSON_STRING)) {
+ms_json_result_t ms_json_get_string_n(const ms_json_value_t* value, const char** result, size_t* length) {
+    if (!ms_json_validate_access(value, result, MS_JSON_STRING) || !length) {
         return MS_JSON_ERROR_INVALID_ARGUMENT;
     }
 
     *result = ms_json_value_get_string(value);
+    *length = ms_json_value_get_string_length(value);
     return MS_JSON_SUCCESS;
 }
 
@@ -484,6 +228,11 @@ ms_json_result_t ms_json_get_array_length(const ms_json_value_t* value, size_t*
         return MS_JSON_ERROR_INVALID_ARGUMENT;
     }
 
+    ms_json_result_t status = ms_json_value_resolve(value);
+    if (status != MS_JSON_SUCCESS) {
+        return status;
+    }
+
     const ms_json_array_t* array = ms_json_value_get_array_const(value);
     *result = array->count;
     return MS_JSON_SUCCESS;
@@ -495,6 +244,11 @@ ms_json_result_t ms_json_get_array_element(const ms_json_value_t* value, size_t
         return MS_JSON_ERROR_INVALID_ARGUMENT;
     }
 
+    ms_json_result_t status = ms_json_value_resolve(value);
+    if (status != MS_JSON_SUCCESS) {
+        return status;
+    }
+
     const ms_json_array_t* array = ms_json_value_get_array_const(value);
     if (index >= array->count) {
         return MS_JSON_ERROR_INVALID_ARGUMENT;
@@ -510,6 +264,11 @@ ms_json_result_t ms_json_get_object_size(const ms_json_value_t* value, size_t* r
         return MS_JSON_ERROR_INVALID_ARGUMENT;
     }
 
+    ms_json_result_t status = ms_json_value_resolve(value);
+    if (status != MS_JSON_SUCCESS) {
+        return status;
+    }
+
     const ms_json_object_t* object = ms_json_value_get_object_const(value);
     *result = object->count;
     return MS_JSON_SUCCESS;
@@ -521,13 +280,18 @@ ms_json_result_t ms_json_get_object_value(const ms_json_value_t* value, const ch
         return MS_JSON_ERROR_INVALID_ARGUMENT;
     }
 
+    ms_json_result_t status = ms_json_value_resolve(value);
+    if (status != MS_JSON_SUCCESS) {
+        return status;
+    }
+
     const ms_json_object_t* object = ms_json_value_get_object_const(value);
-    for (size_t i = 0; i < object->count; i++) {
-        if (object->entries[i].key &&
-            strcmp(object->entries[i].key, key) == 0) {
-            *result = object->entries[i].value;
-            return MS_JSON_SUCCESS;
-        }
+    size_t key_length = strlen(key);
+    const ms_json_object_entry_t* entry =
+        ms_json_object_find(object, key, key_length, ms_json_hash_key(key, key_length));
+    if (entry) {
+        *result = entry->value;
+        return MS_JSON_SUCCESS;
     }
 
     return MS_JSON_ERROR_INVALID_ARGUMENT;
@@ -538,15 +302,15 @@ ms_json_result_t ms_json_object_has_key(const ms_json_value_t* value, const char
         return MS_JSON_ERROR_INVALID_ARGUMENT;
     }
 
-    *result = 0;
-    const ms_json_object_t* object = ms_json_value_get_object_const(value);
-    for (size_t i = 0; i < object->count; i++) {
-        if (object->entries[i].key &&
-            strcmp(object->entries[i].key, key) == 0) {
-            *result = 1;
-            break;
-        }
+    ms_json_result_t status = ms_json_value_resolve(value);
+    if (status != MS_JSON_SUCCESS) {
+        return status;
     }
 
+    const ms_json_object_t* object = ms_json_value_get_object_const(value);
+    size_t key_length = strlen(key);
+    *result = ms_json_object_find(object, key, key_length,
+                                  ms_json_hash_key(key, key_length)) != NULL;
+
     return MS_JSON_SUCCESS;
 }
@@ -11,10 +11,27 @@
 
 /**
  * @brief Main parsing API
+ *
+ * Without options->allocator the tree comes from ms_allocator_default(),
+ * which threads may share freely and which does not contend on statistics.
+ * A tree built with ms_allocator_thread_local() dies with its thread: it
+ * must be destroyed by that thread, before the thread exits.
  */
 ms_json_result_t ms_json_parse(const char* input, const ms_json_options_t* options,
                               ms_json_value_t** result);
 
+/**
+ * @brief Parse a document of known length
+ *
+ * Same as ms_json_parse() without the strlen(): input need not be
+ * NUL-terminated, so slices of a larger buffer can be parsed in place.
+ *
+ * @param input JSON text, may be NULL when length is 0
+ * @param length Length of input in bytes
+ */
+ms_json_result_t ms_json_parse_n(const char* input, size_t length, const ms_json_options_t* options,
+                                 ms_json_value_t** result);
+
 /**
  * @brief File I/O operations
  */
@@ -22,6 +39,38 @@ ms_json_result_t ms_json_parse_file(const char* filename, const ms_json_options_
                                    ms_json_value_t** result);
 ms_json_result_t ms_json_serialize_file(const ms_json_value_t* value, const char* filename);
 
+/**
+ * @brief Memory-mapped file backing a zero-copy tree (opaque)
+ */
+typedef struct ms_json_file_mapping ms_json_file_mapping_t;
+
+/**
+ * @brief Parse a file in place from a memory mapping
+ *
+ * The file is mapped read-only and parsed without copying; where mmap is
+ * unavailable it is read with pread instead. There is no size limit.
+ *
+ * With options->zero_copy set and mapping non-NULL, unescaped strings
+ * borrow from the mapping and the mapping is handed to the caller, who
+ * must release it after destroying the tree. Otherwise strings are copied,
+ * *mapping is set to NULL and the file is released before returning.
+ *
+ * @param filename File to parse
+ * @param options Parsing options, NULL for defaults
+ * @param result Output parameter for the parsed value
+ * @param mapping Output parameter for the backing mapping, may be NULL
+ *
+ * @return MS_JSON_SUCCESS on success, MS_JSON_ERROR_INVALID_ARGUMENT if the
+ *         file cannot be opened, MS_JSON_ERROR_IO if it cannot be read
+ */
+ms_json_result_t ms_json_parse_file_mapped(const char* filename, const ms_json_options_t* options,
+                                          ms_json_value_t** result, ms_json_file_mapping_t** mapping);
+
+/**
+ * @brief Release a mapping returned by ms_json_parse_file_mapped()
+ */
+void ms_json_file_mapping_release(ms_json_file_mapping_t* mapping);
+
 /**
  * @brief Serialization functions
  */
@@ -34,8 +83,25 @@ ms_json_result_t ms_json_serialize(const ms_json_value_t* value, ms_allocator_t*
 ms_json_type_t ms_json_get_type(const ms_json_value_t* value);
 ms_json_result_t ms_json_get_bool(const ms_json_value_t* value, int* result);
 ms_json_result_t ms_json_get_number(const ms_json_value_t* value, double* result);
+
+/**
+ * @brief Get a number as an exact 64-bit integer
+ *
+ * Succeeds for integers parsed or created as such, and for doubles with an
+ * integral value in int64_t range. Integers beyond 2^53 keep every digit
+ * here, while ms_json_get_number() rounds them to the nearest double.
+ */
+ms_json_result_t ms_json_get_int64(const ms_json_value_t* value, int64_t* result);
 ms_json_result_t ms_json_get_string(const ms_json_value_t* value, const char** result);
 
+/**
+ * @brief Get a string value's bytes and length
+ *
+ * Works for every string, including zero-copy views into the parse input,
+ * which ms_json_get_string rejects because they are not NUL-terminated.
+ */
+ms_json_result_t ms_json_get_string_n(const ms_json_value_t* value, const char** result, size_t* length);
+
 /**
  * @brief Array accessors
  */
@@ -0,0 +1,840 @@
+/**
+ * @file ms_json_bind.c
+ * @brief Schema compilation, struct decoding and struct encoding
+ *
+ * Each struct of a schema becomes a level: its fields in table order, an
+ * open-addressing slot table over their key hashes, and the key text, all
+ * in one block. Compiling searches for a hash seed that puts every key in
+ * its own slot, so a lookup is normally one probe; tables where no such
+ * seed is found quickly stay correct through linear probing.
+ *
+ * Decoding walks the input with the parser's tokenizer like path
+ * extraction does, converting bound members straight into the struct and
+ * skipping the rest. Encoding formats the struct through the serializer's
+ * scalar writers.
+ */
+
+#include "ms_json_bind.h"
+#include "ms_json_parser.h"
+#include "ms_json_serializer.h"
+#include "ms_json_number.h"
+#include "ms_json_internal.h"
+#include <string.h>
+
+/* Configuration constants */
+#define BIND_MAX_FIELDS 65536            /* Fields one struct may bind */
+#define BIND_SEED_ATTEMPTS 64            /* Seeds tried per slot table size */
+#define BIND_PERFECT_GROWTH_STEPS 3      /* Table sizes tried, doubling from twice the field count */
+#define BIND_KEY_BUFFER_SIZE 256         /* Escaped keys and strings below this size decode on the stack */
+#define BIND_ENCODE_INITIAL_SIZE 256     /* First buffer of ms_json_bind_encode() */
+
+typedef struct ms_json_bind_level ms_json_bind_level_t;
+
+typedef struct {
+    const char* key;                 /* Inside the level block, right after an opening quote */
+    size_t key_length;
+    uint32_t hash;
+    int plain_key;                   /* key is followed by "\":" and needs no escaping */
+    ms_json_bind_type_t type;
+    size_t offset;
+    size_t size;
+    ms_json_bind_level_t* nested;    /* MS_JSON_BIND_OBJECT only */
+} ms_json_bind_entry_t;
+
+struct ms_json_bind_level {
+    size_t count;
+    ms_json_bind_entry_t* entries;   /* In field table order */
+    uint32_t* slots;                 /* Entry position + 1 per slot, 0 = empty */
+    size_t slot_count;               /* Power of two, more than twice count */
+    uint32_t seed;
+    unsigned int shift;              /* 32 - log2(slot_count) */
+};
+
+struct ms_json_bind_schema {
+    ms_allocator_t* allocator;
+    ms_json_bind_level_t* root;
+};
+
+/* Internal helper functions */
+static ms_json_result_t ms_json_bind_compile_level(ms_allocator_t* allocator, const ms_json_bind_field_t* fields,
+                                                   size_t count, size_t depth, ms_json_bind_level_t** result);
+static int ms_json_bind_check_field(const ms_json_bind_field_t* field);
+static int ms_json_bind_choose_seed(ms_allocator_t* allocator, const uint32_t* hashes, size_t count,
+                                    size_t* slot_count, uint32_t* seed);
+static void ms_json_bind_destroy_level(ms_allocator_t* allocator, ms_json_bind_level_t* level);
+static unsigned int ms_json_bind_shift(size_t slot_count);
+static size_t ms_json_bind_slot(uint32_t hash, uint32_t seed, unsigned int shift);
+static const ms_json_bind_entry_t* ms_json_bind_find(const ms_json_bind_level_t* level, const char* key,
+                                                     size_t key_length);
+static ms_json_result_t ms_json_bind_decode_object(ms_json_parse_context_t* ctx, const ms_json_bind_level_t* level,
+                                                   char* base);
+static ms_json_result_t ms_json_bind_decode_member(ms_json_parse_context_t* ctx, const ms_json_bind_entry_t* entry,
+                                                   char* base);
+static ms_json_result_t ms_json_bind_decode_number(ms_json_parse_context_t* ctx, const ms_json_bind_entry_t* entry,
+                                                   void* target);
+static int ms_json_bind_integral_value(const char* text, size_t length, int64_t* value);
+static ms_json_result_t ms_json_bind_decode_string(ms_json_parse_context_t* ctx, const ms_json_bind_entry_t* entry,
+                                                   char* target);
+static ms_json_result_t ms_json_bind_lookup_key(ms_json_parse_context_t* ctx, const ms_json_bind_level_t* level,
+                                                const ms_json_bind_entry_t** entry);
+static ms_json_result_t ms_json_bind_mismatch(ms_json_parse_context_t* ctx);
+static ms_json_result_t ms_json_bind_expect_literal(ms_json_parse_context_t* ctx, const char* literal,
+                                                    size_t literal_length);
+static ms_json_result_t ms_json_bind_after_element(ms_json_parse_context_t* ctx, char closing, int* done);
+static ms_json_result_t ms_json_bind_encode_object(const ms_json_bind_level_t* level, const char* base,
+                                                   ms_json_serialize_context_t* ctx);
+
+ms_json_result_t ms_json_bind_compile(const ms_json_bind_field_t* fields, size_t count, ms_allocator_t* allocator,
+                                      ms_json_bind_schema_t** result) {
+    if (!result || (!fields && count > 0)) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+    *result = NULL;
+
+    if (!allocator) {
+        allocator = ms_allocator_default();
+    }
+
+    ms_json_bind_schema_t* schema = NULL;
+    if (ms_allocator_allocate(allocator, sizeof(*schema), (void**)&schema) != MS_MEMORY_SUCCESS) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+    schema->allocator = allocator;
+
+    ms_json_result_t status = ms_json_bind_compile_level(allocator, fields, count, 0, &schema->root);
+    if (status != MS_JSON_SUCCESS) {
+        ms_allocator_deallocate(allocator, schema);
+        return status;
+    }
+
+    *result = schema;
+    return MS_JSON_SUCCESS;
+}
+
+void ms_json_bind_schema_destroy(ms_json_bind_schema_t* schema) {
+    if (schema) {
+        ms_json_bind_destroy_level(schema->allocator, schema->root);
+        ms_allocator_deallocate(schema->allocator, schema);
+    }
+}
+
+ms_json_result_t ms_json_bind_decode(const ms_json_bind_schema_t* schema, const char* input, size_t length,
+                                     const ms_json_options_t* options, void* out) {
+    if (!schema || !out || (!input && length > 0)) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    ms_json_parse_context_t ctx;
+    ctx.input = input;
+    ctx.position = 0;
+    ctx.length = length;
+    ctx.depth = 0;
+    ctx.keys = NULL;
+    ctx.scratch = NULL;
+    if (options) {
+        ctx.options = *options;
+    } else {
+        ctx.options = (ms_json_options_t){0};
+        ctx.options.max_depth = MS_JSON_MAX_DEPTH_DEFAULT;
+    }
+    ctx.allocator = ctx.options.allocator ? ctx.options.allocator : ms_allocator_default();
+
+    if (!ms_json_skip_whitespace_and_comments(&ctx)) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+    if (ctx.position >= length) {
+        return MS_JSON_ERROR_EOF;
+    }
+
+    ms_json_result_t status = input[ctx.position] == '{'
+                                  ? ms_json_bind_decode_object(&ctx, schema->root, (char*)out)
+                                  : ms_json_bind_mismatch(&ctx);
+
+    if (status == MS_JSON_SUCCESS && (!ms_json_skip_whitespace_and_comments(&ctx) || ctx.position < length)) {
+        status = MS_JSON_ERROR_SYNTAX;
+    }
+    return status;
+}
+
+ms_json_result_t ms_json_bind_encode(const ms_json_bind_schema_t* schema, const void* in, ms_allocator_t* allocator,
+                                     char** result) {
+    if (!schema || !in || !result) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (!allocator) {
+        allocator = ms_allocator_default();
+    }
+
+    ms_json_serialize_context_t ctx = {
+        .allocator = allocator,
+        .buffer = NULL,
+        .position = 0,
+        .capacity = BIND_ENCODE_INITIAL_SIZE,
+        .needs_comma = 0,
+        .write_fn = NULL,
+        .write_ctx = NULL,
+        .fixed = 0
+    };
+
+    if (ms_allocator_allocate(allocator, ctx.capacity, (void**)&ctx.buffer) != MS_MEMORY_SUCCESS) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    ms_json_result_t status = ms_json_bind_encode_object(schema->root, (const char*)in, &ctx);
+    if (status == MS_JSON_SUCCESS) {
+        status = ms_json_serialize_append(&ctx, "", 1);
+    }
+    if (status != MS_JSON_SUCCESS) {
+        ms_allocator_deallocate(allocator, ctx.buffer);
+        return status;
+    }
+
+    *result = ctx.buffer;
+    return MS_JSON_SUCCESS;
+}
+
+ms_json_result_t ms_json_bind_encode_into(const ms_json_bind_schema_t* schema, const void* in, char* buffer,
+                                          size_t capacity, size_t* length) {
+    if (!schema || !in || !buffer || capacity == 0) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    /* One byte is held back for the terminator */
+    ms_json_serialize_context_t ctx = {
+        .allocator = NULL,
+        .buffer = buffer,
+        .position = 0,
+        .capacity = capacity - 1,
+        .needs_comma = 0,
+        .write_fn = NULL,
+        .write_ctx = NULL,
+        .fixed = 1
+    };
+
+    ms_json_result_t status = ms_json_bind_encode_object(schema->root, (const char*)in, &ctx);
+    if (status != MS_JSON_SUCCESS) {
+        return status;
+    }
+
+    buffer[ctx.position] = '\0';
+    if (length) {
+        *length = ctx.position;
+    }
+    return MS_JSON_SUCCESS;
+}
+
+/*
+ * One struct's level, laid out as the level, its entries, its slots and
+ * then each key as "key": so plain keys are written by one copy
+ */
+static ms_json_result_t ms_json_bind_compile_level(ms_allocator_t* allocator, const ms_json_bind_field_t* fields,
+                                                   size_t count, size_t depth, ms_json_bind_level_t** result) {
+    if (count > BIND_MAX_FIELDS || depth >= MS_JSON_MAX_DEPTH_DEFAULT) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    size_t key_bytes = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!ms_json_bind_check_field(&fields[i])) {
+            return MS_JSON_ERROR_INVALID_ARGUMENT;
+        }
+        size_t key_length = strlen(fields[i].key);
+        for (size_t j = 0; j < i; j++) {
+            if (strcmp(fields[j].key, fields[i].key) == 0) {
+                return MS_JSON_ERROR_INVALID_ARGUMENT;
+            }
+        }
+        key_bytes += key_length + 3;
+    }
+
+    /* Hashes are needed before the slot table can be sized */
+    uint32_t* hashes = NULL;
+    if (count > 0 && ms_allocator_allocate(allocator, count * sizeof(*hashes), (void**)&hashes) != MS_MEMORY_SUCCESS) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+    for (size_t i = 0; i < count; i++) {
+        hashes[i] = ms_json_hash_key(fields[i].key, strlen(fields[i].key));
+    }
+
+    size_t slot_count = 0;
+    uint32_t seed = 0;
+    if (!ms_json_bind_choose_seed(allocator, hashes, count, &slot_count, &seed)) {
+        if (hashes) {
+            ms_allocator_deallocate(allocator, hashes);
+        }
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    ms_json_bind_level_t* level = NULL;
+    size_t size = sizeof(*level) + count * sizeof(ms_json_bind_entry_t) + slot_count * sizeof(uint32_t) + key_bytes;
+    if (ms_allocator_allocate_zeroed(allocator, 1, size, (void**)&level) != MS_MEMORY_SUCCESS) {
+        if (hashes) {
+            ms_allocator_deallocate(allocator, hashes);
+        }
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    level->count = count;
+    level->entries = (ms_json_bind_entry_t*)(level + 1);
+    level->slots = (uint32_t*)(level->entries + count);
+    level->slot_count = slot_count;
+    level->seed = seed;
+    level->shift = ms_json_bind_shift(slot_count);
+    char* keys = (char*)(level->slots + slot_count);
+
+    ms_json_result_t status = MS_JSON_SUCCESS;
+    for (size_t i = 0; i < count && status == MS_JSON_SUCCESS; i++) {
+        const ms_json_bind_field_t* field = &fields[i];
+        ms_json_bind_entry_t* entry = &level->entries[i];
+        entry->key_length = strlen(field->key);
+        entry->hash = hashes[i];
+        entry->type = field->type;
+        entry->offset = field->offset;
+        entry->size = field->size;
+
+        *keys = '"';
+        memcpy(keys + 1, field->key, entry->key_length);
+        memcpy(keys + 1 + entry->key_length, "\":", 2);
+        entry->key = keys + 1;
+        keys += entry->key_length + 3;
+
+        entry->plain_key = 1;
+        for (size_t k = 0; k < entry->key_length; k++) {
+            unsigned char c = (unsigned char)field->key[k];
+            if (c < 0x20 || c == '"' || c == '\\') {
+                entry->plain_key = 0;
+                break;
+            }
+        }
+
+        size_t mask = slot_count - 1;
+        size_t slot = ms_json_bind_slot(entry->hash, seed, level->shift);
+        while (level->slots[slot]) {
+            slot = (slot + 1) & mask;
+        }
+        level->slots[slot] = (uint32_t)(i + 1);
+
+        if (field->type == MS_JSON_BIND_OBJECT) {
+            status = ms_json_bind_compile_level(allocator, field->fields, field->field_count, depth + 1,
+                                                &entry->nested);
+        }
+    }
+
+    if (hashes) {
+        ms_allocator_deallocate(allocator, hashes);
+    }
+    if (status != MS_JSON_SUCCESS) {
+        ms_json_bind_destroy_level(allocator, level);
+        return status;
+    }
+
+    *result = level;
+    return MS_JSON_SUCCESS;
+}
+
+/* Field has a key and a size its type can be stored in */
+static int ms_json_bind_check_field(const ms_json_bind_field_t* field) {
+    if (!field->key) {
+        return 0;
+    }
+
+    switch (field->type) {
+        case MS_JSON_BIND_BOOL: return field->size == sizeof(int);
+        case MS_JSON_BIND_INT32: return field->size == sizeof(int32_t);
+        case MS_JSON_BIND_INT64: return field->size == sizeof(int64_t);
+        case MS_JSON_BIND_DOUBLE: return field->size == sizeof(double);
+        case MS_JSON_BIND_STRING: return field->size > 0;
+        case MS_JSON_BIND_OBJECT: return field->fields || field->field_count == 0;
+        default: return 0;
+    }
+}
+
+/*
+ * Slot table size and seed for hashes: the first seed that gives every key
+ * its own slot, or twice the field count with seed 0 when none is found.
+ * Returns 0 when out of memory.
+ */
+static int ms_json_bind_choose_seed(ms_allocator_t* allocator, const uint32_t* hashes, size_t count,
+                                    size_t* slot_count, uint32_t* seed) {
+    size_t base = 2;
+    while (base < count * 2) {
+        base *= 2;
+    }
+    *slot_count = base;
+    *seed = 0;
+    if (count < 2) {
+        return 1;
+    }
+
+    /* Slot holds the number of the attempt that last filled it, so nothing is cleared between attempts */
+    size_t largest = base << (BIND_PERFECT_GROWTH_STEPS - 1);
+    uint32_t* marks = NULL;
+    if (ms_allocator_allocate_zeroed(allocator, largest, sizeof(*marks), (void**)&marks) != MS_MEMORY_SUCCESS) {
+        return 0;
+    }
+
+    uint32_t attempt = 0;
+    for (size_t slots = base; slots <= largest; slots *= 2) {
+        unsigned int shift = ms_json_bind_shift(slots);
+        for (uint32_t candidate = 0; candidate < BIND_SEED_ATTEMPTS; candidate++) {
+            attempt++;
+            size_t i = 0;
+            for (; i < count; i++) {
+                size_t slot = ms_json_bind_slot(hashes[i], candidate, shift);
+                if (marks[slot] == attempt) {
+                    break;
+                }
+                marks[slot] = attempt;
+            }
+            if (i == count) {
+                *slot_count = slots;
+                *seed = candidate;
+                ms_allocator_deallocate(allocator, marks);
+                return 1;
+            }
+        }
+    }
+
+    ms_allocator_deallocate(allocator, marks);
+    return 1;
+}
+
+static void ms_json_bind_destroy_level(ms_allocator_t* allocator, ms_json_bind_level_t* level) {
+    if (!level) {
+        return;
+    }
+
+    for (size_t i = 0; i < level->count; i++) {
+        ms_json_bind_destroy_level(allocator, level->entries[i].nested);
+    }
+    ms_allocator_deallocate(allocator, level);
+}
+
+/* Right shift that maps a 32-bit product onto slot_count slots */
+static unsigned int ms_json_bind_shift(size_t slot_count) {
+    unsigned int bits = 0;
+    while (((size_t)1 << bits) < slot_count) {
+        bits++;
+    }
+    return 32 - bits;
+}
+
+/* Home slot of a key hash: multiplicative hashing of the seeded hash, top bits kept */
+static size_t ms_json_bind_slot(uint32_t hash, uint32_t seed, unsigned int shift) {
+    return (size_t)((uint32_t)((hash ^ seed) * 0x9E3779B1u) >> shift);
+}
+
+static const ms_json_bind_entry_t* ms_json_bind_find(const ms_json_bind_level_t* level, const char* key,
+                                                     size_t key_length) {
+    uint32_t hash = ms_json_hash_key(key, key_length);
+    size_t mask = level->slot_count - 1;
+    for (size_t slot = ms_json_bind_slot(hash, level->seed, level->shift); level->slots[slot];
+         slot = (slot + 1) & mask) {
+        const ms_json_bind_entry_t* entry = &level->entries[level->slots[slot] - 1];
+        if (entry->hash == hash && entry->key_length == key_length && memcmp(entry->key, key, key_length) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/* Object at ctx->position into the struct at base */
+static ms_json_result_t ms_json_bind_decode_object(ms_json_parse_context_t* ctx, const ms_json_bind_level_t* level,
+                                                   char* base) {
+    if (ctx->options.max_depth > 0 && ctx->depth >= ctx->options.max_depth) {
+        return MS_JSON_ERROR_DEPTH;
+    }
+
+    ctx->position++; /* Skip '{' */
+    if (!ms_json_skip_whitespace_and_comments(ctx)) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    int done = ctx->position < ctx->length && ctx->input[ctx->position] == '}';
+    if (done) {
+        ctx->position++; /* Empty object */
+    }
+
+    ctx->depth++;
+    ms_json_result_t status = MS_JSON_SUCCESS;
+    while (!done && status == MS_JSON_SUCCESS) {
+        const ms_json_bind_entry_t* entry = NULL;
+        status = ctx->position < ctx->length ? ms_json_bind_lookup_key(ctx, level, &entry) : MS_JSON_ERROR_EOF;
+        if (status != MS_JSON_SUCCESS) {
+            break;
+        }
+
+        if (!ms_json_skip_whitespace_and_comments(ctx) || ctx->position >= ctx->length ||
+            ctx->input[ctx->position] != ':') {
+            status = MS_JSON_ERROR_SYNTAX;
+            break;
+        }
+        ctx->position++; /* Skip ':' */
+
+        status = entry ? ms_json_bind_decode_member(ctx, entry, base) : ms_json_skip_value(ctx);
+        if (status == MS_JSON_SUCCESS) {
+            status = ms_json_bind_after_element(ctx, '}', &done);
+        }
+    }
+    ctx->depth--;
+
+    return status;
+}
+
+/* Value after a bound key; null leaves the member as it was */
+static ms_json_result_t ms_json_bind_decode_member(ms_json_parse_context_t* ctx, const ms_json_bind_entry_t* entry,
+                                                   char* base) {
+    if (!ms_json_skip_whitespace_and_comments(ctx)) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+    if (ctx->position >= ctx->length) {
+        return MS_JSON_ERROR_EOF;
+    }
+
+    char c = ctx->input[ctx->position];
+    if (c == 'n') {
+        return ms_json_bind_expect_literal(ctx, "null", 4);
+    }
+
+    char* target = base + entry->offset;
+    ms_json_result_t status;
+    switch (entry->type) {
+        case MS_JSON_BIND_BOOL:
+            if (c == 't' || c == 'f') {
+                status = c == 't' ? ms_json_bind_expect_literal(ctx, "true", 4)
+                                  : ms_json_bind_expect_literal(ctx, "false", 5);
+                if (status == MS_JSON_SUCCESS) {
+                    *(int*)target = c == 't';
+                }
+                return status;
+            }
+            break;
+
+        case MS_JSON_BIND_INT32:
+        case MS_JSON_BIND_INT64:
+        case MS_JSON_BIND_DOUBLE:
+            if (c == '-' || (c >= '0' && c <= '9')) {
+                return ms_json_bind_decode_number(ctx, entry, target);
+            }
+            break;
+
+        case MS_JSON_BIND_STRING:
+            if (c == '"') {
+                return ms_json_bind_decode_string(ctx, entry, target);
+            }
+            break;
+
+        case MS_JSON_BIND_OBJECT:
+            if (c == '{') {
+                return ms_json_bind_decode_object(ctx, entry->nested, target);
+            }
+            break;
+    }
+
+    return ms_json_bind_mismatch(ctx);
+}
+
+static ms_json_result_t ms_json_bind_decode_number(ms_json_parse_context_t* ctx, const ms_json_bind_entry_t* entry,
+                                                   void* target) {
+    ms_json_number_t number;
+    size_t consumed = 0;
+    const char* text = &ctx->input[ctx->position];
+    ms_json_result_t status = ms_json_parse_number_text(text, ctx->length - ctx->position, &consumed, &number);
+    if (status != MS_JSON_SUCCESS) {
+        return status;
+    }
+    ctx->position += consumed;
+
+    if (entry->type == MS_JSON_BIND_DOUBLE) {
+        *(double*)target = number.number;
+        return MS_JSON_SUCCESS;
+    }
+
+    /* -0, 1e2 and 1.50e1 are integers too, so their digits are checked exactly */
+    if (!number.is_integer && !ms_json_bind_integral_value(text, consumed, &number.integer)) {
+        return MS_JSON_ERROR_TYPE;
+    }
+
+    switch (entry->type) {
+        case MS_JSON_BIND_INT64:
+            *(int64_t*)target = number.integer;
+            return MS_JSON_SUCCESS;
+
+        default:
+            if (number.integer < INT32_MIN || number.integer > INT32_MAX) {
+                return MS_JSON_ERROR_TYPE;
+            }
+            *(int32_t*)target = (int32_t)number.integer;
+            return MS_JSON_SUCCESS;
+    }
+}
+
+/*
+ * Exact value of a valid number token with a fraction or an exponent
+ *
+ * Returns 0 when the digits left of the decimal point after applying the
+ * exponent are followed by non-zero ones, or the value does not fit int64_t.
+ */
+static int ms_json_bind_integral_value(const char* text, size_t length, int64_t* value) {
+    size_t i = 0;
+    int negative = text[0] == '-';
+    if (negative) {
+        i++;
+    }
+
+    /* Significant digits, with the exponent counted against the fraction */
+    const char* digits = text + i;
+    size_t integer_digits = 0;
+    while (i < length && text[i] >= '0' && text[i] <= '9') {
+        i++;
+        integer_digits++;
+    }
+    const char* fraction = text + i + 1;
+    size_t fraction_digits = 0;
+    if (i < length && text[i] == '.') {
+        i++;
+        while (i < length && text[i] >= '0' && text[i] <= '9') {
+            i++;
+            fraction_digits++;
+        }
+    }
+    long exponent = 0;
+    if (i < length && (text[i] == 'e' || text[i] == 'E')) {
+        i++;
+        int exponent_negative = text[i] == '-';
+        if (text[i] == '-' || text[i] == '+') {
+            i++;
+        }
+        while (i < length && text[i] >= '0' && text[i] <= '9') {
+            if (exponent < 1000) {
+                exponent = exponent * 10 + (text[i] - '0');  /* Saturates well past int64_t */
+            }
+            i++;
+        }
+        if (exponent_negative) {
+            exponent = -exponent;
+        }
+    }
+
+    /* Digit k of the significand (integer digits, then fraction digits) has power 10^(point - 1 - k) */
+    long point = (long)integer_digits + exponent;
+    size_t total = integer_digits + fraction_digits;
+    uint64_t magnitude = 0;
+    for (size_t k = 0; k < total; k++) {
+        int digit = k < integer_digits ? digits[k] - '0' : fraction[k - integer_digits] - '0';
+        if ((long)k >= point) {
+            if (digit != 0) {
+                return 0;  /* Below the units place */
+            }
+            continue;
+        }
+        if (magnitude > (UINT64_MAX - (uint64_t)digit) / 10) {
+            return 0;
+        }
+        magnitude = magnitude * 10 + (uint64_t)digit;
+    }
+    for (long k = (long)total; k < point; k++) {
+        if (magnitude != 0 && magnitude > UINT64_MAX / 10) {
+            return 0;
+        }
+        magnitude *= 10;
+    }
+
+    uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+    if (magnitude > limit) {
+        return 0;
+    }
+    *value = negative ? (int64_t)(0 - magnitude) : (int64_t)magnitude;
+    return 1;
+}
+
+/* String into the member's char array, which must hold it and its terminator */
+static ms_json_result_t ms_json_bind_decode_string(ms_json_parse_context_t* ctx, const ms_json_bind_entry_t* entry,
+                                                   char* target) {
+    size_t raw_start = 0;
+    size_t raw_length = 0;
+    int has_escapes = 0;
+    ms_json_result_t status = ms_json_scan_string(ctx, &raw_start, &raw_length, &has_escapes);
+    if (status != MS_JSON_SUCCESS) {
+        return status;
+    }
+
+    const char* raw = &ctx->input[raw_start];
+    if (!has_escapes) {
+        if (raw_length >= entry->size) {
+            return MS_JSON_ERROR_TYPE;
+        }
+        memcpy(target, raw, raw_length);
+        target[raw_length] = '\0';
+        return MS_JSON_SUCCESS;
+    }
+
+    /* Decoded text is never longer than the escaped form, so a short enough one decodes in place */
+    size_t decoded_length = 0;
+    if (raw_length < entry->size) {
+        if (!ms_json_decode_string(raw, raw_length, target, &decoded_length)) {
+            return MS_JSON_ERROR_SYNTAX;
+        }
+        target[decoded_length] = '\0';
+        return MS_JSON_SUCCESS;
+    }
+
+    char stack_buffer[BIND_KEY_BUFFER_SIZE];
+    char* decoded = stack_buffer;
+    if (raw_length >= BIND_KEY_BUFFER_SIZE &&
+        ms_allocator_allocate(ctx->allocator, raw_length + 1, (void**)&decoded) != MS_MEMORY_SUCCESS) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    if (!ms_json_decode_string(raw, raw_length, decoded, &decoded_length)) {
+        status = MS_JSON_ERROR_SYNTAX;
+    } else if (decoded_length >= entry->size) {
+        status = MS_JSON_ERROR_TYPE;
+    } else {
+        memcpy(target, decoded, decoded_length);
+        target[decoded_length] = '\0';
+    }
+
+    if (decoded != stack_buffer) {
+        ms_allocator_deallocate(ctx->allocator, decoded);
+    }
+    return status;
+}
+
+/* Read the key at ctx->position and find its entry, NULL when the struct does not bind it */
+static ms_json_result_t ms_json_bind_lookup_key(ms_json_parse_context_t* ctx, const ms_json_bind_level_t* level,
+                                                const ms_json_bind_entry_t** entry) {
+    size_t raw_start = 0;
+    size_t raw_length = 0;
+    int has_escapes = 0;
+    ms_json_result_t status = ms_json_scan_string(ctx, &raw_start, &raw_length, &has_escapes);
+    if (status != MS_JSON_SUCCESS) {
+        return status;
+    }
+
+    const char* raw = &ctx->input[raw_start];
+    if (!has_escapes) {
+        *entry = ms_json_bind_find(level, raw, raw_length);
+        return MS_JSON_SUCCESS;
+    }
+
+    char stack_buffer[BIND_KEY_BUFFER_SIZE];
+    char* decoded = stack_buffer;
+    if (raw_length >= BIND_KEY_BUFFER_SIZE &&
+        ms_allocator_allocate(ctx->allocator, raw_length + 1, (void**)&decoded) != MS_MEMORY_SUCCESS) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    size_t decoded_length = 0;
+    if (ms_json_decode_string(raw, raw_length, decoded, &decoded_length)) {
+        *entry = ms_json_bind_find(level, decoded, decoded_length);
+    } else {
+        status = MS_JSON_ERROR_SYNTAX;
+    }
+
+    if (decoded != stack_buffer) {
+        ms_allocator_deallocate(ctx->allocator, decoded);
+    }
+    return status;
+}
+
+/* Step over a value of the wrong type; a malformed one reports its own error */
+static ms_json_result_t ms_json_bind_mismatch(ms_json_parse_context_t* ctx) {
+    ms_json_result_t status = ms_json_skip_value(ctx);
+    return status == MS_JSON_SUCCESS ? MS_JSON_ERROR_TYPE : status;
+}
+
+static ms_json_result_t ms_json_bind_expect_literal(ms_json_parse_context_t* ctx, const char* literal,
+                                                    size_t literal_length) {
+    if (ctx->position + literal_length > ctx->length) {
+        return MS_JSON_ERROR_EOF;
+    }
+
+    if (memcmp(&ctx->input[ctx->position], literal, literal_length) != 0) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    ctx->position += literal_length;
+    return MS_JSON_SUCCESS;
+}
+
+/* Consume the separator after a member, setting done at the closing bracket */
+static ms_json_result_t ms_json_bind_after_element(ms_json_parse_context_t* ctx, char closing, int* done) {
+    if (!ms_json_skip_whitespace_and_comments(ctx)) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    if (ctx->position >= ctx->length) {
+        return MS_JSON_ERROR_EOF;
+    }
+
+    if (ctx->input[ctx->position] == closing) {
+        ctx->position++;
+        *done = 1;
+        return MS_JSON_SUCCESS;
+    }
+
+    if (ctx->input[ctx->position] != ',') {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    ctx->position++; /* Skip comma */
+    return ms_json_skip_whitespace_and_comments(ctx) ? MS_JSON_SUCCESS : MS_JSON_ERROR_SYNTAX;
+}
+
+static ms_json_result_t ms_json_bind_encode_object(const ms_json_bind_level_t* level, const char* base,
+                                                   ms_json_serialize_context_t* ctx) {
+    ms_json_result_t status = ms_json_serialize_append(ctx, "{", 1);
+
+    for (size_t i = 0; i < level->count && status == MS_JSON_SUCCESS; i++) {
+        const ms_json_bind_entry_t* entry = &level->entries[i];
+        const char* source = base + entry->offset;
+
+        if (i > 0) {
+            status = ms_json_serialize_append(ctx, ",", 1);
+        }
+        if (status == MS_JSON_SUCCESS) {
+            if (entry->plain_key) {
+                status = ms_json_serialize_append(ctx, entry->key - 1, entry->key_length + 3);
+            } else {
+                status = ms_json_serialize_string(entry->key, entry->key_length, ctx);
+                if (status == MS_JSON_SUCCESS) {
+                    status = ms_json_serialize_append(ctx, ":", 1);
+                }
+            }
+        }
+        if (status != MS_JSON_SUCCESS) {
+            break;
+        }
+
+        switch (entry->type) {
+            case MS_JSON_BIND_BOOL:
+                status = *(const int*)source ? ms_json_serialize_append(ctx, "true", 4)
+                                             : ms_json_serialize_append(ctx, "false", 5);
+                break;
+            case MS_JSON_BIND_INT32:
+                status = ms_json_serialize_integer(*(const int32_t*)source, ctx);
+                break;
+            case MS_JSON_BIND_INT64:
+                status = ms_json_serialize_integer(*(const int64_t*)source, ctx);
+                break;
+            case MS_JSON_BIND_DOUBLE:
+                status = ms_json_serialize_number(*(const double*)source, ctx);
+                break;
+            case MS_JSON_BIND_STRING: {
+                const char* end = memchr(source, '\0', entry->size);
+                status = end ? ms_json_serialize_string(source, (size_t)(end - source), ctx) : MS_JSON_ERROR_TYPE;
+                break;
+            }
+            case MS_JSON_BIND_OBJECT:
+                status = ms_json_bind_encode_object(entry->nested, source, ctx);
+                break;
+        }
+    }
+
+    if (status != MS_JSON_SUCCESS) {
+        return status;
+    }
+    return ms_json_serialize_append(ctx, "}", 1);
+}
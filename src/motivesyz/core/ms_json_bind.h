@@ -0,0 +1,126 @@
+/**
+ * @file ms_json_bind.h
+ * @brief Decoding JSON objects straight into C structs, and back
+ */
+
+#ifndef MS_JSON_BIND_H
+#define MS_JSON_BIND_H
+
+#include "ms_json_types.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief C type of a bound struct member
+ */
+typedef enum {
+    MS_JSON_BIND_BOOL = 0,  /**< int, 0 or 1 */
+    MS_JSON_BIND_INT32,     /**< int32_t; the JSON number must be an integer in range, -0 and 1e2 included */
+    MS_JSON_BIND_INT64,     /**< int64_t; the JSON number must be an integer in range, -0 and 1e2 included */
+    MS_JSON_BIND_DOUBLE,    /**< double */
+    MS_JSON_BIND_STRING,    /**< char array, NUL-terminated; longer strings are a type error */
+    MS_JSON_BIND_OBJECT     /**< Nested struct described by its own field table */
+} ms_json_bind_type_t;
+
+/**
+ * @brief One member of a bound struct
+ *
+ * Usually written with MS_JSON_BIND_FIELD() and MS_JSON_BIND_NESTED().
+ */
+typedef struct ms_json_bind_field {
+    const char* key;                          /**< JSON member name, NUL-terminated */
+    ms_json_bind_type_t type;                 /**< C type of the struct member */
+    size_t offset;                            /**< offsetof() the struct member */
+    size_t size;                              /**< sizeof() the struct member */
+    const struct ms_json_bind_field* fields;  /**< MS_JSON_BIND_OBJECT: the nested struct's table */
+    size_t field_count;                       /**< MS_JSON_BIND_OBJECT: entries in fields */
+} ms_json_bind_field_t;
+
+/** Field named key bound to member of struct_type */
+#define MS_JSON_BIND_FIELD(bind_type, key, struct_type, member) \
+    { (key), (bind_type), offsetof(struct_type, member), sizeof(((struct_type*)0)->member), NULL, 0 }
+
+/** Field named key bound to the nested struct member of struct_type, described by the array fields */
+#define MS_JSON_BIND_NESTED(key, struct_type, member, fields) \
+    { (key), MS_JSON_BIND_OBJECT, offsetof(struct_type, member), sizeof(((struct_type*)0)->member), \
+      (fields), sizeof(fields) / sizeof((fields)[0]) }
+
+/**
+ * @brief Compiled field tables, opaque
+ *
+ * Compiling copies the keys, hashes them and builds a collision-free slot
+ * table per struct where it can, so each input key is matched with one
+ * hash, one probe and one compare. Nested tables are compiled along with
+ * their parent.
+ */
+typedef struct ms_json_bind_schema ms_json_bind_schema_t;
+
+/**
+ * @brief Compile the field table of a root struct
+ *
+ * @param fields Members of the root struct; the table may be freed afterwards
+ * @param count Number of entries in fields
+ * @param allocator Allocator for the schema (NULL for default)
+ * @param result Output parameter, freed with ms_json_bind_schema_destroy()
+ * @return MS_JSON_SUCCESS, MS_JSON_ERROR_INVALID_ARGUMENT for a NULL or
+ *         repeated key, a size that does not fit the type, or nested tables
+ *         deeper than the default parse depth (such as a table nesting
+ *         itself), or MS_JSON_ERROR_MEMORY
+ */
+ms_json_result_t ms_json_bind_compile(const ms_json_bind_field_t* fields, size_t count, ms_allocator_t* allocator,
+                                      ms_json_bind_schema_t** result);
+
+/**
+ * @brief Free a compiled schema
+ */
+void ms_json_bind_schema_destroy(ms_json_bind_schema_t* schema);
+
+/**
+ * @brief Decode a JSON object into a struct without building a tree
+ *
+ * Bound members are converted and stored as they are read; other members,
+ * arrays included, are skipped with only string termination and bracket
+ * nesting checked. Members that are absent or null leave the struct
+ * untouched, so fill in defaults first, and a repeated key stores its last
+ * value. Nothing is allocated unless a key or string with escapes is too
+ * long for the stack buffer.
+ *
+ * @param schema Compiled schema of the root struct
+ * @param input JSON text, need not be NUL-terminated
+ * @param length Length of input in bytes
+ * @param options max_depth, allow_comments and allocator are used; NULL for defaults
+ * @param out Root struct to fill
+ * @return MS_JSON_SUCCESS, MS_JSON_ERROR_TYPE if the root or a bound member
+ *         has the wrong type or does not fit, or a parse error; on error
+ *         the struct may be partly written
+ */
+ms_json_result_t ms_json_bind_decode(const ms_json_bind_schema_t* schema, const char* input, size_t length,
+                                     const ms_json_options_t* options, void* out);
+
+/**
+ * @brief Serialize a struct as a JSON object without building a tree
+ *
+ * Members are written in field table order, in the same text
+ * ms_json_serialize() would give for the equivalent tree.
+ *
+ * @param schema Compiled schema of the root struct
+ * @param in Root struct to read
+ * @param allocator Allocator for the result (NULL for default)
+ * @param result Output parameter for the NUL-terminated text, freed with allocator
+ * @return MS_JSON_SUCCESS, or MS_JSON_ERROR_TYPE if a string member is not
+ *         NUL-terminated within its array, or MS_JSON_ERROR_MEMORY
+ */
+ms_json_result_t ms_json_bind_encode(const ms_json_bind_schema_t* schema, const void* in, ms_allocator_t* allocator,
+                                     char** result);
+
+/**
+ * @brief Serialize a struct into a caller-owned buffer
+ *
+ * @param capacity Size of buffer, including one byte for the terminator
+ * @param length Output parameter for the text length, NULL if not needed
+ * @return As ms_json_bind_encode(); MS_JSON_ERROR_MEMORY if buffer is too small
+ */
+ms_json_result_t ms_json_bind_encode_into(const ms_json_bind_schema_t* schema, const void* in, char* buffer,
+                                          size_t capacity, size_t* length);
+
+#endif /* MS_JSON_BIND_H */
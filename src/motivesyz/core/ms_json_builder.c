@@ -4,26 +4,23 @@
  */
 
 #include "ms_json_builder.h"
+#include "ms_json_keys.h"
 #include "ms_json_internal.h"  // ДОБАВИТЬ ВМЕСТО ЛОКАЛЬНЫХ СТРУКТУР
+#include "ms_instrument.h"
 #include <string.h>
 #include <stdlib.h>
 
 /* Internal helper functions */
 static ms_json_result_t ms_json_array_grow(ms_json_array_t* array);
+static ms_json_result_t ms_json_array_resize(ms_json_array_t* array, size_t capacity);
 static ms_json_result_t ms_json_object_grow(ms_json_object_t* object);
+static ms_json_result_t ms_json_object_resize(ms_json_object_t* object, size_t capacity);
+static ms_json_result_t ms_json_object_insert(ms_json_value_t* object, const char* key, size_t key_len,
+                                              char* owned_key, ms_json_value_t* value);
 static void ms_json_free_value_data(ms_json_value_t* value, ms_allocator_t* allocator);
-static uint32_t ms_json_hash_string(const char* str);
-
-/* Simple string hash function */
-static uint32_t ms_json_hash_string(const char* str) {
-    uint32_t hash = 2166136261u;
-    while (*str) {
-        hash ^= (uint32_t)(*str);
-        hash *= 16777619u;
-        str++;
-    }
-    return hash;
-}
+static size_t ms_json_object_index_slots(size_t capacity);
+static void ms_json_object_index_insert(ms_json_object_t* object, size_t position);
+static void ms_json_object_build_index(ms_json_object_t* object);
 
 /* JSON value creation functions */
 ms_json_value_t* ms_json_create_null(ms_allocator_t* allocator) {
@@ -37,6 +34,7 @@ ms_json_value_t* ms_json_create_null(ms_allocator_t* allocator) {
     }
 
     value->type = MS_JSON_NULL;
+    value->flags = 0;
     value->allocator = allocator;
     return value;
 }
@@ -63,28 +61,75 @@ ms_json_value_t* ms_json_create_number(ms_allocator_t* allocator, double value)
     return json_value;
 }
 
+ms_json_value_t* ms_json_create_integer(ms_allocator_t* allocator, int64_t value) {
+    ms_json_value_t* json_value = ms_json_create_null(allocator);
+    if (!json_value) {
+        return NULL;
+    }
+
+    json_value->type = MS_JSON_NUMBER;
+    json_value->flags |= MS_JSON_FLAG_INTEGER;
+    json_value->data.integer = value;
+    return json_value;
+}
+
 ms_json_value_t* ms_json_create_string(ms_allocator_t* allocator, const char* value) {
     if (!value) {
         return ms_json_create_null(allocator);
     }
 
+    return ms_json_create_string_n(allocator, value, strlen(value));
+}
+
+ms_json_value_t* ms_json_create_string_n(ms_allocator_t* allocator, const char* value, size_t length) {
+    if (!value) {
+        return ms_json_create_null(allocator);
+    }
+
     ms_json_value_t* json_value = ms_json_create_null(allocator);
     if (!json_value) {
         return NULL;
     }
 
-    size_t len = strlen(value);
+    allocator = json_value->allocator;
     char* string_copy = NULL;
-    if (ms_allocator_allocate(allocator, len + 1, (void**)&string_copy) != MS_MEMORY_SUCCESS) {
+    if (ms_allocator_allocate(allocator, length + 1, (void**)&string_copy) != MS_MEMORY_SUCCESS) {
         ms_allocator_deallocate(allocator, json_value);
         return NULL;
     }
 
-    memcpy(string_copy, value, len);
-    string_copy[len] = '\0';
+    memcpy(string_copy, value, length);
+    string_copy[length] = '\0';
 
     json_value->type = MS_JSON_STRING;
-    json_value->data.string = string_copy;
+    json_value->data.string.chars = string_copy;
+    json_value->data.string.length = length;
+    return json_value;
+}
+
+ms_json_value_t* ms_json_create_string_owned(ms_allocator_t* allocator, char* chars, size_t length) {
+    ms_json_value_t* json_value = ms_json_create_null(allocator);
+    if (!json_value) {
+        return NULL;
+    }
+
+    json_value->type = MS_JSON_STRING;
+    json_value->data.string.chars = chars;
+    json_value->data.string.length = length;
+    return json_value;
+}
+
+ms_json_value_t* ms_json_create_string_borrowed(ms_allocator_t* allocator, const char* chars,
+                                                size_t length) {
+    ms_json_value_t* json_value = ms_json_create_null(allocator);
+    if (!json_value) {
+        return NULL;
+    }
+
+    json_value->type = MS_JSON_STRING;
+    json_value->flags |= MS_JSON_FLAG_BORROWED;
+    json_value->data.string.chars = (char*)chars;
+    json_value->data.string.length = length;
     return json_value;
 }
 
@@ -95,7 +140,7 @@ ms_json_value_t* ms_json_create_array(ms_allocator_t* allocator) {
     }
 
     json_value->type = MS_JSON_ARRAY;
-    json_value->data.array.allocator = allocator;
+    json_value->data.array.allocator = json_value->allocator;
     json_value->data.array.items = NULL;
     json_value->data.array.count = 0;
     json_value->data.array.capacity = 0;
@@ -110,14 +155,29 @@ ms_json_value_t* ms_json_create_object(ms_allocator_t* allocator) {
     }
 
     json_value->type = MS_JSON_OBJECT;
-    json_value->data.object.allocator = allocator;
+    json_value->data.object.allocator = json_value->allocator;
     json_value->data.object.entries = NULL;
     json_value->data.object.count = 0;
     json_value->data.object.capacity = 0;
+    json_value->data.object.index = NULL;
+    json_value->data.object.keys = NULL;
 
     return json_value;
 }
 
+ms_json_value_t* ms_json_create_object_interned(ms_allocator_t* allocator, ms_json_key_table_t* table) {
+    ms_json_value_t* json_value = ms_json_create_object(allocator);
+    if (!json_value || !table) {
+        return json_value;
+    }
+
+    /* Arena objects are never destroyed one by one, so they hold no reference */
+    json_value->data.object.keys = ms_allocator_is_arena(json_value->allocator)
+                                       ? table
+                                       : ms_json_key_table_retain(table);
+    return json_value;
+}
+
 /* JSON value destruction */
 void ms_json_destroy(ms_json_value_t* value, ms_allocator_t* allocator) {
     if (!value) {
@@ -128,6 +188,11 @@ void ms_json_destroy(ms_json_value_t* value, ms_allocator_t* allocator) {
         allocator = value->allocator ? value->allocator : ms_allocator_default();
     }
 
+    /* Arena memory is released all at once by ms_allocator_reset/destroy */
+    if (ms_allocator_is_arena(allocator)) {
+        return;
+    }
+
     ms_json_free_value_data(value, allocator);
     ms_allocator_deallocate(allocator, value);
 }
@@ -137,10 +202,19 @@ static void ms_json_free_value_data(ms_json_value_t* value, ms_allocator_t* allo
         return;
     }
 
+    if (value->flags & MS_JSON_FLAG_LAZY) {
+        ms_json_lazy_release(value);
+        return;
+    }
+
+    if (value->flags & MS_JSON_FLAG_CACHED) {
+        ms_json_fragment_forget(value);
+    }
+
     switch (value->type) {
         case MS_JSON_STRING:
-            if (value->data.string) {
-                ms_allocator_deallocate(allocator, value->data.string);
+            if (value->data.string.chars && !(value->flags & MS_JSON_FLAG_BORROWED)) {
+                ms_allocator_deallocate(allocator, value->data.string.chars);
             }
             break;
 
@@ -156,7 +230,7 @@ static void ms_json_free_value_data(ms_json_value_t* value, ms_allocator_t* allo
         case MS_JSON_OBJECT:
             for (size_t i = 0; i < value->data.object.count; i++) {
                 ms_json_object_entry_t* entry = &value->data.object.entries[i];
-                if (entry->key) {
+                if (entry->key && !value->data.object.keys) {
                     ms_allocator_deallocate(allocator, entry->key);
                 }
                 if (entry->value) {
@@ -166,6 +240,10 @@ static void ms_json_free_value_data(ms_json_value_t* value, ms_allocator_t* allo
             if (value->data.object.entries) {
                 ms_allocator_deallocate(allocator, value->data.object.entries);
             }
+            if (value->data.object.index) {
+                ms_allocator_deallocate(allocator, value->data.object.index);
+            }
+            ms_json_key_table_release(value->data.object.keys);
             break;
 
         default:
@@ -180,6 +258,11 @@ ms_json_result_t ms_json_array_append(ms_json_value_t* array, ms_json_value_t* e
         return MS_JSON_ERROR_INVALID_ARGUMENT;
     }
 
+    ms_json_result_t status = ms_json_value_resolve(array);
+    if (status != MS_JSON_SUCCESS) {
+        return status;
+    }
+
     ms_json_array_t* arr = &array->data.array;
 
     /* Grow array if needed */
@@ -191,43 +274,160 @@ ms_json_result_t ms_json_array_append(ms_json_value_t* array, ms_json_value_t* e
 
     arr->items[arr->count] = element;
     arr->count++;
+    if (array->flags & MS_JSON_FLAG_CACHED) {
+        ms_json_fragment_touch(array);
+    }
+    return MS_JSON_SUCCESS;
+}
+
+ms_json_result_t ms_json_array_reserve(ms_json_value_t* array, size_t capacity) {
+    if (!array || array->type != MS_JSON_ARRAY) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    ms_json_result_t status = ms_json_value_resolve(array);
+    if (status != MS_JSON_SUCCESS) {
+        return status;
+    }
+
+    ms_json_array_t* arr = &array->data.array;
+    return capacity > arr->capacity ? ms_json_array_resize(arr, capacity) : MS_JSON_SUCCESS;
+}
+
+ms_json_result_t ms_json_array_append_many(ms_json_value_t* array, ms_json_value_t* const* elements,
+                                           size_t count) {
+    if (!array || array->type != MS_JSON_ARRAY || (!elements && count > 0)) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (!elements[i]) {
+            return MS_JSON_ERROR_INVALID_ARGUMENT;
+        }
+    }
+
+    ms_json_result_t status = ms_json_value_resolve(array);
+    if (status != MS_JSON_SUCCESS) {
+        return status;
+    }
+
+    ms_json_array_t* arr = &array->data.array;
+    if (count > SIZE_MAX - arr->count) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    /* Repeated small batches still grow geometrically */
+    size_t needed = arr->count + count;
+    if (needed > arr->capacity) {
+        size_t doubled = arr->capacity <= SIZE_MAX / 2 ? arr->capacity * 2 : SIZE_MAX;
+        if (ms_json_array_resize(arr, needed > doubled ? needed : doubled) != MS_JSON_SUCCESS) {
+            return MS_JSON_ERROR_MEMORY;
+        }
+    }
+
+    if (count > 0) {
+        memcpy(arr->items + arr->count, elements, count * sizeof(*elements));
+    }
+    arr->count = needed;
+    if (count > 0 && (array->flags & MS_JSON_FLAG_CACHED)) {
+        ms_json_fragment_touch(array);
+    }
     return MS_JSON_SUCCESS;
 }
 
 static ms_json_result_t ms_json_array_grow(ms_json_array_t* array) {
-    size_t new_capacity = array->capacity == 0 ? 4 : array->capacity * 2;
-    ms_json_value_t** new_items = NULL;
+    return ms_json_array_resize(array, array->capacity == 0 ? 4 : array->capacity * 2);
+}
 
-    if (ms_allocator_reallocate(array->allocator, array->items,
-                               new_capacity * sizeof(ms_json_value_t*),
-                               (void**)&new_items) != MS_MEMORY_SUCCESS) {
+static ms_json_result_t ms_json_array_resize(ms_json_array_t* array, size_t capacity) {
+    if (capacity > SIZE_MAX / sizeof(ms_json_value_t*)) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    MS_INSTRUMENT_BEGIN(span, 0);
+    ms_json_value_t** new_items = NULL;
+    ms_memory_result_t status = ms_allocator_reallocate(array->allocator, array->items,
+                                                        capacity * sizeof(ms_json_value_t*),
+                                                        (void**)&new_items);
+    MS_INSTRUMENT_END(span, MS_INSTRUMENT_GROWTH, capacity * sizeof(ms_json_value_t*));
+    if (status != MS_MEMORY_SUCCESS) {
         return MS_JSON_ERROR_MEMORY;
     }
 
     array->items = new_items;
-    array->capacity = new_capacity;
+    array->capacity = capacity;
     return MS_JSON_SUCCESS;
 }
 
 /* Object manipulation */
 ms_json_result_t ms_json_object_set(ms_json_value_t* object, const char* key, ms_json_value_t* value) {
+    if (!key) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    return ms_json_object_set_n(object, key, strlen(key), value);
+}
+
+ms_json_result_t ms_json_object_set_n(ms_json_value_t* object, const char* key, size_t key_length,
+                                      ms_json_value_t* value) {
+    return ms_json_object_insert(object, key, key_length, NULL, value);
+}
+
+ms_json_result_t ms_json_object_set_owned_key(ms_json_value_t* object, char* key, size_t key_length,
+                                              ms_json_value_t* value) {
+    return ms_json_object_insert(object, key, key_length, key, value);
+}
+
+ms_json_result_t ms_json_object_reserve(ms_json_value_t* object, size_t capacity) {
+    if (!object || object->type != MS_JSON_OBJECT) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    ms_json_result_t status = ms_json_value_resolve(object);
+    if (status != MS_JSON_SUCCESS) {
+        return status;
+    }
+
+    ms_json_object_t* obj = &object->data.object;
+    return capacity > obj->capacity ? ms_json_object_resize(obj, capacity) : MS_JSON_SUCCESS;
+}
+
+/* Shared by the set functions; owned_key, when given, is key itself and passes to the object */
+static ms_json_result_t ms_json_object_insert(ms_json_value_t* object, const char* key, size_t key_len,
+                                              char* owned_key, ms_json_value_t* value) {
     if (!object || object->type != MS_JSON_OBJECT || !key || !value) {
         return MS_JSON_ERROR_INVALID_ARGUMENT;
     }
 
+    ms_json_result_t status = ms_json_value_resolve(object);
+    if (status != MS_JSON_SUCCESS) {
+        return status;
+    }
+
     ms_json_object_t* obj = &object->data.object;
-    uint32_t key_hash = ms_json_hash_string(key);
+    uint32_t key_hash = ms_json_hash_key(key, key_len);
+
+    /* With a key table, keys already in the object compare equal by pointer */
+    if (obj->keys) {
+        key = ms_json_key_table_intern(obj->keys, key, key_len, key_hash);
+        if (!key) {
+            return MS_JSON_ERROR_MEMORY;
+        }
+    }
 
     /* Check if key already exists */
-    for (size_t i = 0; i < obj->count; i++) {
-        if (obj->entries[i].key &&
-            obj->entries[i].hash == key_hash &&
-            strcmp(obj->entries[i].key, key) == 0) {
-            /* Replace existing value */
-            ms_json_destroy(obj->entries[i].value, obj->allocator);
-            obj->entries[i].value = value;
-            return MS_JSON_SUCCESS;
+    ms_json_object_entry_t* existing = ms_json_object_find(obj, key, key_len, key_hash);
+    if (existing) {
+        /* Replace existing value */
+        ms_json_destroy(existing->value, obj->allocator);
+        existing->value = value;
+        if (owned_key) {
+            ms_allocator_deallocate(obj->allocator, owned_key);
         }
+        if (object->flags & MS_JSON_FLAG_CACHED) {
+            ms_json_fragment_touch(object);
+        }
+        return MS_JSON_SUCCESS;
     }
 
     /* Grow object if needed */
@@ -237,35 +437,128 @@ ms_json_result_t ms_json_object_set(ms_json_value_t* object, const char* key, ms
         }
     }
 
-    /* Create key copy */
-    size_t key_len = strlen(key);
-    char* key_copy = NULL;
-    if (ms_allocator_allocate(obj->allocator, key_len + 1, (void**)&key_copy) != MS_MEMORY_SUCCESS) {
-        return MS_JSON_ERROR_MEMORY;
+    /* Create key copy, unless the table or the object already owns it */
+    char* key_copy = (char*)key;
+    if (owned_key) {
+        if (obj->keys) {
+            ms_allocator_deallocate(obj->allocator, owned_key);
+        }
+    } else if (!obj->keys) {
+        if (ms_allocator_allocate(obj->allocator, key_len + 1, (void**)&key_copy) != MS_MEMORY_SUCCESS) {
+            return MS_JSON_ERROR_MEMORY;
+        }
+        memcpy(key_copy, key, key_len);
+        key_copy[key_len] = '\0';
     }
-    memcpy(key_copy, key, key_len);
-    key_copy[key_len] = '\0';
 
     /* Add new entry */
     obj->entries[obj->count].key = key_copy;
+    obj->entries[obj->count].key_length = key_len;
     obj->entries[obj->count].hash = key_hash;
     obj->entries[obj->count].value = value;
     obj->count++;
 
+    if (obj->index) {
+        ms_json_object_index_insert(obj, obj->count - 1);
+    } else if (obj->count >= MS_JSON_OBJECT_INDEX_THRESHOLD) {
+        ms_json_object_build_index(obj);
+    }
+
+    if (object->flags & MS_JSON_FLAG_CACHED) {
+        ms_json_fragment_touch(object);
+    }
     return MS_JSON_SUCCESS;
 }
 
+ms_json_object_entry_t* ms_json_object_find(const ms_json_object_t* object, const char* key,
+                                            size_t key_length, uint32_t hash) {
+    if (object->index) {
+        size_t mask = ms_json_object_index_slots(object->capacity) - 1;
+        for (size_t slot = hash & mask; object->index[slot] != 0; slot = (slot + 1) & mask) {
+            ms_json_object_entry_t* entry = &object->entries[object->index[slot] - 1];
+            if (entry->hash == hash && entry->key_length == key_length &&
+                (entry->key == key || memcmp(entry->key, key, key_length) == 0)) {
+                return entry;
+            }
+        }
+        return NULL;
+    }
+
+    for (size_t i = 0; i < object->count; i++) {
+        ms_json_object_entry_t* entry = &object->entries[i];
+        if (entry->hash == hash && entry->key_length == key_length &&
+            (entry->key == key || memcmp(entry->key, key, key_length) == 0)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/* Hash index keeps load factor <= 1/2 of the entry capacity */
+static size_t ms_json_object_index_slots(size_t capacity) {
+    size_t slots = 2 * MS_JSON_OBJECT_INDEX_THRESHOLD;
+    while (slots < capacity * 2) {
+        slots <<= 1;
+    }
+    return slots;
+}
+
+static void ms_json_object_index_insert(ms_json_object_t* object, size_t position) {
+    size_t mask = ms_json_object_index_slots(object->capacity) - 1;
+    size_t slot = object->entries[position].hash & mask;
+    while (object->index[slot] != 0) {
+        slot = (slot + 1) & mask;
+    }
+    object->index[slot] = (uint32_t)(position + 1);
+}
+
+/* Index is an accelerator only: on allocation failure lookups stay linear */
+static void ms_json_object_build_index(ms_json_object_t* object) {
+    if (object->index) {
+        ms_allocator_deallocate(object->allocator, object->index);
+        object->index = NULL;
+    }
+
+    if (object->capacity < MS_JSON_OBJECT_INDEX_THRESHOLD || object->capacity > UINT32_MAX) {
+        return;
+    }
+
+    uint32_t* index = NULL;
+    if (ms_allocator_allocate_zeroed(object->allocator, ms_json_object_index_slots(object->capacity),
+                                    sizeof(uint32_t), (void**)&index) != MS_MEMORY_SUCCESS) {
+        return;
+    }
+
+    object->index = index;
+    for (size_t i = 0; i < object->count; i++) {
+        ms_json_object_index_insert(object, i);
+    }
+}
+
 static ms_json_result_t ms_json_object_grow(ms_json_object_t* object) {
-    size_t new_capacity = object->capacity == 0 ? 4 : object->capacity * 2;
-    ms_json_object_entry_t* new_entries = NULL;
+    return ms_json_object_resize(object, object->capacity == 0 ? 4 : object->capacity * 2);
+}
 
+static ms_json_result_t ms_json_object_resize(ms_json_object_t* object, size_t capacity) {
+    if (capacity > SIZE_MAX / sizeof(ms_json_object_entry_t)) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    MS_INSTRUMENT_BEGIN(span, 0);
+    ms_json_object_entry_t* new_entries = NULL;
     if (ms_allocator_reallocate(object->allocator, object->entries,
-                               new_capacity * sizeof(ms_json_object_entry_t),
+                               capacity * sizeof(ms_json_object_entry_t),
                                (void**)&new_entries) != MS_MEMORY_SUCCESS) {
         return MS_JSON_ERROR_MEMORY;
     }
 
     object->entries = new_entries;
-    object->capacity = new_capacity;
+    object->capacity = capacity;
+
+    /* Slots depend on capacity, so an existing index is rebuilt */
+    if (object->index) {
+        ms_json_object_build_index(object);
+    }
+    MS_INSTRUMENT_END(span, MS_INSTRUMENT_GROWTH, capacity * sizeof(ms_json_object_entry_t));
     return MS_JSON_SUCCESS;
 }
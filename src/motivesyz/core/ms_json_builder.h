@@ -14,7 +14,9 @@
 ms_json_value_t* ms_json_create_null(ms_allocator_t* allocator);
 ms_json_value_t* ms_json_create_bool(ms_allocator_t* allocator, int value);
 ms_json_value_t* ms_json_create_number(ms_allocator_t* allocator, double value);
+ms_json_value_t* ms_json_create_integer(ms_allocator_t* allocator, int64_t value);
 ms_json_value_t* ms_json_create_string(ms_allocator_t* allocator, const char* value);
+ms_json_value_t* ms_json_create_string_n(ms_allocator_t* allocator, const char* value, size_t length);
 ms_json_value_t* ms_json_create_array(ms_allocator_t* allocator);
 ms_json_value_t* ms_json_create_object(ms_allocator_t* allocator);
 
@@ -28,9 +30,55 @@ void ms_json_destroy(ms_json_value_t* value, ms_allocator_t* allocator);
  */
 ms_json_result_t ms_json_array_append(ms_json_value_t* array, ms_json_value_t* element);
 
+/**
+ * @brief Make room for at least capacity elements in total
+ *
+ * Appending up to that many elements then never reallocates. Never shrinks.
+ */
+ms_json_result_t ms_json_array_reserve(ms_json_value_t* array, size_t capacity);
+
+/**
+ * @brief Append count elements with at most one reallocation
+ *
+ * @param elements Elements to append, none NULL; the array takes ownership
+ *        of all of them on success and of none on failure
+ */
+ms_json_result_t ms_json_array_append_many(ms_json_value_t* array, ms_json_value_t* const* elements,
+                                           size_t count);
+
 /**
  * @brief Object manipulation functions
  */
 ms_json_result_t ms_json_object_set(ms_json_value_t* object, const char* key, ms_json_value_t* value);
 
+/**
+ * @brief Insert or replace a member with an explicit-length key
+ *
+ * The key bytes are copied, so key need not be NUL-terminated and may
+ * contain NUL bytes.
+ */
+ms_json_result_t ms_json_object_set_n(ms_json_value_t* object, const char* key, size_t key_length,
+                                      ms_json_value_t* value);
+
+/**
+ * @brief Insert or replace a member, taking ownership of the key
+ *
+ * Saves the copy ms_json_object_set_n() makes. The key is freed instead
+ * when it is already present in the object or when the object interns its
+ * keys into a key table.
+ *
+ * @param key Key allocated from the object's allocator, with a NUL at key[key_length];
+ *        owned by the object on success, still the caller's on failure
+ */
+ms_json_result_t ms_json_object_set_owned_key(ms_json_value_t* object, char* key, size_t key_length,
+                                              ms_json_value_t* value);
+
+/**
+ * @brief Make room for at least capacity members in total
+ *
+ * Inserting up to that many members then never reallocates the entries
+ * or rebuilds the hash index. Never shrinks.
+ */
+ms_json_result_t ms_json_object_reserve(ms_json_value_t* object, size_t capacity);
+
 #endif
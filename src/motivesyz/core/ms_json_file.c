@@ -0,0 +1,215 @@
+/**
+ * @file ms_json_file.c
+ * @brief Parsing documents straight from files
+ *
+ * Regular files are memory-mapped and parsed in place, so no copy of the
+ * file is made and its size is limited only by the address space. Where
+ * mmap is unavailable or fails (pipes, special files) the file is read
+ * into a heap buffer with pread instead.
+ */
+
+#define _POSIX_C_SOURCE 200809L  /* pread(), madvise() */
+#define _DEFAULT_SOURCE          /* MADV_SEQUENTIAL on glibc */
+
+#include "ms_json_api.h"
+#include "ms_json_parser.h"
+#include "ms_json_internal.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(_POSIX_MAPPED_FILES) && _POSIX_MAPPED_FILES > 0
+#include <sys/mman.h>
+#define MS_JSON_HAVE_MMAP 1
+#else
+#define MS_JSON_HAVE_MMAP 0
+#endif
+
+/* Configuration constants */
+#define READ_INITIAL_CAPACITY (64 * 1024) /* When the file size is unknown */
+
+struct ms_json_file_mapping {
+    char* data;      /* File contents */
+    size_t length;   /* Bytes of data */
+    int is_mapped;   /* data comes from mmap rather than malloc */
+};
+
+/* Forward declarations for internal functions */
+static ms_json_result_t ms_json_map_file(int fd, ms_json_file_mapping_t* mapping);
+static ms_json_result_t ms_json_read_file(int fd, size_t size_hint, ms_json_file_mapping_t* mapping);
+static void ms_json_unmap_file(ms_json_file_mapping_t* mapping);
+
+ms_json_result_t ms_json_parse_file(const char* filename, const ms_json_options_t* options,
+                                   ms_json_value_t** result) {
+    if (!filename || !result) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    /* The file is released before returning, so strings must not borrow from it */
+    ms_json_options_t file_options = {0};
+    if (options) {
+        file_options = *options;
+    } else {
+        file_options.max_depth = MS_JSON_MAX_DEPTH_DEFAULT;
+    }
+    file_options.zero_copy = 0;
+
+    return ms_json_parse_file_mapped(filename, &file_options, result, NULL);
+}
+
+ms_json_result_t ms_json_parse_file_mapped(const char* filename, const ms_json_options_t* options,
+                                          ms_json_value_t** result, ms_json_file_mapping_t** mapping) {
+    if (!filename || !result) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    *result = NULL;
+    if (mapping) {
+        *mapping = NULL;
+    }
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    ms_json_file_mapping_t file = {0};
+    ms_json_result_t load_result = ms_json_map_file(fd, &file);
+    close(fd);
+
+    if (load_result != MS_JSON_SUCCESS) {
+        return load_result;
+    }
+
+    /* Without a caller to hand the mapping to, strings cannot safely borrow it */
+    ms_json_options_t parse_options = {0};
+    if (options) {
+        parse_options = *options;
+    } else {
+        parse_options.max_depth = MS_JSON_MAX_DEPTH_DEFAULT;
+    }
+    if (!mapping) {
+        parse_options.zero_copy = 0;
+    }
+
+    ms_json_result_t parse_result = ms_json_parse_buffer(file.data, file.length, &parse_options, result);
+
+    if (parse_result == MS_JSON_SUCCESS && mapping && parse_options.zero_copy) {
+        ms_json_file_mapping_t* handle = malloc(sizeof(*handle));
+        if (!handle) {
+            ms_json_destroy(*result, parse_options.allocator);
+            *result = NULL;
+            parse_result = MS_JSON_ERROR_MEMORY;
+        } else {
+            *handle = file;
+            *mapping = handle;
+            return MS_JSON_SUCCESS;
+        }
+    }
+
+    ms_json_unmap_file(&file);
+    return parse_result;
+}
+
+void ms_json_file_mapping_release(ms_json_file_mapping_t* mapping) {
+    if (!mapping) {
+        return;
+    }
+
+    ms_json_unmap_file(mapping);
+    free(mapping);
+}
+
+static ms_json_result_t ms_json_map_file(int fd, ms_json_file_mapping_t* mapping) {
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+        return MS_JSON_ERROR_IO;
+    }
+
+    /* Special files often report size 0, so only trust the size of regular files */
+    size_t size = 0;
+    if (S_ISREG(file_stat.st_mode)) {
+        if ((unsigned long long)file_stat.st_size > (unsigned long long)(size_t)-1) {
+            return MS_JSON_ERROR_MEMORY;
+        }
+        size = (size_t)file_stat.st_size;
+    }
+
+#if MS_JSON_HAVE_MMAP
+    if (size > 0) {
+        void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+#ifdef MADV_SEQUENTIAL
+            madvise(data, size, MADV_SEQUENTIAL); /* Advisory only; failure is harmless */
+#endif
+            mapping->data = data;
+            mapping->length = size;
+            mapping->is_mapped = 1;
+            return MS_JSON_SUCCESS;
+        }
+    }
+#endif
+
+    return ms_json_read_file(fd, size, mapping);
+}
+
+/* Read until end of file; size_hint is the expected size, 0 if unknown */
+static ms_json_result_t ms_json_read_file(int fd, size_t size_hint, ms_json_file_mapping_t* mapping) {
+    size_t capacity = size_hint > 0 ? size_hint + 1 : READ_INITIAL_CAPACITY;
+    size_t length = 0;
+    char* data = malloc(capacity);
+    if (!data) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    for (;;) {
+        if (length == capacity) {
+            size_t new_capacity = capacity * 2;
+            char* new_data = new_capacity > capacity ? realloc(data, new_capacity) : NULL;
+            if (!new_data) {
+                free(data);
+                return MS_JSON_ERROR_MEMORY;
+            }
+            data = new_data;
+            capacity = new_capacity;
+        }
+
+        ssize_t bytes_read = pread(fd, data + length, capacity - length, (off_t)length);
+        if (bytes_read < 0 && errno == ESPIPE) {
+            bytes_read = read(fd, data + length, capacity - length); /* Pipes cannot seek */
+        }
+
+        if (bytes_read < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            free(data);
+            return MS_JSON_ERROR_IO;
+        }
+
+        if (bytes_read == 0) {
+            break;
+        }
+        length += (size_t)bytes_read;
+    }
+
+    mapping->data = data;
+    mapping->length = length;
+    mapping->is_mapped = 0;
+    return MS_JSON_SUCCESS;
+}
+
+static void ms_json_unmap_file(ms_json_file_mapping_t* mapping) {
+#if MS_JSON_HAVE_MMAP
+    if (mapping->is_mapped) {
+        munmap(mapping->data, mapping->length);
+        mapping->data = NULL;
+        return;
+    }
+#endif
+
+    free(mapping->data);
+    mapping->data = NULL;
+}
@@ -0,0 +1,461 @@
+/**
+ * @file ms_json_fragment.c
+ * @brief Incremental re-serialization from cached container text
+ *
+ * Each container of a cached tree has a fragment: the offset of its text
+ * inside its parent's text in the previous output, and its length. Offsets
+ * are relative so that a container keeps a valid fragment when a sibling
+ * before it changes size; only the containers on a changed path are
+ * re-emitted, and everything under them that did not change is copied.
+ *
+ * The builder reaches the fragment of a container it modifies through a
+ * process-wide registry keyed by the container's address. Only values
+ * carrying MS_JSON_FLAG_CACHED are looked up, so trees without a cache pay
+ * one flag test per mutation.
+ */
+
+#include "ms_json_fragment.h"
+#include "ms_json_internal.h"
+#include "ms_json_serializer.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Configuration constants */
+#define FRAGMENT_REGISTRY_MIN_CAPACITY 64   /* Slots allocated on first use; always a power of two */
+#define FRAGMENT_TEXT_INITIAL_SIZE 1024     /* First buffer when there is no previous output */
+#define FRAGMENT_NO_POSITION SIZE_MAX       /* Container has no text in the previous output */
+
+typedef struct ms_json_fragment ms_json_fragment_t;
+
+/**
+ * @brief Cached position of one container
+ */
+struct ms_json_fragment {
+    ms_json_value_t* container;        /**< Tracked array or object */
+    ms_json_fragment_t* parent;        /**< Enclosing container's fragment, NULL for the root */
+    ms_json_fragment_cache_t* cache;   /**< Owning cache */
+    ms_json_fragment_t* prev;          /**< Cache's list of fragments */
+    ms_json_fragment_t* next;
+    size_t offset;                     /**< Start in the parent's text, or in the output for the root */
+    size_t length;                     /**< Length of the container's text */
+    int dirty;                         /**< Changed since the previous output; ancestors are dirty too */
+};
+
+struct ms_json_fragment_cache {
+    ms_json_value_t* root;             /**< Tracked tree, NULL once destroyed */
+    ms_allocator_t* allocator;         /**< Owns the cache, its fragments and its text */
+    ms_json_fragment_t* fragments;     /**< Every fragment of the tree */
+    char* text;                        /**< Previous output, NUL-terminated; NULL after a failure */
+    size_t length;                     /**< Length of text */
+};
+
+/**
+ * @brief Container address to fragment, open addressing with linear probing
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    ms_json_fragment_t** slots;        /**< NULL for empty */
+    size_t capacity;                   /**< Power of two, 0 before first use */
+    size_t count;
+} ms_json_fragment_registry_t;
+
+static ms_json_fragment_registry_t registry = { PTHREAD_MUTEX_INITIALIZER, NULL, 0, 0 };
+
+/* Forward declarations */
+static ms_json_result_t ms_json_fragment_emit(ms_json_fragment_cache_t* cache, ms_json_serialize_context_t* ctx,
+                                              const ms_json_value_t* value, ms_json_fragment_t* parent,
+                                              size_t parent_start, size_t parent_old);
+static ms_json_result_t ms_json_fragment_emit_members(ms_json_fragment_cache_t* cache,
+                                                      ms_json_serialize_context_t* ctx,
+                                                      const ms_json_value_t* value, ms_json_fragment_t* fragment,
+                                                      size_t start, size_t old_start);
+static ms_json_fragment_t* ms_json_fragment_track(ms_json_fragment_cache_t* cache, ms_json_value_t* container);
+static void ms_json_fragment_free(ms_json_fragment_t* fragment);
+static size_t ms_json_registry_home(const ms_json_value_t* container, size_t capacity);
+static ms_json_fragment_t* ms_json_fragment_lookup(const ms_json_value_t* container);
+static ms_json_fragment_t* ms_json_registry_find(const ms_json_value_t* container);
+static int ms_json_registry_insert(ms_json_fragment_t* fragment);
+static void ms_json_registry_remove(const ms_json_value_t* container);
+
+ms_json_result_t ms_json_fragment_cache_create(ms_json_value_t* root, ms_allocator_t* allocator,
+                                               ms_json_fragment_cache_t** result) {
+    if (!root || !result) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    *result = NULL;
+    if (root->flags & MS_JSON_FLAG_CACHED) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (!allocator) {
+        allocator = ms_allocator_default();
+    }
+
+    ms_json_fragment_cache_t* cache = NULL;
+    if (ms_allocator_allocate_zeroed(allocator, 1, sizeof(*cache), (void**)&cache) != MS_MEMORY_SUCCESS) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+    cache->root = root;
+    cache->allocator = allocator;
+
+    const char* text = NULL;
+    ms_json_result_t status = ms_json_fragment_cache_serialize(cache, &text, NULL);
+    if (status != MS_JSON_SUCCESS) {
+        ms_json_fragment_cache_destroy(cache);
+        return status;
+    }
+
+    *result = cache;
+    return MS_JSON_SUCCESS;
+}
+
+ms_json_result_t ms_json_fragment_cache_serialize(ms_json_fragment_cache_t* cache, const char** result,
+                                                  size_t* length) {
+    if (!cache || !result || !cache->root) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    ms_json_fragment_t* root = NULL;
+    if (cache->root->flags & MS_JSON_FLAG_CACHED) {
+        root = ms_json_fragment_lookup(cache->root);
+    }
+
+    /* Nothing changed: the previous output is still exact */
+    if (cache->text && root && !root->dirty) {
+        *result = cache->text;
+        if (length) {
+            *length = cache->length;
+        }
+        return MS_JSON_SUCCESS;
+    }
+
+    ms_json_serialize_context_t ctx = {
+        .allocator = cache->allocator,
+        .buffer = NULL,
+        .position = 0,
+        .capacity = cache->text ? cache->length + 1 : FRAGMENT_TEXT_INITIAL_SIZE,
+        .needs_comma = 0,
+        .write_fn = NULL,
+        .write_ctx = NULL,
+        .fixed = 0
+    };
+
+    if (ms_allocator_allocate(ctx.allocator, ctx.capacity, (void**)&ctx.buffer) != MS_MEMORY_SUCCESS) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    ms_json_result_t status = ms_json_fragment_emit(cache, &ctx, cache->root, NULL, 0,
+                                                    cache->text ? 0 : FRAGMENT_NO_POSITION);
+    if (status == MS_JSON_SUCCESS) {
+        status = ms_json_serialize_append(&ctx, "", 1);
+    }
+
+    /*
+     * Fragments were rewritten for the new text as the walk went; after a
+     * failure they match neither text, so the next call starts over.
+     */
+    if (cache->text) {
+        ms_allocator_deallocate(cache->allocator, cache->text);
+    }
+    if (status != MS_JSON_SUCCESS) {
+        ms_allocator_deallocate(ctx.allocator, ctx.buffer);
+        cache->text = NULL;
+        cache->length = 0;
+        return status;
+    }
+
+    cache->text = ctx.buffer;
+    cache->length = ctx.position - 1;
+    *result = cache->text;
+    if (length) {
+        *length = cache->length;
+    }
+    return MS_JSON_SUCCESS;
+}
+
+void ms_json_fragment_cache_destroy(ms_json_fragment_cache_t* cache) {
+    if (!cache) {
+        return;
+    }
+
+    pthread_mutex_lock(&registry.lock);
+    for (ms_json_fragment_t* fragment = cache->fragments; fragment; fragment = fragment->next) {
+        ms_json_registry_remove(fragment->container);
+        fragment->container->flags &= ~MS_JSON_FLAG_CACHED;
+    }
+    pthread_mutex_unlock(&registry.lock);
+
+    while (cache->fragments) {
+        ms_json_fragment_free(cache->fragments);
+    }
+
+    if (cache->text) {
+        ms_allocator_deallocate(cache->allocator, cache->text);
+    }
+    ms_allocator_deallocate(cache->allocator, cache);
+}
+
+void ms_json_fragment_touch(const ms_json_value_t* container) {
+    for (ms_json_fragment_t* fragment = ms_json_fragment_lookup(container); fragment && !fragment->dirty;
+         fragment = fragment->parent) {
+        fragment->dirty = 1;
+    }
+}
+
+void ms_json_fragment_forget(const ms_json_value_t* container) {
+    pthread_mutex_lock(&registry.lock);
+    ms_json_fragment_t* fragment = ms_json_registry_find(container);
+    ms_json_registry_remove(container);
+    pthread_mutex_unlock(&registry.lock);
+
+    if (!fragment) {
+        return;
+    }
+
+    if (fragment->cache->root == container) {
+        fragment->cache->root = NULL;
+    }
+    ms_json_fragment_free(fragment);
+}
+
+/*
+ * Write value's text. parent_start is where the enclosing container starts
+ * in the new output and parent_old where it started in the previous one,
+ * FRAGMENT_NO_POSITION when its text there cannot be used.
+ */
+static ms_json_result_t ms_json_fragment_emit(ms_json_fragment_cache_t* cache, ms_json_serialize_context_t* ctx,
+                                              const ms_json_value_t* value, ms_json_fragment_t* parent,
+                                              size_t parent_start, size_t parent_old) {
+    ms_json_type_t type = ms_json_value_get_type(value);
+    if (type != MS_JSON_ARRAY && type != MS_JSON_OBJECT) {
+        return ms_json_serialize_value(value, ctx);
+    }
+
+    ms_json_fragment_t* fragment = NULL;
+    if (value->flags & MS_JSON_FLAG_CACHED) {
+        fragment = ms_json_fragment_lookup(value);
+        if (!fragment || fragment->cache != cache) {
+            return MS_JSON_ERROR_INVALID_ARGUMENT;
+        }
+    }
+
+    size_t start = ctx->position;
+    ms_json_result_t status;
+
+    if (fragment && !fragment->dirty && parent_old != FRAGMENT_NO_POSITION) {
+        status = ms_json_serialize_append(ctx, cache->text + parent_old + fragment->offset, fragment->length);
+    } else {
+        size_t old_start = FRAGMENT_NO_POSITION;
+        if (fragment && parent_old != FRAGMENT_NO_POSITION) {
+            old_start = parent_old + fragment->offset;
+        }
+
+        status = ms_json_value_resolve(value);
+        if (status == MS_JSON_SUCCESS && !fragment) {
+            fragment = ms_json_fragment_track(cache, (ms_json_value_t*)value);
+            status = fragment ? MS_JSON_SUCCESS : MS_JSON_ERROR_MEMORY;
+        }
+        if (status == MS_JSON_SUCCESS) {
+            status = ms_json_fragment_emit_members(cache, ctx, value, fragment, start, old_start);
+        }
+    }
+
+    if (status != MS_JSON_SUCCESS) {
+        return status;
+    }
+
+    fragment->parent = parent;
+    fragment->offset = start - parent_start;
+    fragment->length = ctx->position - start;
+    fragment->dirty = 0;
+    return MS_JSON_SUCCESS;
+}
+
+/* Brackets and members of a resolved container; members see it start at start / old_start */
+static ms_json_result_t ms_json_fragment_emit_members(ms_json_fragment_cache_t* cache,
+                                                      ms_json_serialize_context_t* ctx,
+                                                      const ms_json_value_t* value, ms_json_fragment_t* fragment,
+                                                      size_t start, size_t old_start) {
+    int is_array = ms_json_value_get_type(value) == MS_JSON_ARRAY;
+    ms_json_result_t status = ms_json_serialize_append(ctx, is_array ? "[" : "{", 1);
+
+    if (is_array) {
+        const ms_json_array_t* array = ms_json_value_get_array_const(value);
+        for (size_t i = 0; i < array->count && status == MS_JSON_SUCCESS; i++) {
+            if (i > 0) {
+                status = ms_json_serialize_append(ctx, ",", 1);
+            }
+            if (status == MS_JSON_SUCCESS) {
+                status = ms_json_fragment_emit(cache, ctx, array->items[i], fragment, start, old_start);
+            }
+        }
+    } else {
+        const ms_json_object_t* object = ms_json_value_get_object_const(value);
+        for (size_t i = 0; i < object->count && status == MS_JSON_SUCCESS; i++) {
+            const ms_json_object_entry_t* entry = &object->entries[i];
+            if (i > 0) {
+                status = ms_json_serialize_append(ctx, ",", 1);
+            }
+            if (status == MS_JSON_SUCCESS) {
+                status = ms_json_serialize_string(entry->key, entry->key_length, ctx);
+            }
+            if (status == MS_JSON_SUCCESS) {
+                status = ms_json_serialize_append(ctx, ":", 1);
+            }
+            if (status == MS_JSON_SUCCESS) {
+                status = ms_json_fragment_emit(cache, ctx, entry->value, fragment, start, old_start);
+            }
+        }
+    }
+
+    if (status != MS_JSON_SUCCESS) {
+        return status;
+    }
+    return ms_json_serialize_append(ctx, is_array ? "]" : "}", 1);
+}
+
+/* New fragment for a container first seen by this cache, registered and flagged */
+static ms_json_fragment_t* ms_json_fragment_track(ms_json_fragment_cache_t* cache, ms_json_value_t* container) {
+    ms_json_fragment_t* fragment = NULL;
+    if (ms_allocator_allocate_zeroed(cache->allocator, 1, sizeof(*fragment), (void**)&fragment) !=
+        MS_MEMORY_SUCCESS) {
+        return NULL;
+    }
+    fragment->container = container;
+    fragment->cache = cache;
+
+    pthread_mutex_lock(&registry.lock);
+    int inserted = ms_json_registry_insert(fragment);
+    pthread_mutex_unlock(&registry.lock);
+    if (!inserted) {
+        ms_allocator_deallocate(cache->allocator, fragment);
+        return NULL;
+    }
+
+    fragment->next = cache->fragments;
+    if (cache->fragments) {
+        cache->fragments->prev = fragment;
+    }
+    cache->fragments = fragment;
+    container->flags |= MS_JSON_FLAG_CACHED;
+    return fragment;
+}
+
+/* Unlink from the cache and free; the registry entry must already be gone */
+static void ms_json_fragment_free(ms_json_fragment_t* fragment) {
+    ms_json_fragment_cache_t* cache = fragment->cache;
+    if (fragment->prev) {
+        fragment->prev->next = fragment->next;
+    } else {
+        cache->fragments = fragment->next;
+    }
+    if (fragment->next) {
+        fragment->next->prev = fragment->prev;
+    }
+    ms_allocator_deallocate(cache->allocator, fragment);
+}
+
+/* Preferred slot: Fibonacci hashing of the address without its alignment bits */
+static size_t ms_json_registry_home(const ms_json_value_t* container, size_t capacity) {
+    uint64_t key = (uint64_t)((uintptr_t)container >> 4);
+    return (size_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & (capacity - 1);
+}
+
+/* Registry lookup taking the lock; caches on other threads share the registry */
+static ms_json_fragment_t* ms_json_fragment_lookup(const ms_json_value_t* container) {
+    pthread_mutex_lock(&registry.lock);
+    ms_json_fragment_t* fragment = ms_json_registry_find(container);
+    pthread_mutex_unlock(&registry.lock);
+    return fragment;
+}
+
+/* Fragment of a container, NULL if untracked; caller holds the lock */
+static ms_json_fragment_t* ms_json_registry_find(const ms_json_value_t* container) {
+    if (registry.capacity == 0) {
+        return NULL;
+    }
+
+    size_t mask = registry.capacity - 1;
+    for (size_t slot = ms_json_registry_home(container, registry.capacity); registry.slots[slot];
+         slot = (slot + 1) & mask) {
+        if (registry.slots[slot]->container == container) {
+            return registry.slots[slot];
+        }
+    }
+    return NULL;
+}
+
+/* Add a fragment, growing at half load; caller holds the lock. Returns 0 when out of memory */
+static int ms_json_registry_insert(ms_json_fragment_t* fragment) {
+    if ((registry.count + 1) * 2 > registry.capacity) {
+        size_t capacity = registry.capacity ? registry.capacity * 2 : FRAGMENT_REGISTRY_MIN_CAPACITY;
+        ms_json_fragment_t** slots = NULL;
+        if (ms_allocator_allocate_zeroed(ms_allocator_default(), capacity, sizeof(*slots), (void**)&slots) !=
+            MS_MEMORY_SUCCESS) {
+            return 0;
+        }
+
+        for (size_t i = 0; i < registry.capacity; i++) {
+            if (registry.slots[i]) {
+                size_t slot = ms_json_registry_home(registry.slots[i]->container, capacity);
+                while (slots[slot]) {
+                    slot = (slot + 1) & (capacity - 1);
+                }
+                slots[slot] = registry.slots[i];
+            }
+        }
+        if (registry.slots) {
+            ms_allocator_deallocate(ms_allocator_default(), registry.slots);
+        }
+        registry.slots = slots;
+        registry.capacity = capacity;
+    }
+
+    size_t slot = ms_json_registry_home(fragment->container, registry.capacity);
+    while (registry.slots[slot]) {
+        slot = (slot + 1) & (registry.capacity - 1);
+    }
+    registry.slots[slot] = fragment;
+    registry.count++;
+    return 1;
+}
+
+/*
+ * Remove a container's entry if present, shifting later entries of its
+ * probe run back so lookups need no tombstones; caller holds the lock
+ */
+static void ms_json_registry_remove(const ms_json_value_t* container) {
+    if (registry.capacity == 0) {
+        return;
+    }
+
+    size_t mask = registry.capacity - 1;
+    size_t hole = ms_json_registry_home(container, registry.capacity);
+    while (registry.slots[hole] && registry.slots[hole]->container != container) {
+        hole = (hole + 1) & mask;
+    }
+    if (!registry.slots[hole]) {
+        return;
+    }
+
+    registry.slots[hole] = NULL;
+    if (--registry.count == 0) {
+        /* Last tracked container gone: give the table back */
+        ms_allocator_deallocate(ms_allocator_default(), registry.slots);
+        registry.slots = NULL;
+        registry.capacity = 0;
+        return;
+    }
+
+    for (size_t slot = (hole + 1) & mask; registry.slots[slot]; slot = (slot + 1) & mask) {
+        size_t home = ms_json_registry_home(registry.slots[slot]->container, registry.capacity);
+        /* Entry may move into the hole only if the hole lies between its home and its slot */
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            registry.slots[hole] = registry.slots[slot];
+            registry.slots[slot] = NULL;
+            hole = slot;
+        }
+    }
+}
@@ -0,0 +1,67 @@
+/**
+ * @file ms_json_fragment.h
+ * @brief Re-serialization of a long-lived tree that reuses unchanged text
+ */
+
+#ifndef MS_JSON_FRAGMENT_H
+#define MS_JSON_FRAGMENT_H
+
+#include "ms_json_types.h"
+#include <stddef.h>
+
+/**
+ * @brief Serialized text of a tree plus where each container sits in it, opaque
+ *
+ * Every array and object of the tree remembers the position and length of
+ * its text in the previous output. Changes made through the builder
+ * functions (ms_json_array_append(), ms_json_object_set() and their
+ * variants) mark the changed container and its ancestors dirty. The next
+ * serialization re-emits only dirty containers; every clean container is
+ * copied from the previous output in one piece, so the cost follows the
+ * size of the change plus one copy of the text, not the cost of
+ * formatting the whole document again.
+ *
+ * The cache costs one small record per container. A tree can have one
+ * cache. The tree and the cache are not safe to use from several threads
+ * at once.
+ */
+typedef struct ms_json_fragment_cache ms_json_fragment_cache_t;
+
+/**
+ * @brief Start caching a tree and serialize it once
+ *
+ * @param root Tree to track; must not be tracked by another cache
+ * @param allocator Allocator for the cache and its text (NULL for default)
+ * @param result Output parameter, freed with ms_json_fragment_cache_destroy()
+ * @return MS_JSON_SUCCESS, MS_JSON_ERROR_INVALID_ARGUMENT if root is already
+ *         tracked, or an error from serializing it
+ */
+ms_json_result_t ms_json_fragment_cache_create(ms_json_value_t* root, ms_allocator_t* allocator,
+                                               ms_json_fragment_cache_t** result);
+
+/**
+ * @brief Serialize the tree's current state
+ *
+ * Output is identical to ms_json_serialize().
+ *
+ * @param cache Cache of the tree
+ * @param result Output parameter for the NUL-terminated text, owned by the
+ *        cache and valid until the next call or ms_json_fragment_cache_destroy()
+ * @param length Output parameter for the text length, NULL if not needed
+ * @return MS_JSON_SUCCESS, MS_JSON_ERROR_INVALID_ARGUMENT if the root was
+ *         destroyed, or MS_JSON_ERROR_MEMORY; after a failure the cached
+ *         text is dropped and the next call serializes everything
+ */
+ms_json_result_t ms_json_fragment_cache_serialize(ms_json_fragment_cache_t* cache, const char** result,
+                                                  size_t* length);
+
+/**
+ * @brief Stop tracking the tree and free the cache
+ *
+ * The tree stays valid and may be destroyed before or after the cache,
+ * except that a tree in an arena allocator must outlive its cache: arena
+ * trees are not walked on destroy, so their containers cannot un-register.
+ */
+void ms_json_fragment_cache_destroy(ms_json_fragment_cache_t* cache);
+
+#endif /* MS_JSON_FRAGMENT_H */
@@ -9,6 +9,7 @@
 
 typedef struct {
     char* key;
+    size_t key_length;
     uint32_t hash;
     ms_json_value_t* value;
 } ms_json_object_entry_t;
@@ -20,33 +21,141 @@ typedef struct ms_json_array {
     ms_allocator_t* allocator;
 } ms_json_array_t;
 
+/* Parser limits shared by every parse entry point */
+#define MS_JSON_MAX_DEPTH_DEFAULT 256               /* Nesting limit when no options are given */
+#define MS_JSON_MAX_STRING_LENGTH (1024 * 1024)     /* 1MB max raw string length */
+
+/* Objects with at least this many keys get an open-addressing hash index */
+#define MS_JSON_OBJECT_INDEX_THRESHOLD 8
+
 typedef struct ms_json_object {
     ms_json_object_entry_t* entries;
     size_t count;
     size_t capacity;
     ms_allocator_t* allocator;
+    uint32_t* index;  /* entry position + 1 per slot, 0 = empty; NULL below threshold */
+    ms_json_key_table_t* keys;  /* Table owning the entry keys; NULL when each key is its own copy */
 } ms_json_object_t;
 
+/**
+ * String payload: NUL-terminated when owned, a view into the parse input
+ * when MS_JSON_FLAG_BORROWED is set
+ */
+typedef struct {
+    char* chars;
+    size_t length;
+} ms_json_string_t;
+
+/* Document shared by the undecoded containers of one lazy parse */
+typedef struct ms_json_lazy_document ms_json_lazy_document_t;
+
+/**
+ * Container not decoded yet: its opening bracket is index entry `entry`
+ * of `document`
+ */
+typedef struct {
+    ms_json_lazy_document_t* document;
+    size_t entry;
+} ms_json_lazy_t;
+
 /**
  * Internal JSON value data union
  */
 typedef union {
     int boolean;
     double number;
-    char* string;
+    int64_t integer;
+    ms_json_string_t string;
     ms_json_array_t array;
     ms_json_object_t object;
+    ms_json_lazy_t lazy;
 } ms_json_data_t;
 
+/* Value flags */
+#define MS_JSON_FLAG_BORROWED 0x1u  /* String points into caller-owned input, not freed */
+#define MS_JSON_FLAG_INTEGER 0x2u   /* Number stored exactly in data.integer */
+#define MS_JSON_FLAG_LAZY 0x4u      /* Array or object still held in data.lazy */
+#define MS_JSON_FLAG_CACHED 0x8u    /* Array or object tracked by a fragment cache */
+
 /**
  * Internal JSON value structure
  */
 struct ms_json_value {
     ms_json_type_t type;
+    unsigned int flags;
     ms_json_data_t data;
     ms_allocator_t* allocator;
 };
 
+/* 32-bit FNV-1a over an explicit-length key */
+static inline uint32_t ms_json_hash_key(const char* key, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint32_t)(unsigned char)key[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/* Find entry by key in O(1) (indexed) or a hash-filtered scan; NULL if absent */
+ms_json_object_entry_t* ms_json_object_find(const ms_json_object_t* object, const char* key,
+                                            size_t key_length, uint32_t hash);
+
+/*
+ * The table's copy of a key, added if missing. hash must be
+ * ms_json_hash_key() of the key. Returns NULL when out of memory.
+ */
+const char* ms_json_key_table_intern(ms_json_key_table_t* table, const char* key, size_t key_length,
+                                     uint32_t hash);
+
+/* Take one more reference to a table; returns table */
+ms_json_key_table_t* ms_json_key_table_retain(ms_json_key_table_t* table);
+
+/*
+ * Table a parse interns into, holding one reference the caller releases:
+ * options->key_table, a new table for intern_keys, or NULL for neither
+ */
+ms_json_result_t ms_json_key_table_acquire(const ms_json_options_t* options, ms_allocator_t* allocator,
+                                           ms_json_key_table_t** result);
+
+/* String values taking ownership of allocator memory / borrowing caller memory */
+ms_json_value_t* ms_json_create_string_owned(ms_allocator_t* allocator, char* chars, size_t length);
+ms_json_value_t* ms_json_create_string_borrowed(ms_allocator_t* allocator, const char* chars,
+                                                size_t length);
+
+/*
+ * Decode the raw body of a JSON string (between the quotes) into output,
+ * which must hold raw_length + 1 bytes; decoded text is never longer than
+ * its escaped form. Returns 0 on an invalid escape sequence.
+ */
+int ms_json_decode_string(const char* raw, size_t raw_length, char* output, size_t* output_length);
+
+/*
+ * Decode the members of a lazy container in place, one level deep; nested
+ * containers stay lazy. The value is left untouched on failure.
+ */
+ms_json_result_t ms_json_lazy_materialize(ms_json_value_t* value);
+
+/* Drop a lazy container's reference to its document without decoding it */
+void ms_json_lazy_release(ms_json_value_t* value);
+
+/*
+ * Make data.array / data.object usable. Decoding caches into the value, so
+ * this writes through const: lazy trees are not safe for concurrent readers.
+ */
+static inline ms_json_result_t ms_json_value_resolve(const ms_json_value_t* value) {
+    if (value->flags & MS_JSON_FLAG_LAZY) {
+        return ms_json_lazy_materialize((ms_json_value_t*)value);
+    }
+    return MS_JSON_SUCCESS;
+}
+
+/* A tracked container changed: its cached text and its ancestors' are stale */
+void ms_json_fragment_touch(const ms_json_value_t* container);
+
+/* A tracked container is being destroyed: drop its fragment */
+void ms_json_fragment_forget(const ms_json_value_t* container);
+
 /* Internal accessors for .c files */
 static inline ms_json_type_t ms_json_value_get_type(const ms_json_value_t* value) {
     return value->type;
@@ -57,11 +166,15 @@ static inline int ms_json_value_get_bool(const ms_json_value_t* value) {
 }
 
 static inline double ms_json_value_get_number(const ms_json_value_t* value) {
-    return value->data.number;
+    return (value->flags & MS_JSON_FLAG_INTEGER) ? (double)value->data.integer : value->data.number;
 }
 
 static inline const char* ms_json_value_get_string(const ms_json_value_t* value) {
-    return value->data.string;
+    return value->data.string.chars;
+}
+
+static inline size_t ms_json_value_get_string_length(const ms_json_value_t* value) {
+    return value->data.string.length;
 }
 
 static inline ms_json_array_t* ms_json_value_get_array(ms_json_value_t* value) {
@@ -0,0 +1,203 @@
+/**
+ * @file ms_json_keys.c
+ * @brief Key tables: one copy of each distinct object key
+ *
+ * Key bytes are packed NUL-terminated into large chunks, and an
+ * open-addressing hash set over them maps key text to its copy. Keys stay
+ * until the table is freed, so object entries can point at them directly.
+ */
+
+#include "ms_json_keys.h"
+#include "ms_json_internal.h"
+#include "ms_platform.h"
+#include <string.h>
+
+/* Configuration constants */
+#define KEY_TABLE_CHUNK_SIZE 4096
+#define KEY_TABLE_INITIAL_SLOTS 64
+
+typedef struct ms_json_key_chunk {
+    struct ms_json_key_chunk* next;
+    size_t used;
+    size_t capacity;
+    char data[];
+} ms_json_key_chunk_t;
+
+typedef struct {
+    const char* key;  /* NULL = empty */
+    size_t key_length;
+    uint32_t hash;
+} ms_json_key_slot_t;
+
+struct ms_json_key_table {
+    ms_allocator_t* allocator;
+    ms_json_key_slot_t* slots;
+    size_t slot_count;            /* Power of two, at most half full */
+    size_t count;
+    ms_json_key_chunk_t* chunks;  /* Chunk being filled first */
+    size_t references;
+};
+
+/* Internal helper functions */
+static ms_json_result_t ms_json_key_table_grow(ms_json_key_table_t* table);
+static char* ms_json_key_table_store(ms_json_key_table_t* table, const char* key, size_t key_length);
+static void ms_json_key_table_destroy(ms_json_key_table_t* table);
+
+ms_json_key_table_t* ms_json_key_table_create(ms_allocator_t* allocator) {
+    if (!allocator) {
+        allocator = ms_allocator_default();
+    }
+
+    ms_json_key_table_t* table = NULL;
+    if (ms_allocator_allocate(allocator, sizeof(*table), (void**)&table) != MS_MEMORY_SUCCESS) {
+        return NULL;
+    }
+
+    table->allocator = allocator;
+    table->slots = NULL;
+    table->slot_count = 0;
+    table->count = 0;
+    table->chunks = NULL;
+    table->references = 1;
+    return table;
+}
+
+void ms_json_key_table_release(ms_json_key_table_t* table) {
+    /*
+     * An arena may hand back its most recent allocation on deallocate, which
+     * would let live arena objects' keys be overwritten
+     */
+    if (!table || ms_allocator_is_arena(table->allocator)) {
+        return;
+    }
+
+    if (MS_ATOMIC_SUB_ACQ_REL(&table->references, 1) == 1) {
+        ms_json_key_table_destroy(table);
+    }
+}
+
+ms_json_key_table_t* ms_json_key_table_retain(ms_json_key_table_t* table) {
+    MS_ATOMIC_ADD(&table->references, 1);
+    return table;
+}
+
+size_t ms_json_key_table_count(const ms_json_key_table_t* table) {
+    return table ? table->count : 0;
+}
+
+ms_json_result_t ms_json_key_table_acquire(const ms_json_options_t* options, ms_allocator_t* allocator,
+                                           ms_json_key_table_t** result) {
+    *result = NULL;
+    if (options->key_table) {
+        *result = ms_json_key_table_retain(options->key_table);
+    } else if (options->intern_keys) {
+        *result = ms_json_key_table_create(allocator);
+        if (!*result) {
+            return MS_JSON_ERROR_MEMORY;
+        }
+    }
+    return MS_JSON_SUCCESS;
+}
+
+const char* ms_json_key_table_intern(ms_json_key_table_t* table, const char* key, size_t key_length,
+                                     uint32_t hash) {
+    if (table->slot_count > 0) {
+        size_t mask = table->slot_count - 1;
+        for (size_t slot = hash & mask; table->slots[slot].key; slot = (slot + 1) & mask) {
+            const ms_json_key_slot_t* entry = &table->slots[slot];
+            if (entry->hash == hash && entry->key_length == key_length &&
+                memcmp(entry->key, key, key_length) == 0) {
+                return entry->key;
+            }
+        }
+    }
+
+    if ((table->count + 1) * 2 > table->slot_count && ms_json_key_table_grow(table) != MS_JSON_SUCCESS) {
+        return NULL;
+    }
+
+    char* copy = ms_json_key_table_store(table, key, key_length);
+    if (!copy) {
+        return NULL;
+    }
+
+    size_t mask = table->slot_count - 1;
+    size_t slot = hash & mask;
+    while (table->slots[slot].key) {
+        slot = (slot + 1) & mask;
+    }
+    table->slots[slot].key = copy;
+    table->slots[slot].key_length = key_length;
+    table->slots[slot].hash = hash;
+    table->count++;
+    return copy;
+}
+
+/* Double the hash set and reinsert every key */
+static ms_json_result_t ms_json_key_table_grow(ms_json_key_table_t* table) {
+    size_t slot_count = table->slot_count ? table->slot_count * 2 : KEY_TABLE_INITIAL_SLOTS;
+    ms_json_key_slot_t* slots = NULL;
+    if (ms_allocator_allocate(table->allocator, slot_count * sizeof(*slots), (void**)&slots) != MS_MEMORY_SUCCESS) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+    memset(slots, 0, slot_count * sizeof(*slots));
+
+    size_t mask = slot_count - 1;
+    for (size_t i = 0; i < table->slot_count; i++) {
+        if (table->slots[i].key) {
+            size_t slot = table->slots[i].hash & mask;
+            while (slots[slot].key) {
+                slot = (slot + 1) & mask;
+            }
+            slots[slot] = table->slots[i];
+        }
+    }
+
+    if (table->slots) {
+        ms_allocator_deallocate(table->allocator, table->slots);
+    }
+    table->slots = slots;
+    table->slot_count = slot_count;
+    return MS_JSON_SUCCESS;
+}
+
+/* Copy a key into the current chunk, starting a new one when it is full */
+static char* ms_json_key_table_store(ms_json_key_table_t* table, const char* key, size_t key_length) {
+    ms_json_key_chunk_t* chunk = table->chunks;
+    if (!chunk || chunk->capacity - chunk->used < key_length + 1) {
+        size_t capacity = key_length + 1 > KEY_TABLE_CHUNK_SIZE ? key_length + 1 : KEY_TABLE_CHUNK_SIZE;
+        if (ms_allocator_allocate(table->allocator, sizeof(*chunk) + capacity, (void**)&chunk) != MS_MEMORY_SUCCESS) {
+            return NULL;
+        }
+        chunk->used = 0;
+        chunk->capacity = capacity;
+
+        /* An oversized key gets a chunk of its own behind the one being filled */
+        if (capacity > KEY_TABLE_CHUNK_SIZE && table->chunks) {
+            chunk->next = table->chunks->next;
+            table->chunks->next = chunk;
+        } else {
+            chunk->next = table->chunks;
+            table->chunks = chunk;
+        }
+    }
+
+    char* copy = chunk->data + chunk->used;
+    memcpy(copy, key, key_length);
+    copy[key_length] = '\0';
+    chunk->used += key_length + 1;
+    return copy;
+}
+
+static void ms_json_key_table_destroy(ms_json_key_table_t* table) {
+    ms_json_key_chunk_t* chunk = table->chunks;
+    while (chunk) {
+        ms_json_key_chunk_t* next = chunk->next;
+        ms_allocator_deallocate(table->allocator, chunk);
+        chunk = next;
+    }
+    if (table->slots) {
+        ms_allocator_deallocate(table->allocator, table->slots);
+    }
+    ms_allocator_deallocate(table->allocator, table);
+}
@@ -0,0 +1,54 @@
+/*
+ * @file ms_json_keys.h
+ * @brief Interned object keys shared between objects
+ */
+
+#ifndef MS_JSON_KEYS_H
+#define MS_JSON_KEYS_H
+
+#include "ms_json_types.h"
+
+/**
+ * Objects attached to a key table store each key as a pointer to the
+ * table's single copy of it, with its hash computed once, instead of a heap
+ * copy per object. Arrays of records that repeat the same keys then hold
+ * every distinct key once. Parses attach their objects to a table when
+ * intern_keys or key_table is set in ms_json_options_t.
+ *
+ * A table is reference counted: every attached object outside an arena
+ * holds a reference, so the table lives until the last of them is
+ * destroyed. Objects allocated from an arena hold none, and a table they
+ * use must outlive the arena's reset. Tables are not thread-safe; objects
+ * attached to one table must not be modified from several threads at once.
+ */
+
+/**
+ * @brief Create an empty key table
+ *
+ * @param allocator Allocator for the table and its keys (NULL for default)
+ * @return New table holding one reference for the caller, NULL on allocation failure
+ */
+ms_json_key_table_t* ms_json_key_table_create(ms_allocator_t* allocator);
+
+/**
+ * @brief Drop the caller's reference to a key table
+ *
+ * Tables allocated from an arena are freed with the arena instead.
+ */
+void ms_json_key_table_release(ms_json_key_table_t* table);
+
+/**
+ * @brief Number of distinct keys stored in a table
+ */
+size_t ms_json_key_table_count(const ms_json_key_table_t* table);
+
+/**
+ * @brief Create an object whose keys are interned into table
+ *
+ * @param allocator Allocator for the object (NULL for default)
+ * @param table Key table, NULL for an ordinary object
+ * @return New object, NULL on allocation failure
+ */
+ms_json_value_t* ms_json_create_object_interned(ms_allocator_t* allocator, ms_json_key_table_t* table);
+
+#endif /* MS_JSON_KEYS_H */
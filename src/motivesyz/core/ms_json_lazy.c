@@ -0,0 +1,421 @@
+/**
+ * @file ms_json_lazy.c
+ * @brief On-demand decoding of arrays and objects
+ *
+ * A lazy parse runs stage one of the structural engine and a single pass
+ * over the index that checks bracket nesting and records, for every opening
+ * bracket, the index entry of its closing bracket. Containers start out as
+ * stubs that remember their opening entry; the first access decodes the
+ * members one level deep and caches them in the stub, turning nested
+ * containers into further stubs that are skipped via their closing entry.
+ *
+ * Every stub holds a reference on the shared document, which is freed with
+ * the last stub, whether it was decoded or destroyed untouched. A container
+ * that is never decoded is never checked beyond its nesting, including one
+ * discarded because a later duplicate key replaced it.
+ */
+
+#include "ms_json_structural.h"
+#include "ms_json_builder.h"
+#include "ms_json_internal.h"
+#include "ms_platform.h"
+#include <string.h>
+
+/* Configuration constants */
+#define LAZY_INITIAL_DEPTH 16
+#define LAZY_KEY_INLINE_SIZE 128
+
+struct ms_json_lazy_document {
+    ms_json_parse_context_t ctx;  /* Decoding context; input is input_copy or the caller's buffer */
+    uint32_t* positions;          /* Structural index followed by its sentinel */
+    uint32_t* matching;           /* Closing entry of the container opened at each entry */
+    size_t count;                 /* Entries before the sentinel */
+    char* input_copy;             /* Private copy of the input, NULL with zero_copy */
+    size_t references;            /* Lazy containers still pointing here; atomic so
+                                     disjoint subtrees may be decoded in parallel */
+};
+
+/* What the validation pass accepts at the next index entry */
+typedef enum {
+    LAZY_VALUE = 0,
+    LAZY_KEY,
+    LAZY_AFTER_VALUE
+} ms_json_lazy_state_t;
+
+/* Forward declarations */
+static ms_json_result_t ms_json_lazy_validate(ms_json_lazy_document_t* document, int unclosed_string);
+static ms_json_result_t ms_json_lazy_check_values(const ms_json_lazy_document_t* document, size_t limit);
+static ms_json_result_t ms_json_lazy_key(const ms_json_lazy_document_t* document, size_t i, char* scratch,
+                                         char** heap_scratch, const char** key, size_t* key_length);
+static ms_json_result_t ms_json_lazy_member(ms_json_lazy_document_t* document, size_t i,
+                                            ms_json_value_t** value, size_t* next);
+static ms_json_value_t* ms_json_lazy_stub(ms_json_lazy_document_t* document, size_t entry);
+static void ms_json_lazy_unref(ms_json_lazy_document_t* document);
+
+ms_json_result_t ms_json_lazy_parse(ms_json_parse_context_t* ctx, ms_json_value_t** result) {
+    if (!ctx || !result) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    /* A scalar root has nothing to defer */
+    size_t start = 0;
+    while (start < ctx->length && (ctx->input[start] == ' ' || ctx->input[start] == '\n' ||
+                                   ctx->input[start] == '\r' || ctx->input[start] == '\t')) {
+        start++;
+    }
+    if (start == ctx->length || (ctx->input[start] != '{' && ctx->input[start] != '[')) {
+        return ms_json_structural_parse(ctx, result);
+    }
+
+    ms_allocator_t* allocator = ctx->allocator;
+    ms_json_lazy_document_t* document = NULL;
+    if (ms_allocator_allocate(allocator, sizeof(*document), (void**)&document) != MS_MEMORY_SUCCESS) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+    memset(document, 0, sizeof(*document));
+    document->ctx = *ctx;
+    document->ctx.position = 0;
+    document->ctx.depth = 0;
+    document->ctx.keys = NULL;     /* Lazy trees do not intern */
+    document->ctx.scratch = NULL;  /* A parser's buffers may not outlive this call */
+    document->references = 1;
+
+    /* Decoding outlives this call, so without zero_copy the input is kept privately */
+    if (!ctx->options.zero_copy) {
+        if (ms_allocator_allocate(allocator, ctx->length, (void**)&document->input_copy) != MS_MEMORY_SUCCESS) {
+            ms_json_lazy_unref(document);
+            return MS_JSON_ERROR_MEMORY;
+        }
+        memcpy(document->input_copy, ctx->input, ctx->length);
+        document->ctx.input = document->input_copy;
+    }
+
+    ms_json_structural_index_t index;
+    ms_json_result_t status = ms_json_structural_index_build(allocator, document->ctx.input, ctx->length, &index);
+    if (status != MS_JSON_SUCCESS) {
+        ms_json_lazy_unref(document);
+        return status;
+    }
+    document->positions = index.positions;
+    document->count = index.count;
+
+    if (ms_allocator_allocate(allocator, (index.count + 1) * sizeof(uint32_t),
+                              (void**)&document->matching) != MS_MEMORY_SUCCESS) {
+        ms_json_lazy_unref(document);
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    status = ms_json_lazy_validate(document, index.unclosed_string);
+    if (status != MS_JSON_SUCCESS) {
+        ms_json_lazy_unref(document);
+        return status;
+    }
+
+    /* The root stub takes over the initial reference */
+    ms_json_value_t* root = ms_json_lazy_stub(document, 0);
+    ms_json_lazy_unref(document);
+    if (!root) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    *result = root;
+    return MS_JSON_SUCCESS;
+}
+
+/*
+ * Grammar check over the index entries alone, filling document->matching.
+ * Scalars are only located here; their text is checked when decoded.
+ */
+static ms_json_result_t ms_json_lazy_validate(ms_json_lazy_document_t* document, int unclosed_string) {
+    const char* input = document->ctx.input;
+    const uint32_t* positions = document->positions;
+    size_t count = document->count;
+    size_t max_depth = document->ctx.options.max_depth;
+
+    uint32_t* open = NULL;  /* Opening entry of each enclosing container */
+    size_t depth = 0;
+    size_t capacity = 0;
+    ms_json_lazy_state_t state = LAZY_VALUE;
+    ms_json_result_t status = MS_JSON_SUCCESS;
+    size_t i = 0;
+
+    while (status == MS_JSON_SUCCESS) {
+        if (state == LAZY_AFTER_VALUE && depth == 0) {
+            if (i < count) {
+                status = MS_JSON_ERROR_SYNTAX;
+            }
+            break;
+        }
+
+        if (i >= count) {
+            status = MS_JSON_ERROR_EOF;
+            break;
+        }
+
+        char c = input[positions[i]];
+        if (state == LAZY_KEY) {
+            if (c != '"') {
+                status = MS_JSON_ERROR_SYNTAX;
+            } else if (unclosed_string && i + 2 == count) {
+                status = MS_JSON_ERROR_EOF;
+            } else if (i + 2 >= count || input[positions[i + 2]] != ':') {
+                status = MS_JSON_ERROR_SYNTAX;
+            } else {
+                i += 3;
+                state = LAZY_VALUE;
+            }
+        } else if (state == LAZY_AFTER_VALUE) {
+            int in_object = input[positions[open[depth - 1]]] == '{';
+            if (c == ',') {
+                i++;
+                state = in_object ? LAZY_KEY : LAZY_VALUE;
+            } else if (c == (in_object ? '}' : ']')) {
+                document->matching[open[--depth]] = (uint32_t)i;
+                i++;
+            } else {
+                status = MS_JSON_ERROR_SYNTAX;
+            }
+        } else if (c == '{' || c == '[') {
+            if (max_depth > 0 && depth >= max_depth) {
+                status = MS_JSON_ERROR_DEPTH;
+                break;
+            }
+            if (depth == capacity) {
+                size_t new_capacity = capacity ? capacity * 2 : LAZY_INITIAL_DEPTH;
+                uint32_t* new_open = NULL;
+                if (ms_allocator_reallocate(ms_allocator_default(), open, new_capacity * sizeof(uint32_t),
+                                            (void**)&new_open) != MS_MEMORY_SUCCESS) {
+                    status = MS_JSON_ERROR_MEMORY;
+                    break;
+                }
+                open = new_open;
+                capacity = new_capacity;
+            }
+            open[depth++] = (uint32_t)i;
+            i++;
+
+            /* Empty containers close immediately */
+            if (i < count && input[positions[i]] == (c == '{' ? '}' : ']')) {
+                document->matching[open[--depth]] = (uint32_t)i;
+                i++;
+                state = LAZY_AFTER_VALUE;
+            } else {
+                state = c == '{' ? LAZY_KEY : LAZY_VALUE;
+            }
+        } else if (c == ',' || c == ':' || c == ']' || c == '}') {
+            status = MS_JSON_ERROR_SYNTAX;
+        } else if (c == '"' && unclosed_string && i + 2 == count) {
+            status = MS_JSON_ERROR_EOF;
+        } else {
+            i += c == '"' ? 2 : 1;
+            state = LAZY_AFTER_VALUE;
+        }
+    }
+
+    if (open) {
+        ms_allocator_deallocate(ms_allocator_default(), open);
+    }
+
+    /* The eager engines stop at a bad scalar or string before reaching the failure found here */
+    if (status != MS_JSON_SUCCESS && status != MS_JSON_ERROR_MEMORY) {
+        ms_json_result_t earlier = ms_json_lazy_check_values(document, i < count ? i : count);
+        if (earlier != MS_JSON_SUCCESS) {
+            status = earlier;
+        }
+    }
+    return status;
+}
+
+/* First error from decoding the strings and scalars before entry limit, in document order */
+static ms_json_result_t ms_json_lazy_check_values(const ms_json_lazy_document_t* document, size_t limit) {
+    const char* input = document->ctx.input;
+    const uint32_t* positions = document->positions;
+    ms_json_result_t status = MS_JSON_SUCCESS;
+    size_t i = 0;
+
+    while (status == MS_JSON_SUCCESS && i < limit) {
+        char c = input[positions[i]];
+        if (c == '"') {
+            if (i + 1 >= document->count) {
+                break;  /* Unclosed string, already reported */
+            }
+            ms_json_value_t* value = NULL;
+            status = ms_json_structural_string(&document->ctx, positions, i, &value);
+            if (value) {
+                ms_json_destroy(value, document->ctx.allocator);
+            }
+            i += 2;
+        } else if (c == '{' || c == '[' || c == '}' || c == ']' || c == ',' || c == ':') {
+            i++;
+        } else {
+            ms_json_scalar_t scalar;
+            status = ms_json_structural_read_scalar(&document->ctx, positions, i, &scalar);
+            i++;
+        }
+    }
+    return status;
+}
+
+ms_json_result_t ms_json_lazy_materialize(ms_json_value_t* value) {
+    if (!value || !(value->flags & MS_JSON_FLAG_LAZY)) {
+        return MS_JSON_SUCCESS;
+    }
+
+    ms_json_lazy_document_t* document = value->data.lazy.document;
+    size_t entry = value->data.lazy.entry;
+    int is_object = value->type == MS_JSON_OBJECT;
+
+    /* Members are built aside so a failure leaves the stub as it was */
+    ms_json_value_t* container = is_object ? ms_json_create_object(value->allocator)
+                                           : ms_json_create_array(value->allocator);
+    if (!container) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    char key_scratch[LAZY_KEY_INLINE_SIZE];
+    char* heap_scratch = NULL;
+    ms_json_result_t status = MS_JSON_SUCCESS;
+    size_t close = document->matching[entry];
+    size_t i = entry + 1;
+
+    while (i < close) {
+        const char* key = NULL;
+        size_t key_length = 0;
+        if (is_object) {
+            status = ms_json_lazy_key(document, i, key_scratch, &heap_scratch, &key, &key_length);
+            if (status != MS_JSON_SUCCESS) {
+                break;
+            }
+            i += 3;  /* Opening quote, closing quote, colon */
+        }
+
+        ms_json_value_t* member = NULL;
+        status = ms_json_lazy_member(document, i, &member, &i);
+        if (status != MS_JSON_SUCCESS) {
+            break;
+        }
+
+        status = is_object ? ms_json_object_set_n(container, key, key_length, member)
+                           : ms_json_array_append(container, member);
+        if (status != MS_JSON_SUCCESS) {
+            ms_json_destroy(member, value->allocator);
+            break;
+        }
+
+        /* Validation guarantees a comma or the closing bracket here */
+        if (i < close) {
+            i++;
+        }
+    }
+
+    if (heap_scratch) {
+        ms_allocator_deallocate(ms_allocator_default(), heap_scratch);
+    }
+
+    if (status != MS_JSON_SUCCESS) {
+        ms_json_destroy(container, value->allocator);
+        return status;
+    }
+
+    value->data = container->data;
+    value->flags &= ~MS_JSON_FLAG_LAZY;
+    ms_allocator_deallocate(value->allocator, container);
+    ms_json_lazy_unref(document);
+    return MS_JSON_SUCCESS;
+}
+
+void ms_json_lazy_release(ms_json_value_t* value) {
+    if (!value || !(value->flags & MS_JSON_FLAG_LAZY)) {
+        return;
+    }
+
+    ms_json_lazy_unref(value->data.lazy.document);
+    value->data.lazy.document = NULL;
+    value->flags &= ~MS_JSON_FLAG_LAZY;
+}
+
+/* Key at entry i, decoded into scratch (or a heap buffer for long escaped keys) */
+static ms_json_result_t ms_json_lazy_key(const ms_json_lazy_document_t* document, size_t i, char* scratch,
+                                         char** heap_scratch, const char** key, size_t* key_length) {
+    uint32_t start = document->positions[i];
+    const char* raw = document->ctx.input + start + 1;
+    size_t raw_length = document->positions[i + 1] - start - 1;
+
+    if (raw_length > MS_JSON_MAX_STRING_LENGTH) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    if (!memchr(raw, '\\', raw_length)) {
+        *key = raw;
+        *key_length = raw_length;
+        return MS_JSON_SUCCESS;
+    }
+
+    char* output = scratch;
+    if (raw_length + 1 > LAZY_KEY_INLINE_SIZE) {
+        if (ms_allocator_reallocate(ms_allocator_default(), *heap_scratch, raw_length + 1,
+                                    (void**)heap_scratch) != MS_MEMORY_SUCCESS) {
+            return MS_JSON_ERROR_MEMORY;
+        }
+        output = *heap_scratch;
+    }
+
+    if (!ms_json_decode_string(raw, raw_length, output, key_length)) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+    *key = output;
+    return MS_JSON_SUCCESS;
+}
+
+/* Value at entry i; *next is the entry just past it */
+static ms_json_result_t ms_json_lazy_member(ms_json_lazy_document_t* document, size_t i,
+                                            ms_json_value_t** value, size_t* next) {
+    char c = document->ctx.input[document->positions[i]];
+
+    if (c == '{' || c == '[') {
+        *value = ms_json_lazy_stub(document, i);
+        *next = document->matching[i] + 1;
+        return *value ? MS_JSON_SUCCESS : MS_JSON_ERROR_MEMORY;
+    }
+
+    if (c == '"') {
+        *next = i + 2;
+        return ms_json_structural_string(&document->ctx, document->positions, i, value);
+    }
+
+    *next = i + 1;
+    return ms_json_structural_scalar(&document->ctx, document->positions, i, value);
+}
+
+/* Undecoded container opened at entry; takes a document reference */
+static ms_json_value_t* ms_json_lazy_stub(ms_json_lazy_document_t* document, size_t entry) {
+    ms_json_value_t* value = ms_json_create_null(document->ctx.allocator);
+    if (!value) {
+        return NULL;
+    }
+
+    value->type = document->ctx.input[document->positions[entry]] == '{' ? MS_JSON_OBJECT : MS_JSON_ARRAY;
+    value->flags |= MS_JSON_FLAG_LAZY;
+    value->data.lazy.document = document;
+    value->data.lazy.entry = entry;
+    MS_ATOMIC_ADD(&document->references, 1);
+    return value;
+}
+
+static void ms_json_lazy_unref(ms_json_lazy_document_t* document) {
+    if (MS_ATOMIC_SUB_ACQ_REL(&document->references, 1) > 1) {
+        return;
+    }
+
+    ms_allocator_t* allocator = document->ctx.allocator;
+    if (document->matching) {
+        ms_allocator_deallocate(allocator, document->matching);
+    }
+    if (document->positions) {
+        ms_allocator_deallocate(allocator, document->positions);
+    }
+    if (document->input_copy) {
+        ms_allocator_deallocate(allocator, document->input_copy);
+    }
+    ms_allocator_deallocate(allocator, document);
+}
@@ -0,0 +1,664 @@
+/**
+ * @file ms_json_msgpack.c
+ * @brief MessagePack encoding and decoding of JSON values
+ *
+ * The encoder writes through the serializer's context, so it shares its
+ * exactly sized buffers, caller buffers and streaming sinks. The decoder
+ * builds trees with the same builders and key tables as the JSON parser.
+ */
+
+#include "ms_json_msgpack.h"
+#include "ms_json_builder.h"
+#include "ms_json_serializer.h"
+#include "ms_json_keys.h"
+#include "ms_json_internal.h"
+#include <string.h>
+
+/* Configuration constants */
+#define MSGPACK_FIXSTR_MAX 31
+#define MSGPACK_FIXCONTAINER_MAX 15
+#define MSGPACK_HEADER_MAX 9  /* Tag byte plus a 64-bit payload */
+
+/* Format tags */
+#define MSGPACK_NIL 0xc0
+#define MSGPACK_FALSE 0xc2
+#define MSGPACK_TRUE 0xc3
+#define MSGPACK_BIN8 0xc4
+#define MSGPACK_BIN16 0xc5
+#define MSGPACK_BIN32 0xc6
+#define MSGPACK_FLOAT32 0xca
+#define MSGPACK_FLOAT64 0xcb
+#define MSGPACK_UINT8 0xcc
+#define MSGPACK_UINT16 0xcd
+#define MSGPACK_UINT32 0xce
+#define MSGPACK_UINT64 0xcf
+#define MSGPACK_INT8 0xd0
+#define MSGPACK_INT16 0xd1
+#define MSGPACK_INT32 0xd2
+#define MSGPACK_INT64 0xd3
+#define MSGPACK_STR8 0xd9
+#define MSGPACK_STR16 0xda
+#define MSGPACK_STR32 0xdb
+#define MSGPACK_ARRAY16 0xdc
+#define MSGPACK_ARRAY32 0xdd
+#define MSGPACK_MAP16 0xde
+#define MSGPACK_MAP32 0xdf
+#define MSGPACK_FIXMAP 0x80
+#define MSGPACK_FIXARRAY 0x90
+#define MSGPACK_FIXSTR 0xa0
+
+/* Decoding state */
+typedef struct {
+    const uint8_t* input;
+    size_t position;
+    size_t length;
+    ms_json_options_t options;
+    ms_allocator_t* allocator;
+    size_t depth;
+    ms_json_key_table_t* keys;
+} ms_json_msgpack_reader_t;
+
+/* Internal helper functions */
+static ms_json_result_t ms_json_msgpack_measure(const ms_json_value_t* value, size_t* size);
+static size_t ms_json_msgpack_integer_size(int64_t value);
+static size_t ms_json_msgpack_header_size(size_t count, size_t fix_max);
+static ms_json_result_t ms_json_msgpack_write(const ms_json_value_t* value, ms_json_serialize_context_t* ctx);
+static ms_json_result_t ms_json_msgpack_write_integer(int64_t value, ms_json_serialize_context_t* ctx);
+static ms_json_result_t ms_json_msgpack_write_header(uint8_t tag, uint64_t payload, size_t payload_bytes,
+                                                     ms_json_serialize_context_t* ctx);
+static ms_json_result_t ms_json_msgpack_write_length(size_t count, uint8_t fix_tag, size_t fix_max, uint8_t tag8,
+                                                     uint8_t tag16, uint8_t tag32, ms_json_serialize_context_t* ctx);
+static ms_json_result_t ms_json_msgpack_read_value(ms_json_msgpack_reader_t* reader, ms_json_value_t** result);
+static ms_json_result_t ms_json_msgpack_read_string(ms_json_msgpack_reader_t* reader, size_t length,
+                                                    ms_json_value_t** result);
+static ms_json_result_t ms_json_msgpack_read_array(ms_json_msgpack_reader_t* reader, size_t count,
+                                                   ms_json_value_t** result);
+static ms_json_result_t ms_json_msgpack_read_map(ms_json_msgpack_reader_t* reader, size_t count,
+                                                 ms_json_value_t** result);
+static ms_json_result_t ms_json_msgpack_read_uint(ms_json_msgpack_reader_t* reader, size_t bytes, uint64_t* result);
+static const uint8_t* ms_json_msgpack_take(ms_json_msgpack_reader_t* reader, size_t bytes);
+
+/* Encoding */
+ms_json_result_t ms_json_msgpack_encoded_size(const ms_json_value_t* value, size_t* result) {
+    if (!value || !result) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    *result = 0;
+    return ms_json_msgpack_measure(value, result);
+}
+
+ms_json_result_t ms_json_msgpack_encode(const ms_json_value_t* value, ms_allocator_t* allocator,
+                                        uint8_t** result, size_t* length) {
+    if (!value || !result || !length) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (!allocator) {
+        allocator = ms_allocator_default();
+    }
+
+    /* Encoded sizes are cheap to compute exactly, so one allocation always fits */
+    size_t size = 0;
+    ms_json_result_t status = ms_json_msgpack_measure(value, &size);
+    if (status != MS_JSON_SUCCESS) {
+        return status;
+    }
+
+    ms_json_serialize_context_t ctx = {
+        .allocator = allocator,
+        .buffer = NULL,
+        .position = 0,
+        .capacity = size,
+        .needs_comma = 0,
+        .write_fn = NULL,
+        .write_ctx = NULL,
+        .fixed = 1
+    };
+
+    if (ms_allocator_allocate(allocator, size, (void**)&ctx.buffer) != MS_MEMORY_SUCCESS) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    status = ms_json_msgpack_write(value, &ctx);
+    if (status != MS_JSON_SUCCESS) {
+        ms_allocator_deallocate(allocator, ctx.buffer);
+        return status;
+    }
+
+    *result = (uint8_t*)ctx.buffer;
+    *length = ctx.position;
+    return MS_JSON_SUCCESS;
+}
+
+ms_json_result_t ms_json_msgpack_encode_into(const ms_json_value_t* value, uint8_t* buffer, size_t capacity,
+                                             size_t* length) {
+    if (!value || !buffer) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    ms_json_serialize_context_t ctx = {
+        .allocator = NULL,
+        .buffer = (char*)buffer,
+        .position = 0,
+        .capacity = capacity,
+        .needs_comma = 0,
+        .write_fn = NULL,
+        .write_ctx = NULL,
+        .fixed = 1
+    };
+
+    ms_json_result_t status = ms_json_msgpack_write(value, &ctx);
+    if (status == MS_JSON_SUCCESS && length) {
+        *length = ctx.position;
+    }
+    return status;
+}
+
+ms_json_result_t ms_json_msgpack_encode_to_sink(const ms_json_value_t* value, ms_json_write_fn write_fn,
+                                                void* user_ctx, size_t buffer_size) {
+    if (!value || !write_fn) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (buffer_size == 0) {
+        buffer_size = MS_JSON_SINK_BUFFER_DEFAULT;
+    } else if (buffer_size < MS_JSON_SINK_BUFFER_MIN) {
+        buffer_size = MS_JSON_SINK_BUFFER_MIN;
+    }
+
+    ms_json_serialize_context_t ctx = {
+        .allocator = ms_allocator_default(),
+        .buffer = NULL,
+        .position = 0,
+        .capacity = buffer_size,
+        .needs_comma = 0,
+        .write_fn = write_fn,
+        .write_ctx = user_ctx
+    };
+
+    if (ms_allocator_allocate(ctx.allocator, buffer_size, (void**)&ctx.buffer) != MS_MEMORY_SUCCESS) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    ms_json_result_t status = ms_json_msgpack_write(value, &ctx);
+    if (status == MS_JSON_SUCCESS) {
+        status = ms_json_serialize_flush(&ctx);
+    }
+
+    ms_allocator_deallocate(ctx.allocator, ctx.buffer);
+    return status;
+}
+
+static ms_json_result_t ms_json_msgpack_measure(const ms_json_value_t* value, size_t* size) {
+    ms_json_result_t status = ms_json_value_resolve(value);
+    if (status != MS_JSON_SUCCESS) {
+        return status;
+    }
+
+    switch (ms_json_value_get_type(value)) {
+        case MS_JSON_NULL:
+        case MS_JSON_BOOL:
+            *size += 1;
+            return MS_JSON_SUCCESS;
+        case MS_JSON_NUMBER:
+            *size += (value->flags & MS_JSON_FLAG_INTEGER) ? ms_json_msgpack_integer_size(value->data.integer)
+                                                           : MSGPACK_HEADER_MAX;
+            return MS_JSON_SUCCESS;
+        case MS_JSON_STRING: {
+            size_t length = ms_json_value_get_string_length(value);
+            if (length > UINT32_MAX) {
+                return MS_JSON_ERROR_INVALID_ARGUMENT;
+            }
+            *size += ms_json_msgpack_header_size(length, MSGPACK_FIXSTR_MAX) + length;
+            return MS_JSON_SUCCESS;
+        }
+        case MS_JSON_ARRAY: {
+            const ms_json_array_t* array = ms_json_value_get_array_const(value);
+            if (array->count > UINT32_MAX) {
+                return MS_JSON_ERROR_INVALID_ARGUMENT;
+            }
+            *size += ms_json_msgpack_header_size(array->count, MSGPACK_FIXCONTAINER_MAX);
+            for (size_t i = 0; i < array->count; i++) {
+                status = ms_json_msgpack_measure(array->items[i], size);
+                if (status != MS_JSON_SUCCESS) {
+                    return status;
+                }
+            }
+            return MS_JSON_SUCCESS;
+        }
+        case MS_JSON_OBJECT: {
+            const ms_json_object_t* object = ms_json_value_get_object_const(value);
+            if (object->count > UINT32_MAX) {
+                return MS_JSON_ERROR_INVALID_ARGUMENT;
+            }
+            *size += ms_json_msgpack_header_size(object->count, MSGPACK_FIXCONTAINER_MAX);
+            for (size_t i = 0; i < object->count; i++) {
+                const ms_json_object_entry_t* entry = &object->entries[i];
+                if (entry->key_length > UINT32_MAX) {
+                    return MS_JSON_ERROR_INVALID_ARGUMENT;
+                }
+                *size += ms_json_msgpack_header_size(entry->key_length, MSGPACK_FIXSTR_MAX) + entry->key_length;
+                status = ms_json_msgpack_measure(entry->value, size);
+                if (status != MS_JSON_SUCCESS) {
+                    return status;
+                }
+            }
+            return MS_JSON_SUCCESS;
+        }
+        default:
+            return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+}
+
+/* Non-negative integers use the unsigned formats, as the specification recommends */
+static size_t ms_json_msgpack_integer_size(int64_t value) {
+    if (value >= -32 && value <= 127) {
+        return 1;
+    }
+    if (value >= 0) {
+        return value <= UINT8_MAX ? 2 : value <= UINT16_MAX ? 3 : value <= UINT32_MAX ? 5 : 9;
+    }
+    return value >= INT8_MIN ? 2 : value >= INT16_MIN ? 3 : value >= INT32_MIN ? 5 : 9;
+}
+
+/* Bytes of a str, array or map header; strings also have an 8-bit length form */
+static size_t ms_json_msgpack_header_size(size_t count, size_t fix_max) {
+    if (count <= fix_max) {
+        return 1;
+    }
+    if (fix_max == MSGPACK_FIXSTR_MAX && count <= UINT8_MAX) {
+        return 2;
+    }
+    return count <= UINT16_MAX ? 3 : 5;
+}
+
+static ms_json_result_t ms_json_msgpack_write(const ms_json_value_t* value, ms_json_serialize_context_t* ctx) {
+    ms_json_result_t status = ms_json_value_resolve(value);
+    if (status != MS_JSON_SUCCESS) {
+        return status;
+    }
+
+    switch (ms_json_value_get_type(value)) {
+        case MS_JSON_NULL:
+            return ms_json_msgpack_write_header(MSGPACK_NIL, 0, 0, ctx);
+        case MS_JSON_BOOL:
+            return ms_json_msgpack_write_header(ms_json_value_get_bool(value) ? MSGPACK_TRUE : MSGPACK_FALSE, 0, 0,
+                                                ctx);
+        case MS_JSON_NUMBER: {
+            if (value->flags & MS_JSON_FLAG_INTEGER) {
+                return ms_json_msgpack_write_integer(value->data.integer, ctx);
+            }
+            double number = ms_json_value_get_number(value);
+            uint64_t bits = 0;
+            memcpy(&bits, &number, sizeof(bits));
+            return ms_json_msgpack_write_header(MSGPACK_FLOAT64, bits, 8, ctx);
+        }
+        case MS_JSON_STRING: {
+            size_t length = ms_json_value_get_string_length(value);
+            status = ms_json_msgpack_write_length(length, MSGPACK_FIXSTR, MSGPACK_FIXSTR_MAX, MSGPACK_STR8,
+                                                  MSGPACK_STR16, MSGPACK_STR32, ctx);
+            if (status != MS_JSON_SUCCESS) {
+                return status;
+            }
+            return ms_json_serialize_append(ctx, ms_json_value_get_string(value), length);
+        }
+        case MS_JSON_ARRAY: {
+            const ms_json_array_t* array = ms_json_value_get_array_const(value);
+            status = ms_json_msgpack_write_length(array->count, MSGPACK_FIXARRAY, MSGPACK_FIXCONTAINER_MAX, 0,
+                                                  MSGPACK_ARRAY16, MSGPACK_ARRAY32, ctx);
+            for (size_t i = 0; i < array->count && status == MS_JSON_SUCCESS; i++) {
+                status = ms_json_msgpack_write(array->items[i], ctx);
+            }
+            return status;
+        }
+        case MS_JSON_OBJECT: {
+            const ms_json_object_t* object = ms_json_value_get_object_const(value);
+            status = ms_json_msgpack_write_length(object->count, MSGPACK_FIXMAP, MSGPACK_FIXCONTAINER_MAX, 0,
+                                                  MSGPACK_MAP16, MSGPACK_MAP32, ctx);
+            for (size_t i = 0; i < object->count && status == MS_JSON_SUCCESS; i++) {
+                const ms_json_object_entry_t* entry = &object->entries[i];
+                status = ms_json_msgpack_write_length(entry->key_length, MSGPACK_FIXSTR, MSGPACK_FIXSTR_MAX,
+                                                      MSGPACK_STR8, MSGPACK_STR16, MSGPACK_STR32, ctx);
+                if (status == MS_JSON_SUCCESS) {
+                    status = ms_json_serialize_append(ctx, entry->key, entry->key_length);
+                }
+                if (status == MS_JSON_SUCCESS) {
+                    status = ms_json_msgpack_write(entry->value, ctx);
+                }
+            }
+            return status;
+        }
+        default:
+            return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+}
+
+static ms_json_result_t ms_json_msgpack_write_integer(int64_t value, ms_json_serialize_context_t* ctx) {
+    if (value >= -32 && value <= 127) {
+        return ms_json_msgpack_write_header((uint8_t)value, 0, 0, ctx); /* Positive or negative fixint */
+    }
+
+    uint64_t bits = (uint64_t)value;
+    switch (ms_json_msgpack_integer_size(value)) {
+        case 2: return ms_json_msgpack_write_header(value >= 0 ? MSGPACK_UINT8 : MSGPACK_INT8, bits, 1, ctx);
+        case 3: return ms_json_msgpack_write_header(value >= 0 ? MSGPACK_UINT16 : MSGPACK_INT16, bits, 2, ctx);
+        case 5: return ms_json_msgpack_write_header(value >= 0 ? MSGPACK_UINT32 : MSGPACK_INT32, bits, 4, ctx);
+        default: return ms_json_msgpack_write_header(value >= 0 ? MSGPACK_UINT64 : MSGPACK_INT64, bits, 8, ctx);
+    }
+}
+
+/* Tag byte followed by the low payload_bytes of payload, big-endian */
+static ms_json_result_t ms_json_msgpack_write_header(uint8_t tag, uint64_t payload, size_t payload_bytes,
+                                                     ms_json_serialize_context_t* ctx) {
+    char header[MSGPACK_HEADER_MAX];
+    header[0] = (char)tag;
+    for (size_t i = 0; i < payload_bytes; i++) {
+        header[payload_bytes - i] = (char)(payload >> (8 * i));
+    }
+    return ms_json_serialize_append(ctx, header, payload_bytes + 1);
+}
+
+/* Header of a str, array or map; tag8 is 0 for formats without an 8-bit length */
+static ms_json_result_t ms_json_msgpack_write_length(size_t count, uint8_t fix_tag, size_t fix_max, uint8_t tag8,
+                                                     uint8_t tag16, uint8_t tag32, ms_json_serialize_context_t* ctx) {
+    if (count <= fix_max) {
+        return ms_json_msgpack_write_header((uint8_t)(fix_tag | count), 0, 0, ctx);
+    }
+    if (tag8 && count <= UINT8_MAX) {
+        return ms_json_msgpack_write_header(tag8, count, 1, ctx);
+    }
+    if (count <= UINT16_MAX) {
+        return ms_json_msgpack_write_header(tag16, count, 2, ctx);
+    }
+    if (count <= UINT32_MAX) {
+        return ms_json_msgpack_write_header(tag32, count, 4, ctx);
+    }
+    return MS_JSON_ERROR_INVALID_ARGUMENT;
+}
+
+/* Decoding */
+ms_json_result_t ms_json_msgpack_decode(const uint8_t* input, size_t length, const ms_json_options_t* options,
+                                        ms_json_value_t** result) {
+    if ((!input && length > 0) || !result) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    ms_json_msgpack_reader_t reader;
+    reader.input = input;
+    reader.position = 0;
+    reader.length = length;
+    reader.depth = 0;
+    if (options) {
+        reader.options = *options;
+    } else {
+        reader.options = (ms_json_options_t){0};
+        reader.options.max_depth = MS_JSON_MAX_DEPTH_DEFAULT;
+    }
+    reader.allocator = reader.options.allocator ? reader.options.allocator : ms_allocator_default();
+
+    ms_json_result_t status = ms_json_key_table_acquire(&reader.options, reader.allocator, &reader.keys);
+    if (status != MS_JSON_SUCCESS) {
+        return status;
+    }
+
+    *result = NULL;
+    status = ms_json_msgpack_read_value(&reader, result);
+    if (status == MS_JSON_SUCCESS && reader.position < reader.length) {
+        ms_json_destroy(*result, reader.allocator);
+        *result = NULL;
+        status = MS_JSON_ERROR_SYNTAX;
+    }
+
+    ms_json_key_table_release(reader.keys);
+    return status;
+}
+
+static ms_json_result_t ms_json_msgpack_read_value(ms_json_msgpack_reader_t* reader, ms_json_value_t** result) {
+    const uint8_t* tag_byte = ms_json_msgpack_take(reader, 1);
+    if (!tag_byte) {
+        return MS_JSON_ERROR_EOF;
+    }
+
+    uint8_t tag = *tag_byte;
+    uint64_t payload = 0;
+    ms_json_result_t status = MS_JSON_SUCCESS;
+
+    /* Formats carrying their value or length in the tag byte */
+    if (tag <= 0x7f || tag >= 0xe0) {
+        *result = ms_json_create_integer(reader->allocator, (int8_t)tag);
+        return *result ? MS_JSON_SUCCESS : MS_JSON_ERROR_MEMORY;
+    }
+    if ((tag & 0xe0) == MSGPACK_FIXSTR) {
+        return ms_json_msgpack_read_string(reader, tag & 0x1f, result);
+    }
+    if ((tag & 0xf0) == MSGPACK_FIXARRAY) {
+        return ms_json_msgpack_read_array(reader, tag & 0x0f, result);
+    }
+    if ((tag & 0xf0) == MSGPACK_FIXMAP) {
+        return ms_json_msgpack_read_map(reader, tag & 0x0f, result);
+    }
+
+    switch (tag) {
+        case MSGPACK_NIL:
+            *result = ms_json_create_null(reader->allocator);
+            break;
+        case MSGPACK_FALSE:
+        case MSGPACK_TRUE:
+            *result = ms_json_create_bool(reader->allocator, tag == MSGPACK_TRUE);
+            break;
+        case MSGPACK_BIN8:
+        case MSGPACK_STR8:
+        case MSGPACK_BIN16:
+        case MSGPACK_STR16:
+        case MSGPACK_BIN32:
+        case MSGPACK_STR32: {
+            size_t bytes = (tag == MSGPACK_BIN8 || tag == MSGPACK_STR8) ? 1
+                         : (tag == MSGPACK_BIN16 || tag == MSGPACK_STR16) ? 2 : 4;
+            status = ms_json_msgpack_read_uint(reader, bytes, &payload);
+            return status == MS_JSON_SUCCESS ? ms_json_msgpack_read_string(reader, (size_t)payload, result) : status;
+        }
+        case MSGPACK_ARRAY16:
+        case MSGPACK_ARRAY32:
+            status = ms_json_msgpack_read_uint(reader, tag == MSGPACK_ARRAY16 ? 2 : 4, &payload);
+            return status == MS_JSON_SUCCESS ? ms_json_msgpack_read_array(reader, (size_t)payload, result) : status;
+        case MSGPACK_MAP16:
+        case MSGPACK_MAP32:
+            status = ms_json_msgpack_read_uint(reader, tag == MSGPACK_MAP16 ? 2 : 4, &payload);
+            return status == MS_JSON_SUCCESS ? ms_json_msgpack_read_map(reader, (size_t)payload, result) : status;
+        case MSGPACK_FLOAT32: {
+            status = ms_json_msgpack_read_uint(reader, 4, &payload);
+            if (status != MS_JSON_SUCCESS) {
+                return status;
+            }
+            uint32_t bits = (uint32_t)payload;
+            float number = 0;
+            memcpy(&number, &bits, sizeof(number));
+            *result = ms_json_create_number(reader->allocator, number);
+            break;
+        }
+        case MSGPACK_FLOAT64: {
+            status = ms_json_msgpack_read_uint(reader, 8, &payload);
+            if (status != MS_JSON_SUCCESS) {
+                return status;
+            }
+            double number = 0;
+            memcpy(&number, &payload, sizeof(number));
+            *result = ms_json_create_number(reader->allocator, number);
+            break;
+        }
+        case MSGPACK_UINT8:
+        case MSGPACK_UINT16:
+        case MSGPACK_UINT32:
+        case MSGPACK_UINT64:
+            status = ms_json_msgpack_read_uint(reader, (size_t)1 << (tag - MSGPACK_UINT8), &payload);
+            if (status != MS_JSON_SUCCESS) {
+                return status;
+            }
+            *result = payload <= INT64_MAX ? ms_json_create_integer(reader->allocator, (int64_t)payload)
+                                           : ms_json_create_number(reader->allocator, (double)payload);
+            break;
+        case MSGPACK_INT8:
+        case MSGPACK_INT16:
+        case MSGPACK_INT32:
+        case MSGPACK_INT64: {
+            size_t bytes = (size_t)1 << (tag - MSGPACK_INT8);
+            status = ms_json_msgpack_read_uint(reader, bytes, &payload);
+            if (status != MS_JSON_SUCCESS) {
+                return status;
+            }
+            /* Sign-extend from the stored width */
+            uint64_t sign = UINT64_C(1) << (8 * bytes - 1);
+            int64_t integer = bytes == 8 ? (int64_t)payload : (int64_t)(payload ^ sign) - (int64_t)sign;
+            *result = ms_json_create_integer(reader->allocator, integer);
+            break;
+        }
+        default:
+            return MS_JSON_ERROR_SYNTAX; /* Extension types and the reserved 0xc1 */
+    }
+
+    return *result ? MS_JSON_SUCCESS : MS_JSON_ERROR_MEMORY;
+}
+
+static ms_json_result_t ms_json_msgpack_read_string(ms_json_msgpack_reader_t* reader, size_t length,
+                                                    ms_json_value_t** result) {
+    if (length > MS_JSON_MAX_STRING_LENGTH) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    const char* chars = (const char*)ms_json_msgpack_take(reader, length);
+    if (!chars) {
+        return MS_JSON_ERROR_EOF;
+    }
+
+    *result = reader->options.zero_copy ? ms_json_create_string_borrowed(reader->allocator, chars, length)
+                                        : ms_json_create_string_n(reader->allocator, chars, length);
+    return *result ? MS_JSON_SUCCESS : MS_JSON_ERROR_MEMORY;
+}
+
+static ms_json_result_t ms_json_msgpack_read_array(ms_json_msgpack_reader_t* reader, size_t count,
+                                                   ms_json_value_t** result) {
+    if (reader->options.max_depth > 0 && reader->depth >= reader->options.max_depth) {
+        return MS_JSON_ERROR_DEPTH;
+    }
+
+    /* Every element takes at least one byte, which bounds a forged count before it is reserved */
+    if (count > reader->length - reader->position) {
+        return MS_JSON_ERROR_EOF;
+    }
+
+    ms_json_value_t* array = ms_json_create_array(reader->allocator);
+    if (!array || ms_json_array_reserve(array, count) != MS_JSON_SUCCESS) {
+        ms_json_destroy(array, reader->allocator);
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    reader->depth++;
+    ms_json_result_t status = MS_JSON_SUCCESS;
+    for (size_t i = 0; i < count && status == MS_JSON_SUCCESS; i++) {
+        ms_json_value_t* element = NULL;
+        status = ms_json_msgpack_read_value(reader, &element);
+        if (status == MS_JSON_SUCCESS) {
+            status = ms_json_array_append(array, element);
+            if (status != MS_JSON_SUCCESS) {
+                ms_json_destroy(element, reader->allocator);
+            }
+        }
+    }
+    reader->depth--;
+
+    if (status != MS_JSON_SUCCESS) {
+        ms_json_destroy(array, reader->allocator);
+        return status;
+    }
+
+    *result = array;
+    return MS_JSON_SUCCESS;
+}
+
+static ms_json_result_t ms_json_msgpack_read_map(ms_json_msgpack_reader_t* reader, size_t count,
+                                                 ms_json_value_t** result) {
+    if (reader->options.max_depth > 0 && reader->depth >= reader->options.max_depth) {
+        return MS_JSON_ERROR_DEPTH;
+    }
+
+    /* Every member takes at least two bytes */
+    if (count > (reader->length - reader->position) / 2) {
+        return MS_JSON_ERROR_EOF;
+    }
+
+    ms_json_value_t* object = ms_json_create_object_interned(reader->allocator, reader->keys);
+    if (!object || ms_json_object_reserve(object, count) != MS_JSON_SUCCESS) {
+        ms_json_destroy(object, reader->allocator);
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    reader->depth++;
+    ms_json_result_t status = MS_JSON_SUCCESS;
+    for (size_t i = 0; i < count && status == MS_JSON_SUCCESS; i++) {
+        /* Keys must be str; their bytes are copied or interned by the object */
+        const uint8_t* tag_byte = ms_json_msgpack_take(reader, 1);
+        uint64_t key_length = 0;
+        if (!tag_byte) {
+            status = MS_JSON_ERROR_EOF;
+        } else if ((*tag_byte & 0xe0) == MSGPACK_FIXSTR) {
+            key_length = *tag_byte & 0x1f;
+        } else if (*tag_byte == MSGPACK_STR8 || *tag_byte == MSGPACK_STR16 || *tag_byte == MSGPACK_STR32) {
+            status = ms_json_msgpack_read_uint(reader, (size_t)1 << (*tag_byte - MSGPACK_STR8), &key_length);
+        } else {
+            status = MS_JSON_ERROR_SYNTAX;
+        }
+
+        const char* key = NULL;
+        if (status == MS_JSON_SUCCESS) {
+            key = (const char*)ms_json_msgpack_take(reader, (size_t)key_length);
+            status = key ? MS_JSON_SUCCESS : MS_JSON_ERROR_EOF;
+        }
+
+        ms_json_value_t* value = NULL;
+        if (status == MS_JSON_SUCCESS) {
+            status = ms_json_msgpack_read_value(reader, &value);
+        }
+        if (status == MS_JSON_SUCCESS) {
+            status = ms_json_object_set_n(object, key, (size_t)key_length, value);
+            if (status != MS_JSON_SUCCESS) {
+                ms_json_destroy(value, reader->allocator);
+            }
+        }
+    }
+    reader->depth--;
+
+    if (status != MS_JSON_SUCCESS) {
+        ms_json_destroy(object, reader->allocator);
+        return status;
+    }
+
+    *result = object;
+    return MS_JSON_SUCCESS;
+}
+
+/* Big-endian unsigned integer of 1, 2, 4 or 8 bytes */
+static ms_json_result_t ms_json_msgpack_read_uint(ms_json_msgpack_reader_t* reader, size_t bytes, uint64_t* result) {
+    const uint8_t* data = ms_json_msgpack_take(reader, bytes);
+    if (!data) {
+        return MS_JSON_ERROR_EOF;
+    }
+
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value = (value << 8) | data[i];
+    }
+    *result = value;
+    return MS_JSON_SUCCESS;
+}
+
+/* Next bytes of input, NULL if fewer remain */
+static const uint8_t* ms_json_msgpack_take(ms_json_msgpack_reader_t* reader, size_t bytes) {
+    if (bytes > reader->length - reader->position) {
+        return NULL;
+    }
+
+    const uint8_t* data = reader->input + reader->position;
+    reader->position += bytes;
+    return data;
+}
@@ -0,0 +1,88 @@
+/*
+ * @file ms_json_msgpack.h
+ * @brief MessagePack encoding and decoding of JSON values
+ */
+
+#ifndef MS_JSON_MSGPACK_H
+#define MS_JSON_MSGPACK_H
+
+#include "ms_json_types.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Values map one to one onto MessagePack: integers keep their exact value
+ * in the smallest integer format, doubles are stored as float64, and
+ * strings and containers are length-prefixed. Decoding therefore needs no
+ * escape processing, number parsing or whitespace skipping, and a decoded
+ * tree is the same as the tree that was encoded.
+ */
+
+/**
+ * @brief Exact length of the MessagePack encoding of a value
+ *
+ * @param value Value to measure; lazy containers are decoded
+ * @param result Output parameter for the length in bytes
+ * @return MS_JSON_SUCCESS, or MS_JSON_ERROR_INVALID_ARGUMENT if a string or
+ *         container is too long for MessagePack (4 GB or 2^32 members)
+ */
+ms_json_result_t ms_json_msgpack_encoded_size(const ms_json_value_t* value, size_t* result);
+
+/**
+ * @brief Encode a value into one newly allocated buffer
+ *
+ * @param value Value to encode
+ * @param allocator Allocator for the result, NULL for default
+ * @param result Output parameter for the encoding, freed with ms_allocator_deallocate()
+ * @param length Output parameter for the encoding length
+ */
+ms_json_result_t ms_json_msgpack_encode(const ms_json_value_t* value, ms_allocator_t* allocator,
+                                        uint8_t** result, size_t* length);
+
+/**
+ * @brief Encode into a caller-provided buffer
+ *
+ * @param value Value to encode
+ * @param buffer Output buffer
+ * @param capacity Size of buffer, at least ms_json_msgpack_encoded_size()
+ * @param length Output parameter for the encoding length, NULL if not needed
+ *
+ * @return MS_JSON_SUCCESS on success, MS_JSON_ERROR_MEMORY if the encoding
+ *         does not fit, in which case the buffer contents are unspecified
+ */
+ms_json_result_t ms_json_msgpack_encode_into(const ms_json_value_t* value, uint8_t* buffer, size_t capacity,
+                                             size_t* length);
+
+/**
+ * @brief Encode through a fixed-size buffer flushed to a callback
+ *
+ * Same buffering as ms_json_serialize_to_sink(); write_fn receives binary
+ * data, not text.
+ *
+ * @param buffer_size Buffer size in bytes, 0 for the serializer's default
+ */
+ms_json_result_t ms_json_msgpack_encode_to_sink(const ms_json_value_t* value, ms_json_write_fn write_fn,
+                                                void* user_ctx, size_t buffer_size);
+
+/**
+ * @brief Decode one MessagePack value into a tree
+ *
+ * Accepts nil, booleans, every integer and float format, str and bin
+ * (both become strings), arrays, and maps with str keys. Integers beyond
+ * the int64 range become doubles. Extension types have no JSON
+ * counterpart and are rejected.
+ *
+ * @param input Encoded bytes
+ * @param length Length of input; the value must fill it exactly
+ * @param options Parsing options, NULL for defaults; allocator, max_depth,
+ *        intern_keys and key_table apply, and zero_copy makes strings
+ *        borrow from input
+ * @param result Output parameter for the root value
+ * @return MS_JSON_SUCCESS, MS_JSON_ERROR_EOF if input ends inside a value,
+ *         MS_JSON_ERROR_SYNTAX for unsupported formats, non-string map keys
+ *         or trailing bytes, MS_JSON_ERROR_DEPTH, or MS_JSON_ERROR_MEMORY
+ */
+ms_json_result_t ms_json_msgpack_decode(const uint8_t* input, size_t length, const ms_json_options_t* options,
+                                        ms_json_value_t** result);
+
+#endif /* MS_JSON_MSGPACK_H */
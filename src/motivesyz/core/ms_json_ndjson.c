@@ -0,0 +1,372 @@
+/**
+ * @file ms_json_ndjson.c
+ * @brief Newline-delimited JSON parsed on a worker group
+ *
+ * The input is cut into batches of lines as workers ask for them. A fixed
+ * ring of slots bounds the batches in flight; each slot owns an arena that
+ * backs every document of its batch and is reset once the batch has been
+ * delivered, so documents never touch a shared allocator. The calling
+ * thread only delivers, unless no worker could be started, in which case
+ * it parses the batches itself.
+ */
+
+#include "ms_json_ndjson.h"
+#include "ms_json_parser.h"
+#include "ms_json_keys.h"
+#include "ms_json_internal.h"
+#include "ms_thread.h"
+#include <pthread.h>
+#include <string.h>
+
+/* Configuration constants */
+#define NDJSON_DEFAULT_BATCH_SIZE 256      /* Lines per work item */
+#define NDJSON_SLOTS_PER_THREAD 2          /* Batches in flight per worker */
+#define NDJSON_ARENA_CHUNK_SIZE (64 * 1024)
+
+typedef enum {
+    SLOT_FREE = 0,   /* Available for the next batch */
+    SLOT_PARSING,    /* Owned by the thread parsing it */
+    SLOT_READY       /* Parsed, waiting for delivery */
+} ms_json_ndjson_slot_state_t;
+
+typedef struct {
+    ms_allocator_t* arena;         /* Backs every document of the batch */
+    ms_json_value_t** values;      /* Documents in line order */
+    size_t* lines;                 /* Line number of each document */
+    size_t count;                  /* Documents parsed */
+    size_t batch;                  /* Sequence number of the batch held */
+    const char* start;             /* First byte of the batch */
+    const char* end;               /* One past the last byte */
+    size_t first_line;             /* Line number at start */
+    ms_json_result_t status;       /* First parse failure in the batch */
+    size_t error_line;
+    ms_json_ndjson_slot_state_t state;
+} ms_json_ndjson_slot_t;
+
+typedef struct {
+    const char* input;
+    size_t length;
+    size_t cursor;                 /* Offset of the next unclaimed line */
+    size_t next_line;              /* Line number at cursor */
+    size_t next_batch;             /* Sequence number of the next claim */
+    size_t next_delivery;          /* Batch the ordered reader delivers next */
+    size_t batch_size;
+    int unordered;
+    ms_json_options_t parse_options;
+
+    ms_json_ndjson_slot_t* slots;
+    size_t slot_count;
+    size_t parsing;                /* Slots in SLOT_PARSING */
+    int stop;                      /* Delivery failed; claim nothing more */
+
+    pthread_mutex_t lock;
+    pthread_cond_t slot_ready;     /* Signalled by workers */
+    pthread_cond_t slot_free;      /* Signalled by the delivering thread */
+} ms_json_ndjson_reader_t;
+
+/* Forward declarations */
+static ms_json_result_t ms_json_ndjson_reader_init(ms_json_ndjson_reader_t* reader, const char* input,
+                                                   size_t length, const ms_json_ndjson_options_t* options,
+                                                   size_t slot_count);
+static void ms_json_ndjson_reader_release(ms_json_ndjson_reader_t* reader);
+static ms_json_ndjson_slot_t* ms_json_ndjson_claim(ms_json_ndjson_reader_t* reader);
+static ms_json_ndjson_slot_t* ms_json_ndjson_find_ready(ms_json_ndjson_reader_t* reader);
+static void ms_json_ndjson_parse_batch(ms_json_ndjson_reader_t* reader, ms_json_ndjson_slot_t* slot);
+static ms_json_result_t ms_json_ndjson_deliver(ms_json_ndjson_slot_t* slot, ms_json_ndjson_callback_t callback,
+                                               void* user_ctx, size_t* error_line);
+static void ms_json_ndjson_worker(void* arg, size_t worker);
+
+ms_json_result_t ms_json_parse_ndjson(const char* input, size_t length, const ms_json_ndjson_options_t* options,
+                                      ms_json_ndjson_callback_t callback, void* user_ctx, size_t* error_line) {
+    if ((!input && length > 0) || !callback) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (error_line) {
+        *error_line = 0;
+    }
+
+    ms_json_ndjson_options_t reader_options = {0};
+    if (options) {
+        reader_options = *options;
+    } else {
+        reader_options.parse.max_depth = MS_JSON_MAX_DEPTH_DEFAULT;
+    }
+
+    size_t threads = reader_options.threads ? reader_options.threads : ms_thread_cpu_count();
+    size_t slot_count = threads * NDJSON_SLOTS_PER_THREAD;
+
+    ms_json_ndjson_reader_t reader;
+    ms_json_result_t result = ms_json_ndjson_reader_init(&reader, input, length, &reader_options, slot_count);
+    if (result != MS_JSON_SUCCESS) {
+        return result;
+    }
+
+    size_t workers = 0;
+    ms_thread_group_t* group = NULL;
+    if (threads > 1) {
+        group = ms_thread_group_start(threads, ms_json_ndjson_worker, &reader, &workers);
+    }
+
+    pthread_mutex_lock(&reader.lock);
+    for (;;) {
+        ms_json_ndjson_slot_t* slot = reader.stop ? NULL : ms_json_ndjson_find_ready(&reader);
+        if (slot) {
+            pthread_mutex_unlock(&reader.lock);
+            result = ms_json_ndjson_deliver(slot, callback, user_ctx, error_line);
+            ms_allocator_reset(slot->arena);
+            pthread_mutex_lock(&reader.lock);
+
+            slot->state = SLOT_FREE;
+            reader.next_delivery++;
+            if (result != MS_JSON_SUCCESS) {
+                reader.stop = 1;
+            }
+            pthread_cond_broadcast(&reader.slot_free);
+            continue;
+        }
+
+        /* Finished once nothing is left to claim, parse or deliver */
+        if ((reader.stop || reader.cursor >= reader.length) && reader.parsing == 0) {
+            break;
+        }
+
+        if (workers == 0) {
+            slot = ms_json_ndjson_claim(&reader);
+            pthread_mutex_unlock(&reader.lock);
+            if (slot) {
+                ms_json_ndjson_parse_batch(&reader, slot);
+            }
+            pthread_mutex_lock(&reader.lock);
+            if (slot) {
+                slot->state = SLOT_READY;
+                reader.parsing--;
+            }
+            continue;
+        }
+
+        pthread_cond_wait(&reader.slot_ready, &reader.lock);
+    }
+
+    /* Wake workers waiting for a slot so they see there is nothing left */
+    reader.stop = 1;
+    pthread_cond_broadcast(&reader.slot_free);
+    pthread_mutex_unlock(&reader.lock);
+
+    ms_thread_group_join(group);
+    ms_json_ndjson_reader_release(&reader);
+    return result;
+}
+
+static ms_json_result_t ms_json_ndjson_reader_init(ms_json_ndjson_reader_t* reader, const char* input,
+                                                   size_t length, const ms_json_ndjson_options_t* options,
+                                                   size_t slot_count) {
+    memset(reader, 0, sizeof(*reader));
+    reader->input = input;
+    reader->length = length;
+    reader->next_line = 1;
+    reader->batch_size = options->batch_size ? options->batch_size : NDJSON_DEFAULT_BATCH_SIZE;
+    reader->unordered = options->unordered;
+    reader->parse_options = options->parse;
+
+    pthread_mutex_init(&reader->lock, NULL);
+    pthread_cond_init(&reader->slot_ready, NULL);
+    pthread_cond_init(&reader->slot_free, NULL);
+
+    if (ms_allocator_allocate(ms_allocator_default(), slot_count * sizeof(*reader->slots),
+                              (void**)&reader->slots) != MS_MEMORY_SUCCESS) {
+        ms_json_ndjson_reader_release(reader);
+        return MS_JSON_ERROR_MEMORY;
+    }
+    memset(reader->slots, 0, slot_count * sizeof(*reader->slots));
+    reader->slot_count = slot_count;
+
+    for (size_t i = 0; i < slot_count; i++) {
+        ms_json_ndjson_slot_t* slot = &reader->slots[i];
+        slot->arena = ms_allocator_create_arena(NDJSON_ARENA_CHUNK_SIZE);
+        if (!slot->arena ||
+            ms_allocator_allocate(ms_allocator_default(), reader->batch_size * sizeof(*slot->values),
+                                  (void**)&slot->values) != MS_MEMORY_SUCCESS ||
+            ms_allocator_allocate(ms_allocator_default(), reader->batch_size * sizeof(*slot->lines),
+                                  (void**)&slot->lines) != MS_MEMORY_SUCCESS) {
+            ms_json_ndjson_reader_release(reader);
+            return MS_JSON_ERROR_MEMORY;
+        }
+    }
+
+    return MS_JSON_SUCCESS;
+}
+
+static void ms_json_ndjson_reader_release(ms_json_ndjson_reader_t* reader) {
+    if (reader->slots) {
+        for (size_t i = 0; i < reader->slot_count; i++) {
+            ms_json_ndjson_slot_t* slot = &reader->slots[i];
+            ms_allocator_destroy(slot->arena);
+            if (slot->values) {
+                ms_allocator_deallocate(ms_allocator_default(), slot->values);
+            }
+            if (slot->lines) {
+                ms_allocator_deallocate(ms_allocator_default(), slot->lines);
+            }
+        }
+        ms_allocator_deallocate(ms_allocator_default(), reader->slots);
+        reader->slots = NULL;
+    }
+
+    pthread_mutex_destroy(&reader->lock);
+    pthread_cond_destroy(&reader->slot_ready);
+    pthread_cond_destroy(&reader->slot_free);
+}
+
+/*
+ * Cut the next batch off the input into a free slot, called with the lock
+ * held. Ordered readers fill slots round-robin so batch n always lands in
+ * slot n % slot_count; unordered readers take any free slot.
+ */
+static ms_json_ndjson_slot_t* ms_json_ndjson_claim(ms_json_ndjson_reader_t* reader) {
+    if (reader->stop || reader->cursor >= reader->length) {
+        return NULL;
+    }
+
+    ms_json_ndjson_slot_t* slot = NULL;
+    if (reader->unordered) {
+        for (size_t i = 0; i < reader->slot_count && !slot; i++) {
+            if (reader->slots[i].state == SLOT_FREE) {
+                slot = &reader->slots[i];
+            }
+        }
+    } else {
+        slot = &reader->slots[reader->next_batch % reader->slot_count];
+        if (slot->state != SLOT_FREE) {
+            slot = NULL;
+        }
+    }
+    if (!slot) {
+        return NULL;
+    }
+
+    const char* start = reader->input + reader->cursor;
+    const char* end = reader->input + reader->length;
+    const char* position = start;
+    size_t lines = 0;
+    while (position < end && lines < reader->batch_size) {
+        const char* newline = memchr(position, '\n', (size_t)(end - position));
+        position = newline ? newline + 1 : end;
+        lines++;
+    }
+
+    slot->start = start;
+    slot->end = position;
+    slot->first_line = reader->next_line;
+    slot->batch = reader->next_batch++;
+    slot->count = 0;
+    slot->status = MS_JSON_SUCCESS;
+    slot->error_line = 0;
+    slot->state = SLOT_PARSING;
+
+    reader->cursor = (size_t)(position - reader->input);
+    reader->next_line += lines;
+    reader->parsing++;
+    return slot;
+}
+
+/* Slot the reader may deliver now, called with the lock held */
+static ms_json_ndjson_slot_t* ms_json_ndjson_find_ready(ms_json_ndjson_reader_t* reader) {
+    if (!reader->unordered) {
+        ms_json_ndjson_slot_t* slot = &reader->slots[reader->next_delivery % reader->slot_count];
+        return slot->state == SLOT_READY && slot->batch == reader->next_delivery ? slot : NULL;
+    }
+
+    for (size_t i = 0; i < reader->slot_count; i++) {
+        if (reader->slots[i].state == SLOT_READY) {
+            return &reader->slots[i];
+        }
+    }
+    return NULL;
+}
+
+/* Parse every line of the batch into the slot's arena, stopping at the first error */
+static void ms_json_ndjson_parse_batch(ms_json_ndjson_reader_t* reader, ms_json_ndjson_slot_t* slot) {
+    ms_json_options_t options = reader->parse_options;
+    options.allocator = slot->arena;
+
+    /* A caller's table cannot be shared between workers; the arena reset frees this one */
+    if (options.intern_keys || options.key_table) {
+        options.key_table = ms_json_key_table_create(slot->arena);
+        if (!options.key_table) {
+            slot->status = MS_JSON_ERROR_MEMORY;
+            slot->error_line = slot->first_line;
+            return;
+        }
+    }
+
+    const char* position = slot->start;
+    size_t line = slot->first_line;
+    while (position < slot->end) {
+        const char* newline = memchr(position, '\n', (size_t)(slot->end - position));
+        const char* line_end = newline ? newline : slot->end;
+
+        const char* first = position;
+        while (first < line_end && (*first == ' ' || *first == '\t' || *first == '\r')) {
+            first++;
+        }
+
+        if (first < line_end) {
+            ms_json_value_t* value = NULL;
+            ms_json_result_t result = ms_json_parse_buffer(position, (size_t)(line_end - position), &options,
+                                                           &value);
+            if (result != MS_JSON_SUCCESS) {
+                slot->status = result;
+                slot->error_line = line;
+                return;
+            }
+            slot->values[slot->count] = value;
+            slot->lines[slot->count] = line;
+            slot->count++;
+        }
+
+        position = line_end + 1;
+        line++;
+    }
+}
+
+static ms_json_result_t ms_json_ndjson_deliver(ms_json_ndjson_slot_t* slot, ms_json_ndjson_callback_t callback,
+                                               void* user_ctx, size_t* error_line) {
+    for (size_t i = 0; i < slot->count; i++) {
+        ms_json_result_t result = callback(user_ctx, slot->lines[i], slot->values[i]);
+        if (result != MS_JSON_SUCCESS) {
+            return result;
+        }
+    }
+
+    if (slot->status != MS_JSON_SUCCESS && error_line) {
+        *error_line = slot->error_line;
+    }
+    return slot->status;
+}
+
+static void ms_json_ndjson_worker(void* arg, size_t worker) {
+    ms_json_ndjson_reader_t* reader = arg;
+    (void)worker;
+
+    pthread_mutex_lock(&reader->lock);
+    for (;;) {
+        ms_json_ndjson_slot_t* slot = ms_json_ndjson_claim(reader);
+        if (!slot) {
+            if (reader->stop || reader->cursor >= reader->length) {
+                break;
+            }
+            pthread_cond_wait(&reader->slot_free, &reader->lock);
+            continue;
+        }
+
+        pthread_mutex_unlock(&reader->lock);
+        ms_json_ndjson_parse_batch(reader, slot);
+        pthread_mutex_lock(&reader->lock);
+
+        slot->state = SLOT_READY;
+        reader->parsing--;
+        pthread_cond_broadcast(&reader->slot_ready);
+    }
+    pthread_mutex_unlock(&reader->lock);
+}
@@ -0,0 +1,66 @@
+/*
+ * @file ms_json_ndjson.h
+ * @brief Parallel parsing of newline-delimited JSON
+ */
+
+#ifndef MS_JSON_NDJSON_H
+#define MS_JSON_NDJSON_H
+
+#include "ms_json_types.h"
+#include <stddef.h>
+
+/**
+ * @brief Receives one parsed document
+ *
+ * Always called on the thread that called ms_json_parse_ndjson(). The value
+ * lives in an arena owned by the reader and is released after the callback
+ * returns, so copy out whatever must be kept. Returning anything other than
+ * MS_JSON_SUCCESS stops the reader and that result is returned.
+ *
+ * @param user_ctx Context given to ms_json_parse_ndjson()
+ * @param line Line number of the document, from 1
+ * @param value Parsed document, borrowed
+ */
+typedef ms_json_result_t (*ms_json_ndjson_callback_t)(void* user_ctx, size_t line, ms_json_value_t* value);
+
+/**
+ * @brief NDJSON reader options
+ */
+typedef struct {
+    ms_json_options_t parse;  /**< Options for every document; allocator is ignored
+                                   because each batch is parsed into its own arena.
+                                   With intern_keys or key_table, the documents of
+                                   a batch share a key table in that arena */
+    size_t threads;           /**< Parser threads, 0 = one per online processor,
+                                   1 = parse on the calling thread */
+    size_t batch_size;        /**< Lines handed to a thread at a time, 0 = 256 */
+    int unordered;            /**< Deliver batches as they finish rather than in
+                                   input order; lines within a batch stay ordered */
+} ms_json_ndjson_options_t;
+
+/**
+ * @brief Parse a buffer holding one JSON document per line
+ *
+ * Lines end at '\n'; a trailing '\r' and lines holding only whitespace are
+ * ignored. Batches of lines are parsed in parallel while the calling thread
+ * delivers finished documents to callback, with a bounded number of batches
+ * in flight so memory use does not grow with the input.
+ *
+ * @param input NDJSON text, need not be NUL-terminated
+ * @param length Length of input in bytes
+ * @param options Reader options, NULL for defaults
+ * @param callback Called for every document
+ * @param user_ctx Passed to callback
+ * @param error_line Output parameter for the line of a parse error, may be NULL
+ *
+ * @return MS_JSON_SUCCESS if every line parsed and was accepted, the parse
+ *         error of the first failing line delivered, or the first
+ *         non-success result of callback
+ *
+ * @note Documents before the failing line are still delivered; with
+ *       unordered set, documents after it may have been delivered too
+ */
+ms_json_result_t ms_json_parse_ndjson(const char* input, size_t length, const ms_json_ndjson_options_t* options,
+                                      ms_json_ndjson_callback_t callback, void* user_ctx, size_t* error_line);
+
+#endif
@@ -0,0 +1,842 @@
+/**
+ * @file ms_json_number.c
+ * @brief JSON number parsing and integer formatting
+ *
+ * Numbers are parsed in one pass into a decimal significand of up to 19
+ * digits and a power of ten. From there:
+ *  - plain integers that fit in int64_t are returned exactly;
+ *  - small significands and exponents take Clinger's exact fast path;
+ *  - everything else goes through the Eisel-Lemire algorithm, which
+ *    produces the correctly rounded double from a 128-bit power of five;
+ *  - the rare significand truncated to 19 digits whose rounding cannot be
+ *    decided that way falls back to strtod, made locale-independent.
+ *
+ * Formatting uses Grisu3 (Florian Loitsch, "Printing Floating-Point Numbers
+ * Quickly and Accurately with Integers"), which proves its digits are the
+ * shortest that read back as the same double, and the closest of those, or
+ * rejects the value. The rejected ones, about 0.5%, are redone exactly from
+ * the C library's correctly rounded conversion.
+ */
+
+#include "ms_json_number.h"
+#include "ms_json_number_tables.h"
+#include <float.h>
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUMBER_MAX_SIGNIFICANT_DIGITS 19
+#define NUMBER_EXPONENT_LIMIT 100000   /* Saturates absurd exponents, well past any double */
+#define NUMBER_FALLBACK_BUFFER 128     /* Longer tokens get a heap copy in the strtod fallback */
+
+/* IEEE-754 binary64 layout */
+#define DOUBLE_MANTISSA_BITS 52
+#define DOUBLE_MINIMUM_EXPONENT (-1023)
+#define DOUBLE_INFINITE_POWER 0x7FF
+#define DOUBLE_ROUND_TO_EVEN_MIN_EXPONENT (-4)
+#define DOUBLE_ROUND_TO_EVEN_MAX_EXPONENT 23
+
+/* Decimal token split into significand and power of ten */
+typedef struct {
+    uint64_t significand;
+    int64_t exponent;
+    int negative;
+    int is_integer_syntax;  /* No fraction and no exponent part */
+    int truncated;          /* Non-zero digits beyond the 19th were dropped */
+} ms_json_decimal_t;
+
+typedef struct {
+    uint64_t high;
+    uint64_t low;
+} ms_json_uint128_t;
+
+/* Grisu "do-it-yourself" floating point: f * 2^e */
+typedef struct {
+    uint64_t f;
+    int e;
+} ms_json_diy_fp_t;
+
+#define DOUBLE_HIDDEN_BIT ((uint64_t)1 << DOUBLE_MANTISSA_BITS)
+#define DOUBLE_EXPONENT_BIAS 1075   /* Exponent bias plus mantissa width */
+#define DOUBLE_EXACT_INTEGER_LIMIT 9007199254740992.0  /* 2^53 */
+#define DOUBLE_ROUND_TRIP_DIGITS 17  /* Significant digits that always read back */
+
+/* Forward declarations */
+static size_t ms_json_scan_decimal(const char* input, size_t length, ms_json_decimal_t* decimal);
+static int ms_json_clinger_fast_path(const ms_json_decimal_t* decimal, double* value);
+static int64_t ms_json_eisel_lemire(int64_t q, uint64_t w, uint64_t* mantissa);
+static ms_json_uint128_t ms_json_multiply_64(uint64_t a, uint64_t b);
+static int ms_json_strtod_fallback(const char* input, size_t length, double* value);
+static double ms_json_assemble_double(int negative, uint64_t mantissa, int64_t power2);
+static int ms_json_grisu3(double value, char* digits, size_t* length, int* decimal_exponent);
+static int ms_json_grisu_digit_gen(ms_json_diy_fp_t low, ms_json_diy_fp_t w, ms_json_diy_fp_t high,
+                                   char* digits, size_t* length, int* k);
+static size_t ms_json_shortest_exact(double value, char* digits, int* decimal_exponent);
+static size_t ms_json_write_exponent(int exponent, char* buffer);
+static size_t ms_json_prettify(char* buffer, size_t length, int k);
+
+static inline int ms_json_is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static inline int ms_json_leading_zeros64(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(value);
+#else
+    int count = 0;
+    while (!(value & ((uint64_t)1 << 63))) {
+        value <<= 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+ms_json_result_t ms_json_parse_number_text(const char* input, size_t length, size_t* consumed,
+                                           ms_json_number_t* number) {
+    if (!input || !consumed || !number) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    ms_json_decimal_t decimal;
+    size_t token_length = ms_json_scan_decimal(input, length, &decimal);
+    if (token_length == 0) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+    *consumed = token_length;
+
+    /* Integer fast path: exact int64_t, the common case for ids and timestamps */
+    if (decimal.is_integer_syntax && decimal.exponent == 0 &&
+        !(decimal.negative && decimal.significand == 0)) {
+        uint64_t limit = decimal.negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+        if (decimal.significand <= limit) {
+            number->is_integer = 1;
+            number->integer = decimal.negative
+                                  ? (int64_t)(0 - decimal.significand)
+                                  : (int64_t)decimal.significand;
+            number->number = (double)number->integer;
+            return MS_JSON_SUCCESS;
+        }
+    }
+
+    number->is_integer = 0;
+
+    if (decimal.significand == 0) {
+        number->number = decimal.negative ? -0.0 : 0.0;
+        return MS_JSON_SUCCESS;
+    }
+
+    if (!decimal.truncated && ms_json_clinger_fast_path(&decimal, &number->number)) {
+        return MS_JSON_SUCCESS;
+    }
+
+    uint64_t mantissa = 0;
+    int64_t power2 = ms_json_eisel_lemire(decimal.exponent, decimal.significand, &mantissa);
+
+    /* A truncated significand lies between w and w + 1; both must round alike */
+    if (decimal.truncated) {
+        uint64_t upper_mantissa = 0;
+        int64_t upper_power2 = ms_json_eisel_lemire(decimal.exponent, decimal.significand + 1,
+                                                    &upper_mantissa);
+        if (upper_mantissa != mantissa || upper_power2 != power2) {
+            if (!ms_json_strtod_fallback(input, token_length, &number->number)) {
+                return MS_JSON_ERROR_SYNTAX;
+            }
+            return MS_JSON_SUCCESS;
+        }
+    }
+
+    if (power2 >= DOUBLE_INFINITE_POWER) {
+        return MS_JSON_ERROR_SYNTAX; /* Magnitude overflows a double */
+    }
+
+    number->number = ms_json_assemble_double(decimal.negative, mantissa, power2);
+    return MS_JSON_SUCCESS;
+}
+
+/**
+ * @brief Validate a number token against the JSON grammar and decompose it
+ *
+ * @return Token length, 0 on a syntax error
+ */
+static size_t ms_json_scan_decimal(const char* input, size_t length, ms_json_decimal_t* decimal) {
+    const char* p = input;
+    const char* end = input + length;
+    uint64_t significand = 0;
+    int64_t exponent = 0;
+    int digits = 0;
+    int truncated = 0;
+
+    decimal->negative = 0;
+    if (p < end && *p == '-') {
+        decimal->negative = 1;
+        p++;
+    }
+
+    if (p >= end || !ms_json_is_digit(*p)) {
+        return 0;
+    }
+
+    /* Integer part; a leading zero must stand alone */
+    if (*p == '0') {
+        p++;
+        if (p < end && ms_json_is_digit(*p)) {
+            return 0;
+        }
+    } else {
+        while (p < end && ms_json_is_digit(*p)) {
+            if (digits < NUMBER_MAX_SIGNIFICANT_DIGITS) {
+                significand = significand * 10 + (uint64_t)(*p - '0');
+                digits++;
+            } else {
+                truncated |= *p != '0';
+                exponent++;
+            }
+            p++;
+        }
+    }
+
+    decimal->is_integer_syntax = 1;
+
+    /* Fraction; leading zeros are not significant */
+    if (p < end && *p == '.') {
+        decimal->is_integer_syntax = 0;
+        p++;
+        if (p >= end || !ms_json_is_digit(*p)) {
+            return 0;
+        }
+        while (p < end && ms_json_is_digit(*p)) {
+            if (digits < NUMBER_MAX_SIGNIFICANT_DIGITS) {
+                if (digits > 0 || *p != '0') {
+                    significand = significand * 10 + (uint64_t)(*p - '0');
+                    digits++;
+                }
+                exponent--;
+            } else {
+                truncated |= *p != '0';
+            }
+            p++;
+        }
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        decimal->is_integer_syntax = 0;
+        p++;
+        int exponent_negative = 0;
+        if (p < end && (*p == '+' || *p == '-')) {
+            exponent_negative = *p == '-';
+            p++;
+        }
+        if (p >= end || !ms_json_is_digit(*p)) {
+            return 0;
+        }
+        int64_t explicit_exponent = 0;
+        while (p < end && ms_json_is_digit(*p)) {
+            if (explicit_exponent < NUMBER_EXPONENT_LIMIT) {
+                explicit_exponent = explicit_exponent * 10 + (*p - '0');
+            }
+            p++;
+        }
+        exponent += exponent_negative ? -explicit_exponent : explicit_exponent;
+    }
+
+    decimal->significand = significand;
+    decimal->exponent = exponent;
+    decimal->truncated = truncated;
+    return (size_t)(p - input);
+}
+
+/**
+ * @brief Clinger's fast path: both operands exact, so one IEEE operation
+ *        gives the correctly rounded result
+ *
+ * @return 1 if the value was computed, 0 if the slow path is needed
+ */
+static int ms_json_clinger_fast_path(const ms_json_decimal_t* decimal, double* value) {
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    static const double powers_of_ten[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    if (decimal->exponent < -22 || decimal->exponent > 22 ||
+        decimal->significand > ((uint64_t)1 << 53)) {
+        return 0;
+    }
+
+    double result = (double)decimal->significand;
+    if (decimal->exponent < 0) {
+        result /= powers_of_ten[-decimal->exponent];
+    } else {
+        result *= powers_of_ten[decimal->exponent];
+    }
+    *value = decimal->negative ? -result : result;
+    return 1;
+#else
+    /* Extended-precision evaluation double-rounds; always take the exact path */
+    (void)decimal;
+    (void)value;
+    return 0;
+#endif
+}
+
+/**
+ * @brief Eisel-Lemire conversion of w * 10^q to binary64
+ *
+ * @param q Decimal exponent
+ * @param w Non-zero decimal significand
+ * @param mantissa Output parameter for the 52 explicit mantissa bits
+ * @return Biased binary exponent; DOUBLE_INFINITE_POWER on overflow
+ */
+static int64_t ms_json_eisel_lemire(int64_t q, uint64_t w, uint64_t* mantissa) {
+    if (q < MS_JSON_POW5_SMALLEST_POWER) {
+        *mantissa = 0;
+        return 0;
+    }
+    if (q > MS_JSON_POW5_LARGEST_POWER) {
+        *mantissa = 0;
+        return DOUBLE_INFINITE_POWER;
+    }
+
+    int leading_zeros = ms_json_leading_zeros64(w);
+    w <<= leading_zeros;
+
+    /* 64x128-bit product, second half only when the first is inconclusive */
+    size_t index = 2 * (size_t)(q - MS_JSON_POW5_SMALLEST_POWER);
+    ms_json_uint128_t product = ms_json_multiply_64(w, ms_json_pow5_128[index]);
+    const uint64_t precision_mask = UINT64_MAX >> (DOUBLE_MANTISSA_BITS + 3);
+    if ((product.high & precision_mask) == precision_mask) {
+        ms_json_uint128_t low_product = ms_json_multiply_64(w, ms_json_pow5_128[index + 1]);
+        product.low += low_product.high;
+        if (low_product.high > product.low) {
+            product.high++;
+        }
+    }
+
+    int upper_bit = (int)(product.high >> 63);
+    int shift = upper_bit + 64 - DOUBLE_MANTISSA_BITS - 3;
+    uint64_t m = product.high >> shift;
+    /* floor(q * log2(10)) + 63, exact over the table range */
+    int64_t power2 = (((152170 + 65536) * q) >> 16) + 63 + upper_bit - leading_zeros -
+                     DOUBLE_MINIMUM_EXPONENT;
+
+    if (power2 <= 0) {
+        /* Subnormal result */
+        if (-power2 + 1 >= 64) {
+            *mantissa = 0;
+            return 0;
+        }
+        m >>= -power2 + 1;
+        m += m & 1;
+        m >>= 1;
+        *mantissa = m & ~((uint64_t)1 << DOUBLE_MANTISSA_BITS);
+        return m < ((uint64_t)1 << DOUBLE_MANTISSA_BITS) ? 0 : 1;
+    }
+
+    /* Exact halfway case: round to even instead of up */
+    if (product.low <= 1 && q >= DOUBLE_ROUND_TO_EVEN_MIN_EXPONENT &&
+        q <= DOUBLE_ROUND_TO_EVEN_MAX_EXPONENT && (m & 3) == 1 &&
+        (m << shift) == product.high) {
+        m &= ~(uint64_t)1;
+    }
+
+    m += m & 1;
+    m >>= 1;
+    if (m >= ((uint64_t)2 << DOUBLE_MANTISSA_BITS)) {
+        m = (uint64_t)1 << DOUBLE_MANTISSA_BITS;
+        power2++;
+    }
+
+    if (power2 >= DOUBLE_INFINITE_POWER) {
+        *mantissa = 0;
+        return DOUBLE_INFINITE_POWER;
+    }
+
+    *mantissa = m & ~((uint64_t)1 << DOUBLE_MANTISSA_BITS);
+    return power2;
+}
+
+static ms_json_uint128_t ms_json_multiply_64(uint64_t a, uint64_t b) {
+    ms_json_uint128_t result;
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 ms_json_u128;
+    ms_json_u128 product = (ms_json_u128)a * b;
+    result.high = (uint64_t)(product >> 64);
+    result.low = (uint64_t)product;
+#else
+    uint64_t a_low = (uint32_t)a, a_high = a >> 32;
+    uint64_t b_low = (uint32_t)b, b_high = b >> 32;
+    uint64_t low_low = a_low * b_low;
+    uint64_t high_low = a_high * b_low;
+    uint64_t low_high = a_low * b_high;
+    uint64_t middle = (low_low >> 32) + (uint32_t)high_low + low_high;
+    result.low = (middle << 32) | (uint32_t)low_low;
+    result.high = a_high * b_high + (high_low >> 32) + (middle >> 32);
+#endif
+    return result;
+}
+
+/**
+ * @brief Convert with strtod, substituting the locale's decimal point
+ *
+ * @return 1 on success, 0 on allocation failure or overflow
+ */
+static int ms_json_strtod_fallback(const char* input, size_t length, double* value) {
+    char stack_buffer[NUMBER_FALLBACK_BUFFER];
+    char* buffer = stack_buffer;
+    ms_allocator_t* allocator = ms_allocator_default();
+
+    if (length >= sizeof(stack_buffer) &&
+        ms_allocator_allocate(allocator, length + 1, (void**)&buffer) != MS_MEMORY_SUCCESS) {
+        return 0;
+    }
+
+    memcpy(buffer, input, length);
+    buffer[length] = '\0';
+
+    const struct lconv* locale_info = localeconv();
+    char decimal_point = locale_info && locale_info->decimal_point && locale_info->decimal_point[0]
+                             ? locale_info->decimal_point[0]
+                             : '.';
+    char* dot = memchr(buffer, '.', length);
+    if (dot) {
+        *dot = decimal_point;
+    }
+
+    char* parse_end = NULL;
+    double result = strtod(buffer, &parse_end);
+    int parsed = parse_end == buffer + length && result <= DBL_MAX && result >= -DBL_MAX;
+
+    if (buffer != stack_buffer) {
+        ms_allocator_deallocate(allocator, buffer);
+    }
+
+    if (parsed) {
+        *value = result;
+    }
+    return parsed;
+}
+
+static double ms_json_assemble_double(int negative, uint64_t mantissa, int64_t power2) {
+    uint64_t bits = mantissa | ((uint64_t)power2 << DOUBLE_MANTISSA_BITS);
+    if (negative) {
+        bits |= (uint64_t)1 << 63;
+    }
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+size_t ms_json_format_int64(int64_t value, char* buffer) {
+    static const char digit_pairs[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+
+    char scratch[MS_JSON_INT64_MAX_CHARS];
+    char* p = scratch + sizeof(scratch);
+    uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+
+    /* Two digits per division, written back to front */
+    while (magnitude >= 100) {
+        unsigned int pair = (unsigned int)(magnitude % 100) * 2;
+        magnitude /= 100;
+        *--p = digit_pairs[pair + 1];
+        *--p = digit_pairs[pair];
+    }
+    if (magnitude >= 10) {
+        unsigned int pair = (unsigned int)magnitude * 2;
+        *--p = digit_pairs[pair + 1];
+        *--p = digit_pairs[pair];
+    } else {
+        *--p = (char)('0' + magnitude);
+    }
+    if (value < 0) {
+        *--p = '-';
+    }
+
+    size_t length = (size_t)(scratch + sizeof(scratch) - p);
+    memcpy(buffer, p, length);
+    return length;
+}
+
+static ms_json_diy_fp_t ms_json_diy_fp_multiply(ms_json_diy_fp_t a, ms_json_diy_fp_t b) {
+    ms_json_uint128_t product = ms_json_multiply_64(a.f, b.f);
+    ms_json_diy_fp_t result;
+    /* Keep the high half, rounded */
+    result.f = product.high + (product.low >> 63);
+    result.e = a.e + b.e + 64;
+    return result;
+}
+
+static ms_json_diy_fp_t ms_json_diy_fp_normalize(ms_json_diy_fp_t value) {
+    int shift = ms_json_leading_zeros64(value.f);
+    value.f <<= shift;
+    value.e -= shift;
+    return value;
+}
+
+/**
+ * @brief Pick the cached power 10^-k that brings w_e into Grisu's window
+ *
+ * @param e Binary exponent of the normalised upper boundary
+ * @param k Output parameter for the decimal exponent of the cached power
+ */
+static ms_json_diy_fp_t ms_json_cached_power(int e, int* k) {
+    /* ceil((-61 - e) * log10(2)) + 347, shifted so the index is never negative */
+    double estimate = (-61 - e) * 0.30102999566398114 + 347;
+    int power = (int)estimate;
+    if (estimate - power > 0.0) {
+        power++;
+    }
+
+    size_t index = (size_t)((power >> 3) + 1);
+    *k = -(MS_JSON_CACHED_POWER_FIRST + (int)index * MS_JSON_CACHED_POWER_STEP);
+
+    ms_json_diy_fp_t cached;
+    cached.f = ms_json_cached_power_significand[index];
+    cached.e = ms_json_cached_power_exponent[index];
+    return cached;
+}
+
+/**
+ * @brief Weed out a last digit that may not be the closest, or may not round-trip
+ *
+ * Walks the last digit down towards w while that stays inside the unsafe
+ * interval, then checks that the imprecision of the scaled values (unit)
+ * cannot have chosen the wrong digit or a digit outside the true interval.
+ *
+ * @return 1 if the digits are provably the shortest and closest, 0 if the
+ *         caller must fall back to an exact method
+ */
+static int ms_json_grisu_round_weed(char* digits, size_t length, uint64_t distance_too_high_w,
+                                    uint64_t unsafe_interval, uint64_t rest, uint64_t ten_kappa,
+                                    uint64_t unit) {
+    uint64_t small_distance = distance_too_high_w - unit;
+    uint64_t big_distance = distance_too_high_w + unit;
+
+    while (rest < small_distance && unsafe_interval - rest >= ten_kappa &&
+           (rest + ten_kappa < small_distance ||
+            small_distance - rest >= rest + ten_kappa - small_distance)) {
+        digits[length - 1]--;
+        rest += ten_kappa;
+    }
+
+    /* The digit could also be one lower, depending on where w really lies */
+    if (rest < big_distance && unsafe_interval - rest >= ten_kappa &&
+        (rest + ten_kappa < big_distance || big_distance - rest > rest + ten_kappa - big_distance)) {
+        return 0;
+    }
+
+    /* Too close to the edges of the unsafe interval to be sure */
+    return 2 * unit <= rest && rest <= unsafe_interval - 4 * unit;
+}
+
+/**
+ * @brief Generate the shortest digits inside (low, high), closest to w
+ *
+ * All three are scaled so that w.e lies in [-60, -32]; each may be off by
+ * one unit, so the interval is widened to the unsafe one and the result
+ * checked by ms_json_grisu_round_weed().
+ *
+ * @return 1 on success, 0 if the digits cannot be guaranteed
+ */
+static int ms_json_grisu_digit_gen(ms_json_diy_fp_t low, ms_json_diy_fp_t w, ms_json_diy_fp_t high,
+                                   char* digits, size_t* length, int* k) {
+    static const uint64_t powers_of_ten[] = {
+        1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u
+    };
+
+    uint64_t unit = 1;
+    uint64_t too_low = low.f - unit;
+    uint64_t too_high = high.f + unit;
+    uint64_t unsafe_interval = too_high - too_low;
+
+    int one_shift = -w.e;
+    uint64_t one = (uint64_t)1 << one_shift;
+    uint32_t integral = (uint32_t)(too_high >> one_shift);
+    uint64_t fractional = too_high & (one - 1);
+
+    int kappa = 1;
+    while (kappa < 10 && integral >= powers_of_ten[kappa]) {
+        kappa++;
+    }
+
+    *length = 0;
+
+    /* Integral digits */
+    while (kappa > 0) {
+        uint32_t divisor = (uint32_t)powers_of_ten[kappa - 1];
+        digits[(*length)++] = (char)('0' + integral / divisor);
+        integral %= divisor;
+        kappa--;
+
+        uint64_t rest = ((uint64_t)integral << one_shift) + fractional;
+        if (rest < unsafe_interval) {
+            *k += kappa;
+            return ms_json_grisu_round_weed(digits, *length, too_high - w.f, unsafe_interval, rest,
+                                            (uint64_t)divisor << one_shift, unit);
+        }
+    }
+
+    /* Fractional digits */
+    for (;;) {
+        fractional *= 10;
+        unit *= 10;
+        unsafe_interval *= 10;
+        digits[(*length)++] = (char)('0' + (fractional >> one_shift));
+        fractional &= one - 1;
+        kappa--;
+
+        if (fractional < unsafe_interval) {
+            *k += kappa;
+            return ms_json_grisu_round_weed(digits, *length, (too_high - w.f) * unit, unsafe_interval,
+                                            fractional, one, unit);
+        }
+    }
+}
+
+/**
+ * @brief Shortest digits of a positive finite double, when Grisu3 can prove them
+ *
+ * @param value Positive, finite, non-zero value
+ * @param digits Output, at least 18 bytes
+ * @param length Output parameter for the number of digits
+ * @param decimal_exponent Output: value = digits * 10^decimal_exponent
+ * @return 1 on success, 0 for the roughly 0.5% of values it rejects
+ */
+static int ms_json_grisu3(double value, char* digits, size_t* length, int* decimal_exponent) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    int biased_exponent = (int)((bits >> DOUBLE_MANTISSA_BITS) & DOUBLE_INFINITE_POWER);
+    ms_json_diy_fp_t v;
+    v.f = bits & (DOUBLE_HIDDEN_BIT - 1);
+    if (biased_exponent != 0) {
+        v.f += DOUBLE_HIDDEN_BIT;
+        v.e = biased_exponent - DOUBLE_EXPONENT_BIAS;
+    } else {
+        v.e = 1 - DOUBLE_EXPONENT_BIAS;
+    }
+
+    /* Boundaries halfway to the neighbouring doubles, at the exponent of the normalised value */
+    ms_json_diy_fp_t plus = { (v.f << 1) + 1, v.e - 1 };
+    plus = ms_json_diy_fp_normalize(plus);
+    ms_json_diy_fp_t minus;
+    if (v.f == DOUBLE_HIDDEN_BIT && biased_exponent > 1) {
+        /* The double below is closer: its exponent is one smaller */
+        minus.f = (v.f << 2) - 1;
+        minus.e = v.e - 2;
+    } else {
+        minus.f = (v.f << 1) - 1;
+        minus.e = v.e - 1;
+    }
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+
+    ms_json_diy_fp_t w = ms_json_diy_fp_normalize(v);
+
+    int k = 0;
+    ms_json_diy_fp_t cached = ms_json_cached_power(plus.e, &k);
+    ms_json_diy_fp_t scaled_w = ms_json_diy_fp_multiply(w, cached);
+    ms_json_diy_fp_t scaled_plus = ms_json_diy_fp_multiply(plus, cached);
+    ms_json_diy_fp_t scaled_minus = ms_json_diy_fp_multiply(minus, cached);
+
+    int ok = ms_json_grisu_digit_gen(scaled_minus, scaled_w, scaled_plus, digits, length, &k);
+    *decimal_exponent = k;
+    return ok;
+}
+
+/* Whether significand * 10^exponent reads back as value */
+static int ms_json_reads_back(uint64_t significand, int exponent, double value) {
+    char text[MS_JSON_INT64_MAX_CHARS + 8];
+    size_t length = ms_json_format_int64((int64_t)significand, text);
+    text[length++] = 'e';
+    length += ms_json_write_exponent(exponent, text + length);
+
+    size_t consumed = 0;
+    ms_json_number_t number;
+    return ms_json_parse_number_text(text, length, &consumed, &number) == MS_JSON_SUCCESS &&
+           number.number == value;
+}
+
+/**
+ * @brief Digits at one precision that read back as value, if any
+ *
+ * Takes the C library's correctly rounded %e conversion and, failing that,
+ * its neighbours in the last place: at a power of two the rounding interval
+ * is lopsided, so the nearest candidate may fall just outside it while the
+ * next one over does not.
+ *
+ * @return 1 with significand * 10^exponent set, 0 if none of them reads back
+ */
+static int ms_json_exact_candidate(double value, int precision, uint64_t* significand, int* exponent) {
+    char text[MS_JSON_DOUBLE_MAX_CHARS + 8];
+    snprintf(text, sizeof(text), "%.*e", precision - 1, value);
+
+    /* Digits around whatever decimal point the locale uses, then the exponent */
+    const char* p = text;
+    uint64_t digits = 0;
+    for (; *p && *p != 'e'; p++) {
+        if (*p >= '0' && *p <= '9') {
+            digits = digits * 10 + (uint64_t)(*p - '0');
+        }
+    }
+    *exponent = (*p ? (int)strtol(p + 1, NULL, 10) : 0) - (precision - 1);
+
+    uint64_t lower = 1;  /* 10^(precision - 1) */
+    for (int i = 1; i < precision; i++) {
+        lower *= 10;
+    }
+
+    if (ms_json_reads_back(digits, *exponent, value)) {
+        *significand = digits;
+    } else if (digits + 1 < lower * 10 && ms_json_reads_back(digits + 1, *exponent, value)) {
+        *significand = digits + 1;
+    } else if (digits - 1 >= lower && ms_json_reads_back(digits - 1, *exponent, value)) {
+        *significand = digits - 1;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Shortest digits found exactly, for the values Grisu3 rejects
+ *
+ * A precision that reads back implies every longer one does, so the
+ * shortest is binary searched between 1 and 17 digits.
+ *
+ * @param value Positive, finite, non-zero value
+ * @param digits Output, at least 18 bytes
+ * @param decimal_exponent Output: value = digits * 10^decimal_exponent
+ * @return Number of digits
+ */
+static size_t ms_json_shortest_exact(double value, char* digits, int* decimal_exponent) {
+    uint64_t significand = 0;
+    int exponent = 0;
+    int found = 0;
+    int low = 1;
+    int high = DOUBLE_ROUND_TRIP_DIGITS;
+
+    while (low < high) {
+        int middle = (low + high) / 2;
+        uint64_t candidate = 0;
+        int candidate_exponent = 0;
+        if (ms_json_exact_candidate(value, middle, &candidate, &candidate_exponent)) {
+            significand = candidate;
+            exponent = candidate_exponent;
+            found = 1;
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    if (!found) {
+        ms_json_exact_candidate(value, DOUBLE_ROUND_TRIP_DIGITS, &significand, &exponent);
+    }
+
+    while (significand % 10 == 0) {
+        significand /= 10;
+        exponent++;
+    }
+
+    *decimal_exponent = exponent;
+    return ms_json_format_int64((int64_t)significand, digits);
+}
+
+static size_t ms_json_write_exponent(int exponent, char* buffer) {
+    char* p = buffer;
+    if (exponent < 0) {
+        *p++ = '-';
+        exponent = -exponent;
+    }
+    if (exponent >= 100) {
+        *p++ = (char)('0' + exponent / 100);
+        exponent %= 100;
+        *p++ = (char)('0' + exponent / 10);
+        *p++ = (char)('0' + exponent % 10);
+    } else if (exponent >= 10) {
+        *p++ = (char)('0' + exponent / 10);
+        *p++ = (char)('0' + exponent % 10);
+    } else {
+        *p++ = (char)('0' + exponent);
+    }
+    return (size_t)(p - buffer);
+}
+
+/**
+ * @brief Lay out digits * 10^k in fixed or exponent notation
+ *
+ * @param buffer Digits on input, formatted number on output
+ * @param length Number of digits
+ * @param k Decimal exponent
+ * @return Formatted length
+ */
+static size_t ms_json_prettify(char* buffer, size_t length, int k) {
+    int kk = (int)length + k; /* 10^(kk-1) <= value < 10^kk */
+
+    if (k >= 0 && kk <= 21) {
+        /* 1234e7 -> 12340000000 */
+        memset(buffer + length, '0', (size_t)k);
+        return (size_t)kk;
+    }
+
+    if (kk > 0 && kk <= 21) {
+        /* 1234e-2 -> 12.34 */
+        memmove(buffer + kk + 1, buffer + kk, length - (size_t)kk);
+        buffer[kk] = '.';
+        return length + 1;
+    }
+
+    if (kk > -6 && kk <= 0) {
+        /* 1234e-6 -> 0.001234 */
+        size_t offset = (size_t)(2 - kk);
+        memmove(buffer + offset, buffer, length);
+        buffer[0] = '0';
+        buffer[1] = '.';
+        memset(buffer + 2, '0', offset - 2);
+        return length + offset;
+    }
+
+    if (length == 1) {
+        /* 1e30 */
+        buffer[1] = 'e';
+        return 2 + ms_json_write_exponent(kk - 1, buffer + 2);
+    }
+
+    /* 1234e30 -> 1.234e33 */
+    memmove(buffer + 2, buffer + 1, length - 1);
+    buffer[1] = '.';
+    buffer[length + 1] = 'e';
+    return length + 2 + ms_json_write_exponent(kk - 1, buffer + length + 2);
+}
+
+size_t ms_json_format_double(double value, char* buffer) {
+    /* Exact integers take the integer formatter; the range check also keeps -0.0 apart */
+    if (value > -DOUBLE_EXACT_INTEGER_LIMIT && value < DOUBLE_EXACT_INTEGER_LIMIT && value != 0.0 &&
+        (double)(int64_t)value == value) {
+        return ms_json_format_int64((int64_t)value, buffer);
+    }
+
+    char* p = buffer;
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    if (bits >> 63) {
+        *p++ = '-';
+        value = -value;
+    }
+
+    if (value == 0.0) {
+        *p++ = '0';
+        return (size_t)(p - buffer);
+    }
+
+    int k = 0;
+    size_t length = 0;
+    if (!ms_json_grisu3(value, p, &length, &k)) {
+        length = ms_json_shortest_exact(value, p, &k);
+    }
+    return (size_t)(p - buffer) + ms_json_prettify(p, length, k);
+}
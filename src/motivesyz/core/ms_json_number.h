@@ -0,0 +1,70 @@
+/**
+ * @file ms_json_number.h
+ * @brief Internal JSON number conversion
+ *
+ * Locale-independent parsing of JSON number tokens. Integers that fit in
+ * int64_t are kept exact; everything else is converted to the correctly
+ * rounded double. Not part of the public API.
+ */
+
+#ifndef MS_JSON_NUMBER_H
+#define MS_JSON_NUMBER_H
+
+#include "ms_json_types.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/* Longest int64_t in decimal: sign plus 19 digits */
+#define MS_JSON_INT64_MAX_CHARS 20
+
+/* Longest formatted double, e.g. -0.0000012345678901234567 or -1.2345678901234567e-308 */
+#define MS_JSON_DOUBLE_MAX_CHARS 32
+
+/**
+ * @brief Parsed number token
+ */
+typedef struct {
+    int is_integer;   /**< Token had no fraction or exponent and fits int64_t */
+    int64_t integer;  /**< Exact value when is_integer is set */
+    double number;    /**< Nearest double, always set */
+} ms_json_number_t;
+
+/**
+ * @brief Parse one JSON number token
+ *
+ * @param input Start of the token
+ * @param length Bytes available from input
+ * @param consumed Output parameter for the token length
+ * @param number Output parameter for the value
+ *
+ * @return MS_JSON_SUCCESS on success, MS_JSON_ERROR_SYNTAX if the text is not
+ *         a JSON number or its magnitude overflows a double
+ */
+ms_json_result_t ms_json_parse_number_text(const char* input, size_t length, size_t* consumed,
+                                           ms_json_number_t* number);
+
+/**
+ * @brief Format an integer in decimal
+ *
+ * @param value Value to format
+ * @param buffer Output, at least MS_JSON_INT64_MAX_CHARS bytes; not terminated
+ * @return Number of characters written
+ */
+size_t ms_json_format_int64(int64_t value, char* buffer);
+
+/**
+ * @brief Format a finite double with the fewest digits that round-trip
+ *
+ * Integral values below 2^53 are written as plain integers; everything else
+ * gets the shortest digits that read back exactly, the closest to the value
+ * when several qualify, in fixed notation for exponents -6 to 21 and in
+ * exponent notation outside that. Grisu3 decides almost every value and an
+ * exact search the rest. Output is locale-independent.
+ *
+ * @param value Finite value to format; NaN and infinities are the caller's job
+ * @param buffer Output, at least MS_JSON_DOUBLE_MAX_CHARS bytes; not terminated
+ * @return Number of characters written
+ */
+size_t ms_json_format_double(double value, char* buffer);
+
+#endif /* MS_JSON_NUMBER_H */
@@ -5,6 +5,10 @@
 #include "ms_json_internal.h"
 #include "ms_json_parser.h"
 #include "ms_json_builder.h"
+#include "ms_json_keys.h"
+#include "ms_json_number.h"
+#include "ms_json_scan.h"
+#include "ms_instrument.h"
 #include <string.h>
 #include <ctype.h>
 #include <stdlib.h>
@@ -12,11 +16,19 @@
 #include <float.h>
 
 /* Configuration constants */
-#define MAX_NUMBER_LENGTH 64
-#define MAX_STRING_LENGTH (1024 * 1024) /* 1MB max string length */
 #define NULL_LENGTH 4
 #define TRUE_LENGTH 4
 #define FALSE_LENGTH 5
+#define KEY_INLINE_BUFFER_SIZE 128 /* Escaped keys up to this size decode on the stack */
+#define UNICODE_REPLACEMENT_CHARACTER 0xFFFD
+
+/* Object key being parsed: a view into the input, or decoded storage */
+typedef struct {
+    const char* chars;
+    size_t length;
+    char* heap;
+    char inline_buffer[KEY_INLINE_BUFFER_SIZE];
+} ms_json_key_buffer_t;
 
 /* Forward declarations for internal functions */
 static int ms_json_skip_comments(ms_json_parse_context_t* ctx);
@@ -25,19 +37,27 @@ static int ms_json_skip_block_comment(ms_json_parse_context_t* ctx);
 static ms_json_result_t parse_null(ms_json_parse_context_t* ctx, ms_json_value_t** result);
 static ms_json_result_t parse_boolean(ms_json_parse_context_t* ctx, ms_json_value_t** result);
 static ms_json_result_t parse_number(ms_json_parse_context_t* ctx, ms_json_value_t** result);
-static int ms_json_parse_number_string(ms_json_parse_context_t* ctx);
-static ms_json_result_t ms_json_convert_number_string(ms_json_parse_context_t* ctx,
-                                                     size_t start, ms_json_value_t** result);
 static ms_json_result_t parse_string(ms_json_parse_context_t* ctx, ms_json_value_t** result);
-static char* ms_json_parse_string_content(ms_json_parse_context_t* ctx);
-static int ms_json_copy_string_content(ms_json_parse_context_t* ctx, size_t start, char* output, size_t max_len);
-static char ms_json_decode_escape(char escape_char);
+static ms_json_result_t ms_json_parse_key(ms_json_parse_context_t* ctx, ms_json_key_buffer_t* key);
+static void ms_json_release_key(ms_json_parse_context_t* ctx, ms_json_key_buffer_t* key);
+static int ms_json_decode_hex4(const char* text, size_t available, uint32_t* code_point);
+static size_t ms_json_encode_utf8(uint32_t code_point, char* output);
 static ms_json_result_t parse_array(ms_json_parse_context_t* ctx, ms_json_value_t** result);
 static ms_json_result_t ms_json_parse_array_elements(ms_json_parse_context_t* ctx, ms_json_value_t* array);
 static ms_json_result_t parse_object(ms_json_parse_context_t* ctx, ms_json_value_t** result);
 static ms_json_result_t ms_json_parse_object_entries(ms_json_parse_context_t* ctx, ms_json_value_t* object);
 static int ms_json_expect_colon(ms_json_parse_context_t* ctx);
 static int ms_json_expect_comma(ms_json_parse_context_t* ctx);
+static ms_json_result_t ms_json_expect_literal(ms_json_parse_context_t* ctx, const char* literal,
+                                               size_t literal_length);
+static ms_json_result_t sax_number(ms_json_parse_context_t* ctx, const ms_json_sax_handler_t* handler,
+                                   void* user_ctx);
+static ms_json_result_t sax_array(ms_json_parse_context_t* ctx, const ms_json_sax_handler_t* handler,
+                                  void* user_ctx);
+static ms_json_result_t sax_object(ms_json_parse_context_t* ctx, const ms_json_sax_handler_t* handler,
+                                   void* user_ctx);
+static ms_json_result_t sax_after_element(ms_json_parse_context_t* ctx, char closing, int* done);
+static ms_json_result_t ms_json_skip_scalar(ms_json_parse_context_t* ctx);
 
 /* Public API implementation */
 ms_json_result_t ms_json_parse_value(ms_json_parse_context_t* ctx, ms_json_value_t** result) {
@@ -59,12 +79,20 @@ ms_json_result_t ms_json_parse_value(ms_json_parse_context_t* ctx, ms_json_value
         case 'n': return parse_null(ctx, result);
         case 't':
         case 'f': return parse_boolean(ctx, result);
-        case '"': return parse_string(ctx, result);
+        case '"': {
+            MS_INSTRUMENT_BEGIN(span, ctx->position);
+            ms_json_result_t status = parse_string(ctx, result);
+            MS_INSTRUMENT_END(span, MS_INSTRUMENT_STRING, ctx->position);
+            return status;
+        }
         case '[': return parse_array(ctx, result);
         case '{': return parse_object(ctx, result);
         default:
             if (isdigit((unsigned char)current_char) || current_char == '-') {
-                return parse_number(ctx, result);
+                MS_INSTRUMENT_BEGIN(span, ctx->position);
+                ms_json_result_t status = parse_number(ctx, result);
+                MS_INSTRUMENT_END(span, MS_INSTRUMENT_NUMBER, ctx->position);
+                return status;
             }
             return MS_JSON_ERROR_SYNTAX;
     }
@@ -75,24 +103,26 @@ int ms_json_skip_whitespace_and_comments(ms_json_parse_context_t* ctx) {
         return 0;
     }
 
+    MS_INSTRUMENT_BEGIN(span, ctx->position);
+    int ok = 1;
     while (ctx->position < ctx->length) {
-        char current_char = ctx->input[ctx->position];
-
-        if (isspace((unsigned char)current_char)) {
-            ctx->position++;
-            continue;
+        ctx->position = ms_json_scan_whitespace(ctx->input, ctx->position, ctx->length);
+        if (ctx->position >= ctx->length) {
+            break;
         }
 
-        if (!ctx->options.allow_comments || current_char != '/') {
+        if (!ctx->options.allow_comments || ctx->input[ctx->position] != '/') {
             break;
         }
 
         if (!ms_json_skip_comments(ctx)) {
-            return 0;
+            ok = 0;
+            break;
         }
     }
 
-    return 1;
+    MS_INSTRUMENT_END(span, MS_INSTRUMENT_TOKENIZE, ctx->position);
+    return ok;
 }
 
 /* Comment skipping extracted to separate function */
@@ -109,7 +139,7 @@ static int ms_json_skip_comments(ms_json_parse_context_t* ctx) {
         return ms_json_skip_block_comment(ctx);
     }
 
-    return 1;
+    return 0; /* A lone '/' is not valid JSON */
 }
 
 static int ms_json_skip_line_comment(ms_json_parse_context_t* ctx) {
@@ -197,205 +227,251 @@ static ms_json_result_t parse_number(ms_json_parse_context_t* ctx, ms_json_value
         return MS_JSON_ERROR_INVALID_ARGUMENT;
     }
 
-    size_t number_start = ctx->position;
-
-    if (!ms_json_parse_number_string(ctx)) {
-        return MS_JSON_ERROR_SYNTAX;
+    ms_json_number_t number;
+    size_t consumed = 0;
+    ms_json_result_t parse_result = ms_json_parse_number_text(&ctx->input[ctx->position],
+                                                              ctx->length - ctx->position,
+                                                              &consumed, &number);
+    if (parse_result != MS_JSON_SUCCESS) {
+        return parse_result;
     }
+    ctx->position += consumed;
 
-    return ms_json_convert_number_string(ctx, number_start, result);
+    *result = number.is_integer ? ms_json_create_integer(ctx->allocator, number.integer)
+                                : ms_json_create_number(ctx->allocator, number.number);
+    return *result ? MS_JSON_SUCCESS : MS_JSON_ERROR_MEMORY;
 }
 
-static int ms_json_parse_number_string(ms_json_parse_context_t* ctx) {
-    if (!ctx) {
-        return 0;
+ms_json_result_t ms_json_scan_string(ms_json_parse_context_t* ctx, size_t* raw_start, size_t* raw_length,
+                                     int* has_escapes) {
+    if (!ctx || ctx->position >= ctx->length || ctx->input[ctx->position] != '"') {
+        return MS_JSON_ERROR_SYNTAX;
     }
 
-    size_t start = ctx->position;
-    size_t digits = 0;
+    size_t start = ctx->position + 1;
+    size_t position = start;
+    int escapes = 0;
 
-    while (ctx->position < ctx->length && digits < MAX_NUMBER_LENGTH) {
-        char current_char = ctx->input[ctx->position];
-        if (!isdigit((unsigned char)current_char) &&
-            current_char != '-' && current_char != '+' &&
-            current_char != '.' && current_char != 'e' && current_char != 'E') {
+    while (position < ctx->length) {
+        position = ms_json_scan_string_delimiter(ctx->input, position, ctx->length);
+        if (position >= ctx->length || ctx->input[position] == '"') {
             break;
         }
-        ctx->position++;
-        digits++;
+        escapes = 1;
+        position += 2; /* Skip backslash and escaped character */
     }
 
-    /* Ensure we have at least one digit */
-    if (digits == 0 || (digits == 1 && (ctx->input[start] == '-' || ctx->input[start] == '+'))) {
-        return 0;
+    if (position >= ctx->length) {
+        return MS_JSON_ERROR_EOF; /* Unclosed string */
+    }
+
+    if (position - start > MS_JSON_MAX_STRING_LENGTH) {
+        return MS_JSON_ERROR_SYNTAX; /* String too long */
     }
 
-    return ctx->position > start;
+    *raw_start = start;
+    *raw_length = position - start;
+    *has_escapes = escapes;
+    ctx->position = position + 1; /* Skip closing quote */
+    return MS_JSON_SUCCESS;
 }
 
-static ms_json_result_t ms_json_convert_number_string(ms_json_parse_context_t* ctx,
-                                                     size_t start, ms_json_value_t** result) {
-    if (!ctx || !result || start >= ctx->position) {
+static ms_json_result_t parse_string(ms_json_parse_context_t* ctx, ms_json_value_t** result) {
+    if (!ctx || !result) {
         return MS_JSON_ERROR_INVALID_ARGUMENT;
     }
 
-    size_t number_length = ctx->position - start;
-    if (number_length >= MAX_NUMBER_LENGTH) {
-        return MS_JSON_ERROR_SYNTAX;
+    size_t raw_start = 0;
+    size_t raw_length = 0;
+    int has_escapes = 0;
+    ms_json_result_t scan_result = ms_json_scan_string(ctx, &raw_start, &raw_length, &has_escapes);
+    if (scan_result != MS_JSON_SUCCESS) {
+        return scan_result;
     }
 
-    char number_string[MAX_NUMBER_LENGTH + 1];
-    if (number_length > sizeof(number_string) - 1) {
-        return MS_JSON_ERROR_SYNTAX;
-    }
+    const char* raw = &ctx->input[raw_start];
 
-    memcpy(number_string, &ctx->input[start], number_length);
-    number_string[number_length] = '\0';
+    /* Unescaped strings are copied once, or not at all in zero-copy mode */
+    if (!has_escapes) {
+        *result = ctx->options.zero_copy
+                      ? ms_json_create_string_borrowed(ctx->allocator, raw, raw_length)
+                      : ms_json_create_string_n(ctx->allocator, raw, raw_length);
+        return *result ? MS_JSON_SUCCESS : MS_JSON_ERROR_MEMORY;
+    }
 
-    char* parse_end;
-    double value = strtod(number_string, &parse_end);
+    char* decoded = NULL;
+    if (ms_allocator_allocate(ctx->allocator, raw_length + 1, (void**)&decoded) != MS_MEMORY_SUCCESS) {
+        return MS_JSON_ERROR_MEMORY;
+    }
 
-    /* Check if entire string was parsed */
-    if (parse_end != number_string + number_length) {
+    size_t decoded_length = 0;
+    if (!ms_json_decode_string(raw, raw_length, decoded, &decoded_length)) {
+        ms_allocator_deallocate(ctx->allocator, decoded);
         return MS_JSON_ERROR_SYNTAX;
     }
 
-    /* Check for overflow/underflow using DBL_MAX instead of HUGE_VAL */
-    if (value >= DBL_MAX || value <= -DBL_MAX) {
-        /* Check if this is actually zero or an error */
-        int is_zero = 1;
-        for (size_t i = 0; i < number_length; i++) {
-            if (number_string[i] != '0' && number_string[i] != '.' &&
-                number_string[i] != '-' && number_string[i] != '+') {
-                is_zero = 0;
-                break;
-            }
-        }
-        if (!is_zero) {
-            return MS_JSON_ERROR_SYNTAX;
-        }
+    *result = ms_json_create_string_owned(ctx->allocator, decoded, decoded_length);
+    if (!*result) {
+        ms_allocator_deallocate(ctx->allocator, decoded);
+        return MS_JSON_ERROR_MEMORY;
     }
 
-    *result = ms_json_create_number(ctx->allocator, value);
-    return *result ? MS_JSON_SUCCESS : MS_JSON_ERROR_MEMORY;
+    return MS_JSON_SUCCESS;
 }
 
-static ms_json_result_t parse_string(ms_json_parse_context_t* ctx, ms_json_value_t** result) {
-    if (!ctx || !result) {
-        return MS_JSON_ERROR_INVALID_ARGUMENT;
-    }
+static ms_json_result_t ms_json_parse_key(ms_json_parse_context_t* ctx, ms_json_key_buffer_t* key) {
+    size_t raw_start = 0;
+    size_t raw_length = 0;
+    int has_escapes = 0;
 
-    if (ctx->input[ctx->position] != '"') {
-        return MS_JSON_ERROR_SYNTAX;
+    key->heap = NULL;
+    ms_json_result_t scan_result = ms_json_scan_string(ctx, &raw_start, &raw_length, &has_escapes);
+    if (scan_result != MS_JSON_SUCCESS) {
+        return scan_result;
     }
 
-    // ДОБАВИТЬ ПРОВЕРКУ ДЛИНЫ СТРОКИ
-    if (ctx->length - ctx->position > MAX_STRING_LENGTH * 2) {
-        return MS_JSON_ERROR_SYNTAX; // Слишком длинная строка
+    /* Unescaped keys are used straight from the input */
+    key->chars = &ctx->input[raw_start];
+    key->length = raw_length;
+    if (!has_escapes) {
+        return MS_JSON_SUCCESS;
     }
 
-    ctx->position++; /* Skip opening quote */
-
-    char* parsed_string = ms_json_parse_string_content(ctx);
-    if (!parsed_string) {
-        return MS_JSON_ERROR_SYNTAX;
+    char* decoded = key->inline_buffer;
+    if (raw_length >= sizeof(key->inline_buffer)) {
+        if (ms_allocator_allocate(ctx->allocator, raw_length + 1, (void**)&key->heap) != MS_MEMORY_SUCCESS) {
+            return MS_JSON_ERROR_MEMORY;
+        }
+        decoded = key->heap;
     }
 
-    ms_json_result_t create_result = MS_JSON_SUCCESS;
-    *result = ms_json_create_string(ctx->allocator, parsed_string);
-
-    if (!*result) {
-        create_result = MS_JSON_ERROR_MEMORY;
+    if (!ms_json_decode_string(key->chars, raw_length, decoded, &key->length)) {
+        ms_json_release_key(ctx, key);
+        return MS_JSON_ERROR_SYNTAX;
     }
 
-    /* Always free the temporary string */
-    free(parsed_string);
-
-    return create_result;
+    key->chars = decoded;
+    return MS_JSON_SUCCESS;
 }
 
-static char* ms_json_parse_string_content(ms_json_parse_context_t* ctx) {
-    if (!ctx) {
-        return NULL;
+static void ms_json_release_key(ms_json_parse_context_t* ctx, ms_json_key_buffer_t* key) {
+    if (key->heap) {
+        ms_allocator_deallocate(ctx->allocator, key->heap);
+        key->heap = NULL;
     }
+}
 
-    size_t start = ctx->position;
-    size_t content_length = 0;
-    size_t max_content_length = (ctx->length - ctx->position < MAX_STRING_LENGTH) ?
-                               ctx->length - ctx->position : MAX_STRING_LENGTH;
-
-    /* Calculate content length with escape processing */
-    while (ctx->position < ctx->length &&
-           ctx->input[ctx->position] != '"' &&
-           content_length < max_content_length) {
-        if (ctx->input[ctx->position] == '\\') {
-            ctx->position++; /* Skip escape character */
-            if (ctx->position >= ctx->length) {
-                return NULL; /* Incomplete escape sequence */
-            }
-        }
-        ctx->position++;
-        content_length++;
-    }
+int ms_json_decode_string(const char* raw, size_t raw_length, char* output, size_t* output_length) {
+    size_t in = 0;
+    size_t out = 0;
 
-    if (ctx->position >= ctx->length || ctx->input[ctx->position] != '"') {
-        return NULL; /* Unclosed string */
-    }
+    while (in < raw_length) {
+        /* Copy the run up to the next escape in one go */
+        const char* escape = memchr(raw + in, '\\', raw_length - in);
+        size_t run = escape ? (size_t)(escape - (raw + in)) : raw_length - in;
+        memcpy(output + out, raw + in, run);
+        in += run;
+        out += run;
 
-    if (content_length >= MAX_STRING_LENGTH) {
-        return NULL; /* String too long */
-    }
+        if (in >= raw_length) {
+            break;
+        }
 
-    char* result_string = malloc(content_length + 1);
-    if (!result_string) {
-        return NULL;
-    }
+        if (in + 1 >= raw_length) {
+            return 0; /* Incomplete escape sequence */
+        }
 
-    if (!ms_json_copy_string_content(ctx, start, result_string, content_length)) {
-        free(result_string);
-        return NULL;
+        char escape_char = raw[in + 1];
+        in += 2;
+
+        switch (escape_char) {
+            case '"':  output[out++] = '"'; break;
+            case '\\': output[out++] = '\\'; break;
+            case '/':  output[out++] = '/'; break;
+            case 'b':  output[out++] = '\b'; break;
+            case 'f':  output[out++] = '\f'; break;
+            case 'n':  output[out++] = '\n'; break;
+            case 'r':  output[out++] = '\r'; break;
+            case 't':  output[out++] = '\t'; break;
+            case 'u': {
+                uint32_t code_point = 0;
+                if (!ms_json_decode_hex4(raw + in, raw_length - in, &code_point)) {
+                    return 0;
+                }
+                in += 4;
+
+                if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+                    uint32_t low = 0;
+                    if (in + 1 < raw_length && raw[in] == '\\' && raw[in + 1] == 'u' &&
+                        ms_json_decode_hex4(raw + in + 2, raw_length - in - 2, &low) &&
+                        low >= 0xDC00 && low <= 0xDFFF) {
+                        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                        in += 6;
+                    } else {
+                        code_point = UNICODE_REPLACEMENT_CHARACTER; /* Lone high surrogate */
+                    }
+                } else if (code_point >= 0xDC00 && code_point <= 0xDFFF) {
+                    code_point = UNICODE_REPLACEMENT_CHARACTER; /* Lone low surrogate */
+                }
+
+                out += ms_json_encode_utf8(code_point, output + out);
+                break;
+            }
+            default:
+                return 0; /* Invalid escape character */
+        }
     }
 
-    ctx->position++; /* Skip closing quote */
-    return result_string;
+    output[out] = '\0';
+    *output_length = out;
+    return 1;
 }
 
-static int ms_json_copy_string_content(ms_json_parse_context_t* ctx, size_t start, char* output, size_t max_len) {
-    if (!ctx || !output || start >= ctx->position) {
+static int ms_json_decode_hex4(const char* text, size_t available, uint32_t* code_point) {
+    if (available < 4) {
         return 0;
     }
 
-    size_t output_position = 0;
-
-    for (size_t i = start; i < ctx->position && output_position < max_len; i++) {
-        if (ctx->input[i] == '\\' && i + 1 < ctx->position) {
-            i++; /* Skip backslash */
-            output[output_position++] = ms_json_decode_escape(ctx->input[i]);
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4; i++) {
+        char c = text[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9') {
+            value |= (uint32_t)(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            value |= (uint32_t)(c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            value |= (uint32_t)(c - 'A' + 10);
         } else {
-            output[output_position++] = ctx->input[i];
+            return 0;
         }
     }
 
-    if (output_position > max_len) {
-        return 0; /* Buffer overflow */
-    }
-
-    output[output_position] = '\0';
+    *code_point = value;
     return 1;
 }
 
-static char ms_json_decode_escape(char escape_char) {
-    switch (escape_char) {
-        case '"': return '"';
-        case '\\': return '\\';
-        case '/': return '/';
-        case 'b': return '\b';
-        case 'f': return '\f';
-        case 'n': return '\n';
-        case 'r': return '\r';
-        case 't': return '\t';
-        default: return escape_char;
-    }
+static size_t ms_json_encode_utf8(uint32_t code_point, char* output) {
+    if (code_point < 0x80) {
+        output[0] = (char)code_point;
+        return 1;
+    }
+    if (code_point < 0x800) {
+        output[0] = (char)(0xC0 | (code_point >> 6));
+        output[1] = (char)(0x80 | (code_point & 0x3F));
+        return 2;
+    }
+    if (code_point < 0x10000) {
+        output[0] = (char)(0xE0 | (code_point >> 12));
+        output[1] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+        output[2] = (char)(0x80 | (code_point & 0x3F));
+        return 3;
+    }
+    output[0] = (char)(0xF0 | (code_point >> 18));
+    output[1] = (char)(0x80 | ((code_point >> 12) & 0x3F));
+    output[2] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+    output[3] = (char)(0x80 | (code_point & 0x3F));
+    return 4;
 }
 
 static ms_json_result_t parse_array(ms_json_parse_context_t* ctx, ms_json_value_t** result) {
@@ -510,7 +586,7 @@ static ms_json_result_t parse_object(ms_json_parse_context_t* ctx, ms_json_value
 
     ctx->position++; /* Skip '{' */
 
-    ms_json_value_t* object = ms_json_create_object(ctx->allocator);
+    ms_json_value_t* object = ms_json_create_object_interned(ctx->allocator, ctx->keys);
     if (!object) {
         ctx->depth--;
         return MS_JSON_ERROR_MEMORY;
@@ -548,26 +624,22 @@ static ms_json_result_t ms_json_parse_object_entries(ms_json_parse_context_t* ct
     }
 
     while (ctx->position < ctx->length) {
-        ms_json_value_t* key_value = NULL;
-        ms_json_result_t result = parse_string(ctx, &key_value);
+        ms_json_key_buffer_t key;
+        MS_INSTRUMENT_BEGIN(key_span, ctx->position);
+        ms_json_result_t result = ms_json_parse_key(ctx, &key);
+        MS_INSTRUMENT_END(key_span, MS_INSTRUMENT_STRING, ctx->position);
 
         if (result != MS_JSON_SUCCESS) {
             return result;
         }
 
-        const char* key = NULL;
-        if (ms_json_get_string(key_value, &key) != MS_JSON_SUCCESS) {
-            ms_json_destroy(key_value, ctx->allocator);
-            return MS_JSON_ERROR_SYNTAX;
-        }
-
         if (!ms_json_skip_whitespace_and_comments(ctx)) {
-            ms_json_destroy(key_value, ctx->allocator);
+            ms_json_release_key(ctx, &key);
             return MS_JSON_ERROR_SYNTAX;
         }
 
         if (!ms_json_expect_colon(ctx)) {
-            ms_json_destroy(key_value, ctx->allocator);
+            ms_json_release_key(ctx, &key);
             return MS_JSON_ERROR_SYNTAX;
         }
 
@@ -575,12 +647,12 @@ static ms_json_result_t ms_json_parse_object_entries(ms_json_parse_context_t* ct
         result = ms_json_parse_value(ctx, &value);
 
         if (result != MS_JSON_SUCCESS) {
-            ms_json_destroy(key_value, ctx->allocator);
+            ms_json_release_key(ctx, &key);
             return result;
         }
 
-        result = ms_json_object_set(object, key, value);
-        ms_json_destroy(key_value, ctx->allocator);
+        result = ms_json_object_set_n(object, key.chars, key.length, value);
+        ms_json_release_key(ctx, &key);
 
         if (result != MS_JSON_SUCCESS) {
             ms_json_destroy(value, ctx->allocator);
@@ -625,3 +697,300 @@ static int ms_json_expect_comma(ms_json_parse_context_t* ctx) {
     ctx->position++; /* Skip comma */
     return ms_json_skip_whitespace_and_comments(ctx);
 }
+
+/* SAX parsing: same grammar as above, reporting events instead of building values */
+ms_json_result_t ms_json_sax_parse_value(ms_json_parse_context_t* ctx, const ms_json_sax_handler_t* handler,
+                                         void* user_ctx) {
+    if (!ctx || !handler) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (!ms_json_skip_whitespace_and_comments(ctx)) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    if (ctx->position >= ctx->length) {
+        return MS_JSON_ERROR_EOF;
+    }
+
+    ms_json_result_t result;
+
+    switch (ctx->input[ctx->position]) {
+        case 'n':
+            result = ms_json_expect_literal(ctx, "null", NULL_LENGTH);
+            if (result == MS_JSON_SUCCESS && handler->null_value) {
+                result = handler->null_value(user_ctx);
+            }
+            return result;
+        case 't':
+            result = ms_json_expect_literal(ctx, "true", TRUE_LENGTH);
+            if (result == MS_JSON_SUCCESS && handler->boolean) {
+                result = handler->boolean(user_ctx, 1);
+            }
+            return result;
+        case 'f':
+            result = ms_json_expect_literal(ctx, "false", FALSE_LENGTH);
+            if (result == MS_JSON_SUCCESS && handler->boolean) {
+                result = handler->boolean(user_ctx, 0);
+            }
+            return result;
+        case '"': {
+            /* Strings reuse the key buffer: borrowed unless escaped */
+            ms_json_key_buffer_t text;
+            result = ms_json_parse_key(ctx, &text);
+            if (result == MS_JSON_SUCCESS) {
+                if (handler->string) {
+                    result = handler->string(user_ctx, text.chars, text.length);
+                }
+                ms_json_release_key(ctx, &text);
+            }
+            return result;
+        }
+        case '[': return sax_array(ctx, handler, user_ctx);
+        case '{': return sax_object(ctx, handler, user_ctx);
+        default:
+            if (isdigit((unsigned char)ctx->input[ctx->position]) || ctx->input[ctx->position] == '-') {
+                return sax_number(ctx, handler, user_ctx);
+            }
+            return MS_JSON_ERROR_SYNTAX;
+    }
+}
+
+/* Same errors as parse_null() and parse_boolean(): EOF only when the input
+ * ends within the first 4 bytes, so a truncated "fals" is a syntax error */
+static ms_json_result_t ms_json_expect_literal(ms_json_parse_context_t* ctx, const char* literal,
+                                               size_t literal_length) {
+    if (ctx->position + TRUE_LENGTH > ctx->length) {
+        return MS_JSON_ERROR_EOF;
+    }
+
+    if (ctx->position + literal_length > ctx->length ||
+        memcmp(&ctx->input[ctx->position], literal, literal_length) != 0) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    ctx->position += literal_length;
+    return MS_JSON_SUCCESS;
+}
+
+static ms_json_result_t sax_number(ms_json_parse_context_t* ctx, const ms_json_sax_handler_t* handler,
+                                   void* user_ctx) {
+    ms_json_number_t number;
+    size_t consumed = 0;
+    ms_json_result_t result = ms_json_parse_number_text(&ctx->input[ctx->position],
+                                                        ctx->length - ctx->position,
+                                                        &consumed, &number);
+    if (result != MS_JSON_SUCCESS) {
+        return result;
+    }
+    ctx->position += consumed;
+
+    if (number.is_integer && handler->integer) {
+        return handler->integer(user_ctx, number.integer);
+    }
+    return handler->number ? handler->number(user_ctx, number.number) : MS_JSON_SUCCESS;
+}
+
+static ms_json_result_t sax_array(ms_json_parse_context_t* ctx, const ms_json_sax_handler_t* handler,
+                                  void* user_ctx) {
+    if (ctx->options.max_depth > 0 && ctx->depth >= ctx->options.max_depth) {
+        return MS_JSON_ERROR_DEPTH;
+    }
+
+    ctx->position++; /* Skip '[' */
+    if (handler->start_array) {
+        ms_json_result_t result = handler->start_array(user_ctx);
+        if (result != MS_JSON_SUCCESS) {
+            return result;
+        }
+    }
+
+    if (!ms_json_skip_whitespace_and_comments(ctx)) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    int done = ctx->position < ctx->length && ctx->input[ctx->position] == ']';
+    if (done) {
+        ctx->position++; /* Empty array */
+    }
+
+    ctx->depth++;
+    while (!done) {
+        ms_json_result_t result = ms_json_sax_parse_value(ctx, handler, user_ctx);
+        if (result == MS_JSON_SUCCESS) {
+            result = sax_after_element(ctx, ']', &done);
+        }
+        if (result != MS_JSON_SUCCESS) {
+            ctx->depth--;
+            return result;
+        }
+    }
+    ctx->depth--;
+
+    return handler->end_array ? handler->end_array(user_ctx) : MS_JSON_SUCCESS;
+}
+
+static ms_json_result_t sax_object(ms_json_parse_context_t* ctx, const ms_json_sax_handler_t* handler,
+                                   void* user_ctx) {
+    if (ctx->options.max_depth > 0 && ctx->depth >= ctx->options.max_depth) {
+        return MS_JSON_ERROR_DEPTH;
+    }
+
+    ctx->position++; /* Skip '{' */
+    if (handler->start_object) {
+        ms_json_result_t result = handler->start_object(user_ctx);
+        if (result != MS_JSON_SUCCESS) {
+            return result;
+        }
+    }
+
+    if (!ms_json_skip_whitespace_and_comments(ctx)) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    int done = ctx->position < ctx->length && ctx->input[ctx->position] == '}';
+    if (done) {
+        ctx->position++; /* Empty object */
+    }
+
+    ctx->depth++;
+    while (!done) {
+        ms_json_key_buffer_t key;
+        ms_json_result_t result = ctx->position < ctx->length ? ms_json_parse_key(ctx, &key)
+                                                              : MS_JSON_ERROR_EOF;
+        if (result == MS_JSON_SUCCESS) {
+            if (handler->key) {
+                result = handler->key(user_ctx, key.chars, key.length);
+            }
+            ms_json_release_key(ctx, &key);
+        }
+
+        if (result == MS_JSON_SUCCESS) {
+            if (!ms_json_skip_whitespace_and_comments(ctx) || !ms_json_expect_colon(ctx)) {
+                result = MS_JSON_ERROR_SYNTAX;
+            }
+        }
+
+        if (result == MS_JSON_SUCCESS) {
+            result = ms_json_sax_parse_value(ctx, handler, user_ctx);
+        }
+        if (result == MS_JSON_SUCCESS) {
+            result = sax_after_element(ctx, '}', &done);
+        }
+        if (result != MS_JSON_SUCCESS) {
+            ctx->depth--;
+            return result;
+        }
+    }
+    ctx->depth--;
+
+    return handler->end_object ? handler->end_object(user_ctx) : MS_JSON_SUCCESS;
+}
+
+/* Consume the separator after an element, setting done at the closing bracket */
+static ms_json_result_t sax_after_element(ms_json_parse_context_t* ctx, char closing, int* done) {
+    if (!ms_json_skip_whitespace_and_comments(ctx)) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    if (ctx->position >= ctx->length) {
+        return MS_JSON_ERROR_EOF;
+    }
+
+    if (ctx->input[ctx->position] == closing) {
+        ctx->position++;
+        *done = 1;
+        return MS_JSON_SUCCESS;
+    }
+
+    return ms_json_expect_comma(ctx) ? MS_JSON_SUCCESS : MS_JSON_ERROR_SYNTAX;
+}
+
+/* Skipping: step over a value while tracking only strings and bracket nesting */
+ms_json_result_t ms_json_skip_value(ms_json_parse_context_t* ctx) {
+    if (!ms_json_skip_whitespace_and_comments(ctx)) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    if (ctx->position >= ctx->length) {
+        return MS_JSON_ERROR_EOF;
+    }
+
+    char current_char = ctx->input[ctx->position];
+    if (current_char != '{' && current_char != '[') {
+        return ms_json_skip_scalar(ctx);
+    }
+
+    size_t nesting = 0;
+    while (ctx->position < ctx->length) {
+        size_t raw_start = 0;
+        size_t raw_length = 0;
+        int has_escapes = 0;
+        ms_json_result_t result = MS_JSON_SUCCESS;
+
+        switch (ctx->input[ctx->position]) {
+            case '"':
+                result = ms_json_scan_string(ctx, &raw_start, &raw_length, &has_escapes);
+                if (result != MS_JSON_SUCCESS) {
+                    return result;
+                }
+                continue;
+            case '{':
+            case '[':
+                nesting++;
+                if (ctx->options.max_depth > 0 && ctx->depth + nesting > ctx->options.max_depth) {
+                    return MS_JSON_ERROR_DEPTH;
+                }
+                break;
+            case '}':
+            case ']':
+                if (--nesting == 0) {
+                    ctx->position++;
+                    return MS_JSON_SUCCESS;
+                }
+                break;
+            case '/':
+                if (ctx->options.allow_comments) {
+                    size_t start = ctx->position;
+                    if (!ms_json_skip_whitespace_and_comments(ctx) || ctx->position == start) {
+                        return MS_JSON_ERROR_SYNTAX;
+                    }
+                    continue;
+                }
+                break;
+            default:
+                break;
+        }
+        ctx->position++;
+    }
+
+    return MS_JSON_ERROR_EOF;
+}
+
+static ms_json_result_t ms_json_skip_scalar(ms_json_parse_context_t* ctx) {
+    size_t raw_start = 0;
+    size_t raw_length = 0;
+    int has_escapes = 0;
+
+    switch (ctx->input[ctx->position]) {
+        case '"': return ms_json_scan_string(ctx, &raw_start, &raw_length, &has_escapes);
+        case 'n': return ms_json_expect_literal(ctx, "null", NULL_LENGTH);
+        case 't': return ms_json_expect_literal(ctx, "true", TRUE_LENGTH);
+        case 'f': return ms_json_expect_literal(ctx, "false", FALSE_LENGTH);
+        default:
+            break;
+    }
+
+    /* Numbers are not converted, only checked to consist of number characters */
+    size_t start = ctx->position;
+    while (ctx->position < ctx->length) {
+        char current_char = ctx->input[ctx->position];
+        if (!isdigit((unsigned char)current_char) && current_char != '-' && current_char != '+' &&
+            current_char != '.' && current_char != 'e' && current_char != 'E') {
+            break;
+        }
+        ctx->position++;
+    }
+
+    return ctx->position > start ? MS_JSON_SUCCESS : MS_JSON_ERROR_SYNTAX;
+}
@@ -7,6 +7,7 @@
 #define MS_JSON_PARSER_H
 
 #include "ms_json.h"
+#include "ms_json_sax.h"
 
 /**
  * @brief JSON parsing context structure
@@ -18,8 +19,26 @@ typedef struct ms_json_parse_context {
     ms_json_options_t options;  /**< Parsing options */
     ms_allocator_t* allocator;  /**< Allocator to use */
     size_t depth;               /**< Current nesting depth */
+    ms_json_key_table_t* keys;  /**< Table object keys are interned into, or NULL */
+    struct ms_json_parse_scratch* scratch; /**< Buffers kept across parses, or NULL */
 } ms_json_parse_context_t;
 
+/**
+ * @brief Parse a complete document of known length
+ *
+ * Same as ms_json_parse() but input need not be NUL-terminated.
+ */
+ms_json_result_t ms_json_parse_buffer(const char* input, size_t length, const ms_json_options_t* options,
+                                      ms_json_value_t** result);
+
+/**
+ * @brief Parse the document described by an initialized context
+ *
+ * Picks the engine from ctx->options. A preset ctx->keys is used as is;
+ * otherwise a key table is acquired from the options for this document.
+ */
+ms_json_result_t ms_json_parse_document(ms_json_parse_context_t* ctx, ms_json_value_t** result);
+
 /**
  * @brief Parse any JSON value from context
  */
@@ -30,4 +49,109 @@ ms_json_result_t ms_json_parse_value(ms_json_parse_context_t* ctx, ms_json_value
  */
 int ms_json_skip_whitespace_and_comments(ms_json_parse_context_t* ctx);
 
+/**
+ * @brief Step over one value without building it
+ *
+ * Allocates nothing and converts nothing: inside a skipped value only
+ * string termination and bracket nesting are checked, so malformed content
+ * such as a missing comma is not reported.
+ */
+ms_json_result_t ms_json_skip_value(ms_json_parse_context_t* ctx);
+
+/**
+ * @brief Scan the string starting at ctx->position up to its closing quote
+ *
+ * @param raw_start Output parameter for the offset of the first content byte
+ * @param raw_length Output parameter for the content length, still escaped
+ * @param has_escapes Output parameter set when the content contains escapes
+ */
+ms_json_result_t ms_json_scan_string(ms_json_parse_context_t* ctx, size_t* raw_start, size_t* raw_length,
+                                     int* has_escapes);
+
+/**
+ * @brief Parse any JSON value from context, reporting it to handler
+ */
+ms_json_result_t ms_json_sax_parse_value(ms_json_parse_context_t* ctx, const ms_json_sax_handler_t* handler,
+                                         void* user_ctx);
+
+/**
+ * @brief Incremental parser handle
+ *
+ * Accepts a document in arbitrary chunks, e.g. as it arrives from a socket,
+ * without buffering the whole input. Strings are always copied, so zero_copy
+ * is ignored and chunks may be reused as soon as feed returns.
+ *
+ * The same handle also parses complete documents with ms_json_parser_parse(),
+ * keeping its options, key table and scratch buffers from one document to
+ * the next, so a server can parse every request without setup cost.
+ */
+typedef struct ms_json_parser ms_json_parser_t;
+
+/**
+ * @brief Create an incremental parser
+ *
+ * @param options Parsing options (copied), NULL for defaults
+ * @return New parser, NULL if allocation failed
+ */
+ms_json_parser_t* ms_json_parser_create(const ms_json_options_t* options);
+
+/**
+ * @brief Create a parser that builds every tree in an arena it owns
+ *
+ * The arena is reset when the next document starts, by ms_json_parser_parse()
+ * or by the first feed after ms_json_parser_finish(), and destroyed with the
+ * parser, so a tree stays valid only until then; ms_json_destroy() on it is
+ * a no-op. options->allocator, if set, still holds the parser's own buffers.
+ *
+ * @param options Parsing options (copied), NULL for defaults
+ * @param chunk_size Arena chunk size, 0 for the arena default
+ * @return New parser, NULL if allocation failed
+ */
+ms_json_parser_t* ms_json_parser_create_arena(const ms_json_options_t* options, size_t chunk_size);
+
+/**
+ * @brief Parse one complete document with the parser's retained state
+ *
+ * Same result as ms_json_parse_n() with the parser's options, but the
+ * structural index, nesting stack and key decode buffer are reused from
+ * earlier calls instead of allocated each time.
+ *
+ * @param parser Parser with no fed document in progress
+ * @param input JSON text, need not be NUL-terminated
+ * @param length Length of input in bytes
+ * @param result Output parameter for the root value
+ * @return MS_JSON_ERROR_INVALID_ARGUMENT if a fed document is unfinished,
+ *         otherwise as ms_json_parse_n()
+ */
+ms_json_result_t ms_json_parser_parse(ms_json_parser_t* parser, const char* input, size_t length,
+                                      ms_json_value_t** result);
+
+/**
+ * @brief Feed the next chunk of the document
+ *
+ * Tokens may be split anywhere across chunks.
+ *
+ * @return MS_JSON_SUCCESS if the input so far is a valid prefix; on error the
+ *         partial tree is freed and the same error is returned until finish
+ */
+ms_json_result_t ms_json_parser_feed(ms_json_parser_t* parser, const char* chunk, size_t length);
+
+/**
+ * @brief Signal end of input and take the parsed value
+ *
+ * Resets the parser so it can be fed the next document.
+ *
+ * @param result Output parameter for the root value, owned by the caller
+ * @return MS_JSON_SUCCESS on success, MS_JSON_ERROR_EOF if the document is
+ *         incomplete, or the error a previous feed reported; input that ends
+ *         in a misspelled literal ("fals") or a key without its colon is
+ *         MS_JSON_ERROR_SYNTAX, as ms_json_parse() reports it
+ */
+ms_json_result_t ms_json_parser_finish(ms_json_parser_t* parser, ms_json_value_t** result);
+
+/**
+ * @brief Destroy parser and any partial tree it holds
+ */
+void ms_json_parser_destroy(ms_json_parser_t* parser);
+
 #endif
@@ -0,0 +1,438 @@
+/**
+ * @file ms_json_path.c
+ * @brief JSON Pointer compilation, tree lookup and raw-input extraction
+ *
+ * Raw extraction walks the input with the parser's tokenizer, carrying the
+ * set of paths that still match the current location as a bit mask. A value
+ * that no remaining path goes through is skipped with ms_json_skip_value(),
+ * and a value some path ends at is parsed with ms_json_parse_value().
+ */
+
+#include "ms_json_path.h"
+#include "ms_json_parser.h"
+#include "ms_json_internal.h"
+#include <stdint.h>
+#include <string.h>
+
+/* Configuration constants */
+#define PATH_NO_INDEX SIZE_MAX      /* Token that is not an array index */
+#define PATH_KEY_BUFFER_SIZE 256    /* Escaped input keys below this size decode on the stack */
+
+typedef struct {
+    const char* key;     /* Unescaped, NUL-terminated */
+    size_t key_length;
+    uint32_t hash;
+    size_t index;        /* PATH_NO_INDEX unless the token is a valid array index */
+} ms_json_path_token_t;
+
+struct ms_json_path {
+    ms_allocator_t* allocator;
+    size_t count;
+    ms_json_path_token_t* tokens;  /* Followed by the key bytes, in the same block */
+};
+
+typedef struct {
+    ms_json_parse_context_t ctx;
+    const ms_json_path_t* const* paths;
+    ms_json_value_t** results;
+    uint64_t pending;  /* Paths not found yet */
+} ms_json_extract_state_t;
+
+/* Internal helper functions */
+static size_t ms_json_path_parse_index(const char* token, size_t length);
+static ms_json_result_t ms_json_path_walk(ms_json_extract_state_t* state, size_t depth, uint64_t active);
+static ms_json_result_t ms_json_path_walk_object(ms_json_extract_state_t* state, size_t depth, uint64_t active);
+static ms_json_result_t ms_json_path_walk_array(ms_json_extract_state_t* state, size_t depth, uint64_t active);
+static uint64_t ms_json_path_match_key(const ms_json_extract_state_t* state, size_t depth, uint64_t active,
+                                       const char* key, size_t key_length);
+static ms_json_result_t ms_json_path_after_element(ms_json_parse_context_t* ctx, char closing, int* done);
+
+ms_json_result_t ms_json_path_compile(const char* pointer, ms_allocator_t* allocator, ms_json_path_t** result) {
+    if (!pointer || !result) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+    *result = NULL;
+
+    if (*pointer != '\0' && *pointer != '/') {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    size_t text_length = strlen(pointer);
+    size_t count = 0;
+    for (size_t i = 0; i < text_length; i++) {
+        count += pointer[i] == '/';
+    }
+
+    if (!allocator) {
+        allocator = ms_allocator_default();
+    }
+
+    /* Unescaped keys are never longer than the pointer, and each gains a NUL in place of its '/' */
+    ms_json_path_t* path = NULL;
+    size_t size = sizeof(*path) + count * sizeof(ms_json_path_token_t) + text_length + 1;
+    if (ms_allocator_allocate(allocator, size, (void**)&path) != MS_MEMORY_SUCCESS) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    path->allocator = allocator;
+    path->count = count;
+    path->tokens = (ms_json_path_token_t*)(path + 1);
+    char* keys = (char*)(path->tokens + count);
+
+    const char* cursor = pointer;
+    for (size_t t = 0; t < count; t++) {
+        cursor++; /* Skip '/' */
+        char* key = keys;
+        while (*cursor != '\0' && *cursor != '/') {
+            if (*cursor == '~') {
+                if (cursor[1] != '0' && cursor[1] != '1') {
+                    ms_allocator_deallocate(allocator, path);
+                    return MS_JSON_ERROR_SYNTAX;
+                }
+                *keys++ = cursor[1] == '0' ? '~' : '/';
+                cursor += 2;
+            } else {
+                *keys++ = *cursor++;
+            }
+        }
+
+        ms_json_path_token_t* token = &path->tokens[t];
+        token->key = key;
+        token->key_length = (size_t)(keys - key);
+        token->hash = ms_json_hash_key(key, token->key_length);
+        token->index = ms_json_path_parse_index(key, token->key_length);
+        *keys++ = '\0';
+    }
+
+    *result = path;
+    return MS_JSON_SUCCESS;
+}
+
+void ms_json_path_destroy(ms_json_path_t* path) {
+    if (path) {
+        ms_allocator_deallocate(path->allocator, path);
+    }
+}
+
+size_t ms_json_path_length(const ms_json_path_t* path) {
+    return path ? path->count : 0;
+}
+
+/* Array index per RFC 6901: "0" or digits without a leading zero */
+static size_t ms_json_path_parse_index(const char* token, size_t length) {
+    if (length == 0 || (token[0] == '0' && length > 1)) {
+        return PATH_NO_INDEX;
+    }
+
+    size_t index = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (token[i] < '0' || token[i] > '9') {
+            return PATH_NO_INDEX;
+        }
+        size_t digit = (size_t)(token[i] - '0');
+        if (index > (PATH_NO_INDEX - 1 - digit) / 10) {
+            return PATH_NO_INDEX;
+        }
+        index = index * 10 + digit;
+    }
+    return index;
+}
+
+ms_json_result_t ms_json_path_eval(const ms_json_path_t* path, const ms_json_value_t* root,
+                                   ms_json_value_t** result) {
+    if (!path || !root || !result) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    const ms_json_value_t* value = root;
+    for (size_t t = 0; t < path->count; t++) {
+        const ms_json_path_token_t* token = &path->tokens[t];
+        ms_json_type_t type = ms_json_value_get_type(value);
+        if (type != MS_JSON_OBJECT && type != MS_JSON_ARRAY) {
+            return MS_JSON_ERROR_INVALID_ARGUMENT;
+        }
+
+        ms_json_result_t status = ms_json_value_resolve(value);
+        if (status != MS_JSON_SUCCESS) {
+            return status;
+        }
+
+        if (type == MS_JSON_OBJECT) {
+            const ms_json_object_entry_t* entry = ms_json_object_find(ms_json_value_get_object_const(value),
+                                                                      token->key, token->key_length,
+                                                                      token->hash);
+            if (!entry) {
+                return MS_JSON_ERROR_INVALID_ARGUMENT;
+            }
+            value = entry->value;
+        } else {
+            const ms_json_array_t* array = ms_json_value_get_array_const(value);
+            if (token->index >= array->count) {
+                return MS_JSON_ERROR_INVALID_ARGUMENT;
+            }
+            value = array->items[token->index];
+        }
+    }
+
+    *result = (ms_json_value_t*)value;
+    return MS_JSON_SUCCESS;
+}
+
+ms_json_result_t ms_json_path_extract(const ms_json_path_t* path, const char* input, size_t length,
+                                      const ms_json_options_t* options, ms_json_value_t** result) {
+    if (!result) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    ms_json_result_t status = ms_json_path_extract_many(&path, 1, input, length, options, result);
+    if (status == MS_JSON_SUCCESS && !*result) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+    return status;
+}
+
+ms_json_result_t ms_json_path_extract_many(const ms_json_path_t* const* paths, size_t count, const char* input,
+                                           size_t length, const ms_json_options_t* options,
+                                           ms_json_value_t** results) {
+    if (!paths || !results || count == 0 || count > MS_JSON_PATH_MAX_BATCH || (!input && length > 0)) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (!paths[i]) {
+            return MS_JSON_ERROR_INVALID_ARGUMENT;
+        }
+        results[i] = NULL;
+    }
+
+    ms_json_extract_state_t state;
+    state.ctx.input = input;
+    state.ctx.position = 0;
+    state.ctx.length = length;
+    state.ctx.depth = 0;
+    state.ctx.keys = NULL;
+    state.ctx.scratch = NULL;
+    if (options) {
+        state.ctx.options = *options;
+    } else {
+        state.ctx.options = (ms_json_options_t){0};
+        state.ctx.options.max_depth = MS_JSON_MAX_DEPTH_DEFAULT;
+    }
+    state.ctx.allocator = state.ctx.options.allocator ? state.ctx.options.allocator : ms_allocator_default();
+    state.paths = paths;
+    state.results = results;
+    state.pending = count == 64 ? UINT64_MAX : (UINT64_C(1) << count) - 1;
+
+    ms_json_result_t status = ms_json_path_walk(&state, 0, state.pending);
+
+    /* A document read to the end is checked for trailing content like a full parse */
+    if (status == MS_JSON_SUCCESS && state.pending &&
+        (!ms_json_skip_whitespace_and_comments(&state.ctx) || state.ctx.position < length)) {
+        status = MS_JSON_ERROR_SYNTAX;
+    }
+    if (status != MS_JSON_SUCCESS) {
+        for (size_t i = 0; i < count; i++) {
+            if (results[i]) {
+                ms_json_destroy(results[i], state.ctx.allocator);
+                results[i] = NULL;
+            }
+        }
+    }
+    return status;
+}
+
+/* Walk the value at ctx->position; active holds the pending paths that match the location so far */
+static ms_json_result_t ms_json_path_walk(ms_json_extract_state_t* state, size_t depth, uint64_t active) {
+    ms_json_parse_context_t* ctx = &state->ctx;
+    if (!ms_json_skip_whitespace_and_comments(ctx)) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    if (ctx->position >= ctx->length) {
+        return MS_JSON_ERROR_EOF;
+    }
+
+    /* Each path ending here parses its own copy, so every result is owned separately */
+    size_t start = ctx->position;
+    size_t end = start;
+    for (uint64_t bits = active; bits; bits &= bits - 1) {
+        size_t i = (size_t)__builtin_ctzll(bits);
+        if (state->paths[i]->count == depth) {
+            ctx->position = start;
+            ms_json_result_t status = ms_json_parse_value(ctx, &state->results[i]);
+            if (status != MS_JSON_SUCCESS) {
+                return status;
+            }
+            end = ctx->position;
+            active &= ~(UINT64_C(1) << i);
+            state->pending &= ~(UINT64_C(1) << i);
+        }
+    }
+
+    if (end != start) {
+        if (!active) {
+            return MS_JSON_SUCCESS;
+        }
+        ctx->position = start;
+    }
+
+    switch (active ? ctx->input[ctx->position] : '\0') {
+        case '{': return ms_json_path_walk_object(state, depth, active);
+        case '[': return ms_json_path_walk_array(state, depth, active);
+        default: return ms_json_skip_value(ctx);
+    }
+}
+
+static ms_json_result_t ms_json_path_walk_object(ms_json_extract_state_t* state, size_t depth, uint64_t active) {
+    ms_json_parse_context_t* ctx = &state->ctx;
+    if (ctx->options.max_depth > 0 && ctx->depth >= ctx->options.max_depth) {
+        return MS_JSON_ERROR_DEPTH;
+    }
+
+    ctx->position++; /* Skip '{' */
+    if (!ms_json_skip_whitespace_and_comments(ctx)) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    int done = ctx->position < ctx->length && ctx->input[ctx->position] == '}';
+    if (done) {
+        ctx->position++; /* Empty object */
+    }
+
+    ctx->depth++;
+    ms_json_result_t status = MS_JSON_SUCCESS;
+    while (!done && status == MS_JSON_SUCCESS) {
+        size_t raw_start = 0;
+        size_t raw_length = 0;
+        int has_escapes = 0;
+        status = ctx->position < ctx->length ? ms_json_scan_string(ctx, &raw_start, &raw_length, &has_escapes)
+                                             : MS_JSON_ERROR_EOF;
+        if (status != MS_JSON_SUCCESS) {
+            break;
+        }
+
+        uint64_t matching = 0;
+        const char* raw = &ctx->input[raw_start];
+        if (!has_escapes) {
+            matching = ms_json_path_match_key(state, depth, active & state->pending, raw, raw_length);
+        } else if (raw_length < PATH_KEY_BUFFER_SIZE) {
+            char decoded[PATH_KEY_BUFFER_SIZE];
+            size_t decoded_length = 0;
+            if (!ms_json_decode_string(raw, raw_length, decoded, &decoded_length)) {
+                status = MS_JSON_ERROR_SYNTAX;
+                break;
+            }
+            matching = ms_json_path_match_key(state, depth, active & state->pending, decoded, decoded_length);
+        } else {
+            char* decoded = NULL;
+            size_t decoded_length = 0;
+            if (ms_allocator_allocate(ctx->allocator, raw_length + 1, (void**)&decoded) != MS_MEMORY_SUCCESS) {
+                status = MS_JSON_ERROR_MEMORY;
+                break;
+            }
+            if (ms_json_decode_string(raw, raw_length, decoded, &decoded_length)) {
+                matching = ms_json_path_match_key(state, depth, active & state->pending, decoded, decoded_length);
+            } else {
+                status = MS_JSON_ERROR_SYNTAX;
+            }
+            ms_allocator_deallocate(ctx->allocator, decoded);
+            if (status != MS_JSON_SUCCESS) {
+                break;
+            }
+        }
+
+        if (!ms_json_skip_whitespace_and_comments(ctx) || ctx->position >= ctx->length ||
+            ctx->input[ctx->position] != ':') {
+            status = MS_JSON_ERROR_SYNTAX;
+            break;
+        }
+        ctx->position++; /* Skip ':' */
+
+        status = matching ? ms_json_path_walk(state, depth + 1, matching) : ms_json_skip_value(ctx);
+        if (status == MS_JSON_SUCCESS && state->pending) {
+            status = ms_json_path_after_element(ctx, '}', &done);
+        } else {
+            done = 1; /* Every path found: stop reading */
+        }
+    }
+    ctx->depth--;
+
+    return status;
+}
+
+static ms_json_result_t ms_json_path_walk_array(ms_json_extract_state_t* state, size_t depth, uint64_t active) {
+    ms_json_parse_context_t* ctx = &state->ctx;
+    if (ctx->options.max_depth > 0 && ctx->depth >= ctx->options.max_depth) {
+        return MS_JSON_ERROR_DEPTH;
+    }
+
+    ctx->position++; /* Skip '[' */
+    if (!ms_json_skip_whitespace_and_comments(ctx)) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    int done = ctx->position < ctx->length && ctx->input[ctx->position] == ']';
+    if (done) {
+        ctx->position++; /* Empty array */
+    }
+
+    ctx->depth++;
+    ms_json_result_t status = MS_JSON_SUCCESS;
+    for (size_t index = 0; !done && status == MS_JSON_SUCCESS; index++) {
+        uint64_t matching = 0;
+        for (uint64_t bits = active & state->pending; bits; bits &= bits - 1) {
+            size_t i = (size_t)__builtin_ctzll(bits);
+            if (state->paths[i]->tokens[depth].index == index) {
+                matching |= UINT64_C(1) << i;
+            }
+        }
+
+        status = matching ? ms_json_path_walk(state, depth + 1, matching) : ms_json_skip_value(ctx);
+        if (status == MS_JSON_SUCCESS && state->pending) {
+            status = ms_json_path_after_element(ctx, ']', &done);
+        } else {
+            done = 1; /* Every path found: stop reading */
+        }
+    }
+    ctx->depth--;
+
+    return status;
+}
+
+/* Subset of active whose token at depth equals key */
+static uint64_t ms_json_path_match_key(const ms_json_extract_state_t* state, size_t depth, uint64_t active,
+                                       const char* key, size_t key_length) {
+    uint64_t matching = 0;
+    for (uint64_t bits = active; bits; bits &= bits - 1) {
+        size_t i = (size_t)__builtin_ctzll(bits);
+        const ms_json_path_token_t* token = &state->paths[i]->tokens[depth];
+        if (token->key_length == key_length && memcmp(token->key, key, key_length) == 0) {
+            matching |= UINT64_C(1) << i;
+        }
+    }
+    return matching;
+}
+
+/* Consume the separator after an element, setting done at the closing bracket */
+static ms_json_result_t ms_json_path_after_element(ms_json_parse_context_t* ctx, char closing, int* done) {
+    if (!ms_json_skip_whitespace_and_comments(ctx)) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    if (ctx->position >= ctx->length) {
+        return MS_JSON_ERROR_EOF;
+    }
+
+    if (ctx->input[ctx->position] == closing) {
+        ctx->position++;
+        *done = 1;
+        return MS_JSON_SUCCESS;
+    }
+
+    if (ctx->input[ctx->position] != ',') {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    ctx->position++; /* Skip comma */
+    return ms_json_skip_whitespace_and_comments(ctx) ? MS_JSON_SUCCESS : MS_JSON_ERROR_SYNTAX;
+}
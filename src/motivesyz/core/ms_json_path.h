@@ -0,0 +1,102 @@
+/*
+ * @file ms_json_path.h
+ * @brief Precompiled JSON Pointer queries
+ */
+
+#ifndef MS_JSON_PATH_H
+#define MS_JSON_PATH_H
+
+#include "ms_json_types.h"
+#include <stddef.h>
+
+/* Most paths one ms_json_path_extract_many() call can look up */
+#define MS_JSON_PATH_MAX_BATCH 64
+
+/**
+ * @brief Compiled JSON Pointer (RFC 6901), opaque
+ *
+ * Compiling splits the pointer into reference tokens once, unescapes "~0"
+ * and "~1", and stores each token's key hash and array index, so evaluating
+ * the same path against many documents repeats none of that work.
+ */
+typedef struct ms_json_path ms_json_path_t;
+
+/**
+ * @brief Compile a JSON Pointer such as "/items/3/price"
+ *
+ * The empty pointer "" selects the whole document.
+ *
+ * @param pointer NUL-terminated pointer text
+ * @param allocator Allocator for the compiled path (NULL for default)
+ * @param result Output parameter, freed with ms_json_path_destroy()
+ * @return MS_JSON_SUCCESS, MS_JSON_ERROR_SYNTAX if pointer is not empty and
+ *         does not start with '/' or holds an invalid '~' escape, or
+ *         MS_JSON_ERROR_MEMORY
+ */
+ms_json_result_t ms_json_path_compile(const char* pointer, ms_allocator_t* allocator, ms_json_path_t** result);
+
+/**
+ * @brief Free a compiled path
+ */
+void ms_json_path_destroy(ms_json_path_t* path);
+
+/**
+ * @brief Number of reference tokens in a path
+ */
+size_t ms_json_path_length(const ms_json_path_t* path);
+
+/**
+ * @brief Find the value a path selects in a parsed tree
+ *
+ * @param path Compiled path
+ * @param root Tree to search
+ * @param result Output parameter for the value, owned by root
+ * @return MS_JSON_SUCCESS, or MS_JSON_ERROR_INVALID_ARGUMENT if the path
+ *         selects nothing
+ */
+ms_json_result_t ms_json_path_eval(const ms_json_path_t* path, const ms_json_value_t* root,
+                                   ms_json_value_t** result);
+
+/**
+ * @brief Parse only the value a path selects straight from JSON text
+ *
+ * No tree is built for the rest of the document: values off the path are
+ * skipped without allocating, and reading stops as soon as the target has
+ * been parsed. The price is validation: skipped values are only checked for
+ * terminated strings and balanced brackets, and the input after the target
+ * is not read at all, so a malformed document can still yield a result.
+ * Where an object repeats a key, the first occurrence is taken, whereas a
+ * parsed tree keeps the last.
+ *
+ * @param path Compiled path
+ * @param input JSON text, need not be NUL-terminated
+ * @param length Length of input in bytes
+ * @param options Parsing options for the target value, NULL for defaults
+ * @param result Output parameter for the value, owned by the caller
+ * @return MS_JSON_SUCCESS, MS_JSON_ERROR_INVALID_ARGUMENT if the path
+ *         selects nothing, or the error met before the target was parsed
+ */
+ms_json_result_t ms_json_path_extract(const ms_json_path_t* path, const char* input, size_t length,
+                                      const ms_json_options_t* options, ms_json_value_t** result);
+
+/**
+ * @brief Parse the values of several paths in one pass over JSON text
+ *
+ * Same rules as ms_json_path_extract(); reading stops once every path has
+ * been found. Paths that select nothing leave their result NULL.
+ *
+ * @param paths Compiled paths, at most MS_JSON_PATH_MAX_BATCH
+ * @param count Number of paths
+ * @param input JSON text, need not be NUL-terminated
+ * @param length Length of input in bytes
+ * @param options Parsing options for the target values, NULL for defaults
+ * @param results Output array of count values, owned by the caller
+ * @return MS_JSON_SUCCESS even if some paths were not found, otherwise the
+ *         error met before the last target was parsed; results are all NULL
+ *         on error
+ */
+ms_json_result_t ms_json_path_extract_many(const ms_json_path_t* const* paths, size_t count, const char* input,
+                                           size_t length, const ms_json_options_t* options,
+                                           ms_json_value_t** results);
+
+#endif /* MS_JSON_PATH_H */
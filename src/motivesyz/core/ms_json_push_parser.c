@@ -0,0 +1,697 @@
+/**
+ * @file ms_json_push_parser.c
+ * @brief Incremental JSON parser fed with arbitrary chunks
+ *
+ * A byte-driven tokenizer feeds a grammar state machine that keeps its
+ * nesting on an explicit stack, so parsing can stop at any chunk boundary
+ * and resume with the next chunk. Tokens that straddle a boundary are
+ * carried over in a small buffer; tokens that fit in one chunk are handled
+ * in place. Containers are linked into the tree as soon as they open, so
+ * the partial tree is always fully owned and freed in one go on error.
+ */
+
+#include "ms_json_parser.h"
+#include "ms_json_structural.h"
+#include "ms_json_builder.h"
+#include "ms_json_keys.h"
+#include "ms_json_internal.h"
+#include "ms_json_number.h"
+#include "ms_json_scan.h"
+#include <string.h>
+
+/* Configuration constants */
+#define PUSH_INITIAL_FRAMES 16
+#define PUSH_INITIAL_BUFFER 64
+#define PUSH_MAX_LITERAL_LENGTH 5   /* "false" */
+#define PUSH_MIN_LITERAL_LENGTH 4   /* Shorter at end of input is EOF, as in the eager engines */
+
+/* Tokenizer states between feed calls */
+typedef enum {
+    LEX_BETWEEN_TOKENS = 0,
+    LEX_STRING,
+    LEX_NUMBER,
+    LEX_LITERAL,
+    LEX_COMMENT_START,
+    LEX_LINE_COMMENT,
+    LEX_BLOCK_COMMENT,
+    LEX_BLOCK_COMMENT_STAR
+} ms_json_lex_state_t;
+
+/* What the grammar accepts next */
+typedef enum {
+    EXPECT_VALUE = 0,
+    EXPECT_VALUE_OR_END,     /* Right after '[' */
+    EXPECT_KEY,              /* After ',' in an object */
+    EXPECT_KEY_OR_END,       /* Right after '{' */
+    EXPECT_COLON,
+    EXPECT_COMMA_OR_END,
+    EXPECT_DONE              /* Top-level value complete */
+} ms_json_expect_t;
+
+/* Open container on the explicit nesting stack */
+typedef struct {
+    ms_json_value_t* container;  /* Owned by the tree, not by the frame */
+    int is_object;
+} ms_json_push_frame_t;
+
+/* Growable byte buffer for carried-over tokens and the pending key */
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} ms_json_push_buffer_t;
+
+struct ms_json_parser {
+    ms_json_options_t options;
+    ms_allocator_t* allocator;          /* Parser state and buffers */
+    ms_allocator_t* tree_allocator;     /* Values: allocator, or arena when owned */
+    ms_allocator_t* arena;              /* Owned, reset per document; NULL if none */
+    int document_open;                  /* A fed document has started */
+    ms_json_parse_scratch_t scratch;    /* Structural engine buffers for parse calls */
+    ms_json_result_t error;             /* Sticky once a feed fails */
+
+    /* Tokenizer */
+    ms_json_lex_state_t lex_state;
+    int string_is_key;
+    int string_has_escapes;
+    int escape_pending;                 /* Chunk ended right after a backslash */
+    ms_json_push_buffer_t token;
+
+    /* Grammar */
+    ms_json_expect_t expect;
+    ms_json_push_frame_t* frames;
+    size_t depth;
+    size_t frame_capacity;
+    ms_json_push_buffer_t key;          /* At most one key waits for its value */
+    ms_json_value_t* root;
+    ms_json_key_table_t* keys;          /* Shared by every document of the parser */
+};
+
+/* Forward declarations */
+static ms_json_result_t ms_json_push_fail(ms_json_parser_t* parser, ms_json_result_t error);
+static void ms_json_push_discard(ms_json_parser_t* parser);
+static ms_json_result_t ms_json_push_buffer_append(ms_json_parser_t* parser, ms_json_push_buffer_t* buffer,
+                                                   const char* data, size_t length);
+static ms_json_result_t ms_json_push_structural(ms_json_parser_t* parser, char c);
+static ms_json_result_t ms_json_push_begin_token(ms_json_parser_t* parser, char c);
+static ms_json_result_t ms_json_push_lex_string(ms_json_parser_t* parser, const char* chunk,
+                                                size_t length, size_t* position);
+static ms_json_result_t ms_json_push_lex_run(ms_json_parser_t* parser, const char* chunk,
+                                             size_t length, size_t* position);
+static ms_json_result_t ms_json_push_lex_comment(ms_json_parser_t* parser, const char* chunk,
+                                                 size_t length, size_t* position);
+static ms_json_result_t ms_json_push_complete_token(ms_json_parser_t* parser, const char* text,
+                                                    size_t length);
+static ms_json_result_t ms_json_push_complete_string(ms_json_parser_t* parser, const char* raw,
+                                                     size_t raw_length);
+static ms_json_result_t ms_json_push_attach(ms_json_parser_t* parser, ms_json_value_t* value);
+static ms_json_result_t ms_json_push_open(ms_json_parser_t* parser, int is_object);
+static ms_json_result_t ms_json_push_close(ms_json_parser_t* parser, int is_object);
+
+static inline int ms_json_push_is_number_char(char c) {
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+static inline int ms_json_push_is_literal_char(char c) {
+    return c >= 'a' && c <= 'z';
+}
+
+static inline int ms_json_push_expects_value(const ms_json_parser_t* parser) {
+    return parser->expect == EXPECT_VALUE || parser->expect == EXPECT_VALUE_OR_END;
+}
+
+ms_json_parser_t* ms_json_parser_create(const ms_json_options_t* options) {
+    ms_json_options_t parser_options = {0};
+    if (options) {
+        parser_options = *options;
+    } else {
+        parser_options.max_depth = MS_JSON_MAX_DEPTH_DEFAULT;
+    }
+
+    ms_allocator_t* allocator = parser_options.allocator ? parser_options.allocator : ms_allocator_default();
+
+    ms_json_parser_t* parser = NULL;
+    if (ms_allocator_allocate(allocator, sizeof(ms_json_parser_t), (void**)&parser) != MS_MEMORY_SUCCESS) {
+        return NULL;
+    }
+
+    memset(parser, 0, sizeof(*parser));
+    parser->options = parser_options;
+    parser->allocator = allocator;
+    parser->tree_allocator = allocator;
+    parser->error = MS_JSON_SUCCESS;
+    ms_json_parse_scratch_init(&parser->scratch);
+    parser->lex_state = LEX_BETWEEN_TOKENS;
+    parser->expect = EXPECT_VALUE;
+
+    if (ms_json_key_table_acquire(&parser_options, allocator, &parser->keys) != MS_JSON_SUCCESS) {
+        ms_allocator_deallocate(allocator, parser);
+        return NULL;
+    }
+    return parser;
+}
+
+ms_json_parser_t* ms_json_parser_create_arena(const ms_json_options_t* options, size_t chunk_size) {
+    ms_json_parser_t* parser = ms_json_parser_create(options);
+    if (!parser) {
+        return NULL;
+    }
+
+    parser->arena = ms_allocator_create_arena(chunk_size);
+    if (!parser->arena) {
+        ms_json_parser_destroy(parser);
+        return NULL;
+    }
+    parser->tree_allocator = parser->arena;
+    return parser;
+}
+
+ms_json_result_t ms_json_parser_parse(ms_json_parser_t* parser, const char* input, size_t length,
+                                      ms_json_value_t** result) {
+    if (!parser || (!input && length > 0) || !result || parser->document_open) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    *result = NULL;
+    if (parser->arena) {
+        ms_allocator_reset(parser->arena);
+    }
+
+    ms_json_parse_context_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.input = input;
+    ctx.length = length;
+    ctx.options = parser->options;
+    ctx.allocator = parser->tree_allocator;
+    ctx.keys = parser->keys;
+    ctx.scratch = &parser->scratch;
+    return ms_json_parse_document(&ctx, result);
+}
+
+void ms_json_parser_destroy(ms_json_parser_t* parser) {
+    if (!parser) {
+        return;
+    }
+
+    ms_json_push_discard(parser);
+    ms_allocator_deallocate(parser->allocator, parser->frames);
+    ms_allocator_deallocate(parser->allocator, parser->token.data);
+    ms_allocator_deallocate(parser->allocator, parser->key.data);
+    ms_json_key_table_release(parser->keys);
+    ms_json_parse_scratch_release(&parser->scratch);
+    ms_allocator_destroy(parser->arena);
+    ms_allocator_deallocate(parser->allocator, parser);
+}
+
+ms_json_result_t ms_json_parser_feed(ms_json_parser_t* parser, const char* chunk, size_t length) {
+    if (!parser || (!chunk && length > 0)) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (parser->error != MS_JSON_SUCCESS) {
+        return parser->error;
+    }
+
+    /* The previous document's tree goes with the arena reset */
+    if (!parser->document_open) {
+        if (parser->arena) {
+            ms_allocator_reset(parser->arena);
+        }
+        parser->document_open = 1;
+    }
+
+    size_t position = 0;
+    while (position < length) {
+        ms_json_result_t result = MS_JSON_SUCCESS;
+
+        switch (parser->lex_state) {
+            case LEX_BETWEEN_TOKENS: {
+                position = ms_json_scan_whitespace(chunk, position, length);
+                if (position >= length) {
+                    break;
+                }
+                char c = chunk[position++];
+                result = ms_json_push_structural(parser, c);
+                break;
+            }
+            case LEX_STRING:
+                result = ms_json_push_lex_string(parser, chunk, length, &position);
+                break;
+            case LEX_NUMBER:
+            case LEX_LITERAL:
+                result = ms_json_push_lex_run(parser, chunk, length, &position);
+                break;
+            default:
+                result = ms_json_push_lex_comment(parser, chunk, length, &position);
+                break;
+        }
+
+        if (result != MS_JSON_SUCCESS) {
+            return ms_json_push_fail(parser, result);
+        }
+    }
+
+    return MS_JSON_SUCCESS;
+}
+
+ms_json_result_t ms_json_parser_finish(ms_json_parser_t* parser, ms_json_value_t** result) {
+    if (!parser || !result) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    *result = NULL;
+    ms_json_result_t status = parser->error;
+
+    /* End of input terminates a trailing number or literal */
+    if (status == MS_JSON_SUCCESS &&
+        (parser->lex_state == LEX_NUMBER || parser->lex_state == LEX_LITERAL)) {
+        /* "nul", "[fal" are truncated; "fals", like "nulx", is misspelled */
+        if (parser->lex_state == LEX_LITERAL && parser->token.length < PUSH_MIN_LITERAL_LENGTH) {
+            status = MS_JSON_ERROR_EOF;
+        } else {
+            status = ms_json_push_complete_token(parser, parser->token.data, parser->token.length);
+        }
+        parser->token.length = 0;
+        parser->lex_state = LEX_BETWEEN_TOKENS;
+    }
+
+    if (status == MS_JSON_SUCCESS) {
+        if (parser->lex_state == LEX_LINE_COMMENT) {
+            parser->lex_state = LEX_BETWEEN_TOKENS;
+        }
+        if (parser->lex_state == LEX_BETWEEN_TOKENS && parser->expect == EXPECT_COLON) {
+            status = MS_JSON_ERROR_SYNTAX; /* A key with no colon, as the eager engines see it */
+        } else if (parser->lex_state != LEX_BETWEEN_TOKENS || parser->expect != EXPECT_DONE) {
+            status = MS_JSON_ERROR_EOF;
+        }
+    }
+
+    if (status == MS_JSON_SUCCESS) {
+        *result = parser->root;
+        parser->root = NULL;
+    }
+
+    /* Ready for the next document either way */
+    ms_json_push_discard(parser);
+    parser->error = MS_JSON_SUCCESS;
+    parser->document_open = 0;
+    return status;
+}
+
+/* Record a failure and drop the partial tree; later calls report the same error */
+static ms_json_result_t ms_json_push_fail(ms_json_parser_t* parser, ms_json_result_t error) {
+    ms_json_push_discard(parser);
+    parser->error = error;
+    return error;
+}
+
+/* Drop the partial tree and return to the initial state, keeping buffers */
+static void ms_json_push_discard(ms_json_parser_t* parser) {
+    if (parser->root) {
+        ms_json_destroy(parser->root, parser->tree_allocator);
+        parser->root = NULL;
+    }
+    parser->depth = 0;
+    parser->expect = EXPECT_VALUE;
+    parser->lex_state = LEX_BETWEEN_TOKENS;
+    parser->escape_pending = 0;
+    parser->token.length = 0;
+    parser->key.length = 0;
+}
+
+static ms_json_result_t ms_json_push_buffer_append(ms_json_parser_t* parser, ms_json_push_buffer_t* buffer,
+                                                   const char* data, size_t length) {
+    if (buffer->length + length + 1 > buffer->capacity) {
+        size_t new_capacity = buffer->capacity ? buffer->capacity * 2 : PUSH_INITIAL_BUFFER;
+        while (new_capacity < buffer->length + length + 1) {
+            new_capacity *= 2;
+        }
+
+        char* new_data = NULL;
+        if (ms_allocator_reallocate(parser->allocator, buffer->data, new_capacity,
+                                    (void**)&new_data) != MS_MEMORY_SUCCESS) {
+            return MS_JSON_ERROR_MEMORY;
+        }
+        buffer->data = new_data;
+        buffer->capacity = new_capacity;
+    }
+
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+    return MS_JSON_SUCCESS;
+}
+
+/* Handle one significant character outside any token */
+static ms_json_result_t ms_json_push_structural(ms_json_parser_t* parser, char c) {
+    switch (c) {
+        case '{':
+        case '[':
+            if (!ms_json_push_expects_value(parser)) {
+                return MS_JSON_ERROR_SYNTAX;
+            }
+            return ms_json_push_open(parser, c == '{');
+
+        case '}':
+            if (parser->expect != EXPECT_KEY_OR_END && parser->expect != EXPECT_COMMA_OR_END) {
+                return MS_JSON_ERROR_SYNTAX;
+            }
+            return ms_json_push_close(parser, 1);
+
+        case ']':
+            if (parser->expect != EXPECT_VALUE_OR_END && parser->expect != EXPECT_COMMA_OR_END) {
+                return MS_JSON_ERROR_SYNTAX;
+            }
+            return ms_json_push_close(parser, 0);
+
+        case ',':
+            if (parser->expect != EXPECT_COMMA_OR_END) {
+                return MS_JSON_ERROR_SYNTAX;
+            }
+            parser->expect = parser->frames[parser->depth - 1].is_object ? EXPECT_KEY : EXPECT_VALUE;
+            return MS_JSON_SUCCESS;
+
+        case ':':
+            if (parser->expect != EXPECT_COLON) {
+                return MS_JSON_ERROR_SYNTAX;
+            }
+            parser->expect = EXPECT_VALUE;
+            return MS_JSON_SUCCESS;
+
+        case '/':
+            if (!parser->options.allow_comments) {
+                return MS_JSON_ERROR_SYNTAX;
+            }
+            parser->lex_state = LEX_COMMENT_START;
+            return MS_JSON_SUCCESS;
+
+        default:
+            return ms_json_push_begin_token(parser, c);
+    }
+}
+
+static ms_json_result_t ms_json_push_begin_token(ms_json_parser_t* parser, char c) {
+    if (c == '"') {
+        if (parser->expect == EXPECT_KEY || parser->expect == EXPECT_KEY_OR_END) {
+            parser->string_is_key = 1;
+        } else if (ms_json_push_expects_value(parser)) {
+            parser->string_is_key = 0;
+        } else {
+            return MS_JSON_ERROR_SYNTAX;
+        }
+        parser->string_has_escapes = 0;
+        parser->escape_pending = 0;
+        parser->lex_state = LEX_STRING;
+        return MS_JSON_SUCCESS;
+    }
+
+    if (!ms_json_push_expects_value(parser)) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    /* Numbers and literals keep their first character in the token buffer */
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        parser->lex_state = LEX_NUMBER;
+    } else if (c == 't' || c == 'f' || c == 'n') {
+        parser->lex_state = LEX_LITERAL;
+    } else {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    return ms_json_push_buffer_append(parser, &parser->token, &c, 1);
+}
+
+static ms_json_result_t ms_json_push_lex_string(ms_json_parser_t* parser, const char* chunk,
+                                                size_t length, size_t* position) {
+    size_t start = *position;
+    size_t cursor = start;
+
+    for (;;) {
+        if (parser->escape_pending) {
+            if (cursor >= length) {
+                break;
+            }
+            cursor++; /* Escaped character; validated when the string is decoded */
+            parser->escape_pending = 0;
+        }
+
+        cursor = ms_json_scan_string_delimiter(chunk, cursor, length);
+        if (cursor >= length) {
+            break;
+        }
+
+        if (chunk[cursor] == '\\') {
+            parser->string_has_escapes = 1;
+            parser->escape_pending = 1;
+            cursor++;
+            continue;
+        }
+
+        /* Closing quote: finish in place unless earlier chunks hold a prefix */
+        ms_json_result_t result;
+        *position = cursor + 1;
+        parser->lex_state = LEX_BETWEEN_TOKENS;
+
+        if (parser->token.length == 0) {
+            if (cursor - start > MS_JSON_MAX_STRING_LENGTH) {
+                return MS_JSON_ERROR_SYNTAX;
+            }
+            return ms_json_push_complete_string(parser, chunk + start, cursor - start);
+        }
+
+        result = ms_json_push_buffer_append(parser, &parser->token, chunk + start, cursor - start);
+        if (result == MS_JSON_SUCCESS) {
+            result = parser->token.length > MS_JSON_MAX_STRING_LENGTH
+                         ? MS_JSON_ERROR_SYNTAX
+                         : ms_json_push_complete_string(parser, parser->token.data, parser->token.length);
+        }
+        parser->token.length = 0;
+        return result;
+    }
+
+    /* Chunk ended inside the string */
+    *position = length;
+    if (parser->token.length + (length - start) > MS_JSON_MAX_STRING_LENGTH) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+    return ms_json_push_buffer_append(parser, &parser->token, chunk + start, length - start);
+}
+
+/* Numbers and literals: a run of characters ended by anything else */
+static ms_json_result_t ms_json_push_lex_run(ms_json_parser_t* parser, const char* chunk,
+                                             size_t length, size_t* position) {
+    int is_number = parser->lex_state == LEX_NUMBER;
+    size_t start = *position;
+    size_t cursor = start;
+
+    while (cursor < length &&
+           (is_number ? ms_json_push_is_number_char(chunk[cursor]) : ms_json_push_is_literal_char(chunk[cursor]))) {
+        cursor++;
+    }
+
+    if (!is_number && parser->token.length + (cursor - start) > PUSH_MAX_LITERAL_LENGTH) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    ms_json_result_t result = ms_json_push_buffer_append(parser, &parser->token, chunk + start, cursor - start);
+    *position = cursor;
+    if (result != MS_JSON_SUCCESS || cursor >= length) {
+        return result; /* Token may continue in the next chunk */
+    }
+
+    parser->lex_state = LEX_BETWEEN_TOKENS;
+    result = ms_json_push_complete_token(parser, parser->token.data, parser->token.length);
+    parser->token.length = 0;
+    return result;
+}
+
+static ms_json_result_t ms_json_push_lex_comment(ms_json_parser_t* parser, const char* chunk,
+                                                 size_t length, size_t* position) {
+    size_t cursor = *position;
+
+    switch (parser->lex_state) {
+        case LEX_COMMENT_START:
+            if (chunk[cursor] == '/') {
+                parser->lex_state = LEX_LINE_COMMENT;
+            } else if (chunk[cursor] == '*') {
+                parser->lex_state = LEX_BLOCK_COMMENT;
+            } else {
+                return MS_JSON_ERROR_SYNTAX;
+            }
+            cursor++;
+            break;
+
+        case LEX_LINE_COMMENT: {
+            const char* newline = memchr(chunk + cursor, '\n', length - cursor);
+            if (newline) {
+                cursor = (size_t)(newline - chunk) + 1;
+                parser->lex_state = LEX_BETWEEN_TOKENS;
+            } else {
+                cursor = length;
+            }
+            break;
+        }
+
+        case LEX_BLOCK_COMMENT_STAR:
+            parser->lex_state = chunk[cursor] == '/' ? LEX_BETWEEN_TOKENS
+                              : chunk[cursor] == '*' ? LEX_BLOCK_COMMENT_STAR
+                                                     : LEX_BLOCK_COMMENT;
+            cursor++;
+            break;
+
+        default: {
+            const char* star = memchr(chunk + cursor, '*', length - cursor);
+            if (star) {
+                cursor = (size_t)(star - chunk) + 1;
+                parser->lex_state = LEX_BLOCK_COMMENT_STAR;
+            } else {
+                cursor = length;
+            }
+            break;
+        }
+    }
+
+    *position = cursor;
+    return MS_JSON_SUCCESS;
+}
+
+/* Turn a complete number or literal into a value */
+static ms_json_result_t ms_json_push_complete_token(ms_json_parser_t* parser, const char* text,
+                                                    size_t length) {
+    ms_json_value_t* value = NULL;
+
+    if (text[0] == '-' || (text[0] >= '0' && text[0] <= '9')) {
+        ms_json_number_t number;
+        size_t consumed = 0;
+        ms_json_result_t result = ms_json_parse_number_text(text, length, &consumed, &number);
+        if (result != MS_JSON_SUCCESS) {
+            return result;
+        }
+        if (consumed != length) {
+            return MS_JSON_ERROR_SYNTAX;
+        }
+        value = number.is_integer ? ms_json_create_integer(parser->tree_allocator, number.integer)
+                                  : ms_json_create_number(parser->tree_allocator, number.number);
+    } else if (length == 4 && memcmp(text, "null", 4) == 0) {
+        value = ms_json_create_null(parser->tree_allocator);
+    } else if (length == 4 && memcmp(text, "true", 4) == 0) {
+        value = ms_json_create_bool(parser->tree_allocator, 1);
+    } else if (length == 5 && memcmp(text, "false", 5) == 0) {
+        value = ms_json_create_bool(parser->tree_allocator, 0);
+    } else {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    if (!value) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+    return ms_json_push_attach(parser, value);
+}
+
+static ms_json_result_t ms_json_push_complete_string(ms_json_parser_t* parser, const char* raw,
+                                                     size_t raw_length) {
+    /* Keys wait in the key buffer until their value arrives */
+    if (parser->string_is_key) {
+        parser->key.length = 0;
+        ms_json_result_t result = ms_json_push_buffer_append(parser, &parser->key, raw, raw_length);
+        if (result != MS_JSON_SUCCESS) {
+            return result;
+        }
+        /* raw never aliases the key buffer, so decoding can overwrite the copy */
+        if (parser->string_has_escapes &&
+            !ms_json_decode_string(raw, raw_length, parser->key.data, &parser->key.length)) {
+            return MS_JSON_ERROR_SYNTAX;
+        }
+        parser->expect = EXPECT_COLON;
+        return MS_JSON_SUCCESS;
+    }
+
+    ms_json_value_t* value = NULL;
+    if (!parser->string_has_escapes) {
+        value = ms_json_create_string_n(parser->tree_allocator, raw, raw_length);
+    } else {
+        char* decoded = NULL;
+        if (ms_allocator_allocate(parser->tree_allocator, raw_length + 1, (void**)&decoded) != MS_MEMORY_SUCCESS) {
+            return MS_JSON_ERROR_MEMORY;
+        }
+        size_t decoded_length = 0;
+        if (!ms_json_decode_string(raw, raw_length, decoded, &decoded_length)) {
+            ms_allocator_deallocate(parser->tree_allocator, decoded);
+            return MS_JSON_ERROR_SYNTAX;
+        }
+        value = ms_json_create_string_owned(parser->tree_allocator, decoded, decoded_length);
+        if (!value) {
+            ms_allocator_deallocate(parser->tree_allocator, decoded);
+        }
+    }
+
+    if (!value) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+    return ms_json_push_attach(parser, value);
+}
+
+/* Link a finished value into its parent; the tree owns it from here on */
+static ms_json_result_t ms_json_push_attach(ms_json_parser_t* parser, ms_json_value_t* value) {
+    ms_json_result_t result = MS_JSON_SUCCESS;
+
+    if (parser->depth == 0) {
+        parser->root = value;
+    } else {
+        ms_json_push_frame_t* parent = &parser->frames[parser->depth - 1];
+        result = parent->is_object
+                     ? ms_json_object_set_n(parent->container, parser->key.data, parser->key.length, value)
+                     : ms_json_array_append(parent->container, value);
+        if (result != MS_JSON_SUCCESS) {
+            ms_json_destroy(value, parser->tree_allocator);
+            return result;
+        }
+    }
+
+    parser->expect = parser->depth == 0 ? EXPECT_DONE : EXPECT_COMMA_OR_END;
+    return MS_JSON_SUCCESS;
+}
+
+static ms_json_result_t ms_json_push_open(ms_json_parser_t* parser, int is_object) {
+    if (parser->options.max_depth > 0 && parser->depth >= parser->options.max_depth) {
+        return MS_JSON_ERROR_DEPTH;
+    }
+
+    if (parser->depth == parser->frame_capacity) {
+        size_t new_capacity = parser->frame_capacity ? parser->frame_capacity * 2 : PUSH_INITIAL_FRAMES;
+        ms_json_push_frame_t* new_frames = NULL;
+        if (ms_allocator_reallocate(parser->allocator, parser->frames, new_capacity * sizeof(*new_frames),
+                                    (void**)&new_frames) != MS_MEMORY_SUCCESS) {
+            return MS_JSON_ERROR_MEMORY;
+        }
+        parser->frames = new_frames;
+        parser->frame_capacity = new_capacity;
+    }
+
+    ms_json_value_t* container = is_object
+                                     ? ms_json_create_object_interned(parser->tree_allocator, parser->keys)
+                                     : ms_json_create_array(parser->tree_allocator);
+    if (!container) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    ms_json_result_t result = ms_json_push_attach(parser, container);
+    if (result != MS_JSON_SUCCESS) {
+        return result;
+    }
+
+    parser->frames[parser->depth].container = container;
+    parser->frames[parser->depth].is_object = is_object;
+    parser->depth++;
+    parser->expect = is_object ? EXPECT_KEY_OR_END : EXPECT_VALUE_OR_END;
+    return MS_JSON_SUCCESS;
+}
+
+static ms_json_result_t ms_json_push_close(ms_json_parser_t* parser, int is_object) {
+    if (parser->depth == 0 || parser->frames[parser->depth - 1].is_object != is_object) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    parser->depth--;
+    parser->expect = parser->depth == 0 ? EXPECT_DONE : EXPECT_COMMA_OR_END;
+    return MS_JSON_SUCCESS;
+}
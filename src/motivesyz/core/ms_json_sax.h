@@ -0,0 +1,58 @@
+/*
+ * @file ms_json_sax.h
+ * @brief Event-driven JSON parsing without building a tree
+ */
+
+#ifndef MS_JSON_SAX_H
+#define MS_JSON_SAX_H
+
+#include "ms_json_types.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Parse event callbacks
+ *
+ * Every callback is optional; events with a NULL callback are skipped, so a
+ * zeroed handler just validates the input. Returning anything other than
+ * MS_JSON_SUCCESS stops parsing and that result is returned to the caller.
+ *
+ * String and key pointers are borrowed: they point into the input, or into
+ * a scratch buffer when the text had escapes, and are valid only for the
+ * duration of the callback. They are not NUL-terminated.
+ */
+typedef struct ms_json_sax_handler {
+    ms_json_result_t (*null_value)(void* user_ctx);
+    ms_json_result_t (*boolean)(void* user_ctx, int value);
+    ms_json_result_t (*integer)(void* user_ctx, int64_t value);  /**< NULL reports integers through number */
+    ms_json_result_t (*number)(void* user_ctx, double value);
+    ms_json_result_t (*string)(void* user_ctx, const char* value, size_t length);
+    ms_json_result_t (*key)(void* user_ctx, const char* key, size_t length);
+    ms_json_result_t (*start_object)(void* user_ctx);
+    ms_json_result_t (*end_object)(void* user_ctx);
+    ms_json_result_t (*start_array)(void* user_ctx);
+    ms_json_result_t (*end_array)(void* user_ctx);
+} ms_json_sax_handler_t;
+
+/**
+ * @brief Parse a document and report it as a stream of events
+ *
+ * Uses the same grammar, limits and options as ms_json_parse(); allocator
+ * is only needed for escaped strings too long for the inline scratch buffer
+ * and zero_copy has no effect. Memory use is proportional to nesting depth.
+ *
+ * @param input JSON text, need not be NUL-terminated
+ * @param length Length of input in bytes
+ * @param options Parsing options, NULL for defaults
+ * @param handler Event callbacks, NULL to only validate
+ * @param user_ctx Passed to every callback
+ *
+ * @return MS_JSON_SUCCESS if the whole input is one valid document, a parse
+ *         error, or the first non-success result returned by a callback
+ *
+ * @note Events already delivered before an error are not retracted
+ */
+ms_json_result_t ms_json_parse_sax(const char* input, size_t length, const ms_json_options_t* options,
+                                   const ms_json_sax_handler_t* handler, void* user_ctx);
+
+#endif
@@ -0,0 +1,386 @@
+/**
+ * @file ms_json_scan.c
+ * @brief Vectorised whitespace and string delimiter scanning
+ *
+ * Each kernel compares a whole block against the characters of interest and
+ * turns the result into a bit mask, so a block without a hit costs a handful
+ * of instructions regardless of width. The final partial block is always
+ * finished by the scalar loop, so no kernel reads past the input.
+ */
+
+#include "ms_json_scan.h"
+#include "ms_platform.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__SSE2__)
+#define MS_JSON_SCAN_SSE2 1
+#include <emmintrin.h>
+#if defined(__x86_64__) || defined(__i386__)
+#define MS_JSON_SCAN_AVX2 1
+#include <immintrin.h>
+#endif
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__ARM_NEON)
+#define MS_JSON_SCAN_NEON 1
+#include <arm_neon.h>
+#endif
+
+typedef size_t (*ms_json_scan_fn)(const char* input, size_t position, size_t length);
+typedef void (*ms_json_classify_fn)(const char* block, ms_json_block_masks_t* masks);
+
+typedef struct {
+    ms_json_scan_fn whitespace;
+    ms_json_scan_fn delimiter;
+    ms_json_classify_fn classify;
+    const char* name;
+} ms_json_scan_kernel_t;
+
+/* Forward declarations */
+static const ms_json_scan_kernel_t* ms_json_scan_select_kernel(void);
+static size_t scan_whitespace_scalar(const char* input, size_t position, size_t length);
+static size_t scan_delimiter_scalar(const char* input, size_t position, size_t length);
+static void classify_block_scalar(const char* block, ms_json_block_masks_t* masks);
+
+static inline int ms_json_is_whitespace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static size_t scan_whitespace_scalar(const char* input, size_t position, size_t length) {
+    while (position < length && ms_json_is_whitespace(input[position])) {
+        position++;
+    }
+    return position;
+}
+
+static size_t scan_delimiter_scalar(const char* input, size_t position, size_t length) {
+    while (position < length && input[position] != '"' && input[position] != '\\') {
+        position++;
+    }
+    return position;
+}
+
+static void classify_block_scalar(const char* block, ms_json_block_masks_t* masks) {
+    uint64_t quote = 0;
+    uint64_t backslash = 0;
+    uint64_t operators = 0;
+    uint64_t whitespace = 0;
+
+    for (int i = 0; i < MS_JSON_SCAN_BLOCK_SIZE; i++) {
+        uint64_t bit = (uint64_t)1 << i;
+        switch (block[i]) {
+            case '"': quote |= bit; break;
+            case '\\': backslash |= bit; break;
+            case '{': case '}': case '[': case ']': case ':': case ',': operators |= bit; break;
+            case ' ': case '\t': case '\n': case '\r': whitespace |= bit; break;
+            default: break;
+        }
+    }
+
+    masks->quote = quote;
+    masks->backslash = backslash;
+    masks->operators = operators;
+    masks->whitespace = whitespace;
+}
+
+static const ms_json_scan_kernel_t scan_kernel_scalar = {
+    scan_whitespace_scalar, scan_delimiter_scalar, classify_block_scalar, "scalar"
+};
+
+#ifdef MS_JSON_SCAN_SSE2
+static size_t scan_whitespace_sse2(const char* input, size_t position, size_t length) {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i carriage = _mm_set1_epi8('\r');
+
+    while (position + 16 <= length) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(input + position));
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, space), _mm_cmpeq_epi8(block, tab)),
+                                   _mm_or_si128(_mm_cmpeq_epi8(block, newline), _mm_cmpeq_epi8(block, carriage)));
+        unsigned int mask = ~(unsigned int)_mm_movemask_epi8(hit) & 0xFFFFu;
+        if (mask != 0) {
+            return position + (size_t)__builtin_ctz(mask);
+        }
+        position += 16;
+    }
+    return scan_whitespace_scalar(input, position, length);
+}
+
+static size_t scan_delimiter_sse2(const char* input, size_t position, size_t length) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+
+    while (position + 16 <= length) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(input + position));
+        __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(hit);
+        if (mask != 0) {
+            return position + (size_t)__builtin_ctz(mask);
+        }
+        position += 16;
+    }
+    return scan_delimiter_scalar(input, position, length);
+}
+
+static void classify_block_sse2(const char* block, ms_json_block_masks_t* masks) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i case_bit = _mm_set1_epi8(0x20);  /* Folds '[' onto '{' and ']' onto '}' */
+    const __m128i open_brace = _mm_set1_epi8('{');
+    const __m128i close_brace = _mm_set1_epi8('}');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i carriage = _mm_set1_epi8('\r');
+
+    ms_json_block_masks_t result = {0, 0, 0, 0};
+    for (int i = 0; i < MS_JSON_SCAN_BLOCK_SIZE / 16; i++) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(block + 16 * i));
+        __m128i folded = _mm_or_si128(chunk, case_bit);
+        __m128i operators = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(folded, open_brace),
+                                                      _mm_cmpeq_epi8(folded, close_brace)),
+                                         _mm_or_si128(_mm_cmpeq_epi8(chunk, colon), _mm_cmpeq_epi8(chunk, comma)));
+        __m128i whitespace = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+                                          _mm_or_si128(_mm_cmpeq_epi8(chunk, newline),
+                                                       _mm_cmpeq_epi8(chunk, carriage)));
+        int shift = 16 * i;
+        result.quote |= (uint64_t)(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)) << shift;
+        result.backslash |= (uint64_t)(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash)) << shift;
+        result.operators |= (uint64_t)(unsigned int)_mm_movemask_epi8(operators) << shift;
+        result.whitespace |= (uint64_t)(unsigned int)_mm_movemask_epi8(whitespace) << shift;
+    }
+    *masks = result;
+}
+
+static const ms_json_scan_kernel_t scan_kernel_sse2 = {
+    scan_whitespace_sse2, scan_delimiter_sse2, classify_block_sse2, "sse2"
+};
+#endif /* MS_JSON_SCAN_SSE2 */
+
+#ifdef MS_JSON_SCAN_AVX2
+__attribute__((target("avx2")))
+static size_t scan_whitespace_avx2(const char* input, size_t position, size_t length) {
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i carriage = _mm256_set1_epi8('\r');
+
+    while (position + 32 <= length) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(input + position));
+        __m256i hit = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, space), _mm256_cmpeq_epi8(block, tab)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, newline), _mm256_cmpeq_epi8(block, carriage)));
+        unsigned int mask = ~(unsigned int)_mm256_movemask_epi8(hit);
+        if (mask != 0) {
+            return position + (size_t)__builtin_ctz(mask);
+        }
+        position += 32;
+    }
+    return scan_whitespace_sse2(input, position, length);
+}
+
+__attribute__((target("avx2")))
+static size_t scan_delimiter_avx2(const char* input, size_t position, size_t length) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+
+    while (position + 32 <= length) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(input + position));
+        __m256i hit = _mm256_or_si256(_mm256_cmpeq_epi8(block, quote), _mm256_cmpeq_epi8(block, backslash));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(hit);
+        if (mask != 0) {
+            return position + (size_t)__builtin_ctz(mask);
+        }
+        position += 32;
+    }
+    return scan_delimiter_sse2(input, position, length);
+}
+
+__attribute__((target("avx2")))
+static void classify_block_avx2(const char* block, ms_json_block_masks_t* masks) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i case_bit = _mm256_set1_epi8(0x20);  /* Folds '[' onto '{' and ']' onto '}' */
+    const __m256i open_brace = _mm256_set1_epi8('{');
+    const __m256i close_brace = _mm256_set1_epi8('}');
+    const __m256i colon = _mm256_set1_epi8(':');
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i carriage = _mm256_set1_epi8('\r');
+
+    ms_json_block_masks_t result = {0, 0, 0, 0};
+    for (int i = 0; i < MS_JSON_SCAN_BLOCK_SIZE / 32; i++) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i*)(block + 32 * i));
+        __m256i folded = _mm256_or_si256(chunk, case_bit);
+        __m256i operators = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(folded, open_brace), _mm256_cmpeq_epi8(folded, close_brace)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, colon), _mm256_cmpeq_epi8(chunk, comma)));
+        __m256i whitespace = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), _mm256_cmpeq_epi8(chunk, tab)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, newline), _mm256_cmpeq_epi8(chunk, carriage)));
+        int shift = 32 * i;
+        result.quote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, quote)) << shift;
+        result.backslash |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, backslash)) << shift;
+        result.operators |= (uint64_t)(uint32_t)_mm256_movemask_epi8(operators) << shift;
+        result.whitespace |= (uint64_t)(uint32_t)_mm256_movemask_epi8(whitespace) << shift;
+    }
+    *masks = result;
+}
+
+static const ms_json_scan_kernel_t scan_kernel_avx2 = {
+    scan_whitespace_avx2, scan_delimiter_avx2, classify_block_avx2, "avx2"
+};
+#endif /* MS_JSON_SCAN_AVX2 */
+
+#ifdef MS_JSON_SCAN_NEON
+/**
+ * @brief Compress a byte-wise comparison into 4 bits per byte
+ *
+ * NEON has no movemask; narrowing each 16-bit lane by 4 bits keeps one
+ * nibble per input byte in a 64-bit scalar.
+ */
+static inline uint64_t ms_json_neon_mask(uint8x16_t hit) {
+    uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(hit), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0);
+}
+
+static size_t scan_whitespace_neon(const char* input, size_t position, size_t length) {
+    const uint8x16_t space = vdupq_n_u8(' ');
+    const uint8x16_t tab = vdupq_n_u8('\t');
+    const uint8x16_t newline = vdupq_n_u8('\n');
+    const uint8x16_t carriage = vdupq_n_u8('\r');
+
+    while (position + 16 <= length) {
+        uint8x16_t block = vld1q_u8((const uint8_t*)(input + position));
+        uint8x16_t hit = vorrq_u8(vorrq_u8(vceqq_u8(block, space), vceqq_u8(block, tab)),
+                                  vorrq_u8(vceqq_u8(block, newline), vceqq_u8(block, carriage)));
+        uint64_t mask = ~ms_json_neon_mask(hit);
+        if (mask != 0) {
+            return position + (size_t)(__builtin_ctzll(mask) >> 2);
+        }
+        position += 16;
+    }
+    return scan_whitespace_scalar(input, position, length);
+}
+
+static size_t scan_delimiter_neon(const char* input, size_t position, size_t length) {
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+
+    while (position + 16 <= length) {
+        uint8x16_t block = vld1q_u8((const uint8_t*)(input + position));
+        uint64_t mask = ms_json_neon_mask(vorrq_u8(vceqq_u8(block, quote), vceqq_u8(block, backslash)));
+        if (mask != 0) {
+            return position + (size_t)(__builtin_ctzll(mask) >> 2);
+        }
+        position += 16;
+    }
+    return scan_delimiter_scalar(input, position, length);
+}
+
+#if defined(__aarch64__)
+/* One bit per byte across four comparisons, via pairwise adds of bit weights */
+static inline uint64_t ms_json_neon_mask64(uint8x16_t hit0, uint8x16_t hit1, uint8x16_t hit2, uint8x16_t hit3) {
+    static const uint8_t weights[16] = {
+        0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80,
+        0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80
+    };
+    const uint8x16_t bits = vld1q_u8(weights);
+    uint8x16_t sum0 = vpaddq_u8(vandq_u8(hit0, bits), vandq_u8(hit1, bits));
+    uint8x16_t sum1 = vpaddq_u8(vandq_u8(hit2, bits), vandq_u8(hit3, bits));
+    sum0 = vpaddq_u8(sum0, sum1);
+    sum0 = vpaddq_u8(sum0, sum0);
+    return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+}
+
+static void classify_block_neon(const char* block, ms_json_block_masks_t* masks) {
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t case_bit = vdupq_n_u8(0x20);  /* Folds '[' onto '{' and ']' onto '}' */
+    const uint8x16_t open_brace = vdupq_n_u8('{');
+    const uint8x16_t close_brace = vdupq_n_u8('}');
+    const uint8x16_t colon = vdupq_n_u8(':');
+    const uint8x16_t comma = vdupq_n_u8(',');
+    const uint8x16_t space = vdupq_n_u8(' ');
+    const uint8x16_t tab = vdupq_n_u8('\t');
+    const uint8x16_t newline = vdupq_n_u8('\n');
+    const uint8x16_t carriage = vdupq_n_u8('\r');
+
+    uint8x16_t quote_hits[4];
+    uint8x16_t backslash_hits[4];
+    uint8x16_t operator_hits[4];
+    uint8x16_t whitespace_hits[4];
+    for (int i = 0; i < 4; i++) {
+        uint8x16_t chunk = vld1q_u8((const uint8_t*)(block + 16 * i));
+        uint8x16_t folded = vorrq_u8(chunk, case_bit);
+        quote_hits[i] = vceqq_u8(chunk, quote);
+        backslash_hits[i] = vceqq_u8(chunk, backslash);
+        operator_hits[i] = vorrq_u8(vorrq_u8(vceqq_u8(folded, open_brace), vceqq_u8(folded, close_brace)),
+                                    vorrq_u8(vceqq_u8(chunk, colon), vceqq_u8(chunk, comma)));
+        whitespace_hits[i] = vorrq_u8(vorrq_u8(vceqq_u8(chunk, space), vceqq_u8(chunk, tab)),
+                                      vorrq_u8(vceqq_u8(chunk, newline), vceqq_u8(chunk, carriage)));
+    }
+
+    masks->quote = ms_json_neon_mask64(quote_hits[0], quote_hits[1], quote_hits[2], quote_hits[3]);
+    masks->backslash = ms_json_neon_mask64(backslash_hits[0], backslash_hits[1],
+                                           backslash_hits[2], backslash_hits[3]);
+    masks->operators = ms_json_neon_mask64(operator_hits[0], operator_hits[1],
+                                           operator_hits[2], operator_hits[3]);
+    masks->whitespace = ms_json_neon_mask64(whitespace_hits[0], whitespace_hits[1],
+                                            whitespace_hits[2], whitespace_hits[3]);
+}
+#else
+#define classify_block_neon classify_block_scalar  /* vpaddq_u8 is AArch64 only */
+#endif
+
+static const ms_json_scan_kernel_t scan_kernel_neon = {
+    scan_whitespace_neon, scan_delimiter_neon, classify_block_neon, "neon"
+};
+#endif /* MS_JSON_SCAN_NEON */
+
+/* Selected on first use; every thread computes the same answer */
+static const ms_json_scan_kernel_t* scan_kernel = NULL;
+
+static const ms_json_scan_kernel_t* ms_json_scan_select_kernel(void) {
+    const ms_json_scan_kernel_t* kernel = MS_ATOMIC_LOAD(&scan_kernel);
+    if (kernel) {
+        return kernel;
+    }
+
+    kernel = &scan_kernel_scalar;
+#if defined(MS_JSON_SCAN_AVX2)
+    __builtin_cpu_init();
+    kernel = __builtin_cpu_supports("avx2") ? &scan_kernel_avx2 : &scan_kernel_sse2;
+#elif defined(MS_JSON_SCAN_SSE2)
+    kernel = &scan_kernel_sse2;
+#elif defined(MS_JSON_SCAN_NEON)
+    kernel = &scan_kernel_neon;
+#endif
+
+    MS_ATOMIC_STORE(&scan_kernel, kernel);
+    return kernel;
+}
+
+size_t ms_json_scan_whitespace(const char* input, size_t position, size_t length) {
+    /* Most tokens are not preceded by whitespace at all */
+    if (position >= length || !ms_json_is_whitespace(input[position])) {
+        return position;
+    }
+    return ms_json_scan_select_kernel()->whitespace(input, position + 1, length);
+}
+
+size_t ms_json_scan_string_delimiter(const char* input, size_t position, size_t length) {
+    return ms_json_scan_select_kernel()->delimiter(input, position, length);
+}
+
+void ms_json_scan_classify_block(const char* block, ms_json_block_masks_t* masks) {
+    ms_json_scan_select_kernel()->classify(block, masks);
+}
+
+const char* ms_json_scan_kernel_name(void) {
+    return ms_json_scan_select_kernel()->name;
+}
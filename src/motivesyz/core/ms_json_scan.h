@@ -0,0 +1,66 @@
+/**
+ * @file ms_json_scan.h
+ * @brief Internal vectorised byte scanning for the JSON parser
+ *
+ * Kernels locate the end of a whitespace run or the next string delimiter
+ * 16 or 32 bytes at a time, and classify whole 64-byte blocks for the
+ * structural index. The best kernel for the running CPU is picked on
+ * first use. Not part of the public API.
+ */
+
+#ifndef MS_JSON_SCAN_H
+#define MS_JSON_SCAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Bytes classified per ms_json_scan_classify_block() call */
+#define MS_JSON_SCAN_BLOCK_SIZE 64
+
+/**
+ * @brief Character classes of one 64-byte block, bit i for byte i
+ */
+typedef struct {
+    uint64_t quote;       /**< '"' */
+    uint64_t backslash;   /**< '\\' */
+    uint64_t operators;   /**< '{', '}', '[', ']', ':' and ',' */
+    uint64_t whitespace;  /**< Space, tab, LF and CR */
+} ms_json_block_masks_t;
+
+/**
+ * @brief Find the first byte that is not JSON whitespace
+ *
+ * @param input Input buffer
+ * @param position Offset to start scanning at
+ * @param length Total input length
+ * @return Offset of the first byte other than space, tab, LF or CR,
+ *         or length when the rest of the input is whitespace
+ */
+size_t ms_json_scan_whitespace(const char* input, size_t position, size_t length);
+
+/**
+ * @brief Find the next '"' or '\\' inside a string
+ *
+ * @param input Input buffer
+ * @param position Offset to start scanning at
+ * @param length Total input length
+ * @return Offset of the first quote or backslash, or length if none
+ */
+size_t ms_json_scan_string_delimiter(const char* input, size_t position, size_t length);
+
+/**
+ * @brief Classify MS_JSON_SCAN_BLOCK_SIZE bytes in one pass
+ *
+ * @param block Exactly MS_JSON_SCAN_BLOCK_SIZE readable bytes
+ * @param masks Output parameter for the class masks
+ */
+void ms_json_scan_classify_block(const char* block, ms_json_block_masks_t* masks);
+
+/**
+ * @brief Name of the kernel selected for this CPU
+ *
+ * @return "avx2", "sse2", "neon" or "scalar"
+ */
+const char* ms_json_scan_kernel_name(void);
+
+#endif /* MS_JSON_SCAN_H */
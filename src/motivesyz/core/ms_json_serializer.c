@@ -0,0 +1,1076 @@
+/**
+ * @file ms_json_serializer.c
+ * @brief JSON serialization into a growing buffer or a streaming sink
+ *
+ * Both modes share one writer. Without a sink the buffer doubles as output
+ * grows, or is sized once by a measuring pass when the tree has no doubles,
+ * and is handed to the caller; with a sink the buffer keeps its size and is
+ * drained to the callback whenever it fills.
+ */
+
+#define _POSIX_C_SOURCE 200809L  /* write() */
+
+#include "ms_json_serializer.h"
+#include "ms_json_internal.h"
+#include "ms_json_number.h"
+#include "ms_instrument.h"
+#include "ms_print.h"
+#include "ms_thread.h"
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Configuration */
+#define SERIALIZE_BUFFER_INITIAL_SIZE 1024
+#define SERIALIZE_SHRINK_FRACTION 8          /* Trim a buffer when more than 1/8 is unused */
+#define SERIALIZE_SIZE_UNKNOWN SIZE_MAX      /* Measuring stopped at a double */
+#define SERIALIZE_PARALLEL_MIN_MEMBERS 1024  /* Smaller roots are not worth splitting */
+#define SERIALIZE_RANGES_PER_THREAD 8        /* Work items per thread, for balance */
+#define SERIALIZE_RANGE_MAX_MEMBERS 4096     /* Bounds the memory of one range buffer */
+#define SERIALIZE_RANGES_IN_FLIGHT 4         /* Finished or running ranges per thread */
+#define PRINT_INDENT_WIDTH 2                 /* Spaces per nesting level of pretty output */
+
+/* Colors of ms_json_print() */
+#define PRINT_COLOR_KEY COLOR_BLUE
+#define PRINT_COLOR_STRING COLOR_GREEN
+#define PRINT_COLOR_NUMBER COLOR_CYAN
+#define PRINT_COLOR_LITERAL COLOR_YELLOW     /* true, false and null */
+
+/* Output of one range of root members */
+typedef struct {
+    char* buffer;
+    size_t length;
+    ms_json_result_t status;
+    int done;
+} ms_json_serialize_range_t;
+
+/* Root members split into ranges, serialized by workers and stitched in order */
+typedef struct {
+    const ms_json_value_t* root;
+    size_t member_count;
+    size_t range_members;        /* Members per range, the last may have fewer */
+    ms_json_serialize_range_t* ranges;
+    size_t range_count;
+    size_t next_range;           /* Next range to claim */
+    size_t stitched;             /* Ranges already copied to the output */
+    size_t window;               /* Ranges that may be claimed ahead of stitched */
+    int stop;                    /* Output failed; claim nothing more */
+    pthread_mutex_t lock;
+    pthread_cond_t range_done;   /* Signalled by workers */
+    pthread_cond_t range_taken;  /* Signalled by the stitching thread */
+} ms_json_parallel_job_t;
+
+/* State of one ms_json_print() call */
+typedef struct {
+    ms_json_serialize_context_t* out;
+    int pretty;
+    int color;
+    size_t depth;                /* Nesting level of the value being printed */
+} ms_json_printer_t;
+
+/* Forward declarations for internal functions */
+static ms_json_result_t ms_json_serialize_buffered(const ms_json_value_t* value, ms_allocator_t* allocator,
+                                                   const ms_json_parallel_options_t* parallel, char** result);
+static ms_json_result_t ms_json_serialize_sink(const ms_json_value_t* value, const ms_json_parallel_options_t* parallel,
+                                               ms_json_write_fn write_fn, void* user_ctx, size_t buffer_size);
+static ms_json_result_t ms_json_sink_open(ms_json_serialize_context_t* ctx, ms_json_write_fn write_fn,
+                                          void* user_ctx, size_t buffer_size);
+static ms_json_result_t ms_json_print_sink(const ms_json_value_t* value, unsigned int flags, int terminal,
+                                           ms_json_write_fn write_fn, void* user_ctx);
+static ms_json_result_t ms_json_print_value(ms_json_printer_t* printer, const ms_json_value_t* value);
+static ms_json_result_t ms_json_print_container(ms_json_printer_t* printer, const ms_json_value_t* value);
+static ms_json_result_t ms_json_print_newline(ms_json_printer_t* printer);
+static ms_json_result_t ms_json_serialize_root(const ms_json_value_t* value,
+                                               const ms_json_parallel_options_t* parallel,
+                                               ms_json_serialize_context_t* ctx);
+static ms_json_result_t ms_json_serialize_tree(const ms_json_value_t* value,
+                                               const ms_json_parallel_options_t* parallel,
+                                               ms_json_serialize_context_t* ctx);
+static ms_json_result_t ms_json_serialize_ranges(const ms_json_value_t* value,
+                                                 const ms_json_parallel_options_t* parallel,
+                                                 ms_json_serialize_context_t* ctx);
+static void ms_json_serialize_range(ms_json_parallel_job_t* job, size_t range);
+static void ms_json_serialize_worker(void* arg, size_t worker);
+static ms_json_result_t ms_json_serialize_null(ms_json_serialize_context_t* ctx);
+static ms_json_result_t ms_json_serialize_bool(int value, ms_json_serialize_context_t* ctx);
+static ms_json_result_t ms_json_serialize_array(const ms_json_value_t* value, ms_json_serialize_context_t* ctx);
+static ms_json_result_t ms_json_serialize_object(const ms_json_value_t* value, ms_json_serialize_context_t* ctx);
+static ms_json_result_t ms_json_serialize_members(const ms_json_value_t* value, size_t begin, size_t end,
+                                                  ms_json_serialize_context_t* ctx);
+static ms_json_result_t ms_json_measure_value(const ms_json_value_t* value, int exact, size_t* size);
+static size_t ms_json_measure_string(const char* value, size_t length);
+static ms_json_result_t ms_json_serialize_ensure_capacity(ms_json_serialize_context_t* ctx, size_t needed);
+static ms_json_result_t ms_json_write_stream(void* user_ctx, const char* data, size_t length);
+static ms_json_result_t ms_json_write_fd(void* user_ctx, const char* data, size_t length);
+
+/* Real serialization implementation */
+ms_json_result_t ms_json_serialize(const ms_json_value_t* value, ms_allocator_t* allocator,
+                                  char** result) {
+    return ms_json_serialize_buffered(value, allocator, NULL, result);
+}
+
+ms_json_result_t ms_json_serialize_parallel(const ms_json_value_t* value, ms_allocator_t* allocator,
+                                           const ms_json_parallel_options_t* options, char** result) {
+    static const ms_json_parallel_options_t defaults = {0};
+    return ms_json_serialize_buffered(value, allocator, options ? options : &defaults, result);
+}
+
+static ms_json_result_t ms_json_serialize_buffered(const ms_json_value_t* value, ms_allocator_t* allocator,
+                                                   const ms_json_parallel_options_t* parallel, char** result) {
+    if (!value || !result) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (!allocator) {
+        allocator = ms_allocator_default();
+    }
+
+    ms_json_serialize_context_t ctx = {
+        .allocator = allocator,
+        .buffer = NULL,
+        .position = 0,
+        .capacity = SERIALIZE_BUFFER_INITIAL_SIZE,
+        .needs_comma = 0,
+        .write_fn = NULL,
+        .write_ctx = NULL
+    };
+
+    /*
+     * A serial pass over a tree without doubles is allocated once at its
+     * exact size. Measuring gives up at the first double, whose length is
+     * only known by formatting it, so numeric trees cost no extra walk and
+     * grow as usual; so does the parallel path, which stitches range buffers.
+     */
+    if (!parallel) {
+        size_t size = 0;
+        ms_json_result_t measure_result = ms_json_measure_value(value, 0, &size);
+        if (measure_result != MS_JSON_SUCCESS) {
+            return measure_result;
+        }
+        if (size != SERIALIZE_SIZE_UNKNOWN) {
+            ctx.capacity = size + 1;
+        }
+    }
+
+    if (ms_allocator_allocate(allocator, ctx.capacity, (void**)&ctx.buffer) != MS_MEMORY_SUCCESS) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    ms_json_result_t serialize_result = ms_json_serialize_root(value, parallel, &ctx);
+
+    if (serialize_result == MS_JSON_SUCCESS && ctx.capacity - ctx.position > ctx.capacity / SERIALIZE_SHRINK_FRACTION) {
+        char* trimmed = NULL;
+        if (ms_allocator_reallocate(allocator, ctx.buffer, ctx.position + 1, (void**)&trimmed) == MS_MEMORY_SUCCESS) {
+            ctx.buffer = trimmed;
+            ctx.capacity = ctx.position + 1;
+        }
+    }
+
+    if (serialize_result == MS_JSON_SUCCESS) {
+        /* Ensure null termination */
+        if (ctx.position >= ctx.capacity) {
+            if (ms_json_serialize_ensure_capacity(&ctx, 1) != MS_JSON_SUCCESS) {
+                ms_allocator_deallocate(allocator, ctx.buffer);
+                return MS_JSON_ERROR_MEMORY;
+            }
+        }
+        ctx.buffer[ctx.position] = '\0';
+        *result = ctx.buffer;
+    } else {
+        if (ctx.buffer) {
+            ms_allocator_deallocate(allocator, ctx.buffer);
+        }
+    }
+
+    return serialize_result;
+}
+
+ms_json_result_t ms_json_serialized_size(const ms_json_value_t* value, size_t* result) {
+    if (!value || !result) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    *result = 0;
+    return ms_json_measure_value(value, 1, result);
+}
+
+ms_json_result_t ms_json_serialize_into(const ms_json_value_t* value, char* buffer, size_t capacity,
+                                        size_t* length) {
+    if (!value || !buffer || capacity == 0) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    /* One byte is held back for the terminator */
+    ms_json_serialize_context_t ctx = {
+        .allocator = NULL,
+        .buffer = buffer,
+        .position = 0,
+        .capacity = capacity - 1,
+        .needs_comma = 0,
+        .write_fn = NULL,
+        .write_ctx = NULL,
+        .fixed = 1
+    };
+
+    ms_json_result_t result = ms_json_serialize_value(value, &ctx);
+    if (result != MS_JSON_SUCCESS) {
+        return result;
+    }
+
+    buffer[ctx.position] = '\0';
+    if (length) {
+        *length = ctx.position;
+    }
+    return MS_JSON_SUCCESS;
+}
+
+ms_json_result_t ms_json_serialize_to_sink(const ms_json_value_t* value, ms_json_write_fn write_fn,
+                                           void* user_ctx, size_t buffer_size) {
+    return ms_json_serialize_sink(value, NULL, write_fn, user_ctx, buffer_size);
+}
+
+ms_json_result_t ms_json_serialize_parallel_to_sink(const ms_json_value_t* value,
+                                                   const ms_json_parallel_options_t* options,
+                                                   ms_json_write_fn write_fn, void* user_ctx, size_t buffer_size) {
+    static const ms_json_parallel_options_t defaults = {0};
+    return ms_json_serialize_sink(value, options ? options : &defaults, write_fn, user_ctx, buffer_size);
+}
+
+static ms_json_result_t ms_json_serialize_sink(const ms_json_value_t* value, const ms_json_parallel_options_t* parallel,
+                                               ms_json_write_fn write_fn, void* user_ctx, size_t buffer_size) {
+    if (!value || !write_fn) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    ms_json_serialize_context_t ctx;
+    ms_json_result_t result = ms_json_sink_open(&ctx, write_fn, user_ctx, buffer_size);
+    if (result != MS_JSON_SUCCESS) {
+        return result;
+    }
+
+    result = ms_json_serialize_root(value, parallel, &ctx);
+    if (result == MS_JSON_SUCCESS) {
+        result = ms_json_serialize_flush(&ctx);
+    }
+
+    ms_allocator_deallocate(ctx.allocator, ctx.buffer);
+    return result;
+}
+
+/* Set up ctx to drain a buffer of buffer_size bytes into write_fn */
+static ms_json_result_t ms_json_sink_open(ms_json_serialize_context_t* ctx, ms_json_write_fn write_fn,
+                                          void* user_ctx, size_t buffer_size) {
+    if (buffer_size == 0) {
+        buffer_size = MS_JSON_SINK_BUFFER_DEFAULT;
+    } else if (buffer_size < MS_JSON_SINK_BUFFER_MIN) {
+        buffer_size = MS_JSON_SINK_BUFFER_MIN; /* Room for the longest number */
+    }
+
+    *ctx = (ms_json_serialize_context_t){
+        .allocator = ms_allocator_default(),
+        .buffer = NULL,
+        .position = 0,
+        .capacity = buffer_size,
+        .needs_comma = 0,
+        .write_fn = write_fn,
+        .write_ctx = user_ctx
+    };
+
+    if (ms_allocator_allocate(ctx->allocator, buffer_size, (void**)&ctx->buffer) != MS_MEMORY_SUCCESS) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+    return MS_JSON_SUCCESS;
+}
+
+ms_json_result_t ms_json_serialize_to_stream(const ms_json_value_t* value, FILE* stream,
+                                             size_t buffer_size) {
+    if (!stream) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+    return ms_json_serialize_to_sink(value, ms_json_write_stream, stream, buffer_size);
+}
+
+ms_json_result_t ms_json_serialize_to_fd(const ms_json_value_t* value, int fd, size_t buffer_size) {
+    if (fd < 0) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+    return ms_json_serialize_to_sink(value, ms_json_write_fd, &fd, buffer_size);
+}
+
+ms_json_result_t ms_json_serialize_file(const ms_json_value_t* value, const char* filename) {
+    if (!value || !filename) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    ms_json_result_t result = ms_json_serialize_to_stream(value, file, 0);
+
+    if (fclose(file) != 0 && result == MS_JSON_SUCCESS) {
+        result = MS_JSON_ERROR_IO;
+    }
+
+    return result;
+}
+
+ms_json_result_t ms_json_print(const ms_json_value_t* value, FILE* stream, unsigned int flags) {
+    if (!stream) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+    int fd = (flags & MS_JSON_PRINT_COLOR) ? fileno(stream) : -1;
+    return ms_json_print_sink(value, flags, fd >= 0 && print_color_enabled(fd), ms_json_write_stream, stream);
+}
+
+ms_json_result_t ms_json_print_fd(const ms_json_value_t* value, int fd, unsigned int flags) {
+    if (fd < 0) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+    int terminal = (flags & MS_JSON_PRINT_COLOR) && print_color_enabled(fd);
+    return ms_json_print_sink(value, flags, terminal, ms_json_write_fd, &fd);
+}
+
+/* Print value plus a newline through one sink buffer; terminal enables MS_JSON_PRINT_COLOR */
+static ms_json_result_t ms_json_print_sink(const ms_json_value_t* value, unsigned int flags, int terminal,
+                                           ms_json_write_fn write_fn, void* user_ctx) {
+    if (!value) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    ms_json_serialize_context_t ctx;
+    ms_json_result_t result = ms_json_sink_open(&ctx, write_fn, user_ctx, 0);
+    if (result != MS_JSON_SUCCESS) {
+        return result;
+    }
+
+    ms_json_printer_t printer = {
+        .out = &ctx,
+        .pretty = (flags & MS_JSON_PRINT_PRETTY) != 0,
+        .color = (flags & MS_JSON_PRINT_COLOR_ALWAYS) != 0 || terminal,
+        .depth = 0
+    };
+
+    MS_INSTRUMENT_BEGIN(span, 0);
+    result = ms_json_print_value(&printer, value);
+    MS_INSTRUMENT_END(span, MS_INSTRUMENT_SERIALIZE, 0);
+    if (result == MS_JSON_SUCCESS) {
+        result = ms_json_serialize_append(&ctx, "\n", 1);
+    }
+    if (result == MS_JSON_SUCCESS) {
+        result = ms_json_serialize_flush(&ctx);
+    }
+
+    ms_allocator_deallocate(ctx.allocator, ctx.buffer);
+    return result;
+}
+
+static ms_json_result_t ms_json_print_value(ms_json_printer_t* printer, const ms_json_value_t* value) {
+    const char* color;
+    switch (ms_json_value_get_type(value)) {
+        case MS_JSON_ARRAY:
+        case MS_JSON_OBJECT:
+            return ms_json_print_container(printer, value);
+        case MS_JSON_STRING:
+            color = PRINT_COLOR_STRING;
+            break;
+        case MS_JSON_NUMBER:
+            color = PRINT_COLOR_NUMBER;
+            break;
+        default:
+            color = PRINT_COLOR_LITERAL;
+            break;
+    }
+
+    if (!printer->color) {
+        return ms_json_serialize_value(value, printer->out);
+    }
+
+    ms_json_result_t result = ms_json_serialize_append(printer->out, color, strlen(color));
+    if (result == MS_JSON_SUCCESS) {
+        result = ms_json_serialize_value(value, printer->out);
+    }
+    if (result == MS_JSON_SUCCESS) {
+        result = ms_json_serialize_append(printer->out, COLOR_RESET, sizeof(COLOR_RESET) - 1);
+    }
+    return result;
+}
+
+/* Array or object with one member per line when pretty; empty containers stay on one line */
+static ms_json_result_t ms_json_print_container(ms_json_printer_t* printer, const ms_json_value_t* value) {
+    ms_json_result_t result = ms_json_value_resolve(value);
+    if (result != MS_JSON_SUCCESS) {
+        return result;
+    }
+
+    int is_array = ms_json_value_get_type(value) == MS_JSON_ARRAY;
+    const ms_json_array_t* array = is_array ? ms_json_value_get_array_const(value) : NULL;
+    const ms_json_object_t* object = is_array ? NULL : ms_json_value_get_object_const(value);
+    size_t count = is_array ? array->count : object->count;
+
+    result = ms_json_serialize_append(printer->out, is_array ? "[" : "{", 1);
+    printer->depth++;
+
+    for (size_t i = 0; i < count && result == MS_JSON_SUCCESS; i++) {
+        if (i > 0) {
+            result = ms_json_serialize_append(printer->out, ",", 1);
+        }
+        if (result == MS_JSON_SUCCESS && printer->pretty) {
+            result = ms_json_print_newline(printer);
+        }
+        if (result != MS_JSON_SUCCESS) {
+            break;
+        }
+
+        if (is_array) {
+            result = ms_json_print_value(printer, array->items[i]);
+            continue;
+        }
+
+        /* Key, then ":" or ": " */
+        if (printer->color) {
+            result = ms_json_serialize_append(printer->out, PRINT_COLOR_KEY, sizeof(PRINT_COLOR_KEY) - 1);
+        }
+        if (result == MS_JSON_SUCCESS) {
+            result = ms_json_serialize_string(object->entries[i].key, object->entries[i].key_length, printer->out);
+        }
+        if (result == MS_JSON_SUCCESS && printer->color) {
+            result = ms_json_serialize_append(printer->out, COLOR_RESET, sizeof(COLOR_RESET) - 1);
+        }
+        if (result == MS_JSON_SUCCESS) {
+            result = ms_json_serialize_append(printer->out, ": ", printer->pretty ? 2 : 1);
+        }
+        if (result == MS_JSON_SUCCESS) {
+            result = ms_json_print_value(printer, object->entries[i].value);
+        }
+    }
+
+    printer->depth--;
+    if (result == MS_JSON_SUCCESS && printer->pretty && count > 0) {
+        result = ms_json_print_newline(printer);
+    }
+    if (result == MS_JSON_SUCCESS) {
+        result = ms_json_serialize_append(printer->out, is_array ? "]" : "}", 1);
+    }
+    return result;
+}
+
+/* Line break and indentation for the current depth */
+static ms_json_result_t ms_json_print_newline(ms_json_printer_t* printer) {
+    static const char spaces[] = "                                                                ";
+    ms_json_result_t result = ms_json_serialize_append(printer->out, "\n", 1);
+
+    size_t indent = printer->depth * PRINT_INDENT_WIDTH;
+    while (indent > 0 && result == MS_JSON_SUCCESS) {
+        size_t chunk = indent < sizeof(spaces) - 1 ? indent : sizeof(spaces) - 1;
+        result = ms_json_serialize_append(printer->out, spaces, chunk);
+        indent -= chunk;
+    }
+    return result;
+}
+
+static ms_json_result_t ms_json_write_stream(void* user_ctx, const char* data, size_t length) {
+    FILE* stream = (FILE*)user_ctx;
+    return fwrite(data, 1, length, stream) == length ? MS_JSON_SUCCESS : MS_JSON_ERROR_IO;
+}
+
+static ms_json_result_t ms_json_write_fd(void* user_ctx, const char* data, size_t length) {
+    int fd = *(const int*)user_ctx;
+
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return MS_JSON_ERROR_IO;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+
+    return MS_JSON_SUCCESS;
+}
+
+/* Byte counts are only known for growing buffers; a sink's position restarts at every flush */
+static ms_json_result_t ms_json_serialize_root(const ms_json_value_t* value,
+                                               const ms_json_parallel_options_t* parallel,
+                                               ms_json_serialize_context_t* ctx) {
+    MS_INSTRUMENT_BEGIN(span, ctx->position);
+    ms_json_result_t result = ms_json_serialize_tree(value, parallel, ctx);
+    MS_INSTRUMENT_END(span, MS_INSTRUMENT_SERIALIZE, ctx->write_fn ? span.offset : ctx->position);
+    return result;
+}
+
+/* Serial or split serialization of a whole tree */
+static ms_json_result_t ms_json_serialize_tree(const ms_json_value_t* value,
+                                               const ms_json_parallel_options_t* parallel,
+                                               ms_json_serialize_context_t* ctx) {
+    ms_json_type_t type = ms_json_value_get_type(value);
+    if (!parallel || (type != MS_JSON_ARRAY && type != MS_JSON_OBJECT)) {
+        return ms_json_serialize_value(value, ctx);
+    }
+
+    /*
+     * Workers decode any lazy containers they meet, anywhere below the root,
+     * allocating from the tree's allocator; only the default one is safe to
+     * share between threads, so other trees are serialized here
+     */
+    if (value->allocator && value->allocator != ms_allocator_default()) {
+        return ms_json_serialize_value(value, ctx);
+    }
+
+    ms_json_result_t result = ms_json_value_resolve(value);
+    if (result != MS_JSON_SUCCESS) {
+        return result;
+    }
+
+    size_t count = type == MS_JSON_ARRAY ? ms_json_value_get_array_const(value)->count
+                                         : ms_json_value_get_object_const(value)->count;
+    size_t min_members = parallel->min_members ? parallel->min_members : SERIALIZE_PARALLEL_MIN_MEMBERS;
+    if (count < min_members) {
+        return ms_json_serialize_value(value, ctx);
+    }
+
+    result = ms_json_serialize_append(ctx, type == MS_JSON_ARRAY ? "[" : "{", 1);
+    if (result != MS_JSON_SUCCESS) {
+        return result;
+    }
+
+    result = ms_json_serialize_ranges(value, parallel, ctx);
+    if (result != MS_JSON_SUCCESS) {
+        return result;
+    }
+
+    return ms_json_serialize_append(ctx, type == MS_JSON_ARRAY ? "]" : "}", 1);
+}
+
+/* Serialize the members of a resolved root on workers, stitching ranges into ctx in order */
+static ms_json_result_t ms_json_serialize_ranges(const ms_json_value_t* value,
+                                                 const ms_json_parallel_options_t* parallel,
+                                                 ms_json_serialize_context_t* ctx) {
+    size_t threads = parallel->threads ? parallel->threads : ms_thread_cpu_count();
+
+    ms_json_parallel_job_t job;
+    memset(&job, 0, sizeof(job));
+    job.root = value;
+    job.member_count = ms_json_value_get_type(value) == MS_JSON_ARRAY ? ms_json_value_get_array_const(value)->count
+                                                                      : ms_json_value_get_object_const(value)->count;
+    job.range_members = (job.member_count + threads * SERIALIZE_RANGES_PER_THREAD - 1) /
+                        (threads * SERIALIZE_RANGES_PER_THREAD);
+    if (job.range_members > SERIALIZE_RANGE_MAX_MEMBERS) {
+        job.range_members = SERIALIZE_RANGE_MAX_MEMBERS;
+    }
+    if (job.range_members == 0) {
+        job.range_members = 1;
+    }
+    job.range_count = (job.member_count + job.range_members - 1) / job.range_members;
+    job.window = threads * SERIALIZE_RANGES_IN_FLIGHT;
+
+    if (ms_allocator_allocate(ms_allocator_default(), job.range_count * sizeof(*job.ranges),
+                              (void**)&job.ranges) != MS_MEMORY_SUCCESS) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+    memset(job.ranges, 0, job.range_count * sizeof(*job.ranges));
+
+    pthread_mutex_init(&job.lock, NULL);
+    pthread_cond_init(&job.range_done, NULL);
+    pthread_cond_init(&job.range_taken, NULL);
+
+    size_t workers = 0;
+    ms_thread_group_t* group = NULL;
+    if (threads > 1) {
+        group = ms_thread_group_start(threads, ms_json_serialize_worker, &job, &workers);
+    }
+
+    ms_json_result_t result = MS_JSON_SUCCESS;
+    for (size_t k = 0; k < job.range_count && result == MS_JSON_SUCCESS; k++) {
+        pthread_mutex_lock(&job.lock);
+        while (!job.ranges[k].done) {
+            if (workers == 0) {
+                /* No worker started: serialize on this thread */
+                size_t range = job.next_range++;
+                pthread_mutex_unlock(&job.lock);
+                ms_json_serialize_range(&job, range);
+                pthread_mutex_lock(&job.lock);
+                job.ranges[range].done = 1;
+                continue;
+            }
+            pthread_cond_wait(&job.range_done, &job.lock);
+        }
+        pthread_mutex_unlock(&job.lock);
+
+        ms_json_serialize_range_t* range = &job.ranges[k];
+        result = range->status;
+        if (result == MS_JSON_SUCCESS && k > 0) {
+            result = ms_json_serialize_append(ctx, ",", 1);
+        }
+        if (result == MS_JSON_SUCCESS) {
+            result = ms_json_serialize_append(ctx, range->buffer, range->length);
+        }
+        if (range->buffer) {
+            ms_allocator_deallocate(ms_allocator_default(), range->buffer);
+            range->buffer = NULL;
+        }
+
+        pthread_mutex_lock(&job.lock);
+        job.stitched = k + 1;
+        pthread_cond_broadcast(&job.range_taken);
+        pthread_mutex_unlock(&job.lock);
+    }
+
+    pthread_mutex_lock(&job.lock);
+    job.stop = 1;
+    pthread_cond_broadcast(&job.range_taken);
+    pthread_mutex_unlock(&job.lock);
+    ms_thread_group_join(group);
+
+    /* Ranges finished after a failure were never stitched */
+    for (size_t k = 0; k < job.range_count; k++) {
+        if (job.ranges[k].buffer) {
+            ms_allocator_deallocate(ms_allocator_default(), job.ranges[k].buffer);
+        }
+    }
+    ms_allocator_deallocate(ms_allocator_default(), job.ranges);
+    pthread_mutex_destroy(&job.lock);
+    pthread_cond_destroy(&job.range_done);
+    pthread_cond_destroy(&job.range_taken);
+    return result;
+}
+
+/* Serialize one range into its own growing buffer */
+static void ms_json_serialize_range(ms_json_parallel_job_t* job, size_t range) {
+    ms_json_serialize_range_t* out = &job->ranges[range];
+    size_t begin = range * job->range_members;
+    size_t end = begin + job->range_members < job->member_count ? begin + job->range_members : job->member_count;
+
+    ms_json_serialize_context_t ctx = {
+        .allocator = ms_allocator_default(),
+        .buffer = NULL,
+        .position = 0,
+        .capacity = SERIALIZE_BUFFER_INITIAL_SIZE,
+        .needs_comma = 0,
+        .write_fn = NULL,
+        .write_ctx = NULL
+    };
+
+    if (ms_allocator_allocate(ctx.allocator, ctx.capacity, (void**)&ctx.buffer) != MS_MEMORY_SUCCESS) {
+        out->status = MS_JSON_ERROR_MEMORY;
+        return;
+    }
+
+    out->status = ms_json_serialize_members(job->root, begin, end, &ctx);
+    out->buffer = ctx.buffer;
+    out->length = ctx.position;
+}
+
+static void ms_json_serialize_worker(void* arg, size_t worker) {
+    ms_json_parallel_job_t* job = arg;
+    (void)worker;
+
+    pthread_mutex_lock(&job->lock);
+    for (;;) {
+        if (job->stop || job->next_range >= job->range_count) {
+            break;
+        }
+
+        /* Stay within the window so unstitched output stays bounded */
+        if (job->next_range >= job->stitched + job->window) {
+            pthread_cond_wait(&job->range_taken, &job->lock);
+            continue;
+        }
+
+        size_t range = job->next_range++;
+        pthread_mutex_unlock(&job->lock);
+        ms_json_serialize_range(job, range);
+        pthread_mutex_lock(&job->lock);
+
+        job->ranges[range].done = 1;
+        pthread_cond_broadcast(&job->range_done);
+    }
+    pthread_mutex_unlock(&job->lock);
+}
+
+ms_json_result_t ms_json_serialize_value(const ms_json_value_t* value, ms_json_serialize_context_t* ctx) {
+    switch (ms_json_value_get_type(value)) {
+        case MS_JSON_NULL:
+            return ms_json_serialize_null(ctx);
+        case MS_JSON_BOOL:
+            return ms_json_serialize_bool(ms_json_value_get_bool(value), ctx);
+        case MS_JSON_NUMBER:
+            if (value->flags & MS_JSON_FLAG_INTEGER) {
+                return ms_json_serialize_integer(value->data.integer, ctx);
+            }
+            return ms_json_serialize_number(ms_json_value_get_number(value), ctx);
+        case MS_JSON_STRING:
+            return ms_json_serialize_string(ms_json_value_get_string(value),
+                                            ms_json_value_get_string_length(value), ctx);
+        case MS_JSON_ARRAY:
+            return ms_json_serialize_array(value, ctx);
+        case MS_JSON_OBJECT:
+            return ms_json_serialize_object(value, ctx);
+        default:
+            return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+}
+
+static ms_json_result_t ms_json_serialize_null(ms_json_serialize_context_t* ctx) {
+    return ms_json_serialize_append(ctx, "null", 4);
+}
+
+static ms_json_result_t ms_json_serialize_bool(int value, ms_json_serialize_context_t* ctx) {
+    if (value) {
+        return ms_json_serialize_append(ctx, "true", 4);
+    } else {
+        return ms_json_serialize_append(ctx, "false", 5);
+    }
+}
+
+ms_json_result_t ms_json_serialize_number(double value, ms_json_serialize_context_t* ctx) {
+    /* Handle special cases */
+    if (isnan(value)) {
+        return ms_json_serialize_append(ctx, "null", 4);
+    }
+
+    if (isinf(value)) {
+        if (value > 0) {
+            return ms_json_serialize_append(ctx, "1e999", 5);
+        } else {
+            return ms_json_serialize_append(ctx, "-1e999", 6);
+        }
+    }
+
+    /* Format straight into the output buffer, unless an exactly sized one is nearly full */
+    if (ctx->capacity - ctx->position < MS_JSON_DOUBLE_MAX_CHARS) {
+        char digits[MS_JSON_DOUBLE_MAX_CHARS];
+        return ms_json_serialize_append(ctx, digits, ms_json_format_double(value, digits));
+    }
+
+    ctx->position += ms_json_format_double(value, ctx->buffer + ctx->position);
+    return MS_JSON_SUCCESS;
+}
+
+ms_json_result_t ms_json_serialize_integer(int64_t value, ms_json_serialize_context_t* ctx) {
+    if (ctx->capacity - ctx->position < MS_JSON_INT64_MAX_CHARS) {
+        char digits[MS_JSON_INT64_MAX_CHARS];
+        return ms_json_serialize_append(ctx, digits, ms_json_format_int64(value, digits));
+    }
+
+    ctx->position += ms_json_format_int64(value, ctx->buffer + ctx->position);
+    return MS_JSON_SUCCESS;
+}
+
+ms_json_result_t ms_json_serialize_string(const char* value, size_t length, ms_json_serialize_context_t* ctx) {
+    if (!value) {
+        return ms_json_serialize_append(ctx, "\"\"", 2);
+    }
+
+    /* Start with quote */
+    ms_json_result_t result = ms_json_serialize_append(ctx, "\"", 1);
+    if (result != MS_JSON_SUCCESS) {
+        return result;
+    }
+
+    /* Escape and append string content; plain runs are appended in one go */
+    size_t run_start = 0;
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)value[i];
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+
+        char escape_buffer[8];
+        const char* to_append = escape_buffer;
+        size_t append_length = 2;
+
+        switch (c) {
+            case '"':  to_append = "\\\""; break;
+            case '\\': to_append = "\\\\"; break;
+            case '\b': to_append = "\\b"; break;
+            case '\f': to_append = "\\f"; break;
+            case '\n': to_append = "\\n"; break;
+            case '\r': to_append = "\\r"; break;
+            case '\t': to_append = "\\t"; break;
+            default:
+                /* Control character - escape as Unicode */
+                snprintf(escape_buffer, sizeof(escape_buffer), "\\u%04x", c);
+                append_length = 6;
+                break;
+        }
+
+        if (i > run_start) {
+            result = ms_json_serialize_append(ctx, value + run_start, i - run_start);
+            if (result != MS_JSON_SUCCESS) {
+                return result;
+            }
+        }
+
+        result = ms_json_serialize_append(ctx, to_append, append_length);
+        if (result != MS_JSON_SUCCESS) {
+            return result;
+        }
+
+        run_start = i + 1;
+    }
+
+    if (length > run_start) {
+        result = ms_json_serialize_append(ctx, value + run_start, length - run_start);
+        if (result != MS_JSON_SUCCESS) {
+            return result;
+        }
+    }
+
+    /* Closing quote */
+    return ms_json_serialize_append(ctx, "\"", 1);
+}
+
+static ms_json_result_t ms_json_serialize_array(const ms_json_value_t* value, ms_json_serialize_context_t* ctx) {
+    ms_json_result_t result = ms_json_value_resolve(value);
+    if (result != MS_JSON_SUCCESS) {
+        return result;
+    }
+
+    result = ms_json_serialize_append(ctx, "[", 1);
+    if (result != MS_JSON_SUCCESS) {
+        return result;
+    }
+
+    result = ms_json_serialize_members(value, 0, ms_json_value_get_array_const(value)->count, ctx);
+    if (result != MS_JSON_SUCCESS) {
+        return result;
+    }
+
+    return ms_json_serialize_append(ctx, "]", 1);
+}
+
+static ms_json_result_t ms_json_serialize_object(const ms_json_value_t* value, ms_json_serialize_context_t* ctx) {
+    ms_json_result_t result = ms_json_value_resolve(value);
+    if (result != MS_JSON_SUCCESS) {
+        return result;
+    }
+
+    result = ms_json_serialize_append(ctx, "{", 1);
+    if (result != MS_JSON_SUCCESS) {
+        return result;
+    }
+
+    result = ms_json_serialize_members(value, 0, ms_json_value_get_object_const(value)->count, ctx);
+    if (result != MS_JSON_SUCCESS) {
+        return result;
+    }
+
+    return ms_json_serialize_append(ctx, "}", 1);
+}
+
+/* Members begin..end of a resolved array or object, comma-separated, without brackets */
+static ms_json_result_t ms_json_serialize_members(const ms_json_value_t* value, size_t begin, size_t end,
+                                                  ms_json_serialize_context_t* ctx) {
+    ms_json_result_t result = MS_JSON_SUCCESS;
+
+    if (ms_json_value_get_type(value) == MS_JSON_ARRAY) {
+        const ms_json_array_t* array = ms_json_value_get_array_const(value);
+        for (size_t i = begin; i < end && result == MS_JSON_SUCCESS; i++) {
+            if (i > begin) {
+                result = ms_json_serialize_append(ctx, ",", 1);
+                if (result != MS_JSON_SUCCESS) {
+                    break;
+                }
+            }
+            result = ms_json_serialize_value(array->items[i], ctx);
+        }
+        return result;
+    }
+
+    const ms_json_object_t* object = ms_json_value_get_object_const(value);
+    for (size_t i = begin; i < end; i++) {
+        if (i > begin) {
+            result = ms_json_serialize_append(ctx, ",", 1);
+            if (result != MS_JSON_SUCCESS) {
+                return result;
+            }
+        }
+
+        /* Serialize key */
+        result = ms_json_serialize_string(object->entries[i].key, object->entries[i].key_length, ctx);
+        if (result != MS_JSON_SUCCESS) {
+            return result;
+        }
+
+        /* Colon separator */
+        result = ms_json_serialize_append(ctx, ":", 1);
+        if (result != MS_JSON_SUCCESS) {
+            return result;
+        }
+
+        /* Serialize value */
+        result = ms_json_serialize_value(object->entries[i].value, ctx);
+        if (result != MS_JSON_SUCCESS) {
+            return result;
+        }
+    }
+
+    return MS_JSON_SUCCESS;
+}
+
+/*
+ * Add the serialized length of value to *size. When exact is 0 a finite
+ * double is not formatted; *size becomes SERIALIZE_SIZE_UNKNOWN instead and
+ * the walk stops there.
+ */
+static ms_json_result_t ms_json_measure_value(const ms_json_value_t* value, int exact, size_t* size) {
+    char digits[MS_JSON_DOUBLE_MAX_CHARS];
+
+    switch (ms_json_value_get_type(value)) {
+        case MS_JSON_NULL:
+            *size += 4;
+            return MS_JSON_SUCCESS;
+        case MS_JSON_BOOL:
+            *size += ms_json_value_get_bool(value) ? 4 : 5;
+            return MS_JSON_SUCCESS;
+        case MS_JSON_NUMBER: {
+            if (value->flags & MS_JSON_FLAG_INTEGER) {
+                *size += ms_json_format_int64(value->data.integer, digits);
+                return MS_JSON_SUCCESS;
+            }
+            double number = ms_json_value_get_number(value);
+            if (isnan(number)) {
+                *size += 4;
+            } else if (isinf(number)) {
+                *size += number > 0 ? 5 : 6;
+            } else if (!exact) {
+                *size = SERIALIZE_SIZE_UNKNOWN;
+            } else {
+                *size += ms_json_format_double(number, digits);
+            }
+            return MS_JSON_SUCCESS;
+        }
+        case MS_JSON_STRING:
+            *size += ms_json_measure_string(ms_json_value_get_string(value), ms_json_value_get_string_length(value));
+            return MS_JSON_SUCCESS;
+        case MS_JSON_ARRAY: {
+            ms_json_result_t result = ms_json_value_resolve(value);
+            if (result != MS_JSON_SUCCESS) {
+                return result;
+            }
+            const ms_json_array_t* array = ms_json_value_get_array_const(value);
+            *size += 2 + (array->count > 0 ? array->count - 1 : 0);
+            for (size_t i = 0; i < array->count; i++) {
+                result = ms_json_measure_value(array->items[i], exact, size);
+                if (result != MS_JSON_SUCCESS || *size == SERIALIZE_SIZE_UNKNOWN) {
+                    return result;
+                }
+            }
+            return MS_JSON_SUCCESS;
+        }
+        case MS_JSON_OBJECT: {
+            ms_json_result_t result = ms_json_value_resolve(value);
+            if (result != MS_JSON_SUCCESS) {
+                return result;
+            }
+            /* Braces, a colon per member and the commas between them */
+            const ms_json_object_t* object = ms_json_value_get_object_const(value);
+            *size += 2 + (object->count > 0 ? 2 * object->count - 1 : 0);
+            for (size_t i = 0; i < object->count; i++) {
+                *size += ms_json_measure_string(object->entries[i].key, object->entries[i].key_length);
+                result = ms_json_measure_value(object->entries[i].value, exact, size);
+                if (result != MS_JSON_SUCCESS || *size == SERIALIZE_SIZE_UNKNOWN) {
+                    return result;
+                }
+            }
+            return MS_JSON_SUCCESS;
+        }
+        default:
+            return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+}
+
+/* Quoted, escaped length of a string, matching ms_json_serialize_string() */
+static size_t ms_json_measure_string(const char* value, size_t length) {
+    size_t size = 2;
+    if (!value) {
+        return size;
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)value[i];
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            size++;
+        } else if (c == '"' || c == '\\' || c == '\b' || c == '\f' || c == '\n' || c == '\r' || c == '\t') {
+            size += 2;
+        } else {
+            size += 6;
+        }
+    }
+    return size;
+}
+
+static ms_json_result_t ms_json_serialize_ensure_capacity(ms_json_serialize_context_t* ctx, size_t needed) {
+    if (ctx->position + needed <= ctx->capacity) {
+        return MS_JSON_SUCCESS;
+    }
+
+    /* Streaming: make room by draining the buffer, never by growing it */
+    if (ctx->write_fn) {
+        ms_json_result_t result = ms_json_serialize_flush(ctx);
+        if (result != MS_JSON_SUCCESS) {
+            return result;
+        }
+        return needed <= ctx->capacity ? MS_JSON_SUCCESS : MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (ctx->fixed) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    size_t new_capacity = ctx->capacity * 2;
+    if (new_capacity < ctx->position + needed) {
+        new_capacity = ctx->position + needed;
+    }
+
+    char* new_buffer = NULL;
+    if (ms_allocator_reallocate(ctx->allocator, ctx->buffer, new_capacity, (void**)&new_buffer) != MS_MEMORY_SUCCESS) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    ctx->buffer = new_buffer;
+    ctx->capacity = new_capacity;
+    return MS_JSON_SUCCESS;
+}
+
+ms_json_result_t ms_json_serialize_append(ms_json_serialize_context_t* ctx, const char* data, size_t length) {
+    /* Chunks larger than the whole sink buffer bypass it */
+    if (ctx->write_fn && ctx->position + length > ctx->capacity) {
+        ms_json_result_t result = ms_json_serialize_flush(ctx);
+        if (result != MS_JSON_SUCCESS) {
+            return result;
+        }
+        if (length > ctx->capacity) {
+            return ctx->write_fn(ctx->write_ctx, data, length);
+        }
+    }
+
+    ms_json_result_t result = ms_json_serialize_ensure_capacity(ctx, length);
+    if (result != MS_JSON_SUCCESS) {
+        return result;
+    }
+
+    memcpy(ctx->buffer + ctx->position, data, length);
+    ctx->position += length;
+    return MS_JSON_SUCCESS;
+}
+
+ms_json_result_t ms_json_serialize_flush(ms_json_serialize_context_t* ctx) {
+    if (!ctx || !ctx->write_fn || ctx->position == 0) {
+        return MS_JSON_SUCCESS;
+    }
+
+    size_t pending = ctx->position;
+    ctx->position = 0;
+    return ctx->write_fn(ctx->write_ctx, ctx->buffer, pending);
+}
+
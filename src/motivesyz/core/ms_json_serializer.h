@@ -0,0 +1,193 @@
+/*
+ * @file ms_json_serializer.h
+ * @brief JSON serialization into a growing buffer or a streaming sink
+ */
+
+#ifndef MS_JSON_SERIALIZER_H
+#define MS_JSON_SERIALIZER_H
+
+#include "ms_json.h"
+#include <stdio.h>
+
+/**
+ * @brief Sink buffer sizes
+ */
+#define MS_JSON_SINK_BUFFER_DEFAULT (64 * 1024)  /**< Used when buffer_size is 0 */
+#define MS_JSON_SINK_BUFFER_MIN 64               /**< Smaller requests are rounded up */
+
+/**
+ * @brief JSON serialization context structure
+ */
+typedef struct ms_json_serialize_context {
+    ms_allocator_t* allocator;  /**< Allocator owning the buffer */
+    char* buffer;               /**< Output buffer */
+    size_t position;            /**< Bytes pending in buffer */
+    size_t capacity;            /**< Size of buffer */
+    int needs_comma;            /**< Next element needs a separator */
+    ms_json_write_fn write_fn;  /**< Sink for full buffers; NULL grows the buffer instead */
+    void* write_ctx;            /**< User context passed to write_fn */
+    int fixed;                  /**< Buffer belongs to the caller and never grows */
+} ms_json_serialize_context_t;
+
+/**
+ * @brief Exact length of the text ms_json_serialize() produces for a value
+ *
+ * Walks the tree once, counting escapes and formatting each double, so a
+ * buffer of *result + 1 bytes holds the output and its terminator.
+ *
+ * @param value Value to measure; lazy containers are decoded
+ * @param result Output parameter for the length, excluding the NUL
+ */
+ms_json_result_t ms_json_serialized_size(const ms_json_value_t* value, size_t* result);
+
+/**
+ * @brief Serialize into a caller-provided buffer
+ *
+ * @param value Value to serialize
+ * @param buffer Output buffer, NUL-terminated on success
+ * @param capacity Size of buffer, at least ms_json_serialized_size() + 1
+ * @param length Output parameter for the text length, NULL if not needed
+ *
+ * @return MS_JSON_SUCCESS on success, MS_JSON_ERROR_MEMORY if the output
+ *         does not fit, in which case the buffer contents are unspecified
+ */
+ms_json_result_t ms_json_serialize_into(const ms_json_value_t* value, char* buffer, size_t capacity,
+                                        size_t* length);
+
+/**
+ * @brief Serialize through a fixed-size buffer flushed to a callback
+ *
+ * @param value Value to serialize
+ * @param write_fn Callback receiving output chunks
+ * @param user_ctx Passed to every write_fn call
+ * @param buffer_size Buffer size in bytes, 0 for MS_JSON_SINK_BUFFER_DEFAULT
+ *
+ * @return MS_JSON_SUCCESS on success, the callback's error if it failed,
+ *         MS_JSON_ERROR_MEMORY if the buffer could not be allocated
+ *
+ * @note Memory use is bounded by buffer_size regardless of document size
+ */
+ms_json_result_t ms_json_serialize_to_sink(const ms_json_value_t* value, ms_json_write_fn write_fn,
+                                           void* user_ctx, size_t buffer_size);
+
+/**
+ * @brief Serialize to a stdio stream through a fixed-size buffer
+ *
+ * @return MS_JSON_ERROR_IO if fwrite fails
+ */
+ms_json_result_t ms_json_serialize_to_stream(const ms_json_value_t* value, FILE* stream,
+                                             size_t buffer_size);
+
+/**
+ * @brief Serialize to a POSIX file descriptor through a fixed-size buffer
+ *
+ * Short writes are resumed and EINTR is retried.
+ *
+ * @return MS_JSON_ERROR_IO if write fails
+ */
+ms_json_result_t ms_json_serialize_to_fd(const ms_json_value_t* value, int fd, size_t buffer_size);
+
+/**
+ * @brief ms_json_print() flags
+ */
+#define MS_JSON_PRINT_COMPACT 0x0       /**< Same text as ms_json_serialize() */
+#define MS_JSON_PRINT_PRETTY 0x1        /**< One member per line, indented by two spaces */
+#define MS_JSON_PRINT_COLOR 0x2         /**< ANSI colors when the output is a terminal */
+#define MS_JSON_PRINT_COLOR_ALWAYS 0x4  /**< ANSI colors even when it is not, e.g. for a pager */
+
+/**
+ * @brief Print a value and a newline to a stdio stream
+ *
+ * Output streams through one MS_JSON_SINK_BUFFER_DEFAULT buffer, so no copy
+ * of the document text is ever built. Keys, strings, numbers and literals
+ * take the COLOR_* codes of ms_print.h; terminal detection is the one the
+ * print functions use.
+ *
+ * @param value Value to print; lazy containers are decoded
+ * @param stream Output stream
+ * @param flags MS_JSON_PRINT_* flags combined with |
+ * @return MS_JSON_SUCCESS, MS_JSON_ERROR_IO if fwrite fails, or
+ *         MS_JSON_ERROR_MEMORY
+ *
+ * @note When async print output runs, call print_flush() first so earlier
+ *       messages come out ahead of the document
+ */
+ms_json_result_t ms_json_print(const ms_json_value_t* value, FILE* stream, unsigned int flags);
+
+/**
+ * @brief Print a value and a newline to a POSIX file descriptor
+ *
+ * @return MS_JSON_ERROR_IO if write fails
+ */
+ms_json_result_t ms_json_print_fd(const ms_json_value_t* value, int fd, unsigned int flags);
+
+/**
+ * @brief Parallel serialization options
+ */
+typedef struct {
+    size_t threads;      /**< Serializer threads, 0 = one per online processor */
+    size_t min_members;  /**< Roots with fewer members are serialized on the
+                              calling thread, 0 = 1024 */
+} ms_json_parallel_options_t;
+
+/**
+ * @brief Serialize using several threads for a large root array or object
+ *
+ * The root's members are split into ranges, each serialized into its own
+ * buffer on a worker thread, and the buffers are joined in order. Output is
+ * identical to ms_json_serialize(). Nested containers are not split, so the
+ * speed-up depends on the root having many members. Trees whose allocator
+ * is not ms_allocator_default(), such as arena or pool trees, are
+ * serialized on the calling thread, since workers may decode lazy members
+ * and allocators other than the default are not thread-safe.
+ *
+ * @param value Value to serialize; must not be modified until this returns
+ * @param allocator Allocator for the result, NULL for default
+ * @param options Parallel options, NULL for defaults
+ * @param result Output parameter for the NUL-terminated text
+ */
+ms_json_result_t ms_json_serialize_parallel(const ms_json_value_t* value, ms_allocator_t* allocator,
+                                           const ms_json_parallel_options_t* options, char** result);
+
+/**
+ * @brief Serialize in parallel through a fixed-size buffer flushed to a callback
+ *
+ * Ranges are handed to write_fn in document order as they finish, always on
+ * the calling thread. Only a few ranges per thread are buffered at a time,
+ * so memory use does not grow with the document.
+ */
+ms_json_result_t ms_json_serialize_parallel_to_sink(const ms_json_value_t* value,
+                                                   const ms_json_parallel_options_t* options,
+                                                   ms_json_write_fn write_fn, void* user_ctx, size_t buffer_size);
+
+/**
+ * @brief Serialize any JSON value into context
+ */
+ms_json_result_t ms_json_serialize_value(const ms_json_value_t* value, ms_json_serialize_context_t* ctx);
+
+/**
+ * @brief Append raw bytes to context, growing or draining its buffer as needed
+ */
+ms_json_result_t ms_json_serialize_append(ms_json_serialize_context_t* ctx, const char* data, size_t length);
+
+/**
+ * @brief Append a string to context, quoted and escaped
+ */
+ms_json_result_t ms_json_serialize_string(const char* value, size_t length, ms_json_serialize_context_t* ctx);
+
+/**
+ * @brief Append a double as its shortest round-trip text; NaN becomes null
+ */
+ms_json_result_t ms_json_serialize_number(double value, ms_json_serialize_context_t* ctx);
+
+/**
+ * @brief Append an integer in decimal
+ */
+ms_json_result_t ms_json_serialize_integer(int64_t value, ms_json_serialize_context_t* ctx);
+
+/**
+ * @brief Hand buffered output to the sink
+ */
+ms_json_result_t ms_json_serialize_flush(ms_json_serialize_context_t* ctx);
+
+#endif
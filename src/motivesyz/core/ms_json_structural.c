@@ -0,0 +1,579 @@
+/**
+ * @file ms_json_structural.c
+ * @brief Two-stage parse engine: structural index, then index walk
+ *
+ * Stage one turns each 64-byte block into bit masks with the SIMD
+ * classifier and resolves escapes and string extents with a few word-wide
+ * bit operations, so the cost per block does not depend on its content.
+ * Stage two visits only the indexed offsets: strings span from one quote
+ * offset to the next, scalars are checked to end where the next index entry
+ * or whitespace begins, and nesting lives on an explicit frame stack.
+ */
+
+#include "ms_json_structural.h"
+#include "ms_json_builder.h"
+#include "ms_json_keys.h"
+#include "ms_json_internal.h"
+#include "ms_json_number.h"
+#include "ms_json_scan.h"
+#include "ms_instrument.h"
+#include <string.h>
+
+/* Configuration constants */
+#define INDEX_MIN_CAPACITY 256
+#define WALK_INITIAL_FRAMES 16
+
+/* What the walk accepts at the next index entry */
+typedef enum {
+    WALK_VALUE = 0,
+    WALK_KEY,
+    WALK_AFTER_VALUE
+} ms_json_walk_state_t;
+
+typedef struct {
+    ms_json_parse_context_t* ctx;
+    const uint32_t* positions;
+    size_t count;
+    ms_json_value_t* root;
+    ms_json_walk_frame_t* frames;
+    size_t depth;
+    size_t frame_capacity;
+    int unclosed_string;         /* Last string entry has no closing quote */
+    const char* key;             /* Key waiting for its value */
+    size_t key_length;
+    char* key_scratch;           /* Decoded escaped keys */
+    size_t key_scratch_capacity;
+} ms_json_walk_t;
+
+/* Forward declarations */
+static uint64_t ms_json_escaped_mask(uint64_t backslash, uint64_t* prev_escaped);
+static ms_json_result_t ms_json_index_reserve(ms_json_structural_index_t* index, size_t needed);
+static ms_json_result_t ms_json_index_fill(ms_json_structural_index_t* index, const char* input, size_t length);
+static ms_json_result_t ms_json_walk_value(ms_json_walk_t* walk, size_t* i, ms_json_walk_state_t* state);
+static ms_json_result_t ms_json_walk_key(ms_json_walk_t* walk, size_t* i);
+static ms_json_result_t ms_json_walk_after_value(ms_json_walk_t* walk, size_t* i, ms_json_walk_state_t* state);
+static ms_json_result_t ms_json_walk_attach(ms_json_walk_t* walk, ms_json_value_t* value);
+static ms_json_result_t ms_json_walk_open(ms_json_walk_t* walk, int is_object);
+static void ms_json_walk_release(ms_json_walk_t* walk);
+
+static inline int ms_json_structural_is_whitespace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+/* Bit i set when an odd number of bits at or below i are set: inside-string mask from quotes */
+static inline uint64_t ms_json_prefix_xor(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+/*
+ * Bytes preceded by an odd run of backslashes. Runs starting on even and odd
+ * bits are separated with one addition; the carry out records a run that
+ * escapes the first byte of the next block.
+ */
+static uint64_t ms_json_escaped_mask(uint64_t backslash, uint64_t* prev_escaped) {
+    const uint64_t even_bits = 0x5555555555555555ULL;
+
+    backslash &= ~*prev_escaped;
+    uint64_t follows_escape = (backslash << 1) | *prev_escaped;
+    uint64_t odd_sequence_starts = backslash & ~even_bits & ~follows_escape;
+    uint64_t sequences_starting_on_even_bits = odd_sequence_starts + backslash;
+    *prev_escaped = sequences_starting_on_even_bits < backslash;
+    uint64_t invert_mask = sequences_starting_on_even_bits << 1;
+    return (even_bits ^ invert_mask) & follows_escape;
+}
+
+ms_json_result_t ms_json_structural_index_build(ms_allocator_t* allocator, const char* input, size_t length,
+                                                ms_json_structural_index_t* index) {
+    if (!allocator || !index) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    index->positions = NULL;
+    index->count = 0;
+    index->capacity = 0;
+    index->unclosed_string = 0;
+    index->allocator = allocator;
+    return ms_json_structural_index_refill(index, input, length);
+}
+
+ms_json_result_t ms_json_structural_index_refill(ms_json_structural_index_t* index, const char* input,
+                                                 size_t length) {
+    if ((!input && length > 0) || length > MS_JSON_STRUCTURAL_MAX_INPUT) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    MS_INSTRUMENT_BEGIN(span, 0);
+    ms_json_result_t result = ms_json_index_fill(index, input, length);
+    MS_INSTRUMENT_END(span, MS_INSTRUMENT_TOKENIZE, length);
+    return result;
+}
+
+/* Stage one over a whole input */
+static ms_json_result_t ms_json_index_fill(ms_json_structural_index_t* index, const char* input, size_t length) {
+    index->count = 0;
+    index->unclosed_string = 0;
+
+    /* Typical documents have one structural byte per 4-16 input bytes */
+    ms_json_result_t result = ms_json_index_reserve(index, length / 8 + INDEX_MIN_CAPACITY);
+    if (result != MS_JSON_SUCCESS) {
+        return result;
+    }
+
+    uint64_t prev_escaped = 0;
+    uint64_t prev_in_string = 0;
+    uint64_t prev_scalar = 0;
+
+    for (size_t offset = 0; offset < length; offset += MS_JSON_SCAN_BLOCK_SIZE) {
+        const char* block = input + offset;
+        char padded[MS_JSON_SCAN_BLOCK_SIZE];
+        if (length - offset < MS_JSON_SCAN_BLOCK_SIZE) {
+            memset(padded, ' ', sizeof(padded));
+            memcpy(padded, block, length - offset);
+            block = padded;
+        }
+
+        ms_json_block_masks_t masks;
+        ms_json_scan_classify_block(block, &masks);
+
+        uint64_t quote = masks.quote & ~ms_json_escaped_mask(masks.backslash, &prev_escaped);
+        uint64_t in_string = ms_json_prefix_xor(quote) ^ prev_in_string;  /* Opening quote to closing quote, exclusive */
+        prev_in_string = (uint64_t)0 - (in_string >> 63);
+
+        /* Numbers and literals are indexed by their first byte only */
+        uint64_t scalar = ~(masks.operators | masks.whitespace | quote);
+        uint64_t scalar_start = scalar & ~((scalar << 1) | prev_scalar);
+        prev_scalar = scalar >> 63;
+
+        uint64_t structurals = ((masks.operators | scalar_start) & ~in_string) | quote;
+
+        if (index->count + MS_JSON_SCAN_BLOCK_SIZE + 1 > index->capacity) {
+            result = ms_json_index_reserve(index, index->count + MS_JSON_SCAN_BLOCK_SIZE + 1);
+            if (result != MS_JSON_SUCCESS) {
+                ms_json_structural_index_release(index);
+                return result;
+            }
+        }
+
+        uint32_t* out = index->positions + index->count;
+        uint32_t base = (uint32_t)offset;
+        while (structurals) {
+            *out++ = base + (uint32_t)__builtin_ctzll(structurals);
+            structurals &= structurals - 1;
+        }
+        index->count = (size_t)(out - index->positions);
+    }
+
+    /* An unterminated string gets a closing entry at the end so errors before it are still found first */
+    if (prev_in_string) {
+        index->positions[index->count++] = (uint32_t)length;
+        index->unclosed_string = 1;
+    }
+
+    index->positions[index->count] = (uint32_t)length;
+    return MS_JSON_SUCCESS;
+}
+
+void ms_json_structural_index_release(ms_json_structural_index_t* index) {
+    if (!index) {
+        return;
+    }
+
+    if (index->positions) {
+        ms_allocator_deallocate(index->allocator, index->positions);
+    }
+    index->positions = NULL;
+    index->count = 0;
+    index->capacity = 0;
+}
+
+static ms_json_result_t ms_json_index_reserve(ms_json_structural_index_t* index, size_t needed) {
+    if (needed <= index->capacity) {
+        return MS_JSON_SUCCESS;
+    }
+
+    size_t new_capacity = index->capacity ? index->capacity * 2 : INDEX_MIN_CAPACITY;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+
+    uint32_t* new_positions = NULL;
+    if (ms_allocator_reallocate(index->allocator, index->positions, new_capacity * sizeof(uint32_t),
+                                (void**)&new_positions) != MS_MEMORY_SUCCESS) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    index->positions = new_positions;
+    index->capacity = new_capacity;
+    return MS_JSON_SUCCESS;
+}
+
+ms_json_result_t ms_json_structural_parse(ms_json_parse_context_t* ctx, ms_json_value_t** result) {
+    if (!ctx || !result) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    /* Scratch state is short-lived, so it stays out of arenas meant for the tree */
+    ms_json_parse_scratch_t* scratch = ctx->scratch;
+    ms_json_structural_index_t local_index;
+    ms_json_structural_index_t* index = scratch ? &scratch->index : &local_index;
+    ms_json_result_t status = scratch ? ms_json_structural_index_refill(index, ctx->input, ctx->length)
+                                      : ms_json_structural_index_build(ms_allocator_default(), ctx->input,
+                                                                       ctx->length, index);
+    if (status != MS_JSON_SUCCESS) {
+        return status;
+    }
+
+    ms_json_walk_t walk;
+    memset(&walk, 0, sizeof(walk));
+    walk.ctx = ctx;
+    walk.positions = index->positions;
+    walk.count = index->count;
+    walk.unclosed_string = index->unclosed_string;
+    if (scratch) {
+        walk.frames = scratch->frames;
+        walk.frame_capacity = scratch->frame_capacity;
+        walk.key_scratch = scratch->key_scratch;
+        walk.key_scratch_capacity = scratch->key_scratch_capacity;
+    }
+
+    size_t i = 0;
+    ms_json_walk_state_t state = WALK_VALUE;
+    while (status == MS_JSON_SUCCESS) {
+        if (state == WALK_AFTER_VALUE && walk.depth == 0) {
+            /* Root complete: only whitespace may follow */
+            if (i < walk.count) {
+                status = MS_JSON_ERROR_SYNTAX;
+            }
+            break;
+        }
+
+        if (i >= walk.count) {
+            status = MS_JSON_ERROR_EOF;
+            break;
+        }
+
+        switch (state) {
+            case WALK_VALUE:
+                status = ms_json_walk_value(&walk, &i, &state);
+                break;
+            case WALK_KEY:
+                status = ms_json_walk_key(&walk, &i);
+                state = WALK_VALUE;
+                break;
+            default:
+                status = ms_json_walk_after_value(&walk, &i, &state);
+                break;
+        }
+    }
+
+    if (status == MS_JSON_SUCCESS) {
+        *result = walk.root;
+        walk.root = NULL;
+    }
+
+    /* Hand the grown buffers back instead of freeing them */
+    if (scratch) {
+        scratch->frames = walk.frames;
+        scratch->frame_capacity = walk.frame_capacity;
+        scratch->key_scratch = walk.key_scratch;
+        scratch->key_scratch_capacity = walk.key_scratch_capacity;
+        walk.frames = NULL;
+        walk.key_scratch = NULL;
+    }
+
+    ms_json_walk_release(&walk);
+    if (!scratch) {
+        ms_json_structural_index_release(index);
+    }
+    return status;
+}
+
+void ms_json_parse_scratch_init(ms_json_parse_scratch_t* scratch) {
+    memset(scratch, 0, sizeof(*scratch));
+    scratch->index.allocator = ms_allocator_default();
+}
+
+void ms_json_parse_scratch_release(ms_json_parse_scratch_t* scratch) {
+    ms_json_structural_index_release(&scratch->index);
+    if (scratch->frames) {
+        ms_allocator_deallocate(ms_allocator_default(), scratch->frames);
+    }
+    if (scratch->key_scratch) {
+        ms_allocator_deallocate(ms_allocator_default(), scratch->key_scratch);
+    }
+    ms_json_parse_scratch_init(scratch);
+}
+
+/* Value at entry i; containers are opened here and closed by after_value */
+static ms_json_result_t ms_json_walk_value(ms_json_walk_t* walk, size_t* i, ms_json_walk_state_t* state) {
+    const char* input = walk->ctx->input;
+    char c = input[walk->positions[*i]];
+
+    if (c == '{' || c == '[') {
+        int is_object = c == '{';
+        ms_json_result_t result = ms_json_walk_open(walk, is_object);
+        if (result != MS_JSON_SUCCESS) {
+            return result;
+        }
+        (*i)++;
+
+        /* Empty containers close immediately */
+        if (*i < walk->count && input[walk->positions[*i]] == (is_object ? '}' : ']')) {
+            (*i)++;
+            walk->depth--;
+            *state = WALK_AFTER_VALUE;
+        } else {
+            *state = is_object ? WALK_KEY : WALK_VALUE;
+        }
+        return MS_JSON_SUCCESS;
+    }
+
+    /* Stage one guarantees every opening quote is followed by its closing entry */
+    if (c == '"' && walk->unclosed_string && *i + 2 == walk->count) {
+        return MS_JSON_ERROR_EOF;
+    }
+
+    ms_json_value_t* value = NULL;
+    ms_json_result_t result = c == '"' ? ms_json_structural_string(walk->ctx, walk->positions, *i, &value)
+                                       : ms_json_structural_scalar(walk->ctx, walk->positions, *i, &value);
+    if (result != MS_JSON_SUCCESS) {
+        return result;
+    }
+
+    *i += c == '"' ? 2 : 1;
+    *state = WALK_AFTER_VALUE;
+    return ms_json_walk_attach(walk, value);
+}
+
+/* Key string and colon; the key is kept until its value is attached */
+static ms_json_result_t ms_json_walk_key(ms_json_walk_t* walk, size_t* i) {
+    const char* input = walk->ctx->input;
+    uint32_t start = walk->positions[*i];
+
+    if (input[start] != '"') {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    if (walk->unclosed_string && *i + 2 == walk->count) {
+        return MS_JSON_ERROR_EOF;
+    }
+
+    const char* raw = input + start + 1;
+    size_t raw_length = walk->positions[*i + 1] - start - 1;
+    if (raw_length > MS_JSON_MAX_STRING_LENGTH) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    walk->key = raw;
+    walk->key_length = raw_length;
+    if (memchr(raw, '\\', raw_length)) {
+        if (raw_length + 1 > walk->key_scratch_capacity) {
+            char* scratch = NULL;
+            if (ms_allocator_reallocate(ms_allocator_default(), walk->key_scratch, raw_length + 1,
+                                        (void**)&scratch) != MS_MEMORY_SUCCESS) {
+                return MS_JSON_ERROR_MEMORY;
+            }
+            walk->key_scratch = scratch;
+            walk->key_scratch_capacity = raw_length + 1;
+        }
+
+        if (!ms_json_decode_string(raw, raw_length, walk->key_scratch, &walk->key_length)) {
+            return MS_JSON_ERROR_SYNTAX;
+        }
+        walk->key = walk->key_scratch;
+    }
+
+    *i += 2;
+    if (*i >= walk->count || input[walk->positions[*i]] != ':') {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    (*i)++;
+    return MS_JSON_SUCCESS;
+}
+
+static ms_json_result_t ms_json_walk_after_value(ms_json_walk_t* walk, size_t* i, ms_json_walk_state_t* state) {
+    char c = walk->ctx->input[walk->positions[*i]];
+    int in_object = walk->frames[walk->depth - 1].is_object;
+
+    if (c == ',') {
+        (*i)++;
+        *state = in_object ? WALK_KEY : WALK_VALUE;
+        return MS_JSON_SUCCESS;
+    }
+
+    if (c != (in_object ? '}' : ']')) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    (*i)++;
+    walk->depth--;
+    return MS_JSON_SUCCESS;
+}
+
+ms_json_result_t ms_json_structural_string(const ms_json_parse_context_t* ctx, const uint32_t* positions,
+                                           size_t i, ms_json_value_t** value) {
+    uint32_t start = positions[i];
+    const char* raw = ctx->input + start + 1;
+    size_t raw_length = positions[i + 1] - start - 1;
+
+    if (raw_length > MS_JSON_MAX_STRING_LENGTH) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    if (!memchr(raw, '\\', raw_length)) {
+        *value = ctx->options.zero_copy ? ms_json_create_string_borrowed(ctx->allocator, raw, raw_length)
+                                        : ms_json_create_string_n(ctx->allocator, raw, raw_length);
+        return *value ? MS_JSON_SUCCESS : MS_JSON_ERROR_MEMORY;
+    }
+
+    char* decoded = NULL;
+    if (ms_allocator_allocate(ctx->allocator, raw_length + 1, (void**)&decoded) != MS_MEMORY_SUCCESS) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    size_t decoded_length = 0;
+    if (!ms_json_decode_string(raw, raw_length, decoded, &decoded_length)) {
+        ms_allocator_deallocate(ctx->allocator, decoded);
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    *value = ms_json_create_string_owned(ctx->allocator, decoded, decoded_length);
+    if (!*value) {
+        ms_allocator_deallocate(ctx->allocator, decoded);
+        return MS_JSON_ERROR_MEMORY;
+    }
+    return MS_JSON_SUCCESS;
+}
+
+ms_json_result_t ms_json_structural_read_scalar(const ms_json_parse_context_t* ctx, const uint32_t* positions,
+                                                size_t i, ms_json_scalar_t* scalar) {
+    const char* input = ctx->input;
+    size_t start = positions[i];
+    size_t end = start;
+    char c = input[start];
+    size_t available = ctx->length - start;
+
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        size_t consumed = 0;
+        ms_json_result_t result = ms_json_parse_number_text(input + start, available, &consumed, &scalar->number);
+        if (result != MS_JSON_SUCCESS) {
+            return result;
+        }
+        scalar->type = MS_JSON_NUMBER;
+        end = start + consumed;
+    } else if (available >= 4 && memcmp(input + start, "null", 4) == 0) {
+        scalar->type = MS_JSON_NULL;
+        end = start + 4;
+    } else if (available >= 4 && memcmp(input + start, "true", 4) == 0) {
+        scalar->type = MS_JSON_BOOL;
+        scalar->boolean = 1;
+        end = start + 4;
+    } else if (available >= 5 && memcmp(input + start, "false", 5) == 0) {
+        scalar->type = MS_JSON_BOOL;
+        scalar->boolean = 0;
+        end = start + 5;
+    } else {
+        return (c == 'n' || c == 't' || c == 'f') && available < 4 ? MS_JSON_ERROR_EOF : MS_JSON_ERROR_SYNTAX;
+    }
+
+    if (end != positions[i + 1] && !ms_json_structural_is_whitespace(input[end])) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+    return MS_JSON_SUCCESS;
+}
+
+ms_json_result_t ms_json_structural_scalar(const ms_json_parse_context_t* ctx, const uint32_t* positions,
+                                           size_t i, ms_json_value_t** value) {
+    ms_json_scalar_t scalar;
+    ms_json_result_t result = ms_json_structural_read_scalar(ctx, positions, i, &scalar);
+    if (result != MS_JSON_SUCCESS) {
+        return result;
+    }
+
+    switch (scalar.type) {
+        case MS_JSON_NUMBER:
+            *value = scalar.number.is_integer ? ms_json_create_integer(ctx->allocator, scalar.number.integer)
+                                              : ms_json_create_number(ctx->allocator, scalar.number.number);
+            break;
+        case MS_JSON_BOOL:
+            *value = ms_json_create_bool(ctx->allocator, scalar.boolean);
+            break;
+        default:
+            *value = ms_json_create_null(ctx->allocator);
+            break;
+    }
+    return *value ? MS_JSON_SUCCESS : MS_JSON_ERROR_MEMORY;
+}
+
+/* Link a finished value into its parent; the tree owns it from here on */
+static ms_json_result_t ms_json_walk_attach(ms_json_walk_t* walk, ms_json_value_t* value) {
+    if (walk->depth == 0) {
+        walk->root = value;
+        return MS_JSON_SUCCESS;
+    }
+
+    ms_json_walk_frame_t* parent = &walk->frames[walk->depth - 1];
+    ms_json_result_t result = parent->is_object
+                                  ? ms_json_object_set_n(parent->container, walk->key, walk->key_length, value)
+                                  : ms_json_array_append(parent->container, value);
+    if (result != MS_JSON_SUCCESS) {
+        ms_json_destroy(value, walk->ctx->allocator);
+    }
+    return result;
+}
+
+static ms_json_result_t ms_json_walk_open(ms_json_walk_t* walk, int is_object) {
+    ms_json_parse_context_t* ctx = walk->ctx;
+    if (ctx->options.max_depth > 0 && walk->depth >= ctx->options.max_depth) {
+        return MS_JSON_ERROR_DEPTH;
+    }
+
+    if (walk->depth == walk->frame_capacity) {
+        size_t new_capacity = walk->frame_capacity ? walk->frame_capacity * 2 : WALK_INITIAL_FRAMES;
+        ms_json_walk_frame_t* new_frames = NULL;
+        if (ms_allocator_reallocate(ms_allocator_default(), walk->frames, new_capacity * sizeof(*new_frames),
+                                    (void**)&new_frames) != MS_MEMORY_SUCCESS) {
+            return MS_JSON_ERROR_MEMORY;
+        }
+        walk->frames = new_frames;
+        walk->frame_capacity = new_capacity;
+    }
+
+    ms_json_value_t* container = is_object ? ms_json_create_object_interned(ctx->allocator, ctx->keys)
+                                           : ms_json_create_array(ctx->allocator);
+    if (!container) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    ms_json_result_t result = ms_json_walk_attach(walk, container);
+    if (result != MS_JSON_SUCCESS) {
+        return result;
+    }
+
+    walk->frames[walk->depth].container = container;
+    walk->frames[walk->depth].is_object = is_object;
+    walk->depth++;
+    return MS_JSON_SUCCESS;
+}
+
+static void ms_json_walk_release(ms_json_walk_t* walk) {
+    if (walk->root) {
+        ms_json_destroy(walk->root, walk->ctx->allocator);
+        walk->root = NULL;
+    }
+    if (walk->frames) {
+        ms_allocator_deallocate(ms_allocator_default(), walk->frames);
+        walk->frames = NULL;
+    }
+    if (walk->key_scratch) {
+        ms_allocator_deallocate(ms_allocator_default(), walk->key_scratch);
+        walk->key_scratch = NULL;
+    }
+}
@@ -0,0 +1,130 @@
+/**
+ * @file ms_json_structural.h
+ * @brief Internal two-stage parse engine
+ *
+ * Stage one classifies the input 64 bytes at a time and records the offset
+ * of every operator, every unescaped quote and the first byte of every
+ * number or literal. Stage two walks that index to build the tree without
+ * looking at the bytes in between. Not part of the public API.
+ */
+
+#ifndef MS_JSON_STRUCTURAL_H
+#define MS_JSON_STRUCTURAL_H
+
+#include "ms_json_parser.h"
+#include "ms_json_number.h"
+#include <stdint.h>
+
+/* Offsets are 32-bit, so longer inputs use the recursive engine */
+#define MS_JSON_STRUCTURAL_MAX_INPUT ((size_t)UINT32_MAX)
+
+/**
+ * @brief Offsets of the structural bytes of a document
+ */
+typedef struct {
+    uint32_t* positions;        /**< Ascending offsets, then a sentinel equal to the input length */
+    size_t count;               /**< Entries before the sentinel */
+    size_t capacity;            /**< Allocated entries */
+    int unclosed_string;        /**< Last string has no closing quote; its closing entry is length */
+    ms_allocator_t* allocator;  /**< Owner of positions */
+} ms_json_structural_index_t;
+
+/**
+ * @brief Build the structural index of input (stage one)
+ *
+ * @param allocator Allocator for the index
+ * @param input Input buffer
+ * @param length Input length, at most MS_JSON_STRUCTURAL_MAX_INPUT
+ * @param index Output parameter, released with ms_json_structural_index_release()
+ *
+ * @return MS_JSON_SUCCESS on success, MS_JSON_ERROR_MEMORY if allocation failed
+ */
+ms_json_result_t ms_json_structural_index_build(ms_allocator_t* allocator, const char* input, size_t length,
+                                                ms_json_structural_index_t* index);
+
+/**
+ * @brief Rebuild an index over new input, reusing its offsets buffer
+ *
+ * @param index Index built before, or set up by ms_json_parse_scratch_init()
+ */
+ms_json_result_t ms_json_structural_index_refill(ms_json_structural_index_t* index, const char* input,
+                                                 size_t length);
+
+/**
+ * @brief Free the offsets held by index
+ */
+void ms_json_structural_index_release(ms_json_structural_index_t* index);
+
+/* Open container on the walk's nesting stack */
+typedef struct {
+    ms_json_value_t* container;  /* Owned by the tree, not by the frame */
+    int is_object;
+} ms_json_walk_frame_t;
+
+/**
+ * @brief Buffers the structural engine keeps between parses
+ *
+ * Held by a parser handle and passed in ctx->scratch. Only capacity carries
+ * over, sized by the largest document so far; all of it is allocated from
+ * the default allocator, never from the tree's.
+ */
+typedef struct ms_json_parse_scratch {
+    ms_json_structural_index_t index;
+    ms_json_walk_frame_t* frames;
+    size_t frame_capacity;
+    char* key_scratch;
+    size_t key_scratch_capacity;
+} ms_json_parse_scratch_t;
+
+void ms_json_parse_scratch_init(ms_json_parse_scratch_t* scratch);
+void ms_json_parse_scratch_release(ms_json_parse_scratch_t* scratch);
+
+/**
+ * @brief Parse the whole of ctx->input with both stages
+ *
+ * Accepts exactly the documents ms_json_parse_value() plus the trailing
+ * content check accept, without comments.
+ */
+ms_json_result_t ms_json_structural_parse(ms_json_parse_context_t* ctx, ms_json_value_t** result);
+
+/**
+ * @brief Decode the string whose opening quote is entry i of positions
+ *
+ * Entry i + 1 must be its closing quote. Strings borrow ctx->input when
+ * ctx->options.zero_copy is set and need no unescaping.
+ */
+ms_json_result_t ms_json_structural_string(const ms_json_parse_context_t* ctx, const uint32_t* positions,
+                                           size_t i, ms_json_value_t** value);
+
+/**
+ * @brief Number or literal read from the input
+ */
+typedef struct {
+    ms_json_type_t type;      /**< MS_JSON_NULL, MS_JSON_BOOL or MS_JSON_NUMBER */
+    int boolean;              /**< Value of a boolean */
+    ms_json_number_t number;  /**< Value of a number */
+} ms_json_scalar_t;
+
+/**
+ * @brief Read the number or literal starting at entry i of positions
+ *
+ * The scalar must run up to whitespace or the offset of entry i + 1.
+ */
+ms_json_result_t ms_json_structural_read_scalar(const ms_json_parse_context_t* ctx, const uint32_t* positions,
+                                                size_t i, ms_json_scalar_t* scalar);
+
+/**
+ * @brief Decode the number or literal starting at entry i of positions into a value
+ */
+ms_json_result_t ms_json_structural_scalar(const ms_json_parse_context_t* ctx, const uint32_t* positions,
+                                           size_t i, ms_json_value_t** value);
+
+/**
+ * @brief Parse ctx->input into a tree whose containers are decoded on first access
+ *
+ * Only the structural index and the bracket nesting are checked up front;
+ * see ms_json_options_t.lazy.
+ */
+ms_json_result_t ms_json_lazy_parse(ms_json_parse_context_t* ctx, ms_json_value_t** result);
+
+#endif /* MS_JSON_STRUCTURAL_H */
@@ -0,0 +1,590 @@
+/**
+ * @file ms_json_tape.c
+ * @brief Flat tape documents built from the structural index
+ *
+ * Entry layout: the top 8 bits hold a tag character and the low 56 bits a
+ * payload.
+ *
+ *   '[' '{'  (children << 32) | entry of the closing bracket; children
+ *            saturates at TAPE_COUNT_SATURATED
+ *   ']' '}'  entry of the opening bracket
+ *   '"'      offset in the string buffer of a 32-bit length, the bytes and a NUL
+ *   'l' 'd'  no payload; the next entry holds the int64_t or double bits
+ *   'n' 't' 'f'
+ *
+ * Object members are a key string entry followed by the value entries.
+ */
+
+#include "ms_json_tape.h"
+#include "ms_json_structural.h"
+#include "ms_json_internal.h"
+#include <string.h>
+
+/* Configuration constants */
+#define TAPE_INITIAL_FRAMES 16
+#define TAPE_TAG_SHIFT 56
+#define TAPE_PAYLOAD_MASK ((UINT64_C(1) << TAPE_TAG_SHIFT) - 1)
+#define TAPE_INDEX_MASK UINT64_C(0xFFFFFFFF)
+#define TAPE_COUNT_SATURATED UINT64_C(0xFFFFFF)  /* 24 bits above the jump offset */
+#define TAPE_STRING_OVERHEAD 5                   /* Length prefix and NUL */
+
+struct ms_json_tape {
+    uint64_t* entries;
+    size_t count;
+    char* strings;
+    size_t strings_length;
+    ms_allocator_t* allocator;
+};
+
+/* Open container while building */
+typedef struct {
+    size_t entry;     /* Tape entry of the opening bracket */
+    size_t children;  /* Elements or members so far */
+    int is_object;
+} ms_json_tape_frame_t;
+
+typedef enum {
+    TAPE_VALUE = 0,
+    TAPE_KEY,
+    TAPE_AFTER_VALUE
+} ms_json_tape_state_t;
+
+typedef struct {
+    ms_json_parse_context_t* ctx;
+    const uint32_t* positions;
+    size_t count;
+    int unclosed_string;
+    ms_json_tape_t* tape;
+    ms_json_tape_frame_t* frames;
+    size_t depth;
+    size_t frame_capacity;
+} ms_json_tape_builder_t;
+
+/* Forward declarations */
+static ms_json_result_t ms_json_tape_build(ms_json_tape_builder_t* builder);
+static ms_json_result_t ms_json_tape_value(ms_json_tape_builder_t* builder, size_t* i, ms_json_tape_state_t* state);
+static ms_json_result_t ms_json_tape_key(ms_json_tape_builder_t* builder, size_t* i);
+static ms_json_result_t ms_json_tape_after_value(ms_json_tape_builder_t* builder, size_t* i,
+                                                 ms_json_tape_state_t* state);
+static ms_json_result_t ms_json_tape_string(ms_json_tape_builder_t* builder, size_t i);
+static ms_json_result_t ms_json_tape_open(ms_json_tape_builder_t* builder, int is_object);
+static void ms_json_tape_close(ms_json_tape_builder_t* builder);
+static size_t ms_json_tape_skip(const ms_json_tape_t* tape, size_t index);
+
+static inline uint64_t ms_json_tape_entry(char tag, uint64_t payload) {
+    return ((uint64_t)(unsigned char)tag << TAPE_TAG_SHIFT) | payload;
+}
+
+static inline char ms_json_tape_tag(const ms_json_tape_t* tape, size_t index) {
+    return (char)(tape->entries[index] >> TAPE_TAG_SHIFT);
+}
+
+static inline uint64_t ms_json_tape_payload(const ms_json_tape_t* tape, size_t index) {
+    return tape->entries[index] & TAPE_PAYLOAD_MASK;
+}
+
+ms_json_result_t ms_json_tape_parse(const char* input, size_t length, const ms_json_options_t* options,
+                                    ms_json_tape_t** result) {
+    if ((!input && length > 0) || !result || length > MS_JSON_STRUCTURAL_MAX_INPUT) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    *result = NULL;
+
+    ms_json_parse_context_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.input = input;
+    ctx.length = length;
+    if (options) {
+        ctx.options = *options;
+    } else {
+        ctx.options.max_depth = MS_JSON_MAX_DEPTH_DEFAULT;
+    }
+    ctx.allocator = ctx.options.allocator ? ctx.options.allocator : ms_allocator_default();
+
+    if (ctx.options.allow_comments) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    /* Scratch index stays out of arenas meant for the tape */
+    ms_json_structural_index_t index;
+    ms_json_result_t status = ms_json_structural_index_build(ms_allocator_default(), input, length, &index);
+    if (status != MS_JSON_SUCCESS) {
+        return status;
+    }
+
+    /* Each index entry yields at most two tape entries and a string at most its raw bytes plus overhead */
+    size_t entry_capacity = 2 * index.count + 1;
+    size_t strings_capacity = length + (index.count / 2 + 1) * TAPE_STRING_OVERHEAD;
+    if (entry_capacity > TAPE_INDEX_MASK) {
+        ms_json_structural_index_release(&index);
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    ms_json_tape_t* tape = NULL;
+    if (ms_allocator_allocate(ctx.allocator, sizeof(*tape), (void**)&tape) != MS_MEMORY_SUCCESS) {
+        ms_json_structural_index_release(&index);
+        return MS_JSON_ERROR_MEMORY;
+    }
+    memset(tape, 0, sizeof(*tape));
+    tape->allocator = ctx.allocator;
+
+    if (ms_allocator_allocate(ctx.allocator, entry_capacity * sizeof(uint64_t),
+                              (void**)&tape->entries) != MS_MEMORY_SUCCESS ||
+        ms_allocator_allocate(ctx.allocator, strings_capacity, (void**)&tape->strings) != MS_MEMORY_SUCCESS) {
+        ms_json_tape_destroy(tape);
+        ms_json_structural_index_release(&index);
+        return MS_JSON_ERROR_MEMORY;
+    }
+
+    ms_json_tape_builder_t builder;
+    memset(&builder, 0, sizeof(builder));
+    builder.ctx = &ctx;
+    builder.positions = index.positions;
+    builder.count = index.count;
+    builder.unclosed_string = index.unclosed_string;
+    builder.tape = tape;
+
+    status = ms_json_tape_build(&builder);
+
+    if (builder.frames) {
+        ms_allocator_deallocate(ms_allocator_default(), builder.frames);
+    }
+    ms_json_structural_index_release(&index);
+
+    if (status != MS_JSON_SUCCESS) {
+        ms_json_tape_destroy(tape);
+        return status;
+    }
+
+    *result = tape;
+    return MS_JSON_SUCCESS;
+}
+
+void ms_json_tape_destroy(ms_json_tape_t* tape) {
+    if (!tape) {
+        return;
+    }
+
+    if (tape->entries) {
+        ms_allocator_deallocate(tape->allocator, tape->entries);
+    }
+    if (tape->strings) {
+        ms_allocator_deallocate(tape->allocator, tape->strings);
+    }
+    ms_allocator_deallocate(tape->allocator, tape);
+}
+
+/* Same walk as the structural engine, writing entries instead of nodes */
+static ms_json_result_t ms_json_tape_build(ms_json_tape_builder_t* builder) {
+    ms_json_result_t status = MS_JSON_SUCCESS;
+    ms_json_tape_state_t state = TAPE_VALUE;
+    size_t i = 0;
+
+    while (status == MS_JSON_SUCCESS) {
+        if (state == TAPE_AFTER_VALUE && builder->depth == 0) {
+            /* Root complete: only whitespace may follow */
+            return i < builder->count ? MS_JSON_ERROR_SYNTAX : MS_JSON_SUCCESS;
+        }
+
+        if (i >= builder->count) {
+            return MS_JSON_ERROR_EOF;
+        }
+
+        switch (state) {
+            case TAPE_VALUE:
+                status = ms_json_tape_value(builder, &i, &state);
+                break;
+            case TAPE_KEY:
+                status = ms_json_tape_key(builder, &i);
+                state = TAPE_VALUE;
+                break;
+            default:
+                status = ms_json_tape_after_value(builder, &i, &state);
+                break;
+        }
+    }
+
+    return status;
+}
+
+static ms_json_result_t ms_json_tape_value(ms_json_tape_builder_t* builder, size_t* i, ms_json_tape_state_t* state) {
+    const char* input = builder->ctx->input;
+    ms_json_tape_t* tape = builder->tape;
+    char c = input[builder->positions[*i]];
+
+    if (builder->depth > 0 && !builder->frames[builder->depth - 1].is_object) {
+        builder->frames[builder->depth - 1].children++;
+    }
+
+    if (c == '{' || c == '[') {
+        int is_object = c == '{';
+        ms_json_result_t result = ms_json_tape_open(builder, is_object);
+        if (result != MS_JSON_SUCCESS) {
+            return result;
+        }
+        (*i)++;
+
+        /* Empty containers close immediately */
+        if (*i < builder->count && input[builder->positions[*i]] == (is_object ? '}' : ']')) {
+            (*i)++;
+            ms_json_tape_close(builder);
+            *state = TAPE_AFTER_VALUE;
+        } else {
+            *state = is_object ? TAPE_KEY : TAPE_VALUE;
+        }
+        return MS_JSON_SUCCESS;
+    }
+
+    if (c == '"') {
+        /* Stage one guarantees every opening quote is followed by its closing entry */
+        if (builder->unclosed_string && *i + 2 == builder->count) {
+            return MS_JSON_ERROR_EOF;
+        }
+        ms_json_result_t result = ms_json_tape_string(builder, *i);
+        if (result != MS_JSON_SUCCESS) {
+            return result;
+        }
+        *i += 2;
+        *state = TAPE_AFTER_VALUE;
+        return MS_JSON_SUCCESS;
+    }
+
+    ms_json_scalar_t scalar;
+    ms_json_result_t result = ms_json_structural_read_scalar(builder->ctx, builder->positions, *i, &scalar);
+    if (result != MS_JSON_SUCCESS) {
+        return result;
+    }
+
+    if (scalar.type == MS_JSON_NUMBER) {
+        uint64_t bits;
+        if (scalar.number.is_integer) {
+            memcpy(&bits, &scalar.number.integer, sizeof(bits));
+            tape->entries[tape->count++] = ms_json_tape_entry('l', 0);
+        } else {
+            memcpy(&bits, &scalar.number.number, sizeof(bits));
+            tape->entries[tape->count++] = ms_json_tape_entry('d', 0);
+        }
+        tape->entries[tape->count++] = bits;
+    } else if (scalar.type == MS_JSON_BOOL) {
+        tape->entries[tape->count++] = ms_json_tape_entry(scalar.boolean ? 't' : 'f', 0);
+    } else {
+        tape->entries[tape->count++] = ms_json_tape_entry('n', 0);
+    }
+
+    (*i)++;
+    *state = TAPE_AFTER_VALUE;
+    return MS_JSON_SUCCESS;
+}
+
+static ms_json_result_t ms_json_tape_key(ms_json_tape_builder_t* builder, size_t* i) {
+    const char* input = builder->ctx->input;
+
+    if (input[builder->positions[*i]] != '"') {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    if (builder->unclosed_string && *i + 2 == builder->count) {
+        return MS_JSON_ERROR_EOF;
+    }
+
+    builder->frames[builder->depth - 1].children++;
+    ms_json_result_t result = ms_json_tape_string(builder, *i);
+    if (result != MS_JSON_SUCCESS) {
+        return result;
+    }
+
+    *i += 2;
+    if (*i >= builder->count || input[builder->positions[*i]] != ':') {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    (*i)++;
+    return MS_JSON_SUCCESS;
+}
+
+static ms_json_result_t ms_json_tape_after_value(ms_json_tape_builder_t* builder, size_t* i,
+                                                 ms_json_tape_state_t* state) {
+    char c = builder->ctx->input[builder->positions[*i]];
+    int in_object = builder->frames[builder->depth - 1].is_object;
+
+    if (c == ',') {
+        (*i)++;
+        *state = in_object ? TAPE_KEY : TAPE_VALUE;
+        return MS_JSON_SUCCESS;
+    }
+
+    if (c != (in_object ? '}' : ']')) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    (*i)++;
+    ms_json_tape_close(builder);
+    return MS_JSON_SUCCESS;
+}
+
+/* Copy the string at index entry i, unescaped, into the string buffer */
+static ms_json_result_t ms_json_tape_string(ms_json_tape_builder_t* builder, size_t i) {
+    ms_json_tape_t* tape = builder->tape;
+    uint32_t start = builder->positions[i];
+    const char* raw = builder->ctx->input + start + 1;
+    size_t raw_length = builder->positions[i + 1] - start - 1;
+
+    if (raw_length > MS_JSON_MAX_STRING_LENGTH) {
+        return MS_JSON_ERROR_SYNTAX;
+    }
+
+    char* out = tape->strings + tape->strings_length;
+    size_t length = raw_length;
+    if (memchr(raw, '\\', raw_length)) {
+        if (!ms_json_decode_string(raw, raw_length, out + sizeof(uint32_t), &length)) {
+            return MS_JSON_ERROR_SYNTAX;
+        }
+    } else {
+        memcpy(out + sizeof(uint32_t), raw, raw_length);
+    }
+
+    uint32_t stored_length = (uint32_t)length;
+    memcpy(out, &stored_length, sizeof(stored_length));
+    out[sizeof(uint32_t) + length] = '\0';
+
+    tape->entries[tape->count++] = ms_json_tape_entry('"', tape->strings_length);
+    tape->strings_length += sizeof(uint32_t) + length + 1;
+    return MS_JSON_SUCCESS;
+}
+
+static ms_json_result_t ms_json_tape_open(ms_json_tape_builder_t* builder, int is_object) {
+    size_t max_depth = builder->ctx->options.max_depth;
+    if (max_depth > 0 && builder->depth >= max_depth) {
+        return MS_JSON_ERROR_DEPTH;
+    }
+
+    if (builder->depth == builder->frame_capacity) {
+        size_t new_capacity = builder->frame_capacity ? builder->frame_capacity * 2 : TAPE_INITIAL_FRAMES;
+        ms_json_tape_frame_t* new_frames = NULL;
+        if (ms_allocator_reallocate(ms_allocator_default(), builder->frames, new_capacity * sizeof(*new_frames),
+                                    (void**)&new_frames) != MS_MEMORY_SUCCESS) {
+            return MS_JSON_ERROR_MEMORY;
+        }
+        builder->frames = new_frames;
+        builder->frame_capacity = new_capacity;
+    }
+
+    ms_json_tape_t* tape = builder->tape;
+    ms_json_tape_frame_t* frame = &builder->frames[builder->depth++];
+    frame->entry = tape->count;
+    frame->children = 0;
+    frame->is_object = is_object;
+
+    tape->entries[tape->count++] = ms_json_tape_entry(is_object ? '{' : '[', 0);
+    return MS_JSON_SUCCESS;
+}
+
+/* Write the closing entry and point both ends at each other */
+static void ms_json_tape_close(ms_json_tape_builder_t* builder) {
+    ms_json_tape_t* tape = builder->tape;
+    ms_json_tape_frame_t* frame = &builder->frames[--builder->depth];
+    size_t close = tape->count++;
+
+    uint64_t children = frame->children < TAPE_COUNT_SATURATED ? frame->children : TAPE_COUNT_SATURATED;
+    tape->entries[close] = ms_json_tape_entry(frame->is_object ? '}' : ']', frame->entry);
+    tape->entries[frame->entry] = ms_json_tape_entry(frame->is_object ? '{' : '[', (children << 32) | close);
+}
+
+/* Entry just past the value at index */
+static size_t ms_json_tape_skip(const ms_json_tape_t* tape, size_t index) {
+    switch (ms_json_tape_tag(tape, index)) {
+        case '[':
+        case '{':
+            return (size_t)(ms_json_tape_payload(tape, index) & TAPE_INDEX_MASK) + 1;
+        case 'l':
+        case 'd':
+            return index + 2;
+        default:
+            return index + 1;
+    }
+}
+
+ms_json_tape_value_t ms_json_tape_root(const ms_json_tape_t* tape) {
+    ms_json_tape_value_t root = { tape, 0 };
+    return root;
+}
+
+ms_json_type_t ms_json_tape_get_type(ms_json_tape_value_t value) {
+    if (!value.tape) {
+        return MS_JSON_NULL;
+    }
+
+    switch (ms_json_tape_tag(value.tape, value.index)) {
+        case 't':
+        case 'f':
+            return MS_JSON_BOOL;
+        case 'l':
+        case 'd':
+            return MS_JSON_NUMBER;
+        case '"':
+            return MS_JSON_STRING;
+        case '[':
+            return MS_JSON_ARRAY;
+        case '{':
+            return MS_JSON_OBJECT;
+        default:
+            return MS_JSON_NULL;
+    }
+}
+
+ms_json_result_t ms_json_tape_get_bool(ms_json_tape_value_t value, int* result) {
+    if (!result || ms_json_tape_get_type(value) != MS_JSON_BOOL) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    *result = ms_json_tape_tag(value.tape, value.index) == 't';
+    return MS_JSON_SUCCESS;
+}
+
+ms_json_result_t ms_json_tape_get_number(ms_json_tape_value_t value, double* result) {
+    if (!result || ms_json_tape_get_type(value) != MS_JSON_NUMBER) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    uint64_t bits = value.tape->entries[value.index + 1];
+    if (ms_json_tape_tag(value.tape, value.index) == 'l') {
+        int64_t integer;
+        memcpy(&integer, &bits, sizeof(integer));
+        *result = (double)integer;
+    } else {
+        memcpy(result, &bits, sizeof(*result));
+    }
+    return MS_JSON_SUCCESS;
+}
+
+ms_json_result_t ms_json_tape_get_int64(ms_json_tape_value_t value, int64_t* result) {
+    if (!result || ms_json_tape_get_type(value) != MS_JSON_NUMBER) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    uint64_t bits = value.tape->entries[value.index + 1];
+    if (ms_json_tape_tag(value.tape, value.index) == 'l') {
+        memcpy(result, &bits, sizeof(*result));
+        return MS_JSON_SUCCESS;
+    }
+
+    /* Doubles qualify only when integral and inside [-2^63, 2^63) */
+    double number;
+    memcpy(&number, &bits, sizeof(number));
+    if (!(number >= -9223372036854775808.0 && number < 9223372036854775808.0) ||
+        (double)(int64_t)number != number) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    *result = (int64_t)number;
+    return MS_JSON_SUCCESS;
+}
+
+ms_json_result_t ms_json_tape_get_string(ms_json_tape_value_t value, const char** result, size_t* length) {
+    if (!result || ms_json_tape_get_type(value) != MS_JSON_STRING) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    const char* stored = value.tape->strings + ms_json_tape_payload(value.tape, value.index);
+    uint32_t stored_length;
+    memcpy(&stored_length, stored, sizeof(stored_length));
+
+    *result = stored + sizeof(uint32_t);
+    if (length) {
+        *length = stored_length;
+    }
+    return MS_JSON_SUCCESS;
+}
+
+ms_json_result_t ms_json_tape_get_length(ms_json_tape_value_t value, size_t* result) {
+    ms_json_type_t type = ms_json_tape_get_type(value);
+    if (!result || (type != MS_JSON_ARRAY && type != MS_JSON_OBJECT)) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    uint64_t children = ms_json_tape_payload(value.tape, value.index) >> 32;
+    if (children < TAPE_COUNT_SATURATED) {
+        *result = (size_t)children;
+        return MS_JSON_SUCCESS;
+    }
+
+    ms_json_tape_iterator_t iterator = {0};
+    ms_json_tape_value_t child = {0};
+    ms_json_tape_iterate(value, &iterator);
+    *result = 0;
+    while (ms_json_tape_next(&iterator, NULL, &child)) {
+        (*result)++;
+    }
+    return MS_JSON_SUCCESS;
+}
+
+ms_json_result_t ms_json_tape_get_element(ms_json_tape_value_t value, size_t index, ms_json_tape_value_t* result) {
+    if (!result || ms_json_tape_get_type(value) != MS_JSON_ARRAY) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    ms_json_tape_iterator_t iterator = {0};
+    ms_json_tape_iterate(value, &iterator);
+    for (size_t i = 0; ms_json_tape_next(&iterator, NULL, result); i++) {
+        if (i == index) {
+            return MS_JSON_SUCCESS;
+        }
+    }
+    return MS_JSON_ERROR_INVALID_ARGUMENT;
+}
+
+ms_json_result_t ms_json_tape_get_member(ms_json_tape_value_t value, const char* key, size_t key_length,
+                                         ms_json_tape_value_t* result) {
+    if (!key || !result || ms_json_tape_get_type(value) != MS_JSON_OBJECT) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    ms_json_tape_iterator_t iterator = {0};
+    ms_json_tape_value_t member_key = {0};
+    ms_json_tape_value_t member = {0};
+    int found = 0;
+    ms_json_tape_iterate(value, &iterator);
+    while (ms_json_tape_next(&iterator, &member_key, &member)) {
+        const char* text = NULL;
+        size_t length = 0;
+        if (ms_json_tape_get_string(member_key, &text, &length) == MS_JSON_SUCCESS && length == key_length &&
+            memcmp(text, key, key_length) == 0) {
+            *result = member;
+            found = 1;
+        }
+    }
+    return found ? MS_JSON_SUCCESS : MS_JSON_ERROR_INVALID_ARGUMENT;
+}
+
+ms_json_result_t ms_json_tape_iterate(ms_json_tape_value_t value, ms_json_tape_iterator_t* iterator) {
+    ms_json_type_t type = ms_json_tape_get_type(value);
+    if (!iterator || (type != MS_JSON_ARRAY && type != MS_JSON_OBJECT)) {
+        return MS_JSON_ERROR_INVALID_ARGUMENT;
+    }
+
+    iterator->tape = value.tape;
+    iterator->position = value.index + 1;
+    iterator->end = (size_t)(ms_json_tape_payload(value.tape, value.index) & TAPE_INDEX_MASK);
+    iterator->is_object = type == MS_JSON_OBJECT;
+    return MS_JSON_SUCCESS;
+}
+
+int ms_json_tape_next(ms_json_tape_iterator_t* iterator, ms_json_tape_value_t* key, ms_json_tape_value_t* value) {
+    if (!iterator || !value || iterator->position >= iterator->end) {
+        return 0;
+    }
+
+    if (iterator->is_object) {
+        if (key) {
+            key->tape = iterator->tape;
+            key->index = iterator->position;
+        }
+        iterator->position++;
+    }
+
+    value->tape = iterator->tape;
+    value->index = iterator->position;
+    iterator->position = ms_json_tape_skip(iterator->tape, iterator->position);
+    return 1;
+}
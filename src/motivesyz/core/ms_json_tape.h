@@ -0,0 +1,124 @@
+/*
+ * @file ms_json_tape.h
+ * @brief Read-only documents stored as one flat tape
+ */
+
+#ifndef MS_JSON_TAPE_H
+#define MS_JSON_TAPE_H
+
+#include "ms_json_types.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Parsed document laid out as a tape (opaque)
+ *
+ * Every value is one 64-bit entry, numbers two, in document order, and
+ * containers have an entry at each end holding the offset of the other, so
+ * skipping a subtree is a single jump. String bytes live in a separate
+ * buffer. A tape costs 8-16 bytes per value against a heap node per value
+ * for ms_json_value_t trees and cannot be modified; build a tree with
+ * ms_json_parse() for that.
+ */
+typedef struct ms_json_tape ms_json_tape_t;
+
+/**
+ * @brief Position of one value on a tape
+ *
+ * A small handle passed by value; valid as long as the tape.
+ */
+typedef struct {
+    const ms_json_tape_t* tape;
+    size_t index;
+} ms_json_tape_value_t;
+
+/**
+ * @brief Iterator over the elements of an array or the members of an object
+ */
+typedef struct {
+    const ms_json_tape_t* tape;
+    size_t position;  /**< Entry of the next element or key */
+    size_t end;       /**< Entry of the closing bracket */
+    int is_object;
+} ms_json_tape_iterator_t;
+
+/**
+ * @brief Parse a document into a tape
+ *
+ * Accepts the same documents as ms_json_parse() with the structural engine;
+ * comments are not supported and zero_copy has no effect, since strings are
+ * always copied into the tape's string buffer.
+ *
+ * @param input JSON text, need not be NUL-terminated
+ * @param length Length of input in bytes, below 4 GB
+ * @param options Parsing options, NULL for defaults; allocator backs the tape
+ * @param result Output parameter, freed with ms_json_tape_destroy()
+ *
+ * @return MS_JSON_SUCCESS on success, a parse error, or
+ *         MS_JSON_ERROR_INVALID_ARGUMENT if comments are enabled or the
+ *         input is too long
+ */
+ms_json_result_t ms_json_tape_parse(const char* input, size_t length, const ms_json_options_t* options,
+                                    ms_json_tape_t** result);
+
+/**
+ * @brief Free a tape and its string buffer
+ */
+void ms_json_tape_destroy(ms_json_tape_t* tape);
+
+/**
+ * @brief Root value of a tape
+ */
+ms_json_tape_value_t ms_json_tape_root(const ms_json_tape_t* tape);
+
+/**
+ * @brief Value accessors, with the same rules as their ms_json_get_* counterparts
+ */
+ms_json_type_t ms_json_tape_get_type(ms_json_tape_value_t value);
+ms_json_result_t ms_json_tape_get_bool(ms_json_tape_value_t value, int* result);
+ms_json_result_t ms_json_tape_get_number(ms_json_tape_value_t value, double* result);
+ms_json_result_t ms_json_tape_get_int64(ms_json_tape_value_t value, int64_t* result);
+
+/**
+ * @brief Get a string or key; the text is NUL-terminated and lives in the tape
+ */
+ms_json_result_t ms_json_tape_get_string(ms_json_tape_value_t value, const char** result, size_t* length);
+
+/**
+ * @brief Number of elements of an array or members of an object
+ *
+ * Constant time below 2^24 children, a walk over the children above.
+ */
+ms_json_result_t ms_json_tape_get_length(ms_json_tape_value_t value, size_t* result);
+
+/**
+ * @brief Element of an array by position, in time linear in index
+ */
+ms_json_result_t ms_json_tape_get_element(ms_json_tape_value_t value, size_t index, ms_json_tape_value_t* result);
+
+/**
+ * @brief Member of an object by key, scanning the members in order
+ *
+ * With duplicate keys the last one wins, as in ms_json_get_object_value().
+ */
+ms_json_result_t ms_json_tape_get_member(ms_json_tape_value_t value, const char* key, size_t key_length,
+                                         ms_json_tape_value_t* result);
+
+/**
+ * @brief Start iterating over an array or object
+ */
+ms_json_result_t ms_json_tape_iterate(ms_json_tape_value_t value, ms_json_tape_iterator_t* iterator);
+
+/**
+ * @brief Advance an iterator
+ *
+ * @param iterator Iterator set up by ms_json_tape_iterate()
+ * @param key Output parameter for the member's key, NULL when iterating an array
+ *            or when the key is not needed
+ * @param value Output parameter for the element or member value
+ *
+ * @return 1 if a value was produced, 0 at the end
+ */
+int ms_json_tape_next(ms_json_tape_iterator_t* iterator, ms_json_tape_value_t* key, ms_json_tape_value_t* value);
+
+#endif
@@ -36,6 +36,11 @@ typedef struct ms_json_array ms_json_array_t;
  */
 typedef struct ms_json_object ms_json_object_t;
 
+/**
+ * @brief Table of interned object keys (opaque), see ms_json_keys.h
+ */
+typedef struct ms_json_key_table ms_json_key_table_t;
+
 /**
  * @brief JSON parsing result codes
  */
@@ -45,16 +50,60 @@ typedef enum {
     MS_JSON_ERROR_SYNTAX,             /**< JSON syntax error */
     MS_JSON_ERROR_MEMORY,             /**< Memory allocation failed */
     MS_JSON_ERROR_EOF,                /**< Unexpected end of input */
-    MS_JSON_ERROR_DEPTH               /**< Nesting depth exceeded */
+    MS_JSON_ERROR_DEPTH,              /**< Nesting depth exceeded */
+    MS_JSON_ERROR_IO,                 /**< Output sink or file I/O failed */
+    MS_JSON_ERROR_TYPE                /**< Value does not have the type a binding expects */
 } ms_json_result_t;
 
+/**
+ * @brief Parse engines behind ms_json_parse()
+ */
+typedef enum {
+    MS_JSON_ENGINE_RECURSIVE = 0,  /**< Recursive descent, byte at a time (reference) */
+    MS_JSON_ENGINE_STRUCTURAL      /**< SIMD structural index, then a walk over the index */
+} ms_json_engine_t;
+
 /**
  * @brief JSON parsing options
  */
 typedef struct {
-    ms_allocator_t* allocator;  /**< Allocator to use (NULL for default) */
+    ms_allocator_t* allocator;  /**< Allocator to use (NULL for default); a tree from
+                                     ms_allocator_thread_local() must be destroyed
+                                     by its thread before the thread exits */
     size_t max_depth;           /**< Maximum nesting depth (0 = unlimited) */
     int allow_comments;         /**< Allow C-style comments in JSON */
+    int zero_copy;              /**< Unescaped strings borrow the input buffer, which
+                                     must outlive the tree; read them with
+                                     ms_json_get_string_n() */
+    ms_json_engine_t engine;    /**< Parse engine; the structural engine falls back
+                                     to recursive descent when comments are allowed */
+    int lazy;                   /**< Only index the input and check bracket nesting;
+                                     each array or object is decoded when first
+                                     accessed. Malformed numbers, literals and
+                                     escapes inside a container are therefore not
+                                     parse errors: "[-]" or "[NaN]" parse with
+                                     MS_JSON_SUCCESS, and the error comes from the
+                                     first accessor, serializer or other walk that
+                                     decodes that container. A document that fails
+                                     the nesting check reports the same error as the
+                                     eager engines. The input is copied unless
+                                     zero_copy is set. Decoding writes to the tree,
+                                     so concurrent readers must synchronize. Falls
+                                     back to eager parsing when comments are allowed */
+    int intern_keys;            /**< Store each distinct object key once per document
+                                     and share it between objects; ignored by lazy
+                                     parses */
+    ms_json_key_table_t* key_table; /**< Intern keys into this table instead, so
+                                     several documents share it; implies intern_keys */
 } ms_json_options_t;
 
+/**
+ * @brief Output callback for streaming serialization
+ *
+ * Receives each filled buffer in document order. Must consume all length
+ * bytes; any result other than MS_JSON_SUCCESS aborts serialization and is
+ * returned to the caller.
+ */
+typedef ms_json_result_t (*ms_json_write_fn)(void* user_ctx, const char* data, size_t length);
+
 #endif /* MS_JSON_TYPES_H */
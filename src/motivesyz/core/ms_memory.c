@@ -7,6 +7,10 @@
  */
 
 #include "ms_memory.h"
+#include "ms_memory_stats.h"
+#include "ms_platform.h"
+#include "ms_instrument.h"
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -17,10 +21,14 @@
 
 #ifdef MS_MEMORY_DEBUG
 #define MEMORY_GUARDS_ENABLED 1    /**< Enable memory guard validation */
-#define MEMORY_STATS_ENABLED 1     /**< Enable allocation statistics */
 #else
 #define MEMORY_GUARDS_ENABLED 0    /**< Disable guards for performance */
-#define MEMORY_STATS_ENABLED 0     /**< Disable stats for performance */
+#endif
+
+#ifdef MS_MEMORY_NO_STATS
+#define MEMORY_STATS_ENABLED 0     /**< Compile statistics out entirely */
+#else
+#define MEMORY_STATS_ENABLED 1     /**< Relaxed atomic counters, on by default */
 #endif
 
 /** @} */
@@ -38,18 +46,81 @@ typedef struct {
 
 #define MEMORY_HEADER_SIZE sizeof(memory_header_t)  /**< Size of allocation header */
 
+/**
+ * @defgroup arena_config Arena Configuration
+ * @{
+ */
+
+#define ARENA_ALIGNMENT 16                      /**< Alignment of every arena block */
+#define ARENA_DEFAULT_CHUNK_SIZE (64 * 1024)    /**< Chunk size when 0 is requested */
+#define ARENA_DEDICATED_DIVISOR 4               /**< Blocks above chunk/4 get own chunk */
+
+/** @} */
+
+/**
+ * @defgroup pool_config Pool Configuration
+ * @{
+ */
+
+#define POOL_CLASS_GRANULARITY 16   /**< Size class step in bytes */
+#define POOL_CLASS_COUNT 8          /**< Classes cover 16..128 byte blocks */
+#define POOL_MAX_BLOCK_SIZE (POOL_CLASS_GRANULARITY * POOL_CLASS_COUNT)
+#define POOL_SLAB_SIZE (64 * 1024)  /**< Slab carved into pooled blocks */
+#define HEADER_TAG_POOLED ((uintptr_t)1)  /**< Header tag bit for pooled blocks */
+
+/** @} */
+
+/**
+ * @brief Allocation strategy backing an allocator instance
+ */
+typedef enum {
+    ALLOCATOR_KIND_HEAP = 0,  /**< Header-prefixed malloc per block */
+    ALLOCATOR_KIND_ARENA,     /**< Bump allocation from large chunks */
+    ALLOCATOR_KIND_POOL       /**< Size-class free lists over slabs */
+} allocator_kind_t;
+
+/**
+ * @brief Free list link stored in the user area of a released pooled block
+ */
+typedef struct pool_free_block {
+    struct pool_free_block* next; /**< Next free block of the same class */
+} pool_free_block_t;
+
+/**
+ * @brief Arena chunk header, user blocks follow it contiguously
+ */
+typedef struct arena_chunk {
+    struct arena_chunk* next; /**< Next (older) chunk in the arena */
+    size_t capacity;          /**< Usable bytes after the header */
+    size_t used;              /**< Bytes handed out from this chunk */
+    size_t last_offset;       /**< Offset of the most recent block */
+} arena_chunk_t;
+
+#define ARENA_CHUNK_HEADER_SIZE \
+    ((sizeof(arena_chunk_t) + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1))
+
+#define ALLOCATOR_GUARD_VALUE ((uintptr_t)0x7F3A5C91)  /**< Tag of live allocators */
+
 /**
  * @brief Opaque allocator implementation structure
  *
  * Contains allocator state including instance identification and
  * optional statistics tracking.
+ *
+ * @note The statistics sit on their own cache lines so that threads bumping
+ *       counters on a shared allocator do not invalidate the tag every
+ *       call validates; the default allocator, shared by every caller that
+ *       passes no allocator, keeps them per thread in sharded_stats
  */
 struct ms_allocator {
     uintptr_t instance_tag;   /**< Unique identifier for allocator validation */
-#if MEMORY_STATS_ENABLED
-    size_t total_allocated;   /**< Total bytes currently allocated */
-    size_t allocation_count;  /**< Number of active allocations */
-#endif
+    allocator_kind_t kind;    /**< Allocation strategy of this instance */
+    size_t chunk_size;        /**< Standard arena chunk / pool slab capacity */
+    arena_chunk_t* chunks;    /**< Arena chunks or pool slabs, current first */
+    pool_free_block_t* free_lists[POOL_CLASS_COUNT]; /**< Pool free lists */
+    ms_memory_stats_sharded_t* sharded_stats; /**< Per-thread counters used instead of stats, or NULL */
+    char stats_padding[MS_CACHE_LINE_SIZE]; /**< Keeps counters off the hot line */
+    ms_memory_stats_t stats;  /**< Allocation and pool statistics */
 };
 
 /**
@@ -60,7 +131,7 @@ struct ms_allocator {
  * @note In debug mode, this could be randomized for better security
  */
 static uintptr_t generate_guard_value(void) {
-    return 0x7F3A5C91;
+    return ALLOCATOR_GUARD_VALUE;
 }
 
 /**
@@ -108,6 +179,16 @@ static void write_memory_header(memory_header_t* header, size_t size,
     header->allocator_tag = (uintptr_t)allocator;
 }
 
+/**
+ * @brief Check whether a header belongs to a pooled block
+ *
+ * @param header Header to inspect
+ * @return 1 if the block lives in a pool slab, 0 if it came from malloc
+ */
+static int is_pooled_header(const memory_header_t* header) {
+    return (header->allocator_tag & HEADER_TAG_POOLED) != 0;
+}
+
 /**
  * @brief Validate memory header integrity
  *
@@ -121,7 +202,7 @@ static int validate_memory_header(const memory_header_t* header,
                                  const ms_allocator_t* allocator) {
 #if MEMORY_GUARDS_ENABLED
     if (header == NULL) return 0;
-    return header->allocator_tag == (uintptr_t)allocator;
+    return (header->allocator_tag & ~HEADER_TAG_POOLED) == (uintptr_t)allocator;
 #else
     (void)header;
     (void)allocator;
@@ -155,8 +236,11 @@ static size_t calculate_total_size_safe(size_t user_size) {
  * @param size Size of allocation in bytes
  */
 static void record_allocation(ms_allocator_t* allocator, size_t size) {
-    allocator->total_allocated += size;
-    allocator->allocation_count++;
+    if (allocator->sharded_stats != NULL) {
+        ms_memory_stats_sharded_record_allocation(allocator->sharded_stats, size);
+        return;
+    }
+    ms_memory_stats_record_allocation(&allocator->stats, size);
 }
 
 /**
@@ -166,20 +250,366 @@ static void record_allocation(ms_allocator_t* allocator, size_t size) {
  * @param size Size of deallocation in bytes
  */
 static void record_deallocation(ms_allocator_t* allocator, size_t size) {
-    if (allocator->total_allocated >= size) {
-        allocator->total_allocated -= size;
+    if (allocator->sharded_stats != NULL) {
+        ms_memory_stats_sharded_record_deallocation(allocator->sharded_stats, size);
+        return;
     }
-    if (allocator->allocation_count > 0) {
-        allocator->allocation_count--;
+    ms_memory_stats_record_deallocation(&allocator->stats, size);
+}
+
+/**
+ * @brief Record resize of an existing block in statistics
+ *
+ * @param allocator Allocator to update
+ * @param old_size Bytes released by the resize
+ * @param new_size Bytes held after the resize
+ */
+static void record_reallocation(ms_allocator_t* allocator, size_t old_size, size_t new_size) {
+    if (allocator->sharded_stats != NULL) {
+        ms_memory_stats_sharded_record_reallocation(allocator->sharded_stats, old_size, new_size);
+        return;
     }
+    ms_memory_stats_record_reallocation(&allocator->stats, old_size, new_size);
 }
 #else
 #define record_allocation(allocator, size) ((void)(allocator), (void)(size))
 #define record_deallocation(allocator, size) ((void)(allocator), (void)(size))
+#define record_reallocation(allocator, old_size, new_size) \
+    ((void)(allocator), (void)(old_size), (void)(new_size))
+#endif
+
+/** @} */
+
+/**
+ * @defgroup arena_impl Arena Backend
+ * @{
+ */
+
+/**
+ * @brief Get pointer to the first usable byte of a chunk
+ *
+ * @param chunk Chunk header
+ * @return Start of the chunk data area
+ */
+static char* arena_chunk_data(arena_chunk_t* chunk) {
+    return (char*)chunk + ARENA_CHUNK_HEADER_SIZE;
+}
+
+/**
+ * @brief Round block size up to arena alignment
+ *
+ * @param size Requested size in bytes
+ * @return Aligned size, or 0 on overflow
+ */
+static size_t arena_align_size(size_t size) {
+    if (size > SIZE_MAX - (ARENA_ALIGNMENT - 1)) {
+        return 0;
+    }
+    return (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+}
+
+/**
+ * @brief Allocate a new chunk from the system
+ *
+ * @param capacity Usable bytes required in the chunk
+ * @return New chunk with no blocks handed out, or NULL on failure
+ */
+static arena_chunk_t* arena_chunk_create(size_t capacity) {
+    if (capacity > SIZE_MAX - ARENA_CHUNK_HEADER_SIZE) {
+        return NULL;
+    }
+
+    arena_chunk_t* chunk = malloc(ARENA_CHUNK_HEADER_SIZE + capacity);
+    if (chunk == NULL) {
+        return NULL;
+    }
+
+    chunk->next = NULL;
+    chunk->capacity = capacity;
+    chunk->used = 0;
+    chunk->last_offset = 0;
+    return chunk;
+}
+
+/**
+ * @brief Find the chunk that owns a block handed out by the arena
+ *
+ * @param allocator Arena allocator to search
+ * @param ptr Block pointer
+ * @return Owning chunk, or NULL if ptr does not belong to this arena
+ */
+static arena_chunk_t* arena_find_chunk(const ms_allocator_t* allocator, const void* ptr) {
+    for (arena_chunk_t* chunk = allocator->chunks; chunk != NULL; chunk = chunk->next) {
+        const char* data = arena_chunk_data(chunk);
+        if ((const char*)ptr >= data && (const char*)ptr < data + chunk->used) {
+            return chunk;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Bump-allocate a block from the arena
+ *
+ * @param allocator Arena allocator
+ * @param size Requested size in bytes, must be > 0
+ * @param result Output parameter for the block pointer
+ * @return MS_MEMORY_SUCCESS on success, appropriate error code on failure
+ *
+ * @note Blocks larger than a quarter chunk get a dedicated chunk placed
+ *       behind the current one, so the current chunk keeps filling up
+ */
+static ms_memory_result_t arena_allocate(ms_allocator_t* allocator, size_t size, void** result) {
+    size_t aligned_size = arena_align_size(size);
+    if (aligned_size == 0) {
+        return MS_MEMORY_ERROR_OVERFLOW;
+    }
+
+    arena_chunk_t* chunk = allocator->chunks;
+    if (chunk == NULL || chunk->capacity - chunk->used < aligned_size) {
+        if (chunk != NULL && aligned_size > allocator->chunk_size / ARENA_DEDICATED_DIVISOR) {
+            arena_chunk_t* dedicated = arena_chunk_create(aligned_size);
+            if (dedicated == NULL) {
+                return MS_MEMORY_ERROR_OUT_OF_MEMORY;
+            }
+            dedicated->next = chunk->next;
+            chunk->next = dedicated;
+            dedicated->used = aligned_size;
+            *result = arena_chunk_data(dedicated);
+            return MS_MEMORY_SUCCESS;
+        }
+
+        size_t capacity = aligned_size > allocator->chunk_size ? aligned_size : allocator->chunk_size;
+        chunk = arena_chunk_create(capacity);
+        if (chunk == NULL) {
+            return MS_MEMORY_ERROR_OUT_OF_MEMORY;
+        }
+        chunk->next = allocator->chunks;
+        allocator->chunks = chunk;
+    }
+
+    chunk->last_offset = chunk->used;
+    chunk->used += aligned_size;
+    *result = arena_chunk_data(chunk) + chunk->last_offset;
+    return MS_MEMORY_SUCCESS;
+}
+
+/**
+ * @brief Resize an arena block, in place when it is the most recent one
+ *
+ * @param allocator Arena allocator
+ * @param ptr Existing block from this arena
+ * @param new_size New size in bytes, must be > 0
+ * @param result Output parameter for the resized block
+ * @return MS_MEMORY_SUCCESS on success, original block preserved on failure
+ *
+ * @note Arena blocks carry no size header; when the block has to move, the
+ *       copy is bounded by the end of the owning chunk's used area, which
+ *       always covers the original block
+ * @note The owner is found without a search when it is the current chunk
+ *       or the chunk right behind it holding only this block, where large
+ *       blocks live; the latter is resized as a whole. Only a block whose
+ *       chunk was retired since its last resize walks the chunk list, and
+ *       it then moves to the current chunk
+ */
+static ms_memory_result_t arena_reallocate(ms_allocator_t* allocator, void* ptr,
+                                          size_t new_size, void** result) {
+    size_t aligned_size = arena_align_size(new_size);
+    if (aligned_size == 0) {
+        *result = ptr;
+        return MS_MEMORY_ERROR_OVERFLOW;
+    }
+
+    arena_chunk_t* head = allocator->chunks;
+    arena_chunk_t* owner = NULL;
+    if (head != NULL) {
+        char* head_data = arena_chunk_data(head);
+        if ((char*)ptr == head_data + head->last_offset &&
+            aligned_size <= head->capacity - head->last_offset) {
+            record_reallocation(allocator, head->used - head->last_offset, aligned_size);
+            head->used = head->last_offset + aligned_size;
+            *result = ptr;
+            return MS_MEMORY_SUCCESS;
+        }
+
+        arena_chunk_t* single = head->next;
+        if (single != NULL && (char*)ptr == arena_chunk_data(single) &&
+            single->last_offset == 0 && single->used > 0) {
+            arena_chunk_t* resized = realloc(single, ARENA_CHUNK_HEADER_SIZE + aligned_size);
+            if (resized == NULL) {
+                *result = ptr;
+                return MS_MEMORY_ERROR_OUT_OF_MEMORY;
+            }
+            record_reallocation(allocator, resized->used, aligned_size);
+            resized->capacity = aligned_size;
+            resized->used = aligned_size;
+            head->next = resized;
+            *result = arena_chunk_data(resized);
+            return MS_MEMORY_SUCCESS;
+        }
+
+        if ((char*)ptr >= head_data && (char*)ptr < head_data + head->used) {
+            owner = head;
+        }
+    }
+
+    if (owner == NULL) {
+        owner = arena_find_chunk(allocator, ptr);
+        if (owner == NULL) {
+            return MS_MEMORY_ERROR_CORRUPTED;
+        }
+    }
+    size_t available = (size_t)(arena_chunk_data(owner) + owner->used - (char*)ptr);
+
+    void* new_ptr = NULL;
+    ms_memory_result_t alloc_result = arena_allocate(allocator, new_size, &new_ptr);
+    if (alloc_result != MS_MEMORY_SUCCESS) {
+        *result = ptr;
+        return alloc_result;
+    }
+
+    memcpy(new_ptr, ptr, available < new_size ? available : new_size);
+    record_reallocation(allocator, 0, aligned_size);
+    *result = new_ptr;
+    return MS_MEMORY_SUCCESS;
+}
+
+/**
+ * @brief Release an arena block
+ *
+ * @param allocator Arena allocator
+ * @param ptr Block to release
+ * @return MS_MEMORY_SUCCESS, or MS_MEMORY_ERROR_CORRUPTED in debug builds
+ *         when ptr does not belong to the arena
+ *
+ * @note Only the most recent block is actually reclaimed; everything else
+ *       is released by ms_allocator_reset() or ms_allocator_destroy()
+ */
+static ms_memory_result_t arena_deallocate(ms_allocator_t* allocator, void* ptr) {
+    arena_chunk_t* head = allocator->chunks;
+    if (head != NULL && (char*)ptr == arena_chunk_data(head) + head->last_offset &&
+        head->used > head->last_offset) {
+        record_deallocation(allocator, head->used - head->last_offset);
+        head->used = head->last_offset;
+        return MS_MEMORY_SUCCESS;
+    }
+
+#if MEMORY_GUARDS_ENABLED
+    if (arena_find_chunk(allocator, ptr) == NULL) {
+        return MS_MEMORY_ERROR_CORRUPTED;
+    }
 #endif
+    return MS_MEMORY_SUCCESS;
+}
+
+/**
+ * @brief Free arena chunks
+ *
+ * @param allocator Arena allocator
+ * @param keep_one Keep the current chunk for reuse if it has standard size
+ */
+static void arena_release_chunks(ms_allocator_t* allocator, int keep_one) {
+    arena_chunk_t* chunk = allocator->chunks;
+    allocator->chunks = NULL;
+
+    if (keep_one && chunk != NULL && chunk->capacity == allocator->chunk_size) {
+        arena_chunk_t* kept = chunk;
+        chunk = chunk->next;
+        kept->next = NULL;
+        kept->used = 0;
+        kept->last_offset = 0;
+        allocator->chunks = kept;
+    }
+
+    while (chunk != NULL) {
+        arena_chunk_t* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+}
+
+/** @} */
+
+/**
+ * @defgroup pool_impl Pool Backend
+ * @{
+ */
+
+/**
+ * @brief Map a block size to its pool size class
+ *
+ * @param size User-requested size, must be in 1..POOL_MAX_BLOCK_SIZE
+ * @return Size class index
+ */
+static size_t pool_class_index(size_t size) {
+    return (size - 1) / POOL_CLASS_GRANULARITY;
+}
+
+/**
+ * @brief Get a pooled block for a small allocation
+ *
+ * @param allocator Pool allocator
+ * @param size User-requested size, must be in 1..POOL_MAX_BLOCK_SIZE
+ * @return Header of the pooled block, or NULL on failure
+ *
+ * @note Reuses a free-listed block of the same class when one exists,
+ *       otherwise carves a new block from the current slab
+ */
+static memory_header_t* pool_allocate_block(ms_allocator_t* allocator, size_t size) {
+    size_t class_index = pool_class_index(size);
+    pool_free_block_t* block = allocator->free_lists[class_index];
+
+    if (block != NULL) {
+        allocator->free_lists[class_index] = block->next;
+        ms_memory_stats_record_pool_hit(&allocator->stats);
+        return get_header_from_user_ptr(block);
+    }
+
+    size_t block_size = MEMORY_HEADER_SIZE + (class_index + 1) * POOL_CLASS_GRANULARITY;
+    void* raw = NULL;
+    if (arena_allocate(allocator, block_size, &raw) != MS_MEMORY_SUCCESS) {
+        return NULL;
+    }
+
+    ms_memory_stats_record_pool_miss(&allocator->stats);
+    return (memory_header_t*)raw;
+}
+
+/**
+ * @brief Return a pooled block to its class free list
+ *
+ * @param allocator Pool allocator that owns the block
+ * @param header Header of the pooled block
+ */
+static void pool_release_block(ms_allocator_t* allocator, memory_header_t* header) {
+    size_t class_index = pool_class_index(header->block_size);
+    pool_free_block_t* block = get_user_ptr_from_header(header);
+
+    block->next = allocator->free_lists[class_index];
+    allocator->free_lists[class_index] = block;
+}
 
 /** @} */
 
+/**
+ * @brief Initialize common allocator fields
+ *
+ * @param allocator Allocator to initialize
+ * @param kind Allocation strategy
+ * @param chunk_size Arena chunk capacity, ignored for heap allocators
+ */
+static void init_allocator(ms_allocator_t* allocator, allocator_kind_t kind, size_t chunk_size) {
+    allocator->instance_tag = generate_guard_value();
+    allocator->kind = kind;
+    allocator->chunks = NULL;
+    allocator->chunk_size = chunk_size;
+    for (size_t i = 0; i < POOL_CLASS_COUNT; i++) {
+        allocator->free_lists[i] = NULL;
+    }
+    allocator->sharded_stats = NULL;
+    ms_memory_stats_reset(&allocator->stats);
+}
+
 /* Public API implementation */
 ms_allocator_t* ms_allocator_create(void) {
     ms_allocator_t* allocator = malloc(sizeof(ms_allocator_t));
@@ -187,12 +617,36 @@ ms_allocator_t* ms_allocator_create(void) {
         return NULL;
     }
 
-    allocator->instance_tag = generate_guard_value();
-#if MEMORY_STATS_ENABLED
-    allocator->total_allocated = 0;
-    allocator->allocation_count = 0;
-#endif
+    init_allocator(allocator, ALLOCATOR_KIND_HEAP, 0);
+    return allocator;
+}
+
+ms_allocator_t* ms_allocator_create_arena(size_t chunk_size) {
+    if (chunk_size == 0) {
+        chunk_size = ARENA_DEFAULT_CHUNK_SIZE;
+    }
+
+    chunk_size = arena_align_size(chunk_size);
+    if (chunk_size == 0) {
+        return NULL;
+    }
+
+    ms_allocator_t* allocator = malloc(sizeof(ms_allocator_t));
+    if (allocator == NULL) {
+        return NULL;
+    }
+
+    init_allocator(allocator, ALLOCATOR_KIND_ARENA, chunk_size);
+    return allocator;
+}
+
+ms_allocator_t* ms_allocator_create_pool(void) {
+    ms_allocator_t* allocator = malloc(sizeof(ms_allocator_t));
+    if (allocator == NULL) {
+        return NULL;
+    }
 
+    init_allocator(allocator, ALLOCATOR_KIND_POOL, POOL_SLAB_SIZE);
     return allocator;
 }
 
@@ -200,19 +654,71 @@ void ms_allocator_destroy(ms_allocator_t* allocator) {
     if (allocator == NULL) return;
 
     if (is_valid_allocator(allocator)) {
-#if MEMORY_STATS_ENABLED
-        if (allocator->allocation_count > 0) {
-            /* Debug warning - intentionally empty in relelease */
+        if (allocator->kind != ALLOCATOR_KIND_HEAP) {
+            arena_release_chunks(allocator, 0);
         }
-#endif
         allocator->instance_tag = 0;
     }
 
     free(allocator);
 }
 
-ms_memory_result_t ms_allocator_allocate(ms_allocator_t* allocator,
-                                        size_t size, void** result) {
+ms_memory_result_t ms_allocator_reset(ms_allocator_t* allocator) {
+    if (!is_valid_allocator(allocator) || allocator->kind != ALLOCATOR_KIND_ARENA) {
+        return MS_MEMORY_ERROR_INVALID_ARGUMENT;
+    }
+
+    arena_release_chunks(allocator, 1);
+    MS_ATOMIC_STORE(&allocator->stats.bytes_allocated, 0);
+    MS_ATOMIC_STORE(&allocator->stats.allocation_count, 0);
+    return MS_MEMORY_SUCCESS;
+}
+
+int ms_allocator_is_arena(const ms_allocator_t* allocator) {
+    return is_valid_allocator(allocator) && allocator->kind == ALLOCATOR_KIND_ARENA;
+}
+
+/**
+ * @brief Allocate a header-prefixed block from the pool or the system
+ *
+ * @param allocator Heap or pool allocator
+ * @param size User-requested size in bytes, must be > 0
+ * @param result Output parameter for the user pointer
+ * @return MS_MEMORY_SUCCESS on success, appropriate error code on failure
+ *
+ * @note Does not touch statistics; callers record the operation
+ */
+static ms_memory_result_t allocate_header_block(ms_allocator_t* allocator,
+                                               size_t size, void** result) {
+    memory_header_t* header = NULL;
+    if (allocator->kind == ALLOCATOR_KIND_POOL && size <= POOL_MAX_BLOCK_SIZE) {
+        header = pool_allocate_block(allocator, size);
+        if (header == NULL) {
+            return MS_MEMORY_ERROR_OUT_OF_MEMORY;
+        }
+        write_memory_header(header, size, allocator);
+        header->allocator_tag |= HEADER_TAG_POOLED;
+    } else {
+        size_t total_size = calculate_total_size_safe(size);
+        if (total_size == 0) {
+            return MS_MEMORY_ERROR_OVERFLOW;
+        }
+
+        header = malloc(total_size);
+        if (header == NULL) {
+            return MS_MEMORY_ERROR_OUT_OF_MEMORY;
+        }
+        write_memory_header(header, size, allocator);
+    }
+
+    *result = get_user_ptr_from_header(header);
+    return MS_MEMORY_SUCCESS;
+}
+
+/* Allocation, reallocation and release behind the instrumented public entry points */
+static ms_memory_result_t allocator_deallocate(ms_allocator_t* allocator, void* ptr);
+
+static ms_memory_result_t allocator_allocate(ms_allocator_t* allocator, size_t size, void** result) {
     if (result == NULL) {
         return MS_MEMORY_ERROR_INVALID_ARGUMENT;
     }
@@ -226,21 +732,19 @@ ms_memory_result_t ms_allocator_allocate(ms_allocator_t* allocator,
         return MS_MEMORY_ERROR_INVALID_ARGUMENT;
     }
 
-    size_t total_size = calculate_total_size_safe(size);
-    if (total_size == 0) {
-        return MS_MEMORY_ERROR_OVERFLOW;
+    if (allocator->kind == ALLOCATOR_KIND_ARENA) {
+        ms_memory_result_t arena_result = arena_allocate(allocator, size, result);
+        if (arena_result == MS_MEMORY_SUCCESS) {
+            record_allocation(allocator, arena_align_size(size));
+        }
+        return arena_result;
     }
 
-    memory_header_t* header = malloc(total_size);
-    if (header == NULL) {
-        return MS_MEMORY_ERROR_OUT_OF_MEMORY;
+    ms_memory_result_t block_result = allocate_header_block(allocator, size, result);
+    if (block_result == MS_MEMORY_SUCCESS) {
+        record_allocation(allocator, size);
     }
-
-    write_memory_header(header, size, allocator);
-    record_allocation(allocator, size);
-
-    *result = get_user_ptr_from_header(header);
-    return MS_MEMORY_SUCCESS;
+    return block_result;
 }
 
 ms_memory_result_t ms_allocator_allocate_zeroed(ms_allocator_t* allocator,
@@ -274,8 +778,8 @@ ms_memory_result_t ms_allocator_allocate_zeroed(ms_allocator_t* allocator,
     return alloc_result;
 }
 
-ms_memory_result_t ms_allocator_reallocate(ms_allocator_t* allocator, void* ptr,
-                                          size_t new_size, void** result) {
+static ms_memory_result_t allocator_reallocate(ms_allocator_t* allocator, void* ptr,
+                                               size_t new_size, void** result) {
     if (result == NULL) {
         return MS_MEMORY_ERROR_INVALID_ARGUMENT;
     }
@@ -286,37 +790,67 @@ ms_memory_result_t ms_allocator_reallocate(ms_allocator_t* allocator, void* ptr,
     }
 
     if (ptr == NULL) {
-        return ms_allocator_allocate(allocator, new_size, result);
+        return allocator_allocate(allocator, new_size, result);
     }
 
     if (new_size == 0) {
-        ms_memory_result_t free_result = ms_allocator_deallocate(allocator, ptr);
+        ms_memory_result_t free_result = allocator_deallocate(allocator, ptr);
         *result = NULL;
         return free_result;
     }
 
+    if (allocator->kind == ALLOCATOR_KIND_ARENA) {
+        return arena_reallocate(allocator, ptr, new_size, result);
+    }
+
     memory_header_t* old_header = get_header_from_user_ptr(ptr);
     if (!validate_memory_header(old_header, allocator)) {
         return MS_MEMORY_ERROR_CORRUPTED;
     }
 
+    if (is_pooled_header(old_header)) {
+        size_t old_size = old_header->block_size;
+        size_t class_capacity = (pool_class_index(old_size) + 1) * POOL_CLASS_GRANULARITY;
+        if (new_size <= class_capacity) {
+            record_reallocation(allocator, old_size, new_size);
+            old_header->block_size = new_size;
+            *result = ptr;
+            return MS_MEMORY_SUCCESS;
+        }
+
+        void* new_ptr = NULL;
+        ms_memory_result_t alloc_result = allocate_header_block(allocator, new_size, &new_ptr);
+        if (alloc_result != MS_MEMORY_SUCCESS) {
+            *result = ptr;
+            return alloc_result;
+        }
+
+        memcpy(new_ptr, ptr, old_size);
+        record_reallocation(allocator, old_size, new_size);
+        pool_release_block(allocator, old_header);
+        *result = new_ptr;
+        return MS_MEMORY_SUCCESS;
+    }
+
     size_t total_size = calculate_total_size_safe(new_size);
     if (total_size == 0) {
         return MS_MEMORY_ERROR_OVERFLOW;
     }
 
+    size_t old_size = old_header->block_size;
     memory_header_t* new_header = realloc(old_header, total_size);
     if (new_header == NULL) {
         *result = ptr;
         return MS_MEMORY_ERROR_OUT_OF_MEMORY;
     }
 
+    record_reallocation(allocator, old_size, new_size);
     write_memory_header(new_header, new_size, allocator);
     *result = get_user_ptr_from_header(new_header);
     return MS_MEMORY_SUCCESS;
 }
 
-ms_memory_result_t ms_allocator_deallocate(ms_allocator_t* allocator, void* ptr) {
+static ms_memory_result_t allocator_deallocate(ms_allocator_t* allocator, void* ptr) {
     if (ptr == NULL) {
         return MS_MEMORY_SUCCESS;
     }
@@ -325,6 +859,10 @@ ms_memory_result_t ms_allocator_deallocate(ms_allocator_t* allocator, void* ptr)
         return MS_MEMORY_ERROR_INVALID_ARGUMENT;
     }
 
+    if (allocator->kind == ALLOCATOR_KIND_ARENA) {
+        return arena_deallocate(allocator, ptr);
+    }
+
     memory_header_t* header = get_header_from_user_ptr(ptr);
     if (!validate_memory_header(header, allocator)) {
         return MS_MEMORY_ERROR_CORRUPTED;
@@ -332,22 +870,121 @@ ms_memory_result_t ms_allocator_deallocate(ms_allocator_t* allocator, void* ptr)
 
     size_t size = header->block_size;
     record_deallocation(allocator, size);
-    free(header);
+    if (is_pooled_header(header)) {
+        pool_release_block(allocator, header);
+    } else {
+        free(header);
+    }
 
     return MS_MEMORY_SUCCESS;
 }
 
+ms_memory_result_t ms_allocator_allocate(ms_allocator_t* allocator,
+                                        size_t size, void** result) {
+    MS_INSTRUMENT_BEGIN(span, 0);
+    ms_memory_result_t status = allocator_allocate(allocator, size, result);
+    MS_INSTRUMENT_END(span, MS_INSTRUMENT_ALLOCATOR, size);
+    return status;
+}
+
+ms_memory_result_t ms_allocator_reallocate(ms_allocator_t* allocator, void* ptr,
+                                          size_t new_size, void** result) {
+    MS_INSTRUMENT_BEGIN(span, 0);
+    ms_memory_result_t status = allocator_reallocate(allocator, ptr, new_size, result);
+    MS_INSTRUMENT_END(span, MS_INSTRUMENT_ALLOCATOR, new_size);
+    return status;
+}
+
+ms_memory_result_t ms_allocator_deallocate(ms_allocator_t* allocator, void* ptr) {
+    MS_INSTRUMENT_BEGIN(span, 0);
+    ms_memory_result_t status = allocator_deallocate(allocator, ptr);
+    MS_INSTRUMENT_END(span, MS_INSTRUMENT_ALLOCATOR, 0);
+    return status;
+}
+
+static ms_memory_stats_sharded_t g_default_stats; /**< Default allocator's per-thread counters */
+
+/**
+ * @brief Process-wide default allocator
+ *
+ * Fully initialized at load time, so ms_allocator_default() involves no
+ * lazy setup that threads could race on.
+ */
+static ms_allocator_t g_default_allocator = {
+    .instance_tag = ALLOCATOR_GUARD_VALUE,
+    .kind = ALLOCATOR_KIND_HEAP,
+    .sharded_stats = &g_default_stats
+};
+
 ms_allocator_t* ms_allocator_default(void) {
-    static ms_allocator_t g_default_allocator = {0};
-    static int initialized = 0;
+    return &g_default_allocator;
+}
 
-    if (!initialized) {
-        g_default_allocator.instance_tag = generate_guard_value();
-#if MEMORY_STATS_ENABLED
-        g_default_allocator.total_allocated = 0;
-        g_default_allocator.allocation_count = 0;
-#endif
-        initialized = 1;
+/**
+ * @defgroup thread_cache Per-Thread Allocator Cache
+ * @{
+ */
+
+static MS_THREAD_LOCAL ms_allocator_t* t_thread_allocator = NULL; /**< Calling thread's pool */
+static pthread_key_t g_thread_allocator_key;       /**< Destroys pools at thread exit */
+static pthread_once_t g_thread_allocator_once = PTHREAD_ONCE_INIT;
+static int g_thread_allocator_key_ready = 0;       /**< Written once under pthread_once */
+
+/**
+ * @brief Thread exit hook releasing the thread's pool allocator
+ *
+ * @param allocator Pool allocator registered for the exiting thread
+ */
+static void thread_allocator_release(void* allocator) {
+    t_thread_allocator = NULL;
+    ms_allocator_destroy(allocator);
+}
+
+/**
+ * @brief Create the thread exit key exactly once
+ */
+static void thread_allocator_key_init(void) {
+    g_thread_allocator_key_ready =
+        pthread_key_create(&g_thread_allocator_key, thread_allocator_release) == 0;
+}
+
+/** @} */
+
+ms_allocator_t* ms_allocator_thread_local(void) {
+    ms_allocator_t* allocator = t_thread_allocator;
+    if (allocator != NULL) {
+        return allocator;
     }
-    return &g_default_allocator;
+
+    pthread_once(&g_thread_allocator_once, thread_allocator_key_init);
+    if (!g_thread_allocator_key_ready) {
+        return ms_allocator_default();
+    }
+
+    allocator = ms_allocator_create_pool();
+    if (allocator == NULL) {
+        return ms_allocator_default();
+    }
+
+    if (pthread_setspecific(g_thread_allocator_key, allocator) != 0) {
+        ms_allocator_destroy(allocator);
+        return ms_allocator_default();
+    }
+
+    t_thread_allocator = allocator;
+    return allocator;
+}
+
+ms_memory_result_t ms_allocator_get_stats(const ms_allocator_t* allocator,
+                                         ms_memory_stats_t* stats) {
+    if (stats == NULL || !is_valid_allocator(allocator)) {
+        return MS_MEMORY_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (allocator->sharded_stats != NULL) {
+        ms_memory_stats_sharded_snapshot(allocator->sharded_stats, stats);
+    } else {
+        ms_memory_stats_snapshot(&allocator->stats, stats);
+    }
+    return MS_MEMORY_SUCCESS;
 }
@@ -33,6 +33,35 @@ typedef enum {
  */
 ms_allocator_t* ms_allocator_create(void);
 
+/**
+ * @brief Create an arena allocator that bump-allocates from large chunks
+ *
+ * @param chunk_size Capacity of each chunk in bytes, 0 selects 64 KB
+ *
+ * @return New arena allocator instance or NULL if creation fails
+ *
+ * @note Blocks carry no per-allocation header; deallocation only reclaims
+ *       the most recent block, everything else is released at once by
+ *       ms_allocator_reset() or ms_allocator_destroy()
+ * @note Arena allocators are not thread-safe, use one per thread
+ * @note JSON values created from an arena skip the recursive free in
+ *       ms_json_destroy()
+ */
+ms_allocator_t* ms_allocator_create_arena(size_t chunk_size);
+
+/**
+ * @brief Create a pool allocator with size-class free lists for small blocks
+ *
+ * @return New pool allocator instance or NULL if creation fails
+ *
+ * @note Blocks up to 128 bytes (JSON nodes, short keys) come from 16-byte
+ *       size classes carved out of 64 KB slabs and are recycled through
+ *       per-class free lists; larger blocks fall back to malloc
+ * @note Pool allocators take no locks and are not thread-safe, use one per
+ *       thread; hit rate is reported through ms_allocator_get_stats()
+ */
+ms_allocator_t* ms_allocator_create_pool(void);
+
 /**
  * @brief Destroy an allocator instance and release its resources
  *
@@ -42,6 +71,28 @@ ms_allocator_t* ms_allocator_create(void);
  */
 void ms_allocator_destroy(ms_allocator_t* allocator);
 
+/**
+ * @brief Release every block of an arena allocator at once
+ *
+ * @param allocator Arena allocator to reset
+ *
+ * @return MS_MEMORY_SUCCESS on success, MS_MEMORY_ERROR_INVALID_ARGUMENT
+ *         if allocator is not an arena
+ *
+ * @note One standard-size chunk is kept for reuse by the next document
+ * @warning All blocks handed out before the reset become invalid
+ */
+ms_memory_result_t ms_allocator_reset(ms_allocator_t* allocator);
+
+/**
+ * @brief Check whether an allocator uses the arena backend
+ *
+ * @param allocator Allocator instance to query
+ *
+ * @return 1 if allocator was created by ms_allocator_create_arena(), 0 otherwise
+ */
+int ms_allocator_is_arena(const ms_allocator_t* allocator);
+
 /**
  * @brief Allocate memory block with comprehensive overflow protection
  *
@@ -110,9 +161,25 @@ ms_memory_result_t ms_allocator_deallocate(ms_allocator_t* allocator, void* ptr)
  *
  * @return Default allocator instance (always valid)
  *
- * @note The default allocator is shared and thread-safe
+ * @note The default allocator is shared and thread-safe; it is statically
+ *       initialized and keeps its counters per thread, so threads
+ *       allocating from it concurrently share no statistics cache line
  * @note Do not destroy the default allocator
  */
 ms_allocator_t* ms_allocator_default(void);
 
+/**
+ * @brief Get the calling thread's private pool allocator
+ *
+ * @return Per-thread allocator instance (always valid), falling back to
+ *         ms_allocator_default() if the thread cache cannot be created
+ *
+ * @note Created on first use and destroyed automatically at thread exit
+ * @note Takes no locks and shares no counters with other threads, so
+ *       concurrent parsers each using their own cache scale with cores
+ * @warning Blocks must be freed by the thread that allocated them and must
+ *          not outlive that thread; do not destroy the returned allocator
+ */
+ms_allocator_t* ms_allocator_thread_local(void);
+
 #endif
@@ -0,0 +1,231 @@
+/**
+ * @file ms_memory_stats.c
+ * @brief Allocation statistics bookkeeping
+ *
+ * Counters are kept apart from the allocator core so that allocators only
+ * pay for the statistics they actually record. Every update is a relaxed
+ * atomic operation: counters never tear, but readers get no ordering with
+ * respect to the allocations themselves. Allocators shared by many threads
+ * keep per-thread shards instead, summed when read.
+ */
+
+#include "ms_memory_stats.h"
+#include "ms_platform.h"
+
+/**
+ * @brief Map a request size to its histogram bucket
+ *
+ * @param size Requested size in bytes
+ * @return Bucket index, floor(log2(size)) clamped to the last bucket
+ */
+static size_t histogram_bucket(size_t size) {
+    size_t bucket = 0;
+#if defined(__GNUC__) || defined(__clang__)
+    if (size > 1) {
+        bucket = (size_t)(sizeof(unsigned long long) * 8 - 1 -
+                          (size_t)__builtin_clzll((unsigned long long)size));
+    }
+#else
+    while (size > 1) {
+        size >>= 1;
+        bucket++;
+    }
+#endif
+    return bucket < MS_MEMORY_STATS_HISTOGRAM_BUCKETS ? bucket : MS_MEMORY_STATS_HISTOGRAM_BUCKETS - 1;
+}
+
+/**
+ * @brief Raise the peak counter to at least the given value
+ *
+ * @param stats Statistics to update
+ * @param current Current byte count
+ */
+static void update_peak(ms_memory_stats_t* stats, size_t current) {
+    size_t peak = MS_ATOMIC_LOAD(&stats->peak_bytes_allocated);
+    while (current > peak &&
+           !MS_ATOMIC_CAS(&stats->peak_bytes_allocated, &peak, current)) {
+        /* peak reloaded by the failed compare-exchange */
+    }
+}
+
+void ms_memory_stats_record_allocation(ms_memory_stats_t* stats, size_t size) {
+    if (stats == NULL) return;
+
+    size_t current = MS_ATOMIC_ADD(&stats->bytes_allocated, size) + size;
+    MS_ATOMIC_ADD(&stats->allocation_count, 1);
+    MS_ATOMIC_ADD(&stats->allocation_total, 1);
+    MS_ATOMIC_ADD(&stats->size_histogram[histogram_bucket(size)], 1);
+    update_peak(stats, current);
+}
+
+void ms_memory_stats_record_deallocation(ms_memory_stats_t* stats, size_t size) {
+    if (stats == NULL) return;
+
+    MS_ATOMIC_SUB(&stats->bytes_allocated, size);
+    MS_ATOMIC_SUB(&stats->allocation_count, 1);
+}
+
+void ms_memory_stats_record_reallocation(ms_memory_stats_t* stats, size_t old_size, size_t new_size) {
+    if (stats == NULL) return;
+
+    MS_ATOMIC_ADD(&stats->reallocation_count, 1);
+    if (new_size >= old_size) {
+        size_t grown = new_size - old_size;
+        update_peak(stats, MS_ATOMIC_ADD(&stats->bytes_allocated, grown) + grown);
+    } else {
+        MS_ATOMIC_SUB(&stats->bytes_allocated, old_size - new_size);
+    }
+}
+
+void ms_memory_stats_record_pool_hit(ms_memory_stats_t* stats) {
+    if (stats == NULL) return;
+    MS_ATOMIC_ADD(&stats->pool_hits, 1);
+}
+
+void ms_memory_stats_record_pool_miss(ms_memory_stats_t* stats) {
+    if (stats == NULL) return;
+    MS_ATOMIC_ADD(&stats->pool_misses, 1);
+}
+
+void ms_memory_stats_reset(ms_memory_stats_t* stats) {
+    if (stats == NULL) return;
+
+    MS_ATOMIC_STORE(&stats->bytes_allocated, 0);
+    MS_ATOMIC_STORE(&stats->allocation_count, 0);
+    MS_ATOMIC_STORE(&stats->peak_bytes_allocated, 0);
+    MS_ATOMIC_STORE(&stats->allocation_total, 0);
+    MS_ATOMIC_STORE(&stats->reallocation_count, 0);
+    MS_ATOMIC_STORE(&stats->pool_hits, 0);
+    MS_ATOMIC_STORE(&stats->pool_misses, 0);
+    for (size_t i = 0; i < MS_MEMORY_STATS_HISTOGRAM_BUCKETS; i++) {
+        MS_ATOMIC_STORE(&stats->size_histogram[i], 0);
+    }
+}
+
+static MS_THREAD_LOCAL size_t t_shard_slot = 0;  /**< Calling thread's shard plus one, 0 until assigned */
+static size_t g_next_shard = 0;                  /**< Round-robin shard assignment */
+
+/**
+ * @brief Counters of the calling thread's shard
+ *
+ * @param stats Sharded statistics
+ * @return Shard assigned to this thread on its first call
+ */
+static ms_memory_stats_t* sharded_local(ms_memory_stats_sharded_t* stats) {
+    size_t slot = t_shard_slot;
+    if (slot == 0) {
+        slot = MS_ATOMIC_ADD(&g_next_shard, 1) % MS_MEMORY_STATS_SHARDS + 1;
+        t_shard_slot = slot;
+    }
+    return &stats->shards[slot - 1].stats;
+}
+
+/**
+ * @brief Fold a shard's byte drift into the shared total once it is large
+ *
+ * After growth the shard's own peak_bytes_allocated is raised to the
+ * flushed total plus its drift: exact for one thread, and short by at most
+ * the other shards' drift otherwise, without writing to a shared line.
+ *
+ * @param stats Sharded statistics
+ * @param shard Shard the drift belongs to
+ * @param drift Shard's bytes_allocated after the update, a wrapped signed value
+ * @param grew Whether the update added bytes
+ */
+static void sharded_settle(ms_memory_stats_sharded_t* stats, ms_memory_stats_t* shard, size_t drift, int grew) {
+    if (drift > MS_MEMORY_STATS_FLUSH_BYTES && drift < (size_t)0 - MS_MEMORY_STATS_FLUSH_BYTES) {
+        /* Moving exactly what was observed keeps the sum right even if another thread shares the shard */
+        MS_ATOMIC_SUB(&shard->bytes_allocated, drift);
+        update_peak(&stats->total, MS_ATOMIC_ADD(&stats->total.bytes_allocated, drift) + drift);
+    } else if (grew) {
+        update_peak(shard, MS_ATOMIC_LOAD(&stats->total.bytes_allocated) + drift);
+    }
+}
+
+void ms_memory_stats_sharded_record_allocation(ms_memory_stats_sharded_t* stats, size_t size) {
+    if (stats == NULL) return;
+
+    ms_memory_stats_t* shard = sharded_local(stats);
+    size_t drift = MS_ATOMIC_ADD(&shard->bytes_allocated, size) + size;
+    MS_ATOMIC_ADD(&shard->allocation_count, 1);
+    MS_ATOMIC_ADD(&shard->allocation_total, 1);
+    MS_ATOMIC_ADD(&shard->size_histogram[histogram_bucket(size)], 1);
+    sharded_settle(stats, shard, drift, 1);
+}
+
+void ms_memory_stats_sharded_record_deallocation(ms_memory_stats_sharded_t* stats, size_t size) {
+    if (stats == NULL) return;
+
+    /* Blocks freed on another thread than their allocation leave wrapped counts, which still sum up */
+    ms_memory_stats_t* shard = sharded_local(stats);
+    size_t drift = MS_ATOMIC_SUB(&shard->bytes_allocated, size) - size;
+    MS_ATOMIC_SUB(&shard->allocation_count, 1);
+    sharded_settle(stats, shard, drift, 0);
+}
+
+void ms_memory_stats_sharded_record_reallocation(ms_memory_stats_sharded_t* stats, size_t old_size,
+                                                 size_t new_size) {
+    if (stats == NULL) return;
+
+    ms_memory_stats_t* shard = sharded_local(stats);
+    MS_ATOMIC_ADD(&shard->reallocation_count, 1);
+    if (new_size >= old_size) {
+        size_t grown = new_size - old_size;
+        sharded_settle(stats, shard, MS_ATOMIC_ADD(&shard->bytes_allocated, grown) + grown, 1);
+    } else {
+        size_t shrunk = old_size - new_size;
+        sharded_settle(stats, shard, MS_ATOMIC_SUB(&shard->bytes_allocated, shrunk) - shrunk, 0);
+    }
+}
+
+void ms_memory_stats_sharded_snapshot(const ms_memory_stats_sharded_t* source, ms_memory_stats_t* snapshot) {
+    if (source == NULL || snapshot == NULL) return;
+
+    ms_memory_stats_snapshot(&source->total, snapshot);
+    for (size_t i = 0; i < MS_MEMORY_STATS_SHARDS; i++) {
+        ms_memory_stats_t shard;
+        ms_memory_stats_snapshot(&source->shards[i].stats, &shard);
+        snapshot->bytes_allocated += shard.bytes_allocated;
+        snapshot->allocation_count += shard.allocation_count;
+        snapshot->allocation_total += shard.allocation_total;
+        snapshot->reallocation_count += shard.reallocation_count;
+        snapshot->pool_hits += shard.pool_hits;
+        snapshot->pool_misses += shard.pool_misses;
+        if (snapshot->peak_bytes_allocated < shard.peak_bytes_allocated) {
+            snapshot->peak_bytes_allocated = shard.peak_bytes_allocated;
+        }
+        for (size_t j = 0; j < MS_MEMORY_STATS_HISTOGRAM_BUCKETS; j++) {
+            snapshot->size_histogram[j] += shard.size_histogram[j];
+        }
+    }
+
+    if (snapshot->peak_bytes_allocated < snapshot->bytes_allocated) {
+        snapshot->peak_bytes_allocated = snapshot->bytes_allocated;
+    }
+}
+
+void ms_memory_stats_snapshot(const ms_memory_stats_t* source, ms_memory_stats_t* snapshot) {
+    if (source == NULL || snapshot == NULL) return;
+
+    snapshot->bytes_allocated = MS_ATOMIC_LOAD(&source->bytes_allocated);
+    snapshot->allocation_count = MS_ATOMIC_LOAD(&source->allocation_count);
+    snapshot->peak_bytes_allocated = MS_ATOMIC_LOAD(&source->peak_bytes_allocated);
+    snapshot->allocation_total = MS_ATOMIC_LOAD(&source->allocation_total);
+    snapshot->reallocation_count = MS_ATOMIC_LOAD(&source->reallocation_count);
+    snapshot->pool_hits = MS_ATOMIC_LOAD(&source->pool_hits);
+    snapshot->pool_misses = MS_ATOMIC_LOAD(&source->pool_misses);
+    for (size_t i = 0; i < MS_MEMORY_STATS_HISTOGRAM_BUCKETS; i++) {
+        snapshot->size_histogram[i] = MS_ATOMIC_LOAD(&source->size_histogram[i]);
+    }
+}
+
+double ms_memory_stats_pool_hit_rate(const ms_memory_stats_t* stats) {
+    if (stats == NULL) return 0.0;
+
+    size_t hits = MS_ATOMIC_LOAD(&stats->pool_hits);
+    size_t total = hits + MS_ATOMIC_LOAD(&stats->pool_misses);
+    if (total == 0) {
+        return 0.0;
+    }
+    return (double)hits / (double)total;
+}
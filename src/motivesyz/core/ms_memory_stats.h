@@ -2,17 +2,121 @@
 #define MS_MEMORY_STATS_H
 
 #include "ms_memory.h"
+#include "ms_platform.h"
 #include <stddef.h>
 
+/**
+ * @brief Number of power-of-two buckets in the allocation size histogram
+ *
+ * Bucket i counts requests of 2^i .. 2^(i+1)-1 bytes; the last bucket also
+ * collects everything larger.
+ */
+#define MS_MEMORY_STATS_HISTOGRAM_BUCKETS 24
+
 typedef struct {
-    size_t bytes_allocated;
-    size_t allocation_count;
-    size_t peak_bytes_allocated;
+    size_t bytes_allocated;       /**< Bytes currently handed out */
+    size_t allocation_count;      /**< Blocks currently live */
+    size_t peak_bytes_allocated;  /**< High-water mark of bytes_allocated */
+    size_t allocation_total;      /**< Allocations since creation or reset */
+    size_t reallocation_count;    /**< Reallocations since creation or reset */
+    size_t pool_hits;             /**< Small blocks served from a pool free list */
+    size_t pool_misses;           /**< Small blocks carved from a fresh slab */
+    size_t size_histogram[MS_MEMORY_STATS_HISTOGRAM_BUCKETS]; /**< Request sizes */
 } ms_memory_stats_t;
 
-/* Statistics are separate from core allocation */
+/**
+ * @brief Number of per-thread counter sets behind a sharded allocator
+ *
+ * Threads are assigned a shard round-robin on first use; beyond this many
+ * threads, shards are shared, which stays correct but contends again.
+ */
+#define MS_MEMORY_STATS_SHARDS 16
+
+/**
+ * @brief Byte drift a shard accumulates before folding it into the total
+ *
+ * Bounds how far peak_bytes_allocated of a sharded allocator may trail the
+ * true high-water mark, per concurrently allocating thread.
+ */
+#define MS_MEMORY_STATS_FLUSH_BYTES (64 * 1024)
+
+/**
+ * @brief One thread's counters, padded away from its neighbours
+ */
+typedef struct {
+    ms_memory_stats_t stats;             /**< Counters; bytes_allocated holds unflushed drift and
+                                              peak_bytes_allocated this thread's view of the peak */
+    char padding[MS_CACHE_LINE_SIZE];    /**< Keeps the next shard's counters off these lines */
+} ms_memory_stats_shard_t;
+
+/**
+ * @brief Statistics of an allocator shared by many threads
+ *
+ * Each thread bumps the counters of its own shard, so concurrent callers
+ * share no cache line; only the byte total and its peak are shared, and
+ * they are written once per MS_MEMORY_STATS_FLUSH_BYTES of drift.
+ */
+typedef struct {
+    ms_memory_stats_t total;             /**< Flushed bytes_allocated and peak_bytes_allocated */
+    char padding[MS_CACHE_LINE_SIZE];    /**< Keeps the first shard off the total's lines */
+    ms_memory_stats_shard_t shards[MS_MEMORY_STATS_SHARDS]; /**< Per-thread counters */
+} ms_memory_stats_sharded_t;
+
+/* Statistics are separate from core allocation; all updates are relaxed atomics */
 void ms_memory_stats_record_allocation(ms_memory_stats_t* stats, size_t size);
 void ms_memory_stats_record_deallocation(ms_memory_stats_t* stats, size_t size);
+void ms_memory_stats_record_reallocation(ms_memory_stats_t* stats, size_t old_size, size_t new_size);
+void ms_memory_stats_record_pool_hit(ms_memory_stats_t* stats);
+void ms_memory_stats_record_pool_miss(ms_memory_stats_t* stats);
 void ms_memory_stats_reset(ms_memory_stats_t* stats);
 
+void ms_memory_stats_sharded_record_allocation(ms_memory_stats_sharded_t* stats, size_t size);
+void ms_memory_stats_sharded_record_deallocation(ms_memory_stats_sharded_t* stats, size_t size);
+void ms_memory_stats_sharded_record_reallocation(ms_memory_stats_sharded_t* stats, size_t old_size,
+                                                 size_t new_size);
+
+/**
+ * @brief Sum the shards of sharded statistics into one snapshot
+ *
+ * @param source Statistics being updated concurrently
+ * @param snapshot Output parameter; peak_bytes_allocated is at least the
+ *        current byte count, exact for a single allocating thread, and
+ *        may trail the true peak by up to MS_MEMORY_STATS_FLUSH_BYTES per
+ *        other thread allocating at the same time
+ */
+void ms_memory_stats_sharded_snapshot(const ms_memory_stats_sharded_t* source, ms_memory_stats_t* snapshot);
+
+/**
+ * @brief Take a consistent-per-field copy of live statistics
+ *
+ * @param source Statistics being updated concurrently
+ * @param snapshot Output parameter for the copy
+ */
+void ms_memory_stats_snapshot(const ms_memory_stats_t* source, ms_memory_stats_t* snapshot);
+
+/**
+ * @brief Fraction of pooled allocations served from a free list
+ *
+ * @param stats Statistics to evaluate
+ * @return Hit rate in [0, 1], 0 when no pooled allocation happened
+ */
+double ms_memory_stats_pool_hit_rate(const ms_memory_stats_t* stats);
+
+/**
+ * @brief Copy an allocator's statistics
+ *
+ * @param allocator Allocator instance to query
+ * @param stats Output parameter for the statistics snapshot
+ *
+ * @return MS_MEMORY_SUCCESS on success, MS_MEMORY_ERROR_INVALID_ARGUMENT
+ *         on invalid parameters
+ *
+ * @note Counters are maintained in all builds unless MS_MEMORY_NO_STATS is
+ *       defined; safe to call while other threads allocate
+ * @note Arena blocks other than the most recent one are never individually
+ *       freed, so bytes_allocated of an arena only drops on reset
+ */
+ms_memory_result_t ms_allocator_get_stats(const ms_allocator_t* allocator,
+                                         ms_memory_stats_t* stats);
+
 #endif
@@ -0,0 +1,66 @@
+/**
+ * @file ms_platform.h
+ * @brief Internal compiler and platform abstractions
+ *
+ * Thin wrappers over compiler builtins so the C99 sources can use atomic
+ * counters without depending on C11 <stdatomic.h>. Not part of the public API.
+ */
+
+#ifndef MS_PLATFORM_H
+#define MS_PLATFORM_H
+
+#include <stddef.h>
+
+/**
+ * @defgroup platform_atomics Relaxed Atomic Operations
+ * @brief Counter updates that need atomicity but no ordering
+ * @{
+ */
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MS_ATOMIC_LOAD(ptr) __atomic_load_n((ptr), __ATOMIC_RELAXED)
+#define MS_ATOMIC_STORE(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELAXED)
+#define MS_ATOMIC_ADD(ptr, value) __atomic_fetch_add((ptr), (value), __ATOMIC_RELAXED)
+#define MS_ATOMIC_SUB(ptr, value) __atomic_fetch_sub((ptr), (value), __ATOMIC_RELAXED)
+#define MS_ATOMIC_CAS(ptr, expected_ptr, desired) \
+    __atomic_compare_exchange_n((ptr), (expected_ptr), (desired), 1, \
+                                __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+/* Reference drop: orders every use of the object before the free that follows the last one */
+#define MS_ATOMIC_SUB_ACQ_REL(ptr, value) __atomic_fetch_sub((ptr), (value), __ATOMIC_ACQ_REL)
+/* Publication: data written before the release store is visible after the acquire load that reads it */
+#define MS_ATOMIC_LOAD_ACQUIRE(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define MS_ATOMIC_STORE_RELEASE(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+/* Full barrier for store-then-load handshakes such as sleep/wake flags */
+#define MS_ATOMIC_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+/* Plain accesses: counters are only exact for single-threaded use */
+#define MS_ATOMIC_LOAD(ptr) (*(ptr))
+#define MS_ATOMIC_STORE(ptr, value) ((void)(*(ptr) = (value)))
+#define MS_ATOMIC_ADD(ptr, value) ((*(ptr) += (value)) - (value))
+#define MS_ATOMIC_SUB(ptr, value) ((*(ptr) -= (value)) + (value))
+#define MS_ATOMIC_CAS(ptr, expected_ptr, desired) \
+    (*(ptr) == *(expected_ptr) ? (*(ptr) = (desired), 1) : (*(expected_ptr) = *(ptr), 0))
+#define MS_ATOMIC_SUB_ACQ_REL(ptr, value) MS_ATOMIC_SUB(ptr, value)
+#define MS_ATOMIC_LOAD_ACQUIRE(ptr) MS_ATOMIC_LOAD(ptr)
+#define MS_ATOMIC_STORE_RELEASE(ptr, value) MS_ATOMIC_STORE(ptr, value)
+#define MS_ATOMIC_FENCE() ((void)0)
+#endif
+
+/** @} */
+
+/**
+ * @defgroup platform_threads Thread-Local Storage and Cache Layout
+ * @{
+ */
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MS_THREAD_LOCAL __thread
+#else
+#define MS_THREAD_LOCAL _Thread_local
+#endif
+
+#define MS_CACHE_LINE_SIZE 64   /**< Padding unit that keeps hot fields apart */
+
+/** @} */
+
+#endif /* MS_PLATFORM_H */
@@ -5,23 +5,97 @@
  * Handles color support detection, buffer management, and safe output operations.
  */
 
+#define _POSIX_C_SOURCE 200809L  /* flockfile(), clock_gettime(), sched_yield() */
+
 #include "ms_print.h"
+#include "ms_platform.h"
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <unistd.h>
 
+/* Configuration constants */
+#define PRINT_FORMAT_STACK_SIZE 1024        /**< Formatted output up to this size needs no heap buffer */
+#define PRINT_LINE_STACK_SIZE 256           /**< Separator lines up to this size are built on the stack */
+#define PRINT_MULTIPLE_BATCH 16             /**< Strings of print_multiple() gathered into one message */
+#define PRINT_ASYNC_UNIT 8                  /**< Ring space is reserved in units of this many bytes */
+#define PRINT_ASYNC_BUFFER_MIN 4096         /**< Smallest ring */
+#define PRINT_ASYNC_BUFFER_MAX ((size_t)1 << 30) /**< Largest ring, keeps message lengths in 32 bits */
+#define PRINT_ASYNC_BATCH_SIZE (64 * 1024)  /**< Bytes the writer gathers for one write(2) */
+#define PRINT_ASYNC_WAIT_NS 50000000L       /**< Longest single sleep, bounds the cost of a missed wake-up */
+
+/** One piece of a message */
+typedef struct {
+    const char* text;
+    size_t length;
+} print_part_t;
+
+/**
+ * @brief Ring buffer shared by all printing threads and the writer
+ *
+ * Producers claim space by advancing head with a compare-and-swap, copy
+ * their bytes in, and publish the message by storing its length in the
+ * mark of its first unit. The writer consumes messages strictly in reserve
+ * order, clears each mark and advances tail. Locks are only taken to sleep
+ * and wake, never on the path of a print that finds room.
+ */
+typedef struct {
+    unsigned char* data;        /**< Message bytes, capacity * PRINT_ASYNC_UNIT */
+    uint32_t* marks;            /**< Length of the message starting at each unit, 0 until published */
+    size_t capacity;            /**< Ring size in units, a power of two */
+    size_t max_message;         /**< Longer messages bypass the ring */
+    print_overflow_t overflow;  /**< Policy when the ring is full */
+    char* batch;                /**< Writer's gather buffer, PRINT_ASYNC_BATCH_SIZE bytes */
+
+    char head_padding[MS_CACHE_LINE_SIZE]; /**< Keeps the producers' line apart */
+    size_t head;                /**< Next unit to reserve */
+    char tail_padding[MS_CACHE_LINE_SIZE]; /**< Keeps the writer's line apart */
+    size_t tail;                /**< First unit not yet consumed */
+    size_t written;             /**< Units whose bytes have been handed to write(2) */
+    int writer_idle;            /**< Writer is asleep on wake */
+    int stopping;               /**< Writer exits once the ring is empty */
+    size_t space_waiters;       /**< Producers asleep on space */
+    size_t flush_waiters;       /**< Flushers asleep on drained */
+
+    pthread_mutex_t lock;       /**< Guards the condition variables only */
+    pthread_cond_t wake;        /**< Signalled when a message is published */
+    pthread_cond_t space;       /**< Signalled when the writer frees space */
+    pthread_cond_t drained;     /**< Signalled when written advances */
+    pthread_t writer;           /**< Writer thread */
+} print_async_t;
+
 /**
  * @defgroup internal_state Internal Print State
- * @brief Module-level state for buffer and color management
+ * @brief Module-level state for color and output mode management
  * @{
  */
 
-static char* format_buffer = NULL;    /**< Dynamic buffer for formatted output */
-static size_t buffer_size = 1024;     /**< Current buffer size in bytes */
-static int color_support_checked = 0; /**< Color support check flag */
-static int color_supported = 0;       /**< Terminal color support result */
+static int color_support = -1;         /**< Terminal color support, -1 until checked */
+static print_async_t* async_ring = NULL; /**< Active ring, NULL in synchronous mode */
+static size_t async_dropped = 0;       /**< Messages discarded by PRINT_OVERFLOW_DROP */
+static size_t async_producers = 0;     /**< Threads inside a print or flush that may use the ring */
+static int async_exit_registered = 0;  /**< print_async_stop() registered with atexit() */
+static pthread_mutex_t async_control = PTHREAD_MUTEX_INITIALIZER; /**< Serializes start and stop */
 
 /** @} */
 
+/* Forward declarations for internal functions */
+static void print_emit(const print_part_t* parts, size_t count);
+static void print_write_all(const char* data, size_t length);
+static int print_async_reserve(print_async_t* ring, size_t length, size_t* start);
+static void print_async_commit(print_async_t* ring, size_t start, size_t length);
+static void print_async_wait_for_space(print_async_t* ring, size_t units);
+static void print_async_timed_wait(pthread_cond_t* cond, pthread_mutex_t* lock);
+static void* print_async_writer(void* arg);
+static print_async_t* print_async_create(size_t bytes, print_overflow_t overflow);
+static void print_async_destroy(print_async_t* ring);
+static print_async_t* print_async_enter(void);
+static void print_async_leave(void);
+
 /**
  * @brief Check if terminal supports color output
  *
@@ -31,24 +105,19 @@ static int color_supported = 0;       /**< Terminal color support result */
  * @note Uses isatty() to detect terminal
  */
 static int check_color_support(void) {
-    if (color_support_checked) {
-        return color_supported;
+    int supported = MS_ATOMIC_LOAD(&color_support);
+    if (supported < 0) {
+        supported = isatty(STDOUT_FILENO) ? 1 : 0;
+        MS_ATOMIC_STORE(&color_support, supported);
     }
-
-    color_support_checked = 1;
-    color_supported = isatty(STDOUT_FILENO);
-    return color_supported;
+    return supported;
 }
 
-/**
- * @brief Cleanup function for format buffer
- *
- * @note Automatically called on program exit
- * @note Safe to call multiple times
- */
-static void cleanup_buffer(void) {
-    free(format_buffer);
-    format_buffer = NULL;
+int print_color_enabled(int fd) {
+    if (fd == STDOUT_FILENO) {
+        return check_color_support();
+    }
+    return isatty(fd) ? 1 : 0;
 }
 
 /**
@@ -61,23 +130,331 @@ static void cleanup_buffer(void) {
  * @note Always resets color after printing
  */
 static void print_colored(const char* color_code, const char* text) {
-    if (check_color_support() && text != NULL) {
-        printf("%s%s%s", color_code, text, COLOR_RESET);
-    } else if (text != NULL) {
-        printf("%s", text);
+    if (text == NULL) {
+        return;
+    }
+
+    if (check_color_support()) {
+        print_part_t parts[3] = {
+            { color_code, strlen(color_code) },
+            { text, strlen(text) },
+            { COLOR_RESET, sizeof(COLOR_RESET) - 1 }
+        };
+        print_emit(parts, 3);
+    } else {
+        print_part_t part = { text, strlen(text) };
+        print_emit(&part, 1);
+    }
+}
+
+/**
+ * @brief Output the parts of one message without interleaving
+ *
+ * Synchronous mode writes through stdout under its lock; async mode copies
+ * the message into the ring, or writes it directly when it is too long for
+ * the ring.
+ */
+static void print_emit(const print_part_t* parts, size_t count) {
+    size_t length = 0;
+    for (size_t i = 0; i < count; i++) {
+        length += parts[i].length;
+    }
+    if (length == 0) {
+        return;
+    }
+
+    print_async_t* ring = MS_ATOMIC_LOAD_ACQUIRE(&async_ring) ? print_async_enter() : NULL;
+    if (ring == NULL) {
+        flockfile(stdout);
+        for (size_t i = 0; i < count; i++) {
+            fwrite(parts[i].text, 1, parts[i].length, stdout);
+        }
+        funlockfile(stdout);
+        return;
+    }
+
+    if (length > ring->max_message) {
+        /* Everything this thread queued earlier goes out first */
+        print_flush();
+        for (size_t i = 0; i < count; i++) {
+            print_write_all(parts[i].text, parts[i].length);
+        }
+        print_async_leave();
+        return;
+    }
+
+    size_t start;
+    if (!print_async_reserve(ring, length, &start)) {
+        print_async_leave();
+        return;
+    }
+
+    size_t ring_bytes = ring->capacity * PRINT_ASYNC_UNIT;
+    size_t offset = (start & (ring->capacity - 1)) * PRINT_ASYNC_UNIT;
+    for (size_t i = 0; i < count; i++) {
+        /* A message may wrap past the end of the ring */
+        size_t first = parts[i].length;
+        if (first > ring_bytes - offset) {
+            first = ring_bytes - offset;
+        }
+        memcpy(ring->data + offset, parts[i].text, first);
+        memcpy(ring->data, parts[i].text + first, parts[i].length - first);
+        offset = (offset + parts[i].length) & (ring_bytes - 1);
+    }
+
+    print_async_commit(ring, start, length);
+    print_async_leave();
+}
+
+/**
+ * @brief write(2) a whole buffer to standard output
+ *
+ * @note Retries on EINTR and partial writes; other errors drop the rest
+ */
+static void print_write_all(const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(STDOUT_FILENO, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+}
+
+/**
+ * @brief Claim ring space for a message
+ *
+ * @param ring Active ring
+ * @param length Message length in bytes, at most ring->max_message
+ * @param start Output parameter for the first reserved unit
+ * @return 1 if space was reserved, 0 if the message was dropped
+ */
+static int print_async_reserve(print_async_t* ring, size_t length, size_t* start) {
+    size_t units = (length + PRINT_ASYNC_UNIT - 1) / PRINT_ASYNC_UNIT;
+    size_t head = MS_ATOMIC_LOAD(&ring->head);
+
+    for (;;) {
+        size_t used = head - MS_ATOMIC_LOAD_ACQUIRE(&ring->tail);
+        if (used > ring->capacity) {
+            /* head was read before the writer moved tail past it */
+            head = MS_ATOMIC_LOAD(&ring->head);
+            continue;
+        }
+
+        if (used + units > ring->capacity) {
+            if (ring->overflow == PRINT_OVERFLOW_DROP) {
+                MS_ATOMIC_ADD(&async_dropped, 1);
+                return 0;
+            }
+            print_async_wait_for_space(ring, units);
+            head = MS_ATOMIC_LOAD(&ring->head);
+            continue;
+        }
+
+        if (MS_ATOMIC_CAS(&ring->head, &head, head + units)) {
+            *start = head;
+            return 1;
+        }
+    }
+}
+
+/**
+ * @brief Publish a copied message and wake the writer if it sleeps
+ */
+static void print_async_commit(print_async_t* ring, size_t start, size_t length) {
+    MS_ATOMIC_STORE_RELEASE(&ring->marks[start & (ring->capacity - 1)], (uint32_t)length);
+
+    /* Pairs with the fence between the writer's idle store and its mark check */
+    MS_ATOMIC_FENCE();
+    if (MS_ATOMIC_LOAD(&ring->writer_idle)) {
+        pthread_mutex_lock(&ring->lock);
+        pthread_cond_signal(&ring->wake);
+        pthread_mutex_unlock(&ring->lock);
+    }
+}
+
+/**
+ * @brief Sleep until the writer frees space or the wait times out
+ *
+ * The caller re-checks the space and may come back.
+ */
+static void print_async_wait_for_space(print_async_t* ring, size_t units) {
+    pthread_mutex_lock(&ring->lock);
+    MS_ATOMIC_ADD(&ring->space_waiters, 1);
+    MS_ATOMIC_FENCE();
+
+    size_t used = MS_ATOMIC_LOAD(&ring->head) - MS_ATOMIC_LOAD_ACQUIRE(&ring->tail);
+    if (used + units > ring->capacity) {
+        pthread_cond_signal(&ring->wake);
+        print_async_timed_wait(&ring->space, &ring->lock);
+    }
+
+    MS_ATOMIC_SUB(&ring->space_waiters, 1);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+/**
+ * @brief pthread_cond_timedwait() for at most PRINT_ASYNC_WAIT_NS
+ */
+static void print_async_timed_wait(pthread_cond_t* cond, pthread_mutex_t* lock) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += PRINT_ASYNC_WAIT_NS;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(cond, lock, &deadline);
+}
+
+/**
+ * @brief Writer thread: gather published messages and write them out
+ *
+ * Each pass copies consecutive published messages into the batch buffer
+ * until it is full or the next message is not yet published, then issues
+ * one write(2). The thread sleeps only when the ring is empty at tail.
+ */
+static void* print_async_writer(void* arg) {
+    print_async_t* ring = arg;
+    size_t mask = ring->capacity - 1;
+    size_t ring_bytes = ring->capacity * PRINT_ASYNC_UNIT;
+    size_t tail = ring->tail;
+
+    for (;;) {
+        size_t batched = 0;
+        for (;;) {
+            uint32_t* mark = &ring->marks[tail & mask];
+            size_t length = MS_ATOMIC_LOAD_ACQUIRE(mark);
+            if (length == 0 || batched + length > PRINT_ASYNC_BATCH_SIZE) {
+                break;
+            }
+
+            size_t offset = (tail & mask) * PRINT_ASYNC_UNIT;
+            size_t first = length < ring_bytes - offset ? length : ring_bytes - offset;
+            memcpy(ring->batch + batched, ring->data + offset, first);
+            memcpy(ring->batch + batched + first, ring->data, length - first);
+            batched += length;
+
+            MS_ATOMIC_STORE(mark, 0);
+            tail += (length + PRINT_ASYNC_UNIT - 1) / PRINT_ASYNC_UNIT;
+            MS_ATOMIC_STORE_RELEASE(&ring->tail, tail);
+        }
+
+        if (batched > 0) {
+            print_write_all(ring->batch, batched);
+            MS_ATOMIC_STORE_RELEASE(&ring->written, tail);
+
+            /* Pairs with the fences after the waiter counts are raised */
+            MS_ATOMIC_FENCE();
+            if (MS_ATOMIC_LOAD(&ring->space_waiters) || MS_ATOMIC_LOAD(&ring->flush_waiters)) {
+                pthread_mutex_lock(&ring->lock);
+                pthread_cond_broadcast(&ring->space);
+                pthread_cond_broadcast(&ring->drained);
+                pthread_mutex_unlock(&ring->lock);
+            }
+            continue;
+        }
+
+        if (MS_ATOMIC_LOAD_ACQUIRE(&ring->stopping) && tail == MS_ATOMIC_LOAD(&ring->head)) {
+            break;
+        }
+
+        pthread_mutex_lock(&ring->lock);
+        MS_ATOMIC_STORE(&ring->writer_idle, 1);
+        MS_ATOMIC_FENCE();
+        if (MS_ATOMIC_LOAD_ACQUIRE(&ring->marks[tail & mask]) == 0 && !MS_ATOMIC_LOAD(&ring->stopping)) {
+            print_async_timed_wait(&ring->wake, &ring->lock);
+        }
+        MS_ATOMIC_STORE(&ring->writer_idle, 0);
+        pthread_mutex_unlock(&ring->lock);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Allocate a ring of bytes bytes, a power of two
+ */
+static print_async_t* print_async_create(size_t bytes, print_overflow_t overflow) {
+    print_async_t* ring = calloc(1, sizeof(*ring));
+    if (ring == NULL) {
+        return NULL;
+    }
+
+    ring->capacity = bytes / PRINT_ASYNC_UNIT;
+    ring->data = malloc(bytes);
+    ring->marks = calloc(ring->capacity, sizeof(*ring->marks));
+    ring->batch = malloc(PRINT_ASYNC_BATCH_SIZE);
+    if (ring->data == NULL || ring->marks == NULL || ring->batch == NULL) {
+        free(ring->data);
+        free(ring->marks);
+        free(ring->batch);
+        free(ring);
+        return NULL;
     }
+
+    /* A quarter of the ring keeps one long message from starving the rest */
+    ring->max_message = bytes / 4 < PRINT_ASYNC_BATCH_SIZE ? bytes / 4 : PRINT_ASYNC_BATCH_SIZE;
+    ring->overflow = overflow;
+    pthread_mutex_init(&ring->lock, NULL);
+    pthread_cond_init(&ring->wake, NULL);
+    pthread_cond_init(&ring->space, NULL);
+    pthread_cond_init(&ring->drained, NULL);
+    return ring;
+}
+
+/**
+ * @brief Announce a ring user, then read the ring
+ *
+ * @return Active ring, which print_async_stop() does not free before the
+ *         matching print_async_leave(); NULL in synchronous mode
+ */
+static print_async_t* print_async_enter(void) {
+    MS_ATOMIC_ADD(&async_producers, 1);
+
+    /* Pairs with the fence in print_async_stop(): it sees the count or we see NULL */
+    MS_ATOMIC_FENCE();
+    print_async_t* ring = MS_ATOMIC_LOAD_ACQUIRE(&async_ring);
+    if (ring == NULL) {
+        MS_ATOMIC_SUB(&async_producers, 1);
+    }
+    return ring;
+}
+
+/**
+ * @brief Release the ring taken by print_async_enter()
+ */
+static void print_async_leave(void) {
+    MS_ATOMIC_SUB_ACQ_REL(&async_producers, 1);
+}
+
+static void print_async_destroy(print_async_t* ring) {
+    pthread_mutex_destroy(&ring->lock);
+    pthread_cond_destroy(&ring->wake);
+    pthread_cond_destroy(&ring->space);
+    pthread_cond_destroy(&ring->drained);
+    free(ring->data);
+    free(ring->marks);
+    free(ring->batch);
+    free(ring);
 }
 
 /* Public API implementation */
 void print(const char* text) {
     if (text != NULL) {
-        printf("%s", text);
+        print_part_t part = { text, strlen(text) };
+        print_emit(&part, 1);
     }
 }
 
 void println(const char* text) {
     if (text != NULL) {
-        printf("%s\n", text);
+        print_part_t parts[2] = { { text, strlen(text) }, { "\n", 1 } };
+        print_emit(parts, 2);
     }
 }
 
@@ -106,51 +483,57 @@ void print_format(const char* format, ...) {
         return;
     }
 
-    /* Lazy initialization of format buffer */
-    if (format_buffer == NULL) {
-        format_buffer = malloc(buffer_size);
-        if (format_buffer == NULL) {
-            return;
-        }
-        atexit(cleanup_buffer);
-    }
-
+    /* Each call formats into its own buffer, so threads never share one */
+    char stack_buffer[PRINT_FORMAT_STACK_SIZE];
     va_list args;
     va_start(args, format);
-
-    /* Try formatting with current buffer size */
-    int needed = vsnprintf(format_buffer, buffer_size, format, args);
+    int needed = vsnprintf(stack_buffer, sizeof(stack_buffer), format, args);
     va_end(args);
+    if (needed <= 0) {
+        return;
+    }
 
-    /* Resize buffer if output was truncated */
-    if (needed >= (int)buffer_size) {
-        buffer_size = (size_t)needed + 1;
-        char* new_buffer = realloc(format_buffer, buffer_size);
-        if (new_buffer != NULL) {
-            format_buffer = new_buffer;
-
-            /* Retry formatting with larger buffer */
-            va_start(args, format);
-            vsnprintf(format_buffer, buffer_size, format, args);
-            va_end(args);
+    char* text = stack_buffer;
+    if ((size_t)needed >= sizeof(stack_buffer)) {
+        text = malloc((size_t)needed + 1);
+        if (text == NULL) {
+            return;
         }
+
+        va_start(args, format);
+        vsnprintf(text, (size_t)needed + 1, format, args);
+        va_end(args);
     }
 
-    printf("%s", format_buffer);
+    print_part_t part = { text, (size_t)needed };
+    print_emit(&part, 1);
+
+    if (text != stack_buffer) {
+        free(text);
+    }
 }
 
 void print_multiple(int count, ...) {
+    print_part_t parts[PRINT_MULTIPLE_BATCH];
+    size_t gathered = 0;
+
     va_list args;
     va_start(args, count);
 
     for (int i = 0; i < count; i++) {
         const char* text = va_arg(args, const char*);
         if (text != NULL) {
-            printf("%s", text);
+            parts[gathered].text = text;
+            parts[gathered].length = strlen(text);
+            if (++gathered == PRINT_MULTIPLE_BATCH) {
+                print_emit(parts, gathered);
+                gathered = 0;
+            }
         }
     }
 
     va_end(args);
+    print_emit(parts, gathered);
 }
 
 void print_line(char fill_char, int length) {
@@ -158,8 +541,122 @@ void print_line(char fill_char, int length) {
         return;
     }
 
-    for (int i = 0; i < length; i++) {
-        putchar(fill_char);
+    char stack_buffer[PRINT_LINE_STACK_SIZE];
+    size_t size = (size_t)length + 1;
+    char* line = size <= sizeof(stack_buffer) ? stack_buffer : malloc(size);
+    if (line == NULL) {
+        return;
+    }
+
+    memset(line, fill_char, size - 1);
+    line[size - 1] = '\n';
+    print_part_t part = { line, size };
+    print_emit(&part, 1);
+
+    if (line != stack_buffer) {
+        free(line);
+    }
+}
+
+/* Asynchronous output */
+int print_async_start(const print_async_options_t* options) {
+    static const print_async_options_t defaults = { 0, PRINT_OVERFLOW_BLOCK };
+    if (options == NULL) {
+        options = &defaults;
+    }
+
+    size_t requested = options->buffer_size ? options->buffer_size : PRINT_ASYNC_BUFFER_DEFAULT;
+    if (requested > PRINT_ASYNC_BUFFER_MAX ||
+        (options->overflow != PRINT_OVERFLOW_BLOCK && options->overflow != PRINT_OVERFLOW_DROP)) {
+        return -1;
+    }
+
+    size_t bytes = PRINT_ASYNC_BUFFER_MIN;
+    while (bytes < requested) {
+        bytes <<= 1;
+    }
+
+    pthread_mutex_lock(&async_control);
+    if (async_ring != NULL) {
+        pthread_mutex_unlock(&async_control);
+        return -1;
+    }
+
+    print_async_t* ring = print_async_create(bytes, options->overflow);
+    if (ring == NULL) {
+        pthread_mutex_unlock(&async_control);
+        return -1;
+    }
+
+    /* Output already buffered in stdio goes out ahead of the ring */
+    fflush(stdout);
+    if (pthread_create(&ring->writer, NULL, print_async_writer, ring) != 0) {
+        print_async_destroy(ring);
+        pthread_mutex_unlock(&async_control);
+        return -1;
+    }
+
+    if (!async_exit_registered) {
+        async_exit_registered = atexit(print_async_stop) == 0;
+    }
+
+    MS_ATOMIC_STORE_RELEASE(&async_ring, ring);
+    pthread_mutex_unlock(&async_control);
+    return 0;
+}
+
+void print_flush(void) {
+    print_async_t* ring = MS_ATOMIC_LOAD_ACQUIRE(&async_ring) ? print_async_enter() : NULL;
+    if (ring == NULL) {
+        fflush(stdout);
+        return;
+    }
+
+    /* Everything reserved so far, including this thread's messages */
+    size_t target = MS_ATOMIC_LOAD(&ring->head);
+
+    pthread_mutex_lock(&ring->lock);
+    MS_ATOMIC_ADD(&ring->flush_waiters, 1);
+    MS_ATOMIC_FENCE();
+    while (MS_ATOMIC_LOAD_ACQUIRE(&ring->written) < target) {
+        pthread_cond_signal(&ring->wake);
+        print_async_timed_wait(&ring->drained, &ring->lock);
     }
-    putchar('\n');
+    MS_ATOMIC_SUB(&ring->flush_waiters, 1);
+    pthread_mutex_unlock(&ring->lock);
+    print_async_leave();
+}
+
+void print_async_stop(void) {
+    pthread_mutex_lock(&async_control);
+    print_async_t* ring = async_ring;
+    if (ring == NULL) {
+        pthread_mutex_unlock(&async_control);
+        return;
+    }
+
+    /*
+     * Later prints take the synchronous path. Threads already holding the
+     * ring, which at exit() may still be running, finish their message
+     * while the writer keeps draining, so none touches it once freed.
+     */
+    MS_ATOMIC_STORE_RELEASE(&async_ring, NULL);
+    MS_ATOMIC_FENCE();
+    while (MS_ATOMIC_LOAD_ACQUIRE(&async_producers) != 0) {
+        sched_yield();
+    }
+
+    pthread_mutex_lock(&ring->lock);
+    MS_ATOMIC_STORE_RELEASE(&ring->stopping, 1);
+    pthread_cond_signal(&ring->wake);
+    pthread_mutex_unlock(&ring->lock);
+
+    /* The writer drains the ring before it exits */
+    pthread_join(ring->writer, NULL);
+    print_async_destroy(ring);
+    pthread_mutex_unlock(&async_control);
+}
+
+size_t print_async_dropped(void) {
+    return MS_ATOMIC_LOAD(&async_dropped);
 }
@@ -103,7 +103,7 @@ void print_cyan(const char* text);
  * @param format Format string (printf-style)
  * @param ... Arguments for format string
  *
- * @note Automatically handles buffer allocation and resizing
+ * @note Formats into a per-call buffer, so concurrent calls are safe
  * @note Safe against buffer overflows
  * @note NULL format is silently ignored
  */
@@ -131,4 +131,84 @@ void print_multiple(int count, ...);
  */
 void print_line(char fill_char, int length);
 
+/**
+ * @brief Whether output to a file descriptor should use ANSI colors
+ *
+ * @param fd File descriptor to check
+ * @return 1 if fd is a terminal, 0 otherwise
+ *
+ * @note The result for standard output is cached, as for the print functions
+ */
+int print_color_enabled(int fd);
+
+/**
+ * @defgroup async_output Asynchronous Output
+ * @brief Opt-in mode that takes write(2) off the printing threads
+ *
+ * While async output runs, every function above copies its message into a
+ * lock-free ring shared by all threads and returns; a writer thread drains
+ * the ring into large write(2) calls on standard output. A message is never
+ * split, and messages appear in the order their threads reserved space.
+ * Direct stdio calls such as printf() bypass the ring and are not ordered
+ * against it.
+ * @{
+ */
+
+#define PRINT_ASYNC_BUFFER_DEFAULT ((size_t)1 << 20)  /**< Ring size when none is given */
+
+/**
+ * @brief What a print does when the ring is full
+ */
+typedef enum {
+    PRINT_OVERFLOW_BLOCK = 0,  /**< Wait until the writer frees space */
+    PRINT_OVERFLOW_DROP        /**< Discard the message, counted by print_async_dropped() */
+} print_overflow_t;
+
+/**
+ * @brief Async output settings, zero-initialize for defaults
+ */
+typedef struct {
+    size_t buffer_size;         /**< Ring size in bytes, rounded up to a power of two; 0 for the default */
+    print_overflow_t overflow;  /**< Full-ring policy, PRINT_OVERFLOW_BLOCK by default */
+} print_async_options_t;
+
+/**
+ * @brief Switch all printing to the asynchronous path
+ *
+ * @param options Settings, NULL for defaults
+ * @return 0 on success, -1 if async output already runs, options are
+ *         invalid, or the ring or writer thread could not be created
+ *
+ * @note stdout is flushed first, and print_async_stop() is registered with
+ *       atexit() so queued output is not lost at exit
+ * @note Messages longer than a quarter of the ring or 64 KB are written
+ *       directly after a print_flush()
+ */
+int print_async_start(const print_async_options_t* options);
+
+/**
+ * @brief Wait until everything printed so far has been written
+ *
+ * @note In synchronous mode this is fflush(stdout)
+ */
+void print_flush(void);
+
+/**
+ * @brief Drain the ring, stop the writer and return to synchronous output
+ *
+ * Threads may keep printing while this runs, as they may at exit(): a
+ * message that already has the ring is finished and drained first, and
+ * later ones are written synchronously.
+ *
+ * @note Safe to call when async output is not running
+ */
+void print_async_stop(void);
+
+/**
+ * @brief Number of messages discarded under PRINT_OVERFLOW_DROP
+ */
+size_t print_async_dropped(void);
+
+/** @} */
+
 #endif
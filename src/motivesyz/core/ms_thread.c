@@ -0,0 +1,101 @@
+/**
+ * @file ms_thread.c
+ * @brief Worker thread groups on POSIX threads
+ */
+
+#define _POSIX_C_SOURCE 200809L  /* sysconf() */
+
+#include "ms_thread.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* Start arguments of one thread */
+typedef struct {
+    ms_thread_body_t body;
+    void* arg;
+    size_t worker;
+} ms_thread_start_t;
+
+struct ms_thread_group {
+    pthread_t* threads;
+    ms_thread_start_t* starts;
+    size_t count;
+};
+
+/* Forward declarations */
+static void* ms_thread_entry(void* start);
+
+size_t ms_thread_cpu_count(void) {
+#ifdef _SC_NPROCESSORS_ONLN
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    if (count > 0) {
+        return (size_t)count;
+    }
+#endif
+    return 1;
+}
+
+ms_thread_group_t* ms_thread_group_start(size_t count, ms_thread_body_t body, void* arg, size_t* started) {
+    if (started) {
+        *started = 0;
+    }
+    if (count == 0 || !body) {
+        return NULL;
+    }
+
+    ms_thread_group_t* group = malloc(sizeof(*group));
+    if (!group) {
+        return NULL;
+    }
+
+    group->threads = calloc(count, sizeof(*group->threads));
+    group->starts = calloc(count, sizeof(*group->starts));
+    group->count = 0;
+    if (!group->threads || !group->starts) {
+        free(group->threads);
+        free(group->starts);
+        free(group);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        group->starts[i].body = body;
+        group->starts[i].arg = arg;
+        group->starts[i].worker = i;
+        if (pthread_create(&group->threads[i], NULL, ms_thread_entry, &group->starts[i]) != 0) {
+            break;
+        }
+        group->count++;
+    }
+
+    if (group->count == 0) {
+        ms_thread_group_join(group);
+        return NULL;
+    }
+
+    if (started) {
+        *started = group->count;
+    }
+    return group;
+}
+
+void ms_thread_group_join(ms_thread_group_t* group) {
+    if (!group) {
+        return;
+    }
+
+    for (size_t i = 0; i < group->count; i++) {
+        pthread_join(group->threads[i], NULL);
+    }
+
+    free(group->threads);
+    free(group->starts);
+    free(group);
+}
+
+static void* ms_thread_entry(void* start) {
+    ms_thread_start_t* thread = start;
+    thread->body(thread->arg, thread->worker);
+    return NULL;
+}
@@ -0,0 +1,53 @@
+/**
+ * @file ms_thread.h
+ * @brief Internal worker thread groups
+ *
+ * A group runs the same body on several threads, each given its worker
+ * number, and is joined as a whole. Work distribution is left to the
+ * caller. Not part of the public API.
+ */
+
+#ifndef MS_THREAD_H
+#define MS_THREAD_H
+
+#include <stddef.h>
+
+/**
+ * @brief Code run by every thread of a group
+ *
+ * @param arg Argument given to ms_thread_group_start()
+ * @param worker Index of the thread in the group, from 0
+ */
+typedef void (*ms_thread_body_t)(void* arg, size_t worker);
+
+/**
+ * @brief Running threads (opaque)
+ */
+typedef struct ms_thread_group ms_thread_group_t;
+
+/**
+ * @brief Number of online processors, at least 1
+ */
+size_t ms_thread_cpu_count(void);
+
+/**
+ * @brief Start up to count threads running body
+ *
+ * Stops at the first thread that cannot be created, so fewer threads may
+ * run; callers must make progress with any number, including none.
+ *
+ * @param count Threads wanted
+ * @param body Thread body
+ * @param arg Passed to every body
+ * @param started Output parameter for the number of threads running
+ *
+ * @return Group to join, or NULL if no thread was started
+ */
+ms_thread_group_t* ms_thread_group_start(size_t count, ms_thread_body_t body, void* arg, size_t* started);
+
+/**
+ * @brief Wait for every thread of group to return, then free it
+ */
+void ms_thread_group_join(ms_thread_group_t* group);
+
+#endif /* MS_THREAD_H */
@@ -18,7 +18,9 @@
  */
 
 #include "core/ms_memory.h"   /**< Safe memory allocation utilities */
+#include "core/ms_memory_stats.h" /**< Allocator statistics queries */
 #include "core/ms_print.h"    /**< Simplified output and formatting */
+#include "core/ms_instrument.h" /**< Optional per-phase counters and trace hook */
 #include "core/ms_json.h"     /**< JSON parsing and serialization */
 
 /**
@@ -0,0 +1,1036 @@
+/**
+ * @file test.c
+ * @brief MotiveSyz correctness checks
+ *
+ * Every parse engine is checked against the recursive descent parser, the
+ * reference, on the same inputs: hand-written valid and malformed
+ * documents, generated documents and prefixes of all of them. Engines that
+ * build a tree must give the reference tree, compared through its
+ * serialized text, or the reference error code. Engines without a tree of
+ * their own (SAX, tape) are rebuilt into one first.
+ *
+ * Encoders are checked by round-trip: msgpack, struct binding and the
+ * fragment cache must reproduce the reference text, and the serializer
+ * variants (into a buffer, parallel) must match ms_json_serialize().
+ *
+ * Each failed check prints the input it failed on, and the exit status is
+ * nonzero if any check failed.
+ *
+ * Usage: motivesyz_test
+ */
+
+#define _POSIX_C_SOURCE 200809L  /* snprintf() */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "motivesyz/motivesyz.h"
+
+/* Configuration constants */
+#define TEST_GENERATED_DOCS 200           /* Random documents on top of the hand-written ones */
+#define TEST_GENERATED_MAX_DEPTH 4        /* Nesting of generated documents */
+#define TEST_GENERATED_MAX_MEMBERS 6      /* Members per generated array or object */
+#define TEST_SAX_MAX_DEPTH 64             /* Container stack of the SAX tree builder */
+#define TEST_RANDOM_DOUBLES 20000         /* Doubles checked for shortest round-trip text */
+#define TEST_SEED 0x9E3779B97F4A7C15ull
+
+/**
+ * @brief Growing text buffer the generator writes into
+ */
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} test_text_t;
+
+/**
+ * @brief Result of running one engine on one input
+ */
+typedef struct {
+    ms_json_result_t status;
+    char* text;  /* Serialized tree on success, NULL otherwise */
+} test_outcome_t;
+
+/* SAX handler state rebuilding a tree from events */
+typedef struct {
+    ms_json_value_t* root;
+    ms_json_value_t* stack[TEST_SAX_MAX_DEPTH];
+    size_t depth;
+    char key[256];
+    size_t key_length;
+} test_sax_builder_t;
+
+/* NDJSON callback state comparing each document with the expected text */
+typedef struct {
+    char* const* expected;
+    size_t count;
+    size_t delivered;
+    int mismatch;
+} test_ndjson_ctx_t;
+
+/* Bound struct exercising every binding type */
+typedef struct {
+    int32_t x;
+    int32_t y;
+} test_point_t;
+
+typedef struct {
+    int flag;
+    int32_t small;
+    int64_t big;
+    double ratio;
+    char name[16];
+    test_point_t origin;
+} test_record_t;
+
+static const ms_json_bind_field_t test_point_fields[] = {
+    MS_JSON_BIND_FIELD(MS_JSON_BIND_INT32, "x", test_point_t, x),
+    MS_JSON_BIND_FIELD(MS_JSON_BIND_INT32, "y", test_point_t, y),
+};
+
+static const ms_json_bind_field_t test_record_fields[] = {
+    MS_JSON_BIND_FIELD(MS_JSON_BIND_BOOL, "flag", test_record_t, flag),
+    MS_JSON_BIND_FIELD(MS_JSON_BIND_INT32, "small", test_record_t, small),
+    MS_JSON_BIND_FIELD(MS_JSON_BIND_INT64, "big", test_record_t, big),
+    MS_JSON_BIND_FIELD(MS_JSON_BIND_DOUBLE, "ratio", test_record_t, ratio),
+    MS_JSON_BIND_FIELD(MS_JSON_BIND_STRING, "name", test_record_t, name),
+    MS_JSON_BIND_NESTED("origin", test_record_t, origin, test_point_fields),
+};
+
+/* Forward declarations */
+static void test_check(int condition, const char* what, const char* input, size_t length);
+static uint64_t test_random(void);
+static void test_append(test_text_t* text, const char* data, size_t length);
+static void test_generate_value(test_text_t* text, int depth);
+static char* test_serialize(const ms_json_value_t* value);
+static void test_outcome_from_tree(test_outcome_t* outcome, ms_json_result_t status, ms_json_value_t* value);
+static void test_outcome_release(test_outcome_t* outcome);
+static void test_run_reference(const char* input, size_t length, test_outcome_t* outcome);
+static void test_run_engine(const char* input, size_t length, ms_json_engine_t engine, test_outcome_t* outcome);
+static void test_run_lazy(const char* input, size_t length, test_outcome_t* outcome);
+static void test_run_push(const char* input, size_t length, size_t step, test_outcome_t* outcome);
+static void test_run_sax(const char* input, size_t length, test_outcome_t* outcome);
+static void test_run_tape(const char* input, size_t length, test_outcome_t* outcome);
+static ms_json_value_t* test_tree_from_tape(ms_json_tape_value_t value);
+static void test_compare(const char* engine, const test_outcome_t* reference, const test_outcome_t* outcome,
+                         const char* input, size_t length);
+static void test_parse_engines(const char* input, size_t length);
+static void test_tree_encoders(const ms_json_value_t* tree, const char* reference, const char* input,
+                               size_t length);
+static void test_path(const ms_json_value_t* tree, const char* input, size_t length);
+static void test_ndjson(char* const* documents, size_t count);
+static void test_bind(void);
+static void test_fragment_cache(void);
+static void test_doubles(void);
+
+static size_t g_checks = 0;
+static size_t g_failures = 0;
+static uint64_t g_random_state = TEST_SEED;
+
+/* Hand-written documents, valid and malformed, on top of the generated ones */
+static const char* const test_documents[] = {
+    "null", "true", "false", "0", "-0", "1e2", "-1.5E-3", "123456789012345678901234567890",
+    "1e23", "5e-324", "1.7976931348623157e308", "\"\"", "\"a\\\"b\\\\c\\/\\b\\f\\n\\r\\t\"",
+    "\"\\u0041\\u00e9\\u20ac\\ud83d\\ude00\"", "[]", "{}", "[[[]]]", " [ 1 , 2 , 3 ] ",
+    "{\"a\":{\"b\":[1,{\"c\":null}]},\"d\":\"e\"}", "{\"k\":1,\"k\":2}",
+    /* Malformed */
+    "", " ", "[", "]", "{", "}", "[1,]", "[,1]", "{\"a\"}", "{\"a\":}", "{\"a\":1,}", "{a:1}",
+    "[1 2]", "[-]", "[1.0e]", "[0x10]", "[NaN]", "[Infinity]", "[01]", "[1.]", "[.5]", "[+1]",
+    "fals", "[fals", "[fals]", "nul", "truex", "{\"a\"", "{\"a\":", "{\"a\" 1}", "\"abc", "\"\\x\"",
+    "\"\\u12\"", "\"\\ud800\"", "[\"a\nb\"]", "[1]]", "[1] [2]", "{\"a\":1}}", "[\"\\",
+    "{\"a\":[1,{\"b\":}]}", "[-", "[1e", "[tru", "[true,false,nul]",
+};
+
+/**
+ * @brief Record one check, reporting the input when it fails
+ */
+static void test_check(int condition, const char* what, const char* input, size_t length) {
+    g_checks++;
+    if (condition) {
+        return;
+    }
+    g_failures++;
+    print_red("✗ ");
+    print_format("%s: input (%zu bytes) '%.*s'\n", what, length, (int)(length > 200 ? 200 : length), input);
+}
+
+/**
+ * @brief Deterministic 64-bit generator (xorshift64*)
+ */
+static uint64_t test_random(void) {
+    g_random_state ^= g_random_state >> 12;
+    g_random_state ^= g_random_state << 25;
+    g_random_state ^= g_random_state >> 27;
+    return g_random_state * 0x2545F4914F6CDD1Dull;
+}
+
+static void test_append(test_text_t* text, const char* data, size_t length) {
+    if (text->length + length + 1 > text->capacity) {
+        size_t capacity = text->capacity ? text->capacity : 256;
+        while (capacity < text->length + length + 1) {
+            capacity *= 2;
+        }
+        char* grown = realloc(text->data, capacity);
+        if (grown == NULL) {
+            fprintf(stderr, "out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+        text->data = grown;
+        text->capacity = capacity;
+    }
+    memcpy(text->data + text->length, data, length);
+    text->length += length;
+    text->data[text->length] = '\0';
+}
+
+/**
+ * @brief Append a random compact value; object keys are distinct
+ */
+static void test_generate_value(test_text_t* text, int depth) {
+    static const char* const strings[] = {
+        "\"\"", "\"plain\"", "\"tab\\tand\\nnewline\"", "\"\\u00e9t\\u00e9\"", "\"\\ud83d\\ude00\"",
+        "\"quote\\\"slash\\\\\"", "\"caf\xc3\xa9\"",
+    };
+    char scratch[64];
+    unsigned kind = (unsigned)(test_random() % (depth < TEST_GENERATED_MAX_DEPTH ? 9 : 7));
+
+    switch (kind) {
+    case 0:
+        test_append(text, "null", 4);
+        break;
+    case 1: {
+        const char* value = test_random() & 1 ? "true" : "false";
+        test_append(text, value, strlen(value));
+        break;
+    }
+    case 2: {
+        int length = snprintf(scratch, sizeof(scratch), "%lld", (long long)(int64_t)test_random());
+        test_append(text, scratch, (size_t)length);
+        break;
+    }
+    case 3: {
+        int length = snprintf(scratch, sizeof(scratch), "%d", (int)(test_random() % 2001) - 1000);
+        test_append(text, scratch, (size_t)length);
+        break;
+    }
+    case 4: {
+        uint64_t bits = test_random();
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        if (!isfinite(value)) {
+            value = 0.5;
+        }
+        int length = snprintf(scratch, sizeof(scratch), "%.17g", value);
+        test_append(text, scratch, (size_t)length);
+        break;
+    }
+    case 5: {
+        int length = snprintf(scratch, sizeof(scratch), "%.3fe%d", (double)(test_random() % 100000) / 7.0,
+                              (int)(test_random() % 41) - 20);
+        test_append(text, scratch, (size_t)length);
+        break;
+    }
+    case 6: {
+        const char* value = strings[test_random() % (sizeof(strings) / sizeof(strings[0]))];
+        test_append(text, value, strlen(value));
+        break;
+    }
+    case 7: {
+        size_t count = (size_t)(test_random() % (TEST_GENERATED_MAX_MEMBERS + 1));
+        test_append(text, "[", 1);
+        for (size_t i = 0; i < count; i++) {
+            if (i > 0) {
+                test_append(text, ",", 1);
+            }
+            test_generate_value(text, depth + 1);
+        }
+        test_append(text, "]", 1);
+        break;
+    }
+    default: {
+        size_t count = (size_t)(test_random() % (TEST_GENERATED_MAX_MEMBERS + 1));
+        test_append(text, "{", 1);
+        for (size_t i = 0; i < count; i++) {
+            int length = snprintf(scratch, sizeof(scratch), "%s\"key%zu\":", i > 0 ? "," : "", i);
+            test_append(text, scratch, (size_t)length);
+            test_generate_value(text, depth + 1);
+        }
+        test_append(text, "}", 1);
+        break;
+    }
+    }
+}
+
+/**
+ * @brief Serialize a tree into a malloc'd copy, NULL on failure
+ */
+static char* test_serialize(const ms_json_value_t* value) {
+    char* text = NULL;
+    if (ms_json_serialize(value, NULL, &text) != MS_JSON_SUCCESS) {
+        return NULL;
+    }
+    size_t length = strlen(text);
+    char* copy = malloc(length + 1);
+    if (copy != NULL) {
+        memcpy(copy, text, length + 1);
+    }
+    ms_allocator_deallocate(ms_allocator_default(), text);
+    return copy;
+}
+
+/**
+ * @brief Turn an engine's result into an outcome, consuming the tree
+ *
+ * A tree that fails to serialize (a lazy tree with a deferred error) yields
+ * the serializer's error instead.
+ */
+static void test_outcome_from_tree(test_outcome_t* outcome, ms_json_result_t status, ms_json_value_t* value) {
+    outcome->status = status;
+    outcome->text = NULL;
+    if (status != MS_JSON_SUCCESS) {
+        return;
+    }
+    char* text = NULL;
+    outcome->status = ms_json_serialize(value, NULL, &text);
+    if (outcome->status == MS_JSON_SUCCESS) {
+        outcome->text = malloc(strlen(text) + 1);
+        if (outcome->text != NULL) {
+            strcpy(outcome->text, text);
+        }
+        ms_allocator_deallocate(ms_allocator_default(), text);
+    }
+    ms_json_destroy(value, NULL);
+}
+
+static void test_outcome_release(test_outcome_t* outcome) {
+    free(outcome->text);
+    outcome->text = NULL;
+}
+
+static void test_run_reference(const char* input, size_t length, test_outcome_t* outcome) {
+    test_run_engine(input, length, MS_JSON_ENGINE_RECURSIVE, outcome);
+}
+
+static void test_run_engine(const char* input, size_t length, ms_json_engine_t engine, test_outcome_t* outcome) {
+    ms_json_options_t options = {0};
+    options.engine = engine;
+    ms_json_value_t* value = NULL;
+    ms_json_result_t status = ms_json_parse_n(input, length, &options, &value);
+    test_outcome_from_tree(outcome, status, value);
+}
+
+static void test_run_lazy(const char* input, size_t length, test_outcome_t* outcome) {
+    ms_json_options_t options = {0};
+    options.lazy = 1;
+    ms_json_value_t* value = NULL;
+    ms_json_result_t status = ms_json_parse_n(input, length, &options, &value);
+    test_outcome_from_tree(outcome, status, value);
+}
+
+/**
+ * @brief Feed input to a push parser in pieces of step bytes
+ */
+static void test_run_push(const char* input, size_t length, size_t step, test_outcome_t* outcome) {
+    ms_json_parser_t* parser = ms_json_parser_create(NULL);
+    if (parser == NULL) {
+        outcome->status = MS_JSON_ERROR_MEMORY;
+        outcome->text = NULL;
+        return;
+    }
+
+    ms_json_result_t status = MS_JSON_SUCCESS;
+    for (size_t offset = 0; offset < length && status == MS_JSON_SUCCESS; offset += step) {
+        size_t piece = length - offset < step ? length - offset : step;
+        status = ms_json_parser_feed(parser, input + offset, piece);
+    }
+
+    ms_json_value_t* value = NULL;
+    if (status == MS_JSON_SUCCESS) {
+        status = ms_json_parser_finish(parser, &value);
+    }
+    ms_json_parser_destroy(parser);
+    test_outcome_from_tree(outcome, status, value);
+}
+
+/* SAX callbacks rebuilding the document as a tree */
+static ms_json_result_t test_sax_add(test_sax_builder_t* builder, ms_json_value_t* value) {
+    if (value == NULL) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+    if (builder->depth == 0) {
+        builder->root = value;
+        return MS_JSON_SUCCESS;
+    }
+    ms_json_value_t* parent = builder->stack[builder->depth - 1];
+    if (ms_json_get_type(parent) == MS_JSON_ARRAY) {
+        return ms_json_array_append(parent, value);
+    }
+    return ms_json_object_set_n(parent, builder->key, builder->key_length, value);
+}
+
+static ms_json_result_t test_sax_open(test_sax_builder_t* builder, ms_json_value_t* container) {
+    ms_json_result_t status = test_sax_add(builder, container);
+    if (status != MS_JSON_SUCCESS) {
+        return status;
+    }
+    if (builder->depth == TEST_SAX_MAX_DEPTH) {
+        return MS_JSON_ERROR_DEPTH;
+    }
+    builder->stack[builder->depth++] = container;
+    return MS_JSON_SUCCESS;
+}
+
+static ms_json_result_t test_sax_null(void* ctx) {
+    return test_sax_add(ctx, ms_json_create_null(NULL));
+}
+
+static ms_json_result_t test_sax_boolean(void* ctx, int value) {
+    return test_sax_add(ctx, ms_json_create_bool(NULL, value));
+}
+
+static ms_json_result_t test_sax_integer(void* ctx, int64_t value) {
+    return test_sax_add(ctx, ms_json_create_integer(NULL, value));
+}
+
+static ms_json_result_t test_sax_number(void* ctx, double value) {
+    return test_sax_add(ctx, ms_json_create_number(NULL, value));
+}
+
+static ms_json_result_t test_sax_string(void* ctx, const char* value, size_t length) {
+    return test_sax_add(ctx, ms_json_create_string_n(NULL, value, length));
+}
+
+static ms_json_result_t test_sax_key(void* ctx, const char* key, size_t length) {
+    test_sax_builder_t* builder = ctx;
+    if (length >= sizeof(builder->key)) {
+        return MS_JSON_ERROR_MEMORY;
+    }
+    memcpy(builder->key, key, length);
+    builder->key_length = length;
+    return MS_JSON_SUCCESS;
+}
+
+static ms_json_result_t test_sax_start_object(void* ctx) {
+    return test_sax_open(ctx, ms_json_create_object(NULL));
+}
+
+static ms_json_result_t test_sax_start_array(void* ctx) {
+    return test_sax_open(ctx, ms_json_create_array(NULL));
+}
+
+static ms_json_result_t test_sax_end(void* ctx) {
+    test_sax_builder_t* builder = ctx;
+    builder->depth--;
+    return MS_JSON_SUCCESS;
+}
+
+static void test_run_sax(const char* input, size_t length, test_outcome_t* outcome) {
+    static const ms_json_sax_handler_t handler = {
+        .null_value = test_sax_null,
+        .boolean = test_sax_boolean,
+        .integer = test_sax_integer,
+        .number = test_sax_number,
+        .string = test_sax_string,
+        .key = test_sax_key,
+        .start_object = test_sax_start_object,
+        .end_object = test_sax_end,
+        .start_array = test_sax_start_array,
+        .end_array = test_sax_end,
+    };
+    test_sax_builder_t builder;
+    memset(&builder, 0, sizeof(builder));
+
+    ms_json_result_t status = ms_json_parse_sax(input, length, NULL, &handler, &builder);
+    if (status != MS_JSON_SUCCESS && builder.root != NULL) {
+        ms_json_destroy(builder.root, NULL);
+        builder.root = NULL;
+    }
+    test_outcome_from_tree(outcome, status, builder.root);
+}
+
+/**
+ * @brief Copy a tape value into a tree, NULL on allocation failure
+ */
+static ms_json_value_t* test_tree_from_tape(ms_json_tape_value_t value) {
+    switch (ms_json_tape_get_type(value)) {
+    case MS_JSON_NULL:
+        return ms_json_create_null(NULL);
+    case MS_JSON_BOOL: {
+        int flag = 0;
+        ms_json_tape_get_bool(value, &flag);
+        return ms_json_create_bool(NULL, flag);
+    }
+    case MS_JSON_NUMBER: {
+        int64_t integer = 0;
+        double number = 0;
+        ms_json_tape_get_number(value, &number);
+        /* -0 reads as integer 0, which would lose the sign */
+        if (ms_json_tape_get_int64(value, &integer) == MS_JSON_SUCCESS && !(integer == 0 && signbit(number))) {
+            return ms_json_create_integer(NULL, integer);
+        }
+        return ms_json_create_number(NULL, number);
+    }
+    case MS_JSON_STRING: {
+        const char* text = NULL;
+        size_t length = 0;
+        ms_json_tape_get_string(value, &text, &length);
+        return ms_json_create_string_n(NULL, text, length);
+    }
+    default:
+        break;
+    }
+
+    int is_object = ms_json_tape_get_type(value) == MS_JSON_OBJECT;
+    ms_json_value_t* container = is_object ? ms_json_create_object(NULL) : ms_json_create_array(NULL);
+    ms_json_tape_iterator_t iterator;
+    if (container == NULL || ms_json_tape_iterate(value, &iterator) != MS_JSON_SUCCESS) {
+        ms_json_destroy(container, NULL);
+        return NULL;
+    }
+
+    ms_json_tape_value_t key;
+    ms_json_tape_value_t member;
+    while (ms_json_tape_next(&iterator, is_object ? &key : NULL, &member)) {
+        ms_json_value_t* child = test_tree_from_tape(member);
+        ms_json_result_t status = MS_JSON_ERROR_MEMORY;
+        if (child != NULL && is_object) {
+            const char* key_text = NULL;
+            size_t key_length = 0;
+            ms_json_tape_get_string(key, &key_text, &key_length);
+            status = ms_json_object_set_n(container, key_text, key_length, child);
+        } else if (child != NULL) {
+            status = ms_json_array_append(container, child);
+        }
+        if (status != MS_JSON_SUCCESS) {
+            ms_json_destroy(child, NULL);
+            ms_json_destroy(container, NULL);
+            return NULL;
+        }
+    }
+    return container;
+}
+
+static void test_run_tape(const char* input, size_t length, test_outcome_t* outcome) {
+    ms_json_tape_t* tape = NULL;
+    ms_json_result_t status = ms_json_tape_parse(input, length, NULL, &tape);
+    ms_json_value_t* value = NULL;
+    if (status == MS_JSON_SUCCESS) {
+        value = test_tree_from_tape(ms_json_tape_root(tape));
+        status = value != NULL ? MS_JSON_SUCCESS : MS_JSON_ERROR_MEMORY;
+        ms_json_tape_destroy(tape);
+    }
+    test_outcome_from_tree(outcome, status, value);
+}
+
+/**
+ * @brief Check that an engine gave the reference tree or error
+ */
+static void test_compare(const char* engine, const test_outcome_t* reference, const test_outcome_t* outcome,
+                         const char* input, size_t length) {
+    char what[128];
+    if (reference->status != MS_JSON_SUCCESS) {
+        snprintf(what, sizeof(what), "%s: error %d, reference %d", engine, outcome->status, reference->status);
+        test_check(outcome->status == reference->status, what, input, length);
+        return;
+    }
+    snprintf(what, sizeof(what), "%s: result %d or text differs from reference", engine, outcome->status);
+    test_check(outcome->status == MS_JSON_SUCCESS && outcome->text != NULL && reference->text != NULL &&
+               strcmp(outcome->text, reference->text) == 0, what, input, length);
+}
+
+/**
+ * @brief Run every parse engine on one input against the reference
+ */
+static void test_parse_engines(const char* input, size_t length) {
+    test_outcome_t reference;
+    test_outcome_t outcome;
+    test_run_reference(input, length, &reference);
+
+    test_run_engine(input, length, MS_JSON_ENGINE_STRUCTURAL, &outcome);
+    test_compare("structural", &reference, &outcome, input, length);
+    test_outcome_release(&outcome);
+
+    test_run_lazy(input, length, &outcome);
+    test_compare("lazy", &reference, &outcome, input, length);
+    test_outcome_release(&outcome);
+
+    test_run_push(input, length, length ? length : 1, &outcome);
+    test_compare("push (whole)", &reference, &outcome, input, length);
+    test_outcome_release(&outcome);
+
+    test_run_push(input, length, 1, &outcome);
+    test_compare("push (byte at a time)", &reference, &outcome, input, length);
+    test_outcome_release(&outcome);
+
+    test_run_sax(input, length, &outcome);
+    test_compare("sax", &reference, &outcome, input, length);
+    test_outcome_release(&outcome);
+
+    test_run_tape(input, length, &outcome);
+    test_compare("tape", &reference, &outcome, input, length);
+    test_outcome_release(&outcome);
+
+    if (reference.status == MS_JSON_SUCCESS) {
+        ms_json_value_t* tree = NULL;
+        if (ms_json_parse_n(input, length, NULL, &tree) == MS_JSON_SUCCESS) {
+            test_tree_encoders(tree, reference.text, input, length);
+            test_path(tree, input, length);
+            ms_json_destroy(tree, NULL);
+        }
+    }
+    test_outcome_release(&reference);
+}
+
+/**
+ * @brief Check serializer variants and msgpack against the reference text
+ */
+static void test_tree_encoders(const ms_json_value_t* tree, const char* reference, const char* input,
+                               size_t length) {
+    size_t size = 0;
+    test_check(ms_json_serialized_size(tree, &size) == MS_JSON_SUCCESS && size == strlen(reference),
+               "serialized_size differs from serialize", input, length);
+
+    char* buffer = malloc(size + 1);
+    size_t written = 0;
+    test_check(buffer != NULL && ms_json_serialize_into(tree, buffer, size + 1, &written) == MS_JSON_SUCCESS &&
+               written == size && strcmp(buffer, reference) == 0,
+               "serialize_into differs from serialize", input, length);
+    if (buffer != NULL && size > 0) {
+        test_check(ms_json_serialize_into(tree, buffer, size, &written) == MS_JSON_ERROR_MEMORY,
+                   "serialize_into accepted a buffer without room for the terminator", input, length);
+    }
+    free(buffer);
+
+    ms_json_parallel_options_t parallel = {0};
+    parallel.threads = 2;
+    parallel.min_members = 1;
+    char* text = NULL;
+    test_check(ms_json_serialize_parallel(tree, NULL, &parallel, &text) == MS_JSON_SUCCESS &&
+               strcmp(text, reference) == 0, "serialize_parallel differs from serialize", input, length);
+    ms_allocator_deallocate(ms_allocator_default(), text);
+
+    uint8_t* packed = NULL;
+    size_t packed_length = 0;
+    ms_json_value_t* decoded = NULL;
+    char* round_trip = NULL;
+    if (ms_json_msgpack_encode(tree, NULL, &packed, &packed_length) == MS_JSON_SUCCESS &&
+        ms_json_msgpack_decode(packed, packed_length, NULL, &decoded) == MS_JSON_SUCCESS) {
+        round_trip = test_serialize(decoded);
+        ms_json_destroy(decoded, NULL);
+    }
+    test_check(round_trip != NULL && strcmp(round_trip, reference) == 0, "msgpack round-trip differs",
+               input, length);
+    free(round_trip);
+    ms_allocator_deallocate(ms_allocator_default(), packed);
+}
+
+/**
+ * @brief Extract each member of the root from text and compare with the tree
+ */
+static void test_path(const ms_json_value_t* tree, const char* input, size_t length) {
+    ms_json_type_t type = ms_json_get_type(tree);
+    size_t count = 0;
+    if (type == MS_JSON_ARRAY) {
+        ms_json_get_array_length(tree, &count);
+    } else if (type == MS_JSON_OBJECT) {
+        ms_json_get_object_size(tree, &count);
+    }
+
+    /* Generated and hand-written objects name their members key0, key1, ... or a-d */
+    static const char* const names[] = { "/a", "/d", "/k", "/key0", "/key1", "/key5", "/missing" };
+    size_t targets = type == MS_JSON_OBJECT ? sizeof(names) / sizeof(names[0]) : count + 1;
+    for (size_t i = 0; i < targets; i++) {
+        char pointer[32];
+        if (type == MS_JSON_OBJECT) {
+            snprintf(pointer, sizeof(pointer), "%s", names[i]);
+        } else if (type == MS_JSON_ARRAY) {
+            snprintf(pointer, sizeof(pointer), "/%zu", i);
+        } else {
+            snprintf(pointer, sizeof(pointer), "%s", "");
+        }
+
+        ms_json_path_t* path = NULL;
+        if (ms_json_path_compile(pointer, NULL, &path) != MS_JSON_SUCCESS) {
+            test_check(0, "path compile failed", pointer, strlen(pointer));
+            continue;
+        }
+
+        ms_json_value_t* expected = NULL;
+        ms_json_result_t eval_status = ms_json_path_eval(path, tree, &expected);
+        ms_json_value_t* extracted = NULL;
+        ms_json_result_t extract_status = ms_json_path_extract(path, input, length, NULL, &extracted);
+
+        char* expected_text = eval_status == MS_JSON_SUCCESS ? test_serialize(expected) : NULL;
+        char* extracted_text = extract_status == MS_JSON_SUCCESS ? test_serialize(extracted) : NULL;
+        int same = eval_status == extract_status &&
+                   (expected_text == extracted_text ||
+                    (expected_text != NULL && extracted_text != NULL && strcmp(expected_text, extracted_text) == 0));
+        /* Extraction keeps the first of repeated keys, a tree the last */
+        if (strstr(input, "\"k\":1,\"k\":2") == NULL) {
+            test_check(same, "path extract differs from eval", input, length);
+        }
+        free(expected_text);
+        free(extracted_text);
+        ms_json_destroy(extracted, NULL);
+        ms_json_path_destroy(path);
+
+        if (type != MS_JSON_ARRAY && type != MS_JSON_OBJECT) {
+            break;
+        }
+    }
+}
+
+static ms_json_result_t test_ndjson_collect(void* user_ctx, size_t line, ms_json_value_t* value) {
+    test_ndjson_ctx_t* ctx = user_ctx;
+    char* text = test_serialize(value);
+    if (line != ctx->delivered + 1 || ctx->delivered >= ctx->count || text == NULL ||
+        strcmp(text, ctx->expected[ctx->delivered]) != 0) {
+        ctx->mismatch = 1;
+    }
+    ctx->delivered++;
+    free(text);
+    return MS_JSON_SUCCESS;
+}
+
+/**
+ * @brief Parse valid documents as NDJSON, then again with a malformed line
+ */
+static void test_ndjson(char* const* documents, size_t count) {
+    test_text_t text = {0};
+    char** expected = calloc(count + 1, sizeof(char*));
+    if (expected == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        ms_json_value_t* tree = NULL;
+        ms_json_parse(documents[i], NULL, &tree);
+        expected[i] = test_serialize(tree);
+        ms_json_destroy(tree, NULL);
+        test_append(&text, documents[i], strlen(documents[i]));
+        test_append(&text, i % 3 == 0 ? "\r\n" : "\n", i % 3 == 0 ? 2 : 1);
+    }
+
+    for (size_t threads = 1; threads <= 3; threads += 2) {
+        ms_json_ndjson_options_t options;
+        memset(&options, 0, sizeof(options));
+        options.threads = threads;
+        options.batch_size = 7;
+        test_ndjson_ctx_t ctx = { expected, count, 0, 0 };
+        size_t error_line = 0;
+        ms_json_result_t status = ms_json_parse_ndjson(text.data, text.length, &options, test_ndjson_collect,
+                                                       &ctx, &error_line);
+        test_check(status == MS_JSON_SUCCESS && ctx.delivered == count && !ctx.mismatch,
+                   "ndjson documents differ from the reference", "(generated documents)", 21);
+    }
+
+    /* A malformed line stops the reader with that line's reference error */
+    static const char malformed[] = "{\"a\":1,}";
+    ms_json_value_t* unused = NULL;
+    ms_json_result_t expected_status = ms_json_parse(malformed, NULL, &unused);
+    size_t bad_line = count / 2 + 1;
+    test_text_t broken = {0};
+    for (size_t i = 0; i < count; i++) {
+        const char* line = i + 1 == bad_line ? malformed : documents[i];
+        test_append(&broken, line, strlen(line));
+        test_append(&broken, "\n", 1);
+    }
+    ms_json_ndjson_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.threads = 3;
+    options.batch_size = 7;
+    test_ndjson_ctx_t ctx = { expected, bad_line - 1, 0, 0 };
+    size_t error_line = 0;
+    ms_json_result_t status = ms_json_parse_ndjson(broken.data, broken.length, &options, test_ndjson_collect,
+                                                   &ctx, &error_line);
+    test_check(status == expected_status && error_line == bad_line && ctx.delivered == bad_line - 1 &&
+               !ctx.mismatch, "ndjson error or error line differs from the reference", malformed,
+               sizeof(malformed) - 1);
+
+    for (size_t i = 0; i < count; i++) {
+        free(expected[i]);
+    }
+    free(expected);
+    free(text.data);
+    free(broken.data);
+}
+
+/**
+ * @brief Decode documents into a struct, compare with the tree, round-trip
+ */
+static void test_bind(void) {
+    static const char* const accepted[] = {
+        "{\"flag\":true,\"small\":-7,\"big\":9007199254740993,\"ratio\":0.1,\"name\":\"caf\\u00e9\","
+        "\"origin\":{\"x\":1,\"y\":-2}}",
+        "{\"small\":-0,\"big\":1e2,\"origin\":{\"x\":2.5e1,\"y\":-0.0}}",
+        "{\"small\":2147483647,\"big\":-9223372036854775808,\"unknown\":[1,{\"a\":2}],\"ratio\":-1e300}",
+        "{\"small\":100e-2,\"name\":\"\",\"flag\":false,\"origin\":null}",
+    };
+    static const char* const rejected[] = {
+        "{\"small\":1.5}", "{\"small\":2147483648}", "{\"small\":1e10}", "{\"big\":9223372036854775808}",
+        "{\"flag\":1}", "{\"name\":\"sixteen chars!!!\"}", "{\"origin\":[]}", "[]", "{\"small\":}", "{\"small\":1",
+    };
+
+    ms_json_bind_schema_t* schema = NULL;
+    if (ms_json_bind_compile(test_record_fields, sizeof(test_record_fields) / sizeof(test_record_fields[0]),
+                             NULL, &schema) != MS_JSON_SUCCESS) {
+        test_check(0, "bind schema did not compile", "", 0);
+        return;
+    }
+
+    for (size_t i = 0; i < sizeof(accepted) / sizeof(accepted[0]); i++) {
+        const char* input = accepted[i];
+        size_t length = strlen(input);
+        test_record_t record;
+        memset(&record, 0, sizeof(record));
+        test_check(ms_json_bind_decode(schema, input, length, NULL, &record) == MS_JSON_SUCCESS,
+                   "bind decode rejected a valid document", input, length);
+
+        /* Every bound member must hold what the tree holds */
+        ms_json_value_t* tree = NULL;
+        ms_json_parse_n(input, length, NULL, &tree);
+        ms_json_value_t* member = NULL;
+        double number = 0;
+        int64_t integer = 0;
+        if (ms_json_get_object_value(tree, "small", &member) == MS_JSON_SUCCESS) {
+            ms_json_get_number(member, &number);
+            test_check(record.small == (int32_t)number, "bind small differs from the tree", input, length);
+        }
+        if (ms_json_get_object_value(tree, "big", &member) == MS_JSON_SUCCESS) {
+            if (ms_json_get_int64(member, &integer) != MS_JSON_SUCCESS) {
+                ms_json_get_number(member, &number);
+                integer = (int64_t)number;
+            }
+            test_check(record.big == integer, "bind big differs from the tree", input, length);
+        }
+        if (ms_json_get_object_value(tree, "ratio", &member) == MS_JSON_SUCCESS) {
+            ms_json_get_number(member, &number);
+            test_check(record.ratio == number, "bind ratio differs from the tree", input, length);
+        }
+        ms_json_destroy(tree, NULL);
+
+        /* Encoding and decoding again gives the same struct */
+        char* encoded = NULL;
+        test_record_t again;
+        memset(&again, 0, sizeof(again));
+        test_check(ms_json_bind_encode(schema, &record, NULL, &encoded) == MS_JSON_SUCCESS &&
+                   ms_json_bind_decode(schema, encoded, strlen(encoded), NULL, &again) == MS_JSON_SUCCESS &&
+                   memcmp(&record, &again, sizeof(record)) == 0, "bind round-trip differs", input, length);
+
+        /* The encoding is what the serializer writes for the same tree */
+        ms_json_value_t* encoded_tree = NULL;
+        char* reference = NULL;
+        if (encoded != NULL && ms_json_parse(encoded, NULL, &encoded_tree) == MS_JSON_SUCCESS) {
+            reference = test_serialize(encoded_tree);
+            ms_json_destroy(encoded_tree, NULL);
+        }
+        test_check(reference != NULL && strcmp(reference, encoded) == 0,
+                   "bind encode differs from serialize", input, length);
+        free(reference);
+
+        char buffer[512];
+        size_t written = 0;
+        test_check(encoded != NULL &&
+                   ms_json_bind_encode_into(schema, &record, buffer, sizeof(buffer), &written) == MS_JSON_SUCCESS &&
+                   written == strlen(encoded) && strcmp(buffer, encoded) == 0,
+                   "bind encode_into differs from encode", input, length);
+        ms_allocator_deallocate(ms_allocator_default(), encoded);
+    }
+
+    for (size_t i = 0; i < sizeof(rejected) / sizeof(rejected[0]); i++) {
+        test_record_t record;
+        memset(&record, 0, sizeof(record));
+        test_check(ms_json_bind_decode(schema, rejected[i], strlen(rejected[i]), NULL, &record) != MS_JSON_SUCCESS,
+                   "bind decode accepted an invalid document", rejected[i], strlen(rejected[i]));
+    }
+
+    ms_json_bind_schema_destroy(schema);
+}
+
+/**
+ * @brief Serialize through a fragment cache across edits
+ */
+static void test_fragment_cache(void) {
+    static const char input[] =
+        "{\"users\":[{\"id\":1,\"tags\":[\"a\",\"b\"]},{\"id\":2,\"tags\":[]}],"
+        "\"meta\":{\"count\":2,\"ratio\":0.30000000000000004},\"empty\":{}}";
+    ms_json_value_t* root = NULL;
+    if (ms_json_parse(input, NULL, &root) != MS_JSON_SUCCESS) {
+        test_check(0, "fragment cache input did not parse", input, sizeof(input) - 1);
+        return;
+    }
+
+    ms_json_fragment_cache_t* cache = NULL;
+    if (ms_json_fragment_cache_create(root, NULL, &cache) != MS_JSON_SUCCESS) {
+        test_check(0, "fragment cache create failed", input, sizeof(input) - 1);
+        ms_json_destroy(root, NULL);
+        return;
+    }
+
+    ms_json_value_t* users = NULL;
+    ms_json_value_t* meta = NULL;
+    ms_json_value_t* first = NULL;
+    ms_json_value_t* tags = NULL;
+    ms_json_get_object_value(root, "users", &users);
+    ms_json_get_object_value(root, "meta", &meta);
+    ms_json_get_array_element(users, 0, &first);
+    ms_json_get_object_value(first, "tags", &tags);
+
+    for (int step = 0; step < 6; step++) {
+        switch (step) {
+        case 1:
+            ms_json_array_append(tags, ms_json_create_string(NULL, "c"));
+            break;
+        case 2:
+            ms_json_object_set(meta, "count", ms_json_create_integer(NULL, 3));
+            break;
+        case 3: {
+            ms_json_value_t* user = ms_json_create_object(NULL);
+            ms_json_object_set(user, "id", ms_json_create_number(NULL, 1e23));
+            ms_json_array_append(users, user);
+            break;
+        }
+        case 4:
+            ms_json_object_set(root, "empty", ms_json_create_array(NULL));
+            break;
+        case 5:
+            ms_json_object_set(root, "added", ms_json_create_string(NULL, "tail\n"));
+            break;
+        default:
+            break;
+        }
+
+        const char* cached = NULL;
+        size_t cached_length = 0;
+        char* reference = test_serialize(root);
+        test_check(ms_json_fragment_cache_serialize(cache, &cached, &cached_length) == MS_JSON_SUCCESS &&
+                   reference != NULL && cached_length == strlen(reference) && strcmp(cached, reference) == 0,
+                   "fragment cache differs from serialize after an edit", reference ? reference : "",
+                   reference ? strlen(reference) : 0);
+        free(reference);
+    }
+
+    ms_json_fragment_cache_destroy(cache);
+    ms_json_destroy(root, NULL);
+}
+
+/**
+ * @brief Check doubles serialize to the shortest text that reads back
+ */
+static void test_doubles(void) {
+    static const struct {
+        double value;
+        const char* text;
+    } known[] = {
+        { 0.1, "0.1" }, { 1e23, "1e23" }, { 5e-324, "5e-324" }, { 0.30000000000000004, "0.30000000000000004" },
+        { 1.7976931348623157e308, "1.7976931348623157e308" }, { 2.5, "2.5" }, { -1234.5678, "-1234.5678" },
+    };
+
+    for (size_t i = 0; i < sizeof(known) / sizeof(known[0]); i++) {
+        ms_json_value_t* number = ms_json_create_number(NULL, known[i].value);
+        char* text = test_serialize(number);
+        ms_json_value_t* parsed = NULL;
+        double back = 0;
+        int reads_back = text != NULL && ms_json_parse(text, NULL, &parsed) == MS_JSON_SUCCESS &&
+                         ms_json_get_number(parsed, &back) == MS_JSON_SUCCESS && back == known[i].value;
+        test_check(reads_back, "double does not read back", text ? text : "", text ? strlen(text) : 0);
+        test_check(text != NULL && strcmp(text, known[i].text) == 0, "double is not the shortest text",
+                   text ? text : "", text ? strlen(text) : 0);
+        free(text);
+        ms_json_destroy(parsed, NULL);
+        ms_json_destroy(number, NULL);
+    }
+
+    for (size_t i = 0; i < TEST_RANDOM_DOUBLES; i++) {
+        uint64_t bits = test_random();
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        if (!isfinite(value)) {
+            continue;
+        }
+
+        ms_json_value_t* number = ms_json_create_number(NULL, value);
+        char* text = test_serialize(number);
+        ms_json_value_t* parsed = NULL;
+        double back = 0;
+        int reads_back = text != NULL && ms_json_parse(text, NULL, &parsed) == MS_JSON_SUCCESS &&
+                         ms_json_get_number(parsed, &back) == MS_JSON_SUCCESS &&
+                         memcmp(&back, &value, sizeof(value)) == 0;
+        test_check(reads_back, "double does not read back", text ? text : "", text ? strlen(text) : 0);
+
+        /* One significant digit fewer must not read back */
+        char shorter[64];
+        size_t digits = 0;
+        size_t trailing_zeros = 0;
+        for (const char* c = text; c != NULL && *c != '\0' && *c != 'e'; c++) {
+            if (*c >= '1' && *c <= '9') {
+                digits += trailing_zeros + 1;
+                trailing_zeros = 0;
+            } else if (*c == '0' && digits > 0) {
+                trailing_zeros++;
+            }
+        }
+        if (text != NULL && digits > 1) {
+            snprintf(shorter, sizeof(shorter), "%.*e", (int)digits - 2, value);
+            test_check(strtod(shorter, NULL) != value, "double is not the shortest text", text, strlen(text));
+        }
+        free(text);
+        ms_json_destroy(parsed, NULL);
+        ms_json_destroy(number, NULL);
+    }
+}
+
+/**
+ * @brief Correctness check entry point
+ */
+int main(void) {
+    print_line('=', 40);
+    print_cyan("MotiveSyz Correctness Checks\n");
+    print_line('=', 40);
+
+    /* Hand-written documents, then every prefix of them */
+    size_t document_count = sizeof(test_documents) / sizeof(test_documents[0]);
+    for (size_t i = 0; i < document_count; i++) {
+        size_t length = strlen(test_documents[i]);
+        for (size_t prefix = 0; prefix <= length; prefix++) {
+            test_parse_engines(test_documents[i], prefix);
+        }
+    }
+    print_format("Hand-written documents: %zu checks\n", g_checks);
+
+    /* Generated documents and their prefixes */
+    char* generated[TEST_GENERATED_DOCS];
+    for (size_t i = 0; i < TEST_GENERATED_DOCS; i++) {
+        test_text_t text = {0};
+        test_generate_value(&text, i % 2 ? 0 : TEST_GENERATED_MAX_DEPTH - 1);
+        generated[i] = text.data;
+        /* Every prefix of short documents, a spread of them for long ones */
+        size_t stride = text.length / 64 + 1;
+        for (size_t prefix = 0; prefix < text.length; prefix += stride) {
+            test_parse_engines(text.data, prefix);
+        }
+        test_parse_engines(text.data, text.length);
+    }
+    print_format("Generated documents: %zu checks\n", g_checks);
+
+    test_ndjson(generated, TEST_GENERATED_DOCS);
+    for (size_t i = 0; i < TEST_GENERATED_DOCS; i++) {
+        free(generated[i]);
+    }
+    test_bind();
+    test_fragment_cache();
+    test_doubles();
+    print_format("Encoders and doubles: %zu checks\n", g_checks);
+
+    print_line('=', 40);
+    if (g_failures > 0) {
+        print_red("Checks failed: ");
+        print_format("%zu of %zu\n", g_failures, g_checks);
+        print_line('=', 40);
+        return EXIT_FAILURE;
+    }
+    print_green("All checks passed!\n");
+    print_line('=', 40);
+    return 0;
+}
@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""Generate src/motivesyz/core/ms_json_number_tables.h.
+
+Two tables are emitted:
+- 128-bit approximations of 5^q for q in [-342, 308], stored as (high, low)
+  64-bit halves with the most significant bit set. Positive powers are
+  truncated; negative powers are the reciprocal rounded up, the layout the
+  Eisel-Lemire parser expects.
+- Normalised 64-bit powers of ten 10^k for k = -348, -340, ..., 340, with
+  their binary exponents, rounded to nearest, for the Grisu2 formatter.
+
+Usage: python3 tools/gen_number_tables.py > src/motivesyz/core/ms_json_number_tables.h
+"""
+
+from fractions import Fraction
+
+SMALLEST_POWER = -342
+LARGEST_POWER = 308
+
+CACHED_POWER_FIRST = -348
+CACHED_POWER_LAST = 340
+CACHED_POWER_STEP = 8
+
+
+def pow5_128(q):
+    if q >= 0:
+        value = 5 ** q
+        while value < (1 << 127):
+            value <<= 1
+        while value >= (1 << 128):
+            value >>= 1
+        return value
+
+    power5 = 5 ** -q
+    z = power5.bit_length()
+    if q >= -27:
+        return (1 << (z + 127)) // power5 + 1
+    value = (1 << (2 * z + 128)) // power5 + 1
+    while value >= (1 << 128):
+        value >>= 1
+    return value
+
+
+def cached_power(k):
+    value = Fraction(10) ** k
+    e = value.numerator.bit_length() - value.denominator.bit_length() - 64
+    while value / Fraction(2) ** e >= 2 ** 64:
+        e += 1
+    while value / Fraction(2) ** e < 2 ** 63:
+        e -= 1
+    scaled = value / Fraction(2) ** e
+    f = (2 * scaled.numerator + scaled.denominator) // (2 * scaled.denominator)
+    assert f.bit_length() == 64
+    return f, e
+
+
+def main():
+    print("/**")
+    print(" * @file ms_json_number_tables.h")
+    print(" * @brief Generated constants for number conversion")
+    print(" *")
+    print(" * Generated by tools/gen_number_tables.py; do not edit by hand.")
+    print(" * Included by ms_json_number.c only.")
+    print(" */")
+    print()
+    print("#ifndef MS_JSON_NUMBER_TABLES_H")
+    print("#define MS_JSON_NUMBER_TABLES_H")
+    print()
+    print("#include <stdint.h>")
+    print()
+    print("#define MS_JSON_POW5_SMALLEST_POWER (%d)" % SMALLEST_POWER)
+    print("#define MS_JSON_POW5_LARGEST_POWER %d" % LARGEST_POWER)
+    print()
+    print("/* 128-bit 5^q, high then low half, for q = SMALLEST_POWER .. LARGEST_POWER */")
+    print("static const uint64_t ms_json_pow5_128[%d] = {"
+          % (2 * (LARGEST_POWER - SMALLEST_POWER + 1)))
+    for q in range(SMALLEST_POWER, LARGEST_POWER + 1):
+        value = pow5_128(q)
+        assert value.bit_length() == 128
+        print("    0x%016xu, 0x%016xu, /* 5^%d */"
+              % (value >> 64, value & ((1 << 64) - 1), q))
+    print("};")
+    print()
+    powers = range(CACHED_POWER_FIRST, CACHED_POWER_LAST + 1, CACHED_POWER_STEP)
+    print("#define MS_JSON_CACHED_POWER_FIRST (%d)" % CACHED_POWER_FIRST)
+    print("#define MS_JSON_CACHED_POWER_STEP %d" % CACHED_POWER_STEP)
+    print()
+    print("/* 10^k = significand * 2^exponent, k = FIRST, FIRST + STEP, ... */")
+    print("static const uint64_t ms_json_cached_power_significand[%d] = {" % len(powers))
+    for k in powers:
+        print("    0x%016xu, /* 10^%d */" % (cached_power(k)[0], k))
+    print("};")
+    print()
+    print("static const int16_t ms_json_cached_power_exponent[%d] = {" % len(powers))
+    exponents = [str(cached_power(k)[1]) for k in powers]
+    for i in range(0, len(exponents), 10):
+        print("    " + ", ".join(exponents[i:i + 10]) + ",")
+    print("};")
+    print()
+    print("#endif /* MS_JSON_NUMBER_TABLES_H */")
+
+
+if __name__ == "__main__":
+    main()